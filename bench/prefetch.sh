@@ -0,0 +1,18 @@
+#!/bin/bash
+# Times bench/prefetch.dj compiled with and without --prefetch.
+# usage: bench/prefetch.sh [nodes] [reps]
+# The default tree, about 40 MB of nodes, is far larger than the last
+# level cache, so walking it misses on nearly every node, the case
+# prefetching is for. Small trees stay in cache and gain little.
+cd "$(dirname "$0")/.." || exit 1
+NODES=${1:-1000000}
+REPS=${2:-10}
+
+make -s all || exit 1
+for flags in "" "--prefetch"; do
+  rm -f program
+  ./bin/dj bench/prefetch.dj $flags </dev/null >/dev/null
+  [ -x program ] || { echo "compile failed"; exit 1; }
+  echo "== ${flags:-baseline} (nodes=$NODES, reps=$REPS)"
+  time (echo "$NODES $REPS" | ./program)
+done
@@ -0,0 +1,31 @@
+/* File assume.h: Using DJ assertions as optimizer facts, and stripping them */
+
+#ifndef ASSUME_H
+#define ASSUME_H
+
+#include "fold.h"
+#include "symtbl.h"
+
+/* Uses the conditions of assert expressions as facts about the program.
+   Once `assert E` has run, E holds (or the program has exited), so later
+   expressions in the same expression list, and the lists nested inside
+   them, can rely on E until a variable it mentions gets assigned.
+   Facts are drawn from comparisons of a parameter or local variable with
+   a nat literal or null, including negated ones and negated ||s:
+     x < N, N < x, x == N  narrow the range of nat variable x
+     !(x == null)          makes object variable x non-null
+   Comparisons decided by a range get folded to 0 or 1, variables whose
+   range is a single value become literals, and field accesses and method
+   calls on non-null variables skip their null checks.
+   This method assumes setupSymbolTables() and typecheckProgram() have
+   already executed. */
+void assumeAssertedFacts();
+
+/* Removes every assert expression from the program, so that asserts are
+   type checked but emit no code. An assert whose value is used (e.g. the
+   last expression of a method body) is replaced by the literal 1, the
+   value of a passing comparison.
+   This method assumes typecheckProgram() has already executed. */
+void stripAsserts();
+
+#endif
@@ -41,6 +41,8 @@ typedef enum {
   WHILE_EXPR,           /* while(E) {Es} */
   PRINT_EXPR,           /* printNat(E) */
   READ_EXPR,            /* readNat() */
+  SPAWN_EXPR,           /* spawn E */
+  JOIN_EXPR,            /* join E */
   THIS_EXPR,            /* this */
   NEW_EXPR,             /* new */
   NULL_EXPR,            /* null */
@@ -75,6 +77,22 @@ typedef struct astnode {
   unsigned int staticClassNum;  /* class number in which this member resides */
   unsigned int staticMemberNum; /* when set to i, this member is the ith
                                    method/var in the staticClassNum-th class */
+  /* Node attribute used on method-call expressions (E.ID(E) and ID(E)).
+    It gets set by the optimizer when the call is known to reach exactly one
+    method body, and holds the NASM label of that body. Code gen then jumps
+    straight to the label instead of going through the VTable dispatcher.
+    When NULL, the call is dispatched dynamically. */
+  char *callTarget;
+  /* Node attribute used on E.ID, E.ID = E, and E.ID(E) expressions.
+    It gets set by the optimizer when E is known never to be null there,
+    and code gen then omits the null check on E. */
+  unsigned int nonNullObject;
+  /* Node attribute used on method-call, if-then-else, and while
+    expressions when profiling. It gets set by numberProfileSites before
+    any optimization, so copies of a node share its counters, and holds
+    the node's call-site or branch-site number plus 1.
+    When 0, the node has no profile counters. */
+  unsigned int profileSite;
 } ASTree;
 
 /* METHODS TO CREATE AND MANIPULATE THE AST */
@@ -93,6 +111,14 @@ ASTree *newAST(ASTNodeType t, ASTree *child, unsigned int natAttribute,
 /* Append an AST node onto a parent's list of children */
 void appendToChildrenList(ASTree *parent, ASTree *newChild);
 
+/* Return a deep copy of the AST rooted at t, including node attributes
+   and identifier strings. */
+ASTree *copyAST(ASTree *t);
+
+/* Free the AST rooted at t, including its lists of children and the
+   identifier strings of its AST_ID nodes. */
+void freeAST(ASTree *t);
+
 /* Print the AST to stdout with indentations marking tree depth. */
 void printAST(ASTree *t);
 
@@ -0,0 +1,33 @@
+/* File cha.h: Class-hierarchy analysis helpers for DJ */
+
+#ifndef CHA_H
+#define CHA_H
+
+#include "typecheck.h"
+
+/* Finds the method body that a call dispatches to.
+   The call was statically resolved (during type checking) to method number
+   staticMethod of class staticClass, and the receiver object has dynamic
+   type dynamicType, which must be a subtype of staticClass.
+   The search climbs from dynamicType towards Object and stops at the first
+   class that declares a method with the same name.
+   On success, stores the declaring class and method number in *targetClass
+   and *targetMethod and returns nonzero; otherwise returns 0. */
+int resolveMethod(int dynamicType, int staticClass, int staticMethod,
+                  int *targetClass, int *targetMethod);
+
+/* Returns the number of distinct method bodies that a call statically
+   resolved to (staticClass, staticMethod) may reach, considering every
+   class in the program that is a subtype of staticClass.
+   When exactly one body is reachable, it is stored in *targetClass and
+   *targetMethod. */
+int countCallTargets(int staticClass, int staticMethod, int *targetClass,
+                     int *targetMethod);
+
+/* Returns nonzero iff a call statically resolved to
+   (staticClass, staticMethod) may reach method number targetMethod of
+   class targetClass. */
+int callMayReach(int staticClass, int staticMethod, int targetClass,
+                 int targetMethod);
+
+#endif
@@ -0,0 +1,44 @@
+/* File clone.h: Specialized copies (clones) of DJ method bodies */
+
+#ifndef CLONE_H
+#define CLONE_H
+
+#include "symtbl.h"
+
+/* Encapsulate all information relevant to a method clone:
+   the method it was copied from, the NASM label it is emitted under,
+   its private copy of the method body, and the exact dynamic type of
+   `this` the clone is customized for (-1 when the clone runs for
+   receivers of any type).
+   A clone shares the parameter and locals of the original method, so code
+   gen treats it exactly like method number methodNum of class classNum,
+   except that it emits bodyExprs under label. */
+typedef struct mclone {
+  int classNum;
+  int methodNum;
+  char *label;
+  ASTree *bodyExprs;
+  int thisType;
+} MethodClone;
+
+// Array of every clone made by the optimizer, in creation order
+extern int numMethodClones;       // size of the array
+extern MethodClone *methodClones; // the array itself
+
+/* Returns the NASM label of method number methodNum of class classNum,
+   e.g. "class3method2". The string is shared and must not be freed. */
+char *methodLabel(int classNum, int methodNum);
+
+/* Copies the body of method number methodNum of class classNum and
+   registers the copy as a clone emitted under the given label.
+   Returns the new clone, which stays valid until the next call. */
+MethodClone *addMethodClone(int classNum, int methodNum, char *label);
+
+/* Returns the clone emitted under the given label, or NULL if none. */
+MethodClone *findMethodClone(char *label);
+
+/* Returns the clone of method number methodNum of class classNum that is
+   customized for receivers of exact type thisType, or NULL if none. */
+MethodClone *findCustomizedClone(int classNum, int methodNum, int thisType);
+
+#endif
@@ -6,6 +6,52 @@
 #include "typecheck.h"
 #include <stdio.h>
 
+/* Default most bytes the heap of a compiled program may grow to */
+#define DEFAULT_HEAP_LIMIT (1LL << 30)
+
+/* Bytes of the heap space in use past which the first collection runs */
+#define GC_MIN_THRESHOLD (4LL * 1024 * 1024)
+
+/* Environment variables that override the heap settings when a compiled
+   program starts: the limit in bytes (with an optional K, M, or G
+   suffix), and 1 or 0 to turn prefaulting or huge pages on or off */
+#define HEAP_LIMIT_ENV "DJ_HEAP_LIMIT"
+#define HEAP_POPULATE_ENV "DJ_HEAP_POPULATE"
+#define HEAP_HUGE_PAGES_ENV "DJ_HEAP_HUGEPAGES"
+
+/* Sets the heap settings compiled into the program: the most bytes the
+   heap may grow to (DEFAULT_HEAP_LIMIT by default; at most 4 GB with
+   compressed references), whether the chunks it grows by are prefaulted
+   with MAP_POPULATE, and whether they get a transparent huge page hint.
+   A program whose heap would grow past the limit exits with code 45.
+   With collect nonzero, the heap is split into two semispaces of half
+   the limit each, and a copying collector reclaims unreachable objects
+   whenever the allocation slow path finds the space in use grown past a
+   threshold (twice the data live after the last collection, and at
+   least GC_MIN_THRESHOLD) or full. Code gen then emits a stack map for
+   every call and allocation, listing the frame slots (locals, the
+   parameter, `this`, and pending operand-stack words) that hold
+   references there, and a table of the reference fields of each class. */
+void configureHeap(long long limit, int populate, int hugePages, int collect);
+
+/* Makes the compiled program write a heap dump (see heapdump.h) to
+   fileName when it exits, including when its heap is exhausted, and
+   whenever it gets SIGUSR1. */
+void dumpHeapTo(char *fileName);
+
+/* Makes the compiled program count the objects and bytes each `new`
+   site (a class and a line) allocates, and track its peak heap in use.
+   At exit it writes a report of them, sorted by bytes, to fileName, or
+   to stderr when fileName is NULL. */
+void countAllocations(char *fileName);
+
+/* Makes the compiled program submit its output flushes and input
+   refills through io_uring, double buffering its output and reading its
+   input ahead, so that it computes while the last output drains and the
+   next input arrives. It falls back to plain read and write when the
+   kernel has no io_uring, or does not allow it. */
+void useIoUring();
+
 /* Perform code generation for the compiler's input program.
    The code generation is based on the enhanced symbol tables built
    in setupSymbolTables, which is declared in symtbl.h.
@@ -0,0 +1,29 @@
+/* File customize.h: Receiver-type customization of inherited DJ methods */
+
+#ifndef CUSTOMIZE_H
+#define CUSTOMIZE_H
+
+#include "cha.h"
+#include "clone.h"
+
+/* Default code-growth budget for customization, counted in AST nodes of
+   the cloned method bodies */
+#define DEFAULT_CUSTOMIZE_BUDGET 2000
+
+/* Customizes inherited methods for the subclasses that inherit them.
+   A method declared in class C is compiled once and runs for receivers of
+   C and of every subclass that does not override it, so calls on `this`
+   inside it must go through the dispatcher. For a subclass D inheriting
+   such a method, a clone customized for receivers of exact type D resolves
+   every call on `this` at compile time into a direct jump.
+   Candidates are ranked by the number of calls on `this` they contain
+   (calls inside while loops count more), or, when a profile has been
+   read, by the number of those calls the profile saw with receivers of
+   the subclass; clones are made while the cloned bodies fit within
+   budget AST nodes.
+   The dispatcher routes receivers of type D to their customized clones.
+   This method assumes setupSymbolTables() and typecheckProgram() have
+   already executed. */
+void customizeInheritedMethods(int budget);
+
+#endif
@@ -0,0 +1,22 @@
+/* File deadfield.h: Dead field elimination for DJ object layouts */
+
+#ifndef DEADFIELD_H
+#define DEADFIELD_H
+
+#include "layout.h"
+#include "typecheck.h"
+
+/* Removes fields that are never read from the object layout.
+   A whole-program scan over ID and E.ID expressions finds every field
+   that some expression reads. The others (written but never read, or
+   never used at all) get no slot in the layout, so objects shrink and
+   `new` zeroes less memory.
+   Stores to removed fields are eliminated: `f = E` and `this.f = E`
+   become just E, and code gen drops the store of other `E1.f = E2`
+   expressions, keeping only the evaluation and null check of E1.
+   This method assumes setupSymbolTables() and typecheckProgram() have
+   already executed, and must run before any method clones are made and
+   before any object layout is queried. */
+void eliminateDeadFields();
+
+#endif
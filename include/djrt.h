@@ -0,0 +1,79 @@
+/* File djrt.h: ABI of the DJ runtime library, libdjrt.a, assembled
+   from runtime/djrt.asm and linked into compiled programs. Code gen
+   emits the calls it describes; the driver links the library. */
+
+#ifndef DJRT_H
+#define DJRT_H
+
+/* Version of the ABI below. The library defines the symbol
+   DJRT_ABI_SYMBOL, which every program that calls into it refers to,
+   so that a program and a library of different versions fail to link.
+   Bump both (and the symbol in runtime/djrt.asm) on any change a
+   program compiled for the old ABI would notice. */
+#define DJRT_ABI_VERSION 1
+#define DJRT_ABI_SYMBOL "djrt_abi_1"
+
+/* File name of the library, which the driver looks for next to itself */
+#define DJRT_LIBRARY "libdjrt.a"
+
+/* Entry points, none of which needs the stack aligned:
+     _djrt_init    sets up the runtime at startup, for the DJRT_INIT_*
+                   flags in RDI, given the process's initial stack
+                   pointer in RSI, from which it finds the environment;
+                   keeps RBX, RBP, and R12 to R15
+     _print_int    appends the nat in RAX and a newline to the output;
+                   keeps every register but RAX
+     _read_int     returns in RAX the nat of the next token of the
+                   input, or 0 at its end, flushing the output first
+                   when it must wait for input; keeps every other
+                   register
+     _flush_output writes out (or starts writing out) the output
+     _output_wait  waits until the output started is written
+   The last two keep every register, and are called in this order
+   before the program exits.
+   The methods of the intrinsic classes, _djrt_vector_get and the
+   others intrinsicRoutine names, take the address of the object's
+   state field in RDI and the argument in RSI, return the result in
+   RAX, and keep every other register; they exit with code 45 when
+   memory runs out.
+   The scheduler of spawned tasks, which finds the calling thread's
+   worker in R12:
+     _djrt_sched_init  starts the worker threads, given the process's
+                       initial stack pointer in RDI, and returns the
+                       calling thread's worker in RAX; the threads
+                       start with the caller's R14, and with R13 and R15
+                       0; keeps RBX, RBP, and R12 to R15
+     _djrt_spawn       queues a task calling the entry at RDI with the
+                       receiver in RSI and the argument in RDX, and
+                       returns its handle in RAX
+     _djrt_join        returns in RAX the result of the task whose
+                       handle is RDI, with RDX 0, running other tasks
+                       until it is done; returns at once with RDX 1
+                       when RDI is not the handle of a task spawned and
+                       not yet joined
+     _djrt_io_lock     keeps other threads from printing and reading
+     _djrt_io_unlock   until this
+   A program that runs its spawned calls at once, without worker
+   threads, still gets handles, with these, which keep every register
+   but RAX (and RDX for the join):
+     _djrt_spawn_inline returns the handle of a task done already,
+                        whose result is RDI
+     _djrt_join_inline  returns as _djrt_join does
+   An entry takes the receiver in RSI and the argument in RDX and
+   returns the result in RAX, keeping RBP, R12, and R14 and leaving R13
+   and R15 at the end of the thread's heap block. _djrt_spawn and
+   _djrt_join keep only RBP, RSP, R12, and R14, since tasks may run in
+   them; the lock routines keep every register. */
+#define DJRT_INIT_OUTPUT 1   // the program prints
+#define DJRT_INIT_INPUT 2    // the program reads
+#define DJRT_INIT_IO_URING 4 // try the io_uring backend
+
+/* Environment variable that, set to 0, keeps a program compiled with
+   --io-uring on plain read and write */
+#define IO_URING_ENV "DJ_IO_URING"
+
+/* Environment variable that sets the number of workers that run a
+   program's spawned tasks (by default, the CPUs it may run on) */
+#define WORKERS_ENV "DJ_WORKERS"
+
+#endif
@@ -0,0 +1,45 @@
+/* File fieldorder.h: Access-frequency ordering of DJ object layouts */
+
+#ifndef FIELDORDER_H
+#define FIELDORDER_H
+
+#include "clone.h"
+#include "layout.h"
+#include "profile.h"
+#include "typecheck.h"
+
+/* Weight of an access inside a while loop, relative to one outside it,
+   when there is no profile */
+#define LOOP_WEIGHT 10
+
+/* Loop nesting beyond which accesses get no more weight */
+#define MAX_LOOP_DEPTH 6
+
+/* Percentage of all field accesses that the fields of one class must
+   account for before its objects are aligned to cache lines */
+#define HOT_CLASS_PERCENT 10
+
+/* Orders each class's own fields by how often they are accessed, so that
+   the hottest fields come first in the part of the object the class adds
+   after its superclass's slots.
+   Every ID, E.ID, ID = E, and E.ID = E expression that accesses a field
+   adds to the field's weight (see setFieldWeight). Without a profile, an
+   access weighs LOOP_WEIGHT to the power of the number of while loops
+   around it. With a profile read by readProfile, an access weighs the
+   number of iterations of the innermost while loop around it, or else
+   the number of entries to its method (1 in the main block).
+   The main block, method bodies, and method clones are all scanned.
+   This method assumes setupSymbolTables() and typecheckProgram() have
+   already executed, and must run before any object layout is queried. */
+void orderFieldsByAccess();
+
+/* Aligns objects of hot classes to cache lines, so that a hot object of
+   at most CACHE_LINE_SIZE bytes never straddles two lines. A class is hot
+   when the accesses to the fields it declares or inherits, weighed as
+   orderFieldsByAccess does, make up at least HOT_CLASS_PERCENT of all
+   field accesses.
+   This method assumes setupSymbolTables() and typecheckProgram() have
+   already executed, and must run before any object layout is queried. */
+void alignHotClasses();
+
+#endif
@@ -0,0 +1,24 @@
+/* File fold.h: Constant folding and dead-branch elimination for DJ */
+
+#ifndef FOLD_H
+#define FOLD_H
+
+#include "ast.h"
+
+/* Returns nonzero iff t is a nat literal, storing its value in *value. */
+int isNatLiteral(ASTree *t, unsigned int *value);
+
+/* Folds the expression t, whose subexpressions get folded first.
+   Returns the expression that should replace t in its parent, which is t
+   itself when nothing could be folded at the top level.
+   Sets *changed to 1 if anything in the tree changed. */
+ASTree *foldExpr(ASTree *t, int *changed);
+
+/* Folds every expression in the EXPR_LIST exprList.
+   If-then-else expressions with a constant condition are replaced by the
+   expressions of the branch that always runs, and expressions with no
+   side effects whose value is discarded get removed.
+   Returns nonzero iff anything changed. */
+int foldExprs(ASTree *exprList);
+
+#endif
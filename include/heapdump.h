@@ -0,0 +1,34 @@
+/* File heapdump.h: Format of the heap dumps of compiled DJ programs,
+   shared by code gen, which emits the runtime that writes them, and
+   the djheap tool, which reads them */
+
+#ifndef HEAPDUMP_H
+#define HEAPDUMP_H
+
+/* Heap dump file written by programs compiled with --heap-dump */
+#define DEFAULT_HEAP_DUMP_FILE "program.heapdump"
+
+/* Magic string that starts every heap dump */
+#define HEAP_DUMP_MAGIC "DJHEAP01"
+
+/* A heap dump is a sequence of 8-byte little-endian words:
+     the magic string;
+     the number of classes, 1 if references are compressed (or else 0),
+     and the address compressed references are offsets from;
+     for each class, by type id: its object size in bytes, the number of
+     its reference fields and their offsets, the length of its name, and
+     the name, padded with zero bytes to a whole word;
+   then segments until the end of the file, each its kind, start
+   address, and length in bytes, followed by its contents.
+   Objects in image and heap segments follow each other, each starting
+   with its type id (a 32-bit one with compressed references); a zero
+   word is a gap left by alignment, or an instance of Object. The roots
+   of the object graph are the words of the stack segment, the program's
+   stack, that are addresses of objects, and the objects of the image
+   segment, which is never freed (the collector scans it as roots too).
+   No other memory of the program holds references. */
+#define DUMP_SEGMENT_STACK 0
+#define DUMP_SEGMENT_IMAGE 1 // the heap image pre-evaluation built
+#define DUMP_SEGMENT_HEAP 2
+
+#endif
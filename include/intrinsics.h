@@ -0,0 +1,58 @@
+/* File intrinsics.h: Built-in collection classes of DJ, whose methods
+   are routines of the runtime library */
+
+#ifndef INTRINSICS_H
+#define INTRINSICS_H
+
+#include "symtbl.h"
+
+/* The intrinsic classes, both final subclasses of Object whose methods
+   all take and return a nat. Since every DJ method takes exactly one
+   argument, set and put cannot take the index or key they store under;
+   they store under the one the object has selected instead. Only get
+   and has change an object's selection, which starts at index (or key)
+   0 and belongs to the object, not to its caller: a set or put stores
+   under the argument of the last get or has on the object, through any
+   reference to it. So
+     v.get(i); v.get(j); v.set(x);
+   stores x as element j, and element i stays as it was.
+     NatVector  a growable array of nats, all 0 at first
+       get(i)   returns element i, or 0 past the end; selects i
+       set(v)   stores v as the selected element, growing the vector
+                with 0s up to it; returns v
+       push(v)  appends v; returns the new size
+       size(x)  returns the number of elements
+     NatMap     a map from nats to nats, every key mapped to 0 at first
+       get(k)   returns the value of key k; selects k
+       has(k)   returns 1 if a value was put under key k, 0 otherwise;
+                selects k
+       put(v)   stores v under the selected key; returns v
+       size(x)  returns the number of keys a value was put under
+   Their objects hold nothing but INTRINSIC_STATE_FIELD. */
+
+/* Name of the nat field of an intrinsic class's objects that points at
+   their storage, which the runtime maps outside the heap on first use
+   (it starts out 0). It is not a DJ identifier, so programs cannot
+   name it. The storage is never unmapped, even once the object is
+   garbage. */
+#define INTRINSIC_STATE_FIELD "$state"
+
+/* Returns the number of intrinsic classes the program whose AST is
+   program needs: those whose name it mentions and does not declare as
+   a class of its own. */
+int countIntrinsicClasses(ASTree *program);
+
+/* Fills in classesST entries firstClass onwards with the classes
+   countIntrinsicClasses counted, in that number. */
+void setupIntrinsicClasses(int firstClass);
+
+/* Returns nonzero iff class number classNum is an intrinsic class */
+int isIntrinsicClass(int classNum);
+
+/* Returns the runtime routine that implements method number methodNum
+   of intrinsic class number classNum. Every routine takes the address
+   of the object's state field in RDI and the argument in RSI, returns
+   the result in RAX, and keeps every other register. */
+char *intrinsicRoutine(int classNum, int methodNum);
+
+#endif
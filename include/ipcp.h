@@ -0,0 +1,30 @@
+/* File ipcp.h: Interprocedural constant propagation for DJ */
+
+#ifndef IPCP_H
+#define IPCP_H
+
+#include "cha.h"
+#include "clone.h"
+#include "fold.h"
+
+/* Number of call sites that must pass the same constant to a method before
+   a clone of the method gets specialized for that constant */
+#define IPCP_HOT_SITES 2
+
+/* Most clones made per method */
+#define IPCP_MAX_CLONES 2
+
+/* Propagates constant method arguments across the whole program.
+   For every method, the arguments passed at all call sites that may reach
+   it are merged into a lattice value: no calls seen, one constant, or
+   varying.
+   When every call passes the same nat literal, the literal replaces the
+   parameter inside the method body, which is then folded.
+   When a few literals dominate, clones such as class3method2_arg1 are
+   specialized for them and folded, and call sites that can only reach the
+   method and pass the literal get retargeted to the clone.
+   This method assumes setupSymbolTables() and typecheckProgram() have
+   already executed. */
+void propagateArgumentConstants();
+
+#endif
@@ -0,0 +1,90 @@
+/* File layout.h: Layout of DJ objects in memory */
+
+#ifndef LAYOUT_H
+#define LAYOUT_H
+
+#include "symtbl.h"
+
+/* Size in bytes of a full-width slot: the type id, object references, and
+   nat fields that have not been narrowed */
+#define SLOT_SIZE 8
+
+/* Size in bytes of a compressed reference, and of the type id header of
+   objects when references are compressed */
+#define COMPRESSED_SIZE 4
+
+/* Size in bytes of a cache line */
+#define CACHE_LINE_SIZE 64
+
+/* Encapsulate where a field lives inside an object: its byte offset from
+   the start of the object (the type id comes first, so every offset is at
+   least SLOT_SIZE), and the width of its slot in bytes (1, 2, 4, or 8).
+   Nat fields narrower than 8 bytes hold zero-extended values.
+   A width of 0 means the field was removed from the layout: it is never
+   read, so stores to it are dropped.
+   A compressed slot holds a reference as a COMPRESSED_SIZE-byte offset
+   from the start of the heap, with 0 for null (see compressReferences). */
+typedef struct fieldslot {
+  int offset;
+  int width;
+  int compressed;
+} FieldSlot;
+
+/* Switches to compressed references: every reference field that is still
+   in the layout gets a COMPRESSED_SIZE-byte slot holding the object's
+   offset from the start of the heap (never 0, which encodes null), and
+   the type id header shrinks to COMPRESSED_SIZE bytes, so the first
+   field can share the header's word. Objects still start and end on
+   SLOT_SIZE boundaries.
+   Must be called after every setFieldWidth call and before the first
+   layout query. */
+void compressReferences();
+
+/* Returns nonzero iff references are compressed */
+int referencesCompressed();
+
+/* Returns the size in bytes of the type id header at the start of every
+   object: SLOT_SIZE, or COMPRESSED_SIZE with compressed references. */
+int getHeaderSize();
+
+/* Sets the width in bytes (0, 1, 2, 4, or 8) of the slot for variable
+   number varNum of class classNum. All slots are 8 bytes wide by default.
+   Must be called before the first layout query. */
+void setFieldWidth(int classNum, int varNum, int width);
+
+/* Returns the width in bytes of the slot for variable number varNum of
+   class classNum */
+int getFieldWidth(int classNum, int varNum);
+
+/* Sets the access weight of the slot for variable number varNum of class
+   classNum: an estimate of how often the field is read or written.
+   A class lays out its own variables heaviest first, so its hot fields
+   share the object's first cache line. Weights are 0 by default, which
+   lays variables out widest first, in declaration order.
+   Must be called before the first layout query. */
+void setFieldWeight(int classNum, int varNum, long long weight);
+
+/* Sets the alignment in bytes (SLOT_SIZE by default, or CACHE_LINE_SIZE)
+   that `new` gives objects of class classNum. It does not apply to
+   objects of subclasses. */
+void setObjectAlignment(int classNum, int alignment);
+
+/* Returns the alignment in bytes of objects of class classNum */
+int getObjectAlignment(int classNum);
+
+/* Returns the slot of the field called fieldName in objects of static type
+   objType. The field may be declared in objType or any superclass; since
+   every class lays its own fields out after those of its superclass, the
+   slot is the same in objects of every subclass. */
+FieldSlot getFieldSlot(int objType, char *fieldName);
+
+/* Returns the size in bytes of objects of class classNum, including the
+   type id. Sizes are multiples of SLOT_SIZE. */
+int getObjectSize(int classNum);
+
+/* Prints the layout of every class: its size, alignment, and the number
+   of cache lines an object can touch, then the offset, width, and access
+   weight of every slot, inherited slots first. */
+void printLayoutReport();
+
+#endif
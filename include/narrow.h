@@ -0,0 +1,25 @@
+/* File narrow.h: Value-range narrowing of DJ nat field storage */
+
+#ifndef NARROW_H
+#define NARROW_H
+
+#include "layout.h"
+#include "typecheck.h"
+
+/* Narrows the slots of nat fields that provably hold small values.
+   An interval analysis computes, for every nat field in
+   classesST[i].varList, a range covering every value ever stored into it
+   (fields start out as 0). Stored values get their ranges from literals,
+   comparisons, arithmetic on bounded ranges, other fields' ranges, and
+   the enclosing if/while conditions that compare a variable or field of
+   `this` with a literal (e.g. the store in
+   `if (n < 9) { n = n + 1; } else { n = 0; }` is within [1, 9]).
+   The analysis iterates to a fixed point, widening fields whose range
+   keeps growing to the full nat range.
+   Fields whose range fits in 8, 16, or 32 unsigned bits get 1-, 2-, or
+   4-byte slots in the object layout.
+   This method assumes setupSymbolTables() and typecheckProgram() have
+   already executed, and must run before any object layout is queried. */
+void narrowFieldStorage();
+
+#endif
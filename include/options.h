@@ -0,0 +1,39 @@
+/* File options.h: Command-line options of the DJ compiler */
+
+#ifndef OPTIONS_H
+#define OPTIONS_H
+
+/* Encapsulate every setting that can be given on the command line. */
+typedef struct compileroptions {
+  char *sourceFile; // the DJ program to compile
+
+  // Which optimization passes run (-O levels, --PASS, --disable-pass=PASS)
+  // is kept by the pass manager; see passes.h
+  int customizeBudget; // --customize-budget=N: AST nodes customization may add
+  int preevalFuel;     // --preeval-fuel=N: expressions --preeval may evaluate
+  int timePasses;      // --time-passes: print the time each pass takes
+  int passStats;       // --pass-stats: print how each pass changes the code
+  char *dumpAfter;     // --dump-after=PASS: print the program after PASS
+  int layoutReport;    // --layout-report: print the object layouts
+  char *profileGenerate; // --profile-generate[=FILE]: instrument the program
+                         // to write a profile to FILE
+  char *profileUse;      // --profile-use[=FILE]: optimize using the profile
+                         // in FILE
+  long long heapLimit;   // --heap-limit=N: most bytes the heap may grow to
+  int heapPopulate;      // --heap-populate: prefault heap chunks
+  int heapHugePages;     // --heap-hugepages: huge page hint for the heap
+  int collectGarbage;    // --gc: reclaim unreachable objects
+  char *heapDump;        // --heap-dump[=FILE]: write a heap dump to FILE
+  int allocStats;        // --alloc-stats[=FILE]: report allocation sites
+  char *allocStatsFile;  // ... to FILE, or NULL for stderr
+  int ioUring;           // --io-uring: do I/O through io_uring
+} CompilerOptions;
+
+/* The options of this compiler run; set in parseCommandLine */
+extern CompilerOptions options;
+
+/* Parses the command line into the options global.
+   Prints a usage message and exits the compiler on a bad command line. */
+void parseCommandLine(int argc, char **argv);
+
+#endif
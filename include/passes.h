@@ -0,0 +1,40 @@
+/* File passes.h: Optimization pass manager of the DJ compiler */
+
+#ifndef PASSES_H
+#define PASSES_H
+
+/* Optimization levels, selected with -O0, -O1, -O2, and -Os */
+typedef enum {
+  OPT_LEVEL_0, /* no optimization */
+  OPT_LEVEL_1, /* cheap optimizations that never grow the code much */
+  OPT_LEVEL_2, /* every optimization that keeps the program's meaning */
+  OPT_LEVEL_S  /* optimizations that make the program smaller */
+} OptLevel;
+
+/* Selects the optimization level, which decides the passes that run
+   unless a pass is enabled or disabled explicitly. */
+void setOptLevel(OptLevel level);
+
+/* Explicitly enables (enabled nonzero) or disables the pass called name,
+   whatever the optimization level. Returns 0 if there is no such pass. */
+int setPassEnabled(const char *name, int enabled);
+
+/* Returns nonzero iff name is the name of a pass, or "all" */
+int isPassName(const char *name);
+
+/* Prints the passes in the order they run, with the levels that
+   enable them. */
+void listPasses();
+
+/* Runs the enabled optimization passes, in their fixed order, between
+   type checking and code generation.
+   With options.timePasses set, prints the time each pass took; with
+   options.passStats set, prints how each pass changed the program (AST
+   nodes and method clones); with options.dumpAfter naming a pass (or
+   "all"), prints the program after that pass runs; with
+   options.layoutReport set, prints the resulting object layouts.
+   This method assumes setupSymbolTables() and typecheckProgram() have
+   already executed. */
+void runPasses();
+
+#endif
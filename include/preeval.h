@@ -0,0 +1,43 @@
+/* File preeval.h: Compile-time evaluation of the start of the main block */
+
+#ifndef PREEVAL_H
+#define PREEVAL_H
+
+#include "cha.h"
+#include "layout.h"
+
+/* Default number of expressions pre-evaluation may evaluate */
+#define DEFAULT_PREEVAL_FUEL 1000000
+
+/* Encapsulate one word of compile-time state: a nat, or, when isRef is
+   set, a reference to the object at byte offset value of the heap image */
+typedef struct imageword {
+  long long value;
+  int isRef;
+} ImageWord;
+
+// The objects pre-evaluation created, laid out as code gen lays out
+// objects; code gen emits them as initialized data. With compressed
+// references, the image is copied to the start of the heap when the
+// program starts, and compressed slots in it already hold heap offsets
+extern int heapImageWords;    // size of the image, in words
+extern ImageWord *heapImage;  // the image itself
+
+// The values of the main block's locals after the evaluated prefix,
+// indexed like mainBlockST; NULL when nothing was evaluated
+extern ImageWord *mainLocalsImage;
+
+/* Evaluates the deterministic prefix of the main block at compile time.
+   Statements of the main block are run by an interpreter, in order,
+   until one reads or prints, fails (a null dereference or failing
+   assert), recurses too deeply, or would use more than fuel evaluation
+   steps in total. That statement and everything after it stay in the
+   main block; the statements before it are removed, and the objects
+   and local values they produced become the heap image and the initial
+   values of the main block's locals.
+   This method assumes setupSymbolTables() and typecheckProgram() have
+   already executed, and must run after every optimization that reads the
+   main block to decide what may run (rapid type analysis). */
+void preevaluateMain(int fuel);
+
+#endif
@@ -0,0 +1,41 @@
+/* File prefetch.h: Software prefetching for pointer-chasing DJ code */
+
+#ifndef PREFETCH_H
+#define PREFETCH_H
+
+#include "cha.h"
+#include "clone.h"
+
+/* Encapsulate one prefetch the code generator should emit: at the start
+   of anchor (the body of a while loop, or a method body), evaluate
+   baseExpr, an object of static type baseType, load its reference field
+   called field, and prefetch the object of static type targetType that
+   field points to.
+   A null base skips the prefetch; a null field value is prefetched
+   harmlessly, since prefetches never fault. */
+typedef struct prefetchsite {
+  ASTree *anchor;
+  ASTree *baseExpr;
+  int baseType;
+  char *field;
+  int targetType;
+} PrefetchSite;
+
+// Array of every prefetch site found, in discovery order
+extern int numPrefetchSites;        // size of the array
+extern PrefetchSite *prefetchSites; // the array itself
+
+/* Finds pointer-chasing code and records where to prefetch:
+   - a while loop whose body walks a variable along a reference field
+     (x = x.next) prefetches x.next at the start of every iteration;
+   - a method that calls itself recursively on a reference field of
+     `this` (left.m(E)) or of its parameter (m(p.left)) prefetches the
+     objects those fields point to on entry, so the memory accesses of
+     the recursive calls overlap with the rest of the current call.
+   Method bodies, method clones, and the main block are all searched.
+   This method assumes setupSymbolTables() and typecheckProgram() have
+   already executed, and should run after every optimization that makes
+   method clones. */
+void findPrefetchSites();
+
+#endif
@@ -0,0 +1,75 @@
+/* File profile.h: Profile-guided optimization support for DJ */
+
+#ifndef PROFILE_H
+#define PROFILE_H
+
+#include "cha.h"
+
+/* Profile file written by instrumented programs and read back by default */
+#define DEFAULT_PROFILE_FILE "program.prof"
+
+/* Percentage of a call site's calls one receiver type must account for
+   before the call gets a guarded direct jump to that type's method */
+#define GUARD_PERCENT 90
+
+/* Sizes of the profile of the program being compiled */
+extern int numProfileMethods;  // method-entry counters, one per method
+extern int numProfileBranches; // if-then-else and while sites
+extern int numProfileCalls;    // method-call sites
+
+/* Makes code gen instrument the program with profile counters, which the
+   program writes to fileName when it exits. */
+void instrumentForProfile(char *fileName);
+
+/* Returns the file an instrumented program writes its profile to, or
+   NULL when code gen does not instrument the program. */
+char *profileOutputFile();
+
+/* Numbers the profile sites of the program.
+   Every method gets an entry counter. Every if-then-else and while
+   expression gets a branch-site number and every method call a call-site
+   number, in a fixed traversal order (the main block, then the methods
+   of each class), stored in the nodes' profileSite attributes.
+   This method assumes setupSymbolTables() and typecheckProgram() have
+   already executed, and must run before any optimization, so that an
+   instrumented build and a build using its profile agree on numbers. */
+void numberProfileSites();
+
+/* Returns the index of method number methodNum of class classNum among
+   the method-entry counters. */
+int profileMethodIndex(int classNum, int methodNum);
+
+/* Returns the statically resolved (class << 32 | member) identity of
+   call site number site, which the profile file records so that a
+   profile can be checked against the program it is used for. The
+   identity is the one numberProfileSites() saw, even if an optimization
+   has removed the call since. */
+long long profileCallIdentity(int site);
+
+/* Reads the profile in fileName, written by a run of this program built
+   with --profile-generate. Prints a warning and keeps no profile when the
+   file is missing or does not match the program. */
+void readProfile(char *fileName);
+
+/* Returns nonzero iff a profile has been read */
+int haveProfile();
+
+/* Returns the number of times method number methodNum of class classNum
+   was entered (0 without a profile). */
+long long methodEntryCount(int classNum, int methodNum);
+
+/* Returns how often the branch site t (an if-then-else or while
+   expression) went each way: for an if-then-else, taken selects the
+   then-branch (1) or the else-branch (0); for a while loop, the number of
+   iterations (1) or of exits (0). Returns 0 without a profile. */
+long long branchCount(ASTree *t, int taken);
+
+/* Returns the number of calls at call site t whose receiver had exact
+   type dynamicType (0 without a profile). */
+long long receiverCount(ASTree *t, int dynamicType);
+
+/* Returns the receiver type that accounts for at least GUARD_PERCENT of
+   the calls at call site t, or 0 if there is none. */
+int dominantReceiver(ASTree *t);
+
+#endif
@@ -0,0 +1,26 @@
+/* File promote.h: Scalar promotion of DJ fields inside while loops */
+
+#ifndef PROMOTE_H
+#define PROMOTE_H
+
+#include "clone.h"
+#include "typecheck.h"
+
+/* Promotes fields of `this` into locals across while loops.
+   Inside a method, every access to a field of `this` loads `this` from the
+   stack frame and then loads or stores the field slot. For a while loop
+   that makes no method calls, each field of `this` the loop accesses is
+   instead copied into a synthetic local before the loop, accessed through
+   that local inside the loop, and (if the loop assigns it) copied back
+   after the loop.
+   A field is not promoted when the loop also accesses it through any
+   reference other than `this`, since that reference could alias `this`.
+   Loops with method calls are not promoted at all, since the callee could
+   access the fields through its own `this`.
+   Only while loops that appear directly in an expression list are
+   promoted. Method bodies and method clones are both processed.
+   This method assumes setupSymbolTables() and typecheckProgram() have
+   already executed. */
+void promoteLoopFields();
+
+#endif
@@ -0,0 +1,40 @@
+/* File rta.h: Rapid type analysis of DJ programs */
+
+#ifndef RTA_H
+#define RTA_H
+
+#include "cha.h"
+#include "clone.h"
+
+/* Finds the parts of the program that can run.
+   Starting from the main block, the analysis tracks which classes get
+   instantiated (by reachable `new` expressions) and which method bodies
+   can be reached: a dispatched call reaches, for every instantiated
+   subtype of its static class, the body that subtype dispatches to, and
+   a call the optimizer bound to a label reaches that body (a method or a
+   method clone). Newly reached bodies are scanned in turn until nothing
+   changes.
+   Afterwards, code gen skips unreachable methods and clones, dispatch rows
+   for calls that are never made or receiver types that never exist, and
+   the printNat/readNat runtime helpers when no reachable code uses them.
+   This method assumes setupSymbolTables() and typecheckProgram() have
+   already executed, and must run after every optimization that makes
+   method clones. */
+void runRapidTypeAnalysis();
+
+/* Returns nonzero iff method number methodNum of class classNum may run.
+   Every method may run when runRapidTypeAnalysis() has not executed. */
+int isMethodLive(int classNum, int methodNum);
+
+/* Returns nonzero iff the clone methodClones[cloneNum] may run. */
+int isCloneLive(int cloneNum);
+
+/* Returns nonzero iff the dispatcher row for calls resolved to
+   (staticClass, staticMethod) on receivers of type dynamicType may match. */
+int isDispatchRowLive(int staticClass, int staticMethod, int dynamicType);
+
+/* Returns nonzero iff reachable code may call printNat or readNat. */
+int usesPrintNat();
+int usesReadNat();
+
+#endif
@@ -13,7 +13,8 @@
    NOTE on typing conventions:
    This compiler represents types as integers.
    The DJ type denoted by int i is:
-     The ith class declared in the source program, if i > 0
+     The ith class declared in the source program, if i > 0, or,
+       past those, an intrinsic class the program uses (intrinsics.h)
      Object, if i = 0
      nat, if i = -1
      "any-object" (i.e., the type of "null"), if i = -2
@@ -0,0 +1,2222 @@
+section .bss
+    heap_end resq 1
+
+section .data
+    heap_limit dq 1073741824
+    heap_map_flags dq 50
+    heap_huge_pages dq 0
+    env_heap_limit db "DJ_HEAP_LIMIT=", 0
+    env_heap_populate db "DJ_HEAP_POPULATE=", 0
+    env_heap_huge_pages db "DJ_HEAP_HUGEPAGES=", 0
+
+section .data
+    align 8
+prof_data:
+    db "DJPROF01"
+    dq 13, 0, 19, 7
+prof_methods:
+    times 13 dq 0
+prof_branches:
+    times 0 dq 0
+    dq 4294967296
+    dq 8589934592
+    dq 12884901888
+    dq 17179869184
+    dq 21474836480
+    dq 25769803776
+    dq 4294967296
+    dq 8589934592
+    dq 12884901888
+    dq 4294967298
+    dq 4294967298
+    dq 4294967298
+    dq 4294967298
+    dq 4294967298
+    dq 4294967298
+    dq 4294967298
+    dq 4294967298
+    dq 4294967298
+    dq 4294967297
+prof_receivers:
+    times 133 dq 0
+prof_end:
+prof_file:
+    db "program.prof", 0
+
+section .data
+    djrt_abi dq djrt_abi_1
+
+section .text
+    global _start
+    extern djrt_abi_1
+    extern _djrt_init
+    extern _print_int
+    extern _flush_output
+    extern _output_wait
+    extern _read_int
+
+_exit_program:
+    call _flush_output
+    call _output_wait
+    push rdi
+    mov rax, 2
+    lea rdi, [rel prof_file]
+    mov rsi, 577
+    mov rdx, 420
+    syscall
+    test rax, rax
+    js .profile_done
+    push rax
+    mov rdi, rax
+    mov rax, 1
+    lea rsi, [rel prof_data]
+    mov rdx, prof_end - prof_data
+    syscall
+    pop rdi
+    mov rax, 3
+    syscall
+.profile_done:
+    pop rdi
+    mov rax, 60
+    syscall
+
+_heap_init:
+    mov rcx, [rbp]
+    lea rbx, [rbp + rcx * 8 + 16]
+.env_loop:
+    mov rdi, [rbx]
+    test rdi, rdi
+    jz .env_done
+    lea rsi, [rel env_heap_limit]
+    call _env_value
+    test rax, rax
+    jz .not_limit
+    call _parse_size
+    mov [rel heap_limit], rax
+    jmp .env_next
+.not_limit:
+    mov rdi, [rbx]
+    lea rsi, [rel env_heap_populate]
+    call _env_value
+    test rax, rax
+    jz .not_populate
+    and qword [rel heap_map_flags], -32769
+    cmp byte [rax], '1'
+    jne .env_next
+    or qword [rel heap_map_flags], 32768
+    jmp .env_next
+.not_populate:
+    mov rdi, [rbx]
+    lea rsi, [rel env_heap_huge_pages]
+    call _env_value
+    test rax, rax
+    jz .env_next
+    movzx rax, byte [rax]
+    cmp rax, '1'
+    sete al
+    mov [rel heap_huge_pages], rax
+.env_next:
+    add rbx, 8
+    jmp .env_loop
+.env_done:
+    mov rax, 9
+    xor edi, edi
+    mov rsi, [rel heap_limit]
+    add rsi, 2097152
+    xor edx, edx
+    mov r10, 16418
+    mov r8, -1
+    xor r9d, r9d
+    syscall
+    cmp rax, -4096
+    ja _heap_exhausted
+    add rax, 2097151
+    and rax, -2097152
+    mov r15, rax
+    mov r13, rax
+    add rax, [rel heap_limit]
+    mov [rel heap_end], rax
+    ret
+
+_alloc_slow:
+    push rax
+    push rcx
+    push rdx
+    push rsi
+    push rdi
+    push r8
+    push r9
+    push r10
+    push r11
+    call _heap_commit
+    test rax, rax
+    jz .done
+    jmp _heap_exhausted
+.done:
+    pop r11
+    pop r10
+    pop r9
+    pop r8
+    pop rdi
+    pop rsi
+    pop rdx
+    pop rcx
+    pop rax
+    ret
+
+_heap_commit:
+    mov rsi, r15
+    add rsi, 2097151
+    and rsi, -2097152
+    mov rax, [rel heap_end]
+    cmp rsi, rax
+    cmova rsi, rax
+    cmp r15, rsi
+    ja .commit_failed
+    mov rdi, r13
+    sub rsi, r13
+    mov rdx, 3
+    mov r10, [rel heap_map_flags]
+    mov r8, -1
+    xor r9d, r9d
+    mov rax, 9
+    syscall
+    cmp rax, -4096
+    ja .commit_failed
+    cmp qword [rel heap_huge_pages], 0
+    je .committed
+    mov rax, 28
+    mov rdx, 14
+    syscall
+.committed:
+    add r13, rsi
+    xor eax, eax
+    ret
+.commit_failed:
+    mov eax, 1
+    ret
+
+_heap_exhausted:
+    mov rdi, 45
+    call _exit_program
+
+_env_value:
+    mov cl, [rsi]
+    test cl, cl
+    jz .match
+    cmp cl, [rdi]
+    jne .no_match
+    inc rsi
+    inc rdi
+    jmp _env_value
+.match:
+    mov rax, rdi
+    ret
+.no_match:
+    xor eax, eax
+    ret
+
+_parse_size:
+    mov rsi, rax
+    xor eax, eax
+.digit:
+    movzx ecx, byte [rsi]
+    sub ecx, '0'
+    cmp ecx, 9
+    ja .suffix
+    imul rax, rax, 10
+    add rax, rcx
+    inc rsi
+    jmp .digit
+.suffix:
+    cmp byte [rsi], 'K'
+    jne .not_K
+    shl rax, 10
+.not_K:
+    cmp byte [rsi], 'M'
+    jne .not_M
+    shl rax, 20
+.not_M:
+    cmp byte [rsi], 'G'
+    jne .not_G
+    shl rax, 30
+.not_G:
+    ret
+
+_start:
+    mov rbp, rsp
+    call _heap_init
+    mov rdi, 3
+    mov rsi, rbp
+    call _djrt_init
+    sub rsp, 8
+    mov qword [rsp], 0
+    mov rax, r15
+    add r15, 24
+    cmp r15, r13
+    ja ..@alloc_slow_1
+..@alloc_done_1:
+    mov qword [rax], 1
+    sub rsp, 8
+    mov [rsp], rax
+    mov rbx, rbp
+    sub rbx, 8
+    mov rax, [rsp]
+    mov [rbx], rax
+    add rsp, 8
+    sub rsp, 8
+    mov rax, .L_ret_2
+    mov [rsp], rax
+    sub rsp, 8
+    mov rax, [rbp - 8]
+    mov [rsp], rax
+    cmp qword [rsp], 0
+    jne .L_null_ok_3
+    mov rdi, 1
+    call _exit_program
+.L_null_ok_3:
+    sub rsp, 8
+    mov qword [rsp], 1
+    sub rsp, 8
+    mov qword [rsp], 0
+    sub rsp, 8
+    mov qword [rsp], 0
+    mov rax, [rsp + 24]
+    mov rax, [rax]
+    lea rbx, [rel prof_receivers]
+    inc qword [rbx + rax * 8 + 0]
+    jmp _VTable_Dispatch
+.L_ret_2:
+    add rsp, 8
+    sub rsp, 8
+    mov rax, .L_ret_4
+    mov [rsp], rax
+    sub rsp, 8
+    mov rax, [rbp - 8]
+    mov [rsp], rax
+    cmp qword [rsp], 0
+    jne .L_null_ok_5
+    mov rdi, 1
+    call _exit_program
+.L_null_ok_5:
+    mov rax, [rsp]
+    mov rax, [rax + 16]
+    mov [rsp], rax
+    cmp qword [rsp], 0
+    jne .L_null_ok_6
+    mov rdi, 1
+    call _exit_program
+.L_null_ok_6:
+    sub rsp, 8
+    mov qword [rsp], 2
+    sub rsp, 8
+    mov qword [rsp], 0
+    sub rsp, 8
+    mov qword [rsp], 0
+    mov rax, [rsp + 24]
+    mov rax, [rax]
+    lea rbx, [rel prof_receivers]
+    inc qword [rbx + rax * 8 + 56]
+    jmp _VTable_Dispatch
+.L_ret_4:
+    add rsp, 8
+    sub rsp, 8
+    mov rax, .L_ret_7
+    mov [rsp], rax
+    sub rsp, 8
+    mov rax, [rbp - 8]
+    mov [rsp], rax
+    cmp qword [rsp], 0
+    jne .L_null_ok_8
+    mov rdi, 1
+    call _exit_program
+.L_null_ok_8:
+    mov rax, [rsp]
+    mov rax, [rax + 16]
+    mov [rsp], rax
+    cmp qword [rsp], 0
+    jne .L_null_ok_9
+    mov rdi, 1
+    call _exit_program
+.L_null_ok_9:
+    mov rax, [rsp]
+    mov rax, [rax + 24]
+    mov [rsp], rax
+    cmp qword [rsp], 0
+    jne .L_null_ok_10
+    mov rdi, 1
+    call _exit_program
+.L_null_ok_10:
+    sub rsp, 8
+    mov qword [rsp], 3
+    sub rsp, 8
+    mov qword [rsp], 0
+    sub rsp, 8
+    mov qword [rsp], 0
+    mov rax, [rsp + 24]
+    mov rax, [rax]
+    lea rbx, [rel prof_receivers]
+    inc qword [rbx + rax * 8 + 112]
+    jmp _VTable_Dispatch
+.L_ret_7:
+    add rsp, 8
+    sub rsp, 8
+    mov rax, .L_ret_11
+    mov [rsp], rax
+    sub rsp, 8
+    mov rax, [rbp - 8]
+    mov [rsp], rax
+    cmp qword [rsp], 0
+    jne .L_null_ok_12
+    mov rdi, 1
+    call _exit_program
+.L_null_ok_12:
+    mov rax, [rsp]
+    mov rax, [rax + 16]
+    mov [rsp], rax
+    cmp qword [rsp], 0
+    jne .L_null_ok_13
+    mov rdi, 1
+    call _exit_program
+.L_null_ok_13:
+    mov rax, [rsp]
+    mov rax, [rax + 24]
+    mov [rsp], rax
+    cmp qword [rsp], 0
+    jne .L_null_ok_14
+    mov rdi, 1
+    call _exit_program
+.L_null_ok_14:
+    mov rax, [rsp]
+    mov rax, [rax + 8]
+    mov [rsp], rax
+    cmp qword [rsp], 0
+    jne .L_null_ok_15
+    mov rdi, 1
+    call _exit_program
+.L_null_ok_15:
+    sub rsp, 8
+    mov qword [rsp], 4
+    sub rsp, 8
+    mov qword [rsp], 0
+    sub rsp, 8
+    mov qword [rsp], 0
+    mov rax, [rsp + 24]
+    mov rax, [rax]
+    lea rbx, [rel prof_receivers]
+    inc qword [rbx + rax * 8 + 168]
+    jmp _VTable_Dispatch
+.L_ret_11:
+    add rsp, 8
+    sub rsp, 8
+    mov rax, .L_ret_16
+    mov [rsp], rax
+    sub rsp, 8
+    mov rax, [rbp - 8]
+    mov [rsp], rax
+    cmp qword [rsp], 0
+    jne .L_null_ok_17
+    mov rdi, 1
+    call _exit_program
+.L_null_ok_17:
+    mov rax, [rsp]
+    mov rax, [rax + 16]
+    mov [rsp], rax
+    cmp qword [rsp], 0
+    jne .L_null_ok_18
+    mov rdi, 1
+    call _exit_program
+.L_null_ok_18:
+    mov rax, [rsp]
+    mov rax, [rax + 24]
+    mov [rsp], rax
+    cmp qword [rsp], 0
+    jne .L_null_ok_19
+    mov rdi, 1
+    call _exit_program
+.L_null_ok_19:
+    mov rax, [rsp]
+    mov rax, [rax + 8]
+    mov [rsp], rax
+    cmp qword [rsp], 0
+    jne .L_null_ok_20
+    mov rdi, 1
+    call _exit_program
+.L_null_ok_20:
+    mov rax, [rsp]
+    mov rax, [rax + 32]
+    mov [rsp], rax
+    cmp qword [rsp], 0
+    jne .L_null_ok_21
+    mov rdi, 1
+    call _exit_program
+.L_null_ok_21:
+    sub rsp, 8
+    mov qword [rsp], 5
+    sub rsp, 8
+    mov qword [rsp], 0
+    sub rsp, 8
+    mov qword [rsp], 0
+    mov rax, [rsp + 24]
+    mov rax, [rax]
+    lea rbx, [rel prof_receivers]
+    inc qword [rbx + rax * 8 + 224]
+    jmp _VTable_Dispatch
+.L_ret_16:
+    add rsp, 8
+    sub rsp, 8
+    mov rax, .L_ret_22
+    mov [rsp], rax
+    sub rsp, 8
+    mov rax, [rbp - 8]
+    mov [rsp], rax
+    cmp qword [rsp], 0
+    jne .L_null_ok_23
+    mov rdi, 1
+    call _exit_program
+.L_null_ok_23:
+    mov rax, [rsp]
+    mov rax, [rax + 16]
+    mov [rsp], rax
+    cmp qword [rsp], 0
+    jne .L_null_ok_24
+    mov rdi, 1
+    call _exit_program
+.L_null_ok_24:
+    mov rax, [rsp]
+    mov rax, [rax + 24]
+    mov [rsp], rax
+    cmp qword [rsp], 0
+    jne .L_null_ok_25
+    mov rdi, 1
+    call _exit_program
+.L_null_ok_25:
+    mov rax, [rsp]
+    mov rax, [rax + 8]
+    mov [rsp], rax
+    cmp qword [rsp], 0
+    jne .L_null_ok_26
+    mov rdi, 1
+    call _exit_program
+.L_null_ok_26:
+    mov rax, [rsp]
+    mov rax, [rax + 32]
+    mov [rsp], rax
+    cmp qword [rsp], 0
+    jne .L_null_ok_27
+    mov rdi, 1
+    call _exit_program
+.L_null_ok_27:
+    mov rax, [rsp]
+    mov rax, [rax + 32]
+    mov [rsp], rax
+    cmp qword [rsp], 0
+    jne .L_null_ok_28
+    mov rdi, 1
+    call _exit_program
+.L_null_ok_28:
+    sub rsp, 8
+    mov qword [rsp], 6
+    sub rsp, 8
+    mov qword [rsp], 0
+    sub rsp, 8
+    mov qword [rsp], 0
+    mov rax, [rsp + 24]
+    mov rax, [rax]
+    lea rbx, [rel prof_receivers]
+    inc qword [rbx + rax * 8 + 280]
+    jmp _VTable_Dispatch
+.L_ret_22:
+    add rsp, 8
+    sub rsp, 8
+    mov rax, .L_ret_29
+    mov [rsp], rax
+    sub rsp, 8
+    mov rax, [rbp - 8]
+    mov [rsp], rax
+    cmp qword [rsp], 0
+    jne .L_null_ok_30
+    mov rdi, 1
+    call _exit_program
+.L_null_ok_30:
+    mov rax, [rsp]
+    mov rax, [rax + 16]
+    mov [rsp], rax
+    cmp qword [rsp], 0
+    jne .L_null_ok_31
+    mov rdi, 1
+    call _exit_program
+.L_null_ok_31:
+    mov rax, [rsp]
+    mov rax, [rax + 24]
+    mov [rsp], rax
+    cmp qword [rsp], 0
+    jne .L_null_ok_32
+    mov rdi, 1
+    call _exit_program
+.L_null_ok_32:
+    mov rax, [rsp]
+    mov rax, [rax + 8]
+    mov [rsp], rax
+    cmp qword [rsp], 0
+    jne .L_null_ok_33
+    mov rdi, 1
+    call _exit_program
+.L_null_ok_33:
+    mov rax, [rsp]
+    mov rax, [rax + 32]
+    mov [rsp], rax
+    cmp qword [rsp], 0
+    jne .L_null_ok_34
+    mov rdi, 1
+    call _exit_program
+.L_null_ok_34:
+    mov rax, [rsp]
+    mov rax, [rax + 32]
+    mov [rsp], rax
+    cmp qword [rsp], 0
+    jne .L_null_ok_35
+    mov rdi, 1
+    call _exit_program
+.L_null_ok_35:
+    mov rax, [rsp]
+    mov rax, [rax + 40]
+    mov [rsp], rax
+    cmp qword [rsp], 0
+    jne .L_null_ok_36
+    mov rdi, 1
+    call _exit_program
+.L_null_ok_36:
+    sub rsp, 8
+    mov qword [rsp], 1
+    sub rsp, 8
+    mov qword [rsp], 0
+    sub rsp, 8
+    mov qword [rsp], 0
+    mov rax, [rsp + 24]
+    mov rax, [rax]
+    lea rbx, [rel prof_receivers]
+    inc qword [rbx + rax * 8 + 336]
+    jmp _VTable_Dispatch
+.L_ret_29:
+    add rsp, 8
+    sub rsp, 8
+    mov rax, .L_ret_37
+    mov [rsp], rax
+    sub rsp, 8
+    mov rax, [rbp - 8]
+    mov [rsp], rax
+    cmp qword [rsp], 0
+    jne .L_null_ok_38
+    mov rdi, 1
+    call _exit_program
+.L_null_ok_38:
+    mov rax, [rsp]
+    mov rax, [rax + 16]
+    mov [rsp], rax
+    cmp qword [rsp], 0
+    jne .L_null_ok_39
+    mov rdi, 1
+    call _exit_program
+.L_null_ok_39:
+    mov rax, [rsp]
+    mov rax, [rax + 24]
+    mov [rsp], rax
+    cmp qword [rsp], 0
+    jne .L_null_ok_40
+    mov rdi, 1
+    call _exit_program
+.L_null_ok_40:
+    mov rax, [rsp]
+    mov rax, [rax + 8]
+    mov [rsp], rax
+    cmp qword [rsp], 0
+    jne .L_null_ok_41
+    mov rdi, 1
+    call _exit_program
+.L_null_ok_41:
+    mov rax, [rsp]
+    mov rax, [rax + 32]
+    mov [rsp], rax
+    cmp qword [rsp], 0
+    jne .L_null_ok_42
+    mov rdi, 1
+    call _exit_program
+.L_null_ok_42:
+    mov rax, [rsp]
+    mov rax, [rax + 32]
+    mov [rsp], rax
+    cmp qword [rsp], 0
+    jne .L_null_ok_43
+    mov rdi, 1
+    call _exit_program
+.L_null_ok_43:
+    mov rax, [rsp]
+    mov rax, [rax + 40]
+    mov [rsp], rax
+    cmp qword [rsp], 0
+    jne .L_null_ok_44
+    mov rdi, 1
+    call _exit_program
+.L_null_ok_44:
+    mov rax, [rsp]
+    mov rax, [rax + 16]
+    mov [rsp], rax
+    cmp qword [rsp], 0
+    jne .L_null_ok_45
+    mov rdi, 1
+    call _exit_program
+.L_null_ok_45:
+    sub rsp, 8
+    mov qword [rsp], 2
+    sub rsp, 8
+    mov qword [rsp], 0
+    sub rsp, 8
+    mov qword [rsp], 0
+    mov rax, [rsp + 24]
+    mov rax, [rax]
+    lea rbx, [rel prof_receivers]
+    inc qword [rbx + rax * 8 + 392]
+    jmp _VTable_Dispatch
+.L_ret_37:
+    add rsp, 8
+    sub rsp, 8
+    mov rax, .L_ret_46
+    mov [rsp], rax
+    sub rsp, 8
+    mov rax, [rbp - 8]
+    mov [rsp], rax
+    cmp qword [rsp], 0
+    jne .L_null_ok_47
+    mov rdi, 1
+    call _exit_program
+.L_null_ok_47:
+    mov rax, [rsp]
+    mov rax, [rax + 16]
+    mov [rsp], rax
+    cmp qword [rsp], 0
+    jne .L_null_ok_48
+    mov rdi, 1
+    call _exit_program
+.L_null_ok_48:
+    mov rax, [rsp]
+    mov rax, [rax + 24]
+    mov [rsp], rax
+    cmp qword [rsp], 0
+    jne .L_null_ok_49
+    mov rdi, 1
+    call _exit_program
+.L_null_ok_49:
+    mov rax, [rsp]
+    mov rax, [rax + 8]
+    mov [rsp], rax
+    cmp qword [rsp], 0
+    jne .L_null_ok_50
+    mov rdi, 1
+    call _exit_program
+.L_null_ok_50:
+    mov rax, [rsp]
+    mov rax, [rax + 32]
+    mov [rsp], rax
+    cmp qword [rsp], 0
+    jne .L_null_ok_51
+    mov rdi, 1
+    call _exit_program
+.L_null_ok_51:
+    mov rax, [rsp]
+    mov rax, [rax + 32]
+    mov [rsp], rax
+    cmp qword [rsp], 0
+    jne .L_null_ok_52
+    mov rdi, 1
+    call _exit_program
+.L_null_ok_52:
+    mov rax, [rsp]
+    mov rax, [rax + 40]
+    mov [rsp], rax
+    cmp qword [rsp], 0
+    jne .L_null_ok_53
+    mov rdi, 1
+    call _exit_program
+.L_null_ok_53:
+    mov rax, [rsp]
+    mov rax, [rax + 16]
+    mov [rsp], rax
+    cmp qword [rsp], 0
+    jne .L_null_ok_54
+    mov rdi, 1
+    call _exit_program
+.L_null_ok_54:
+    mov rax, [rsp]
+    mov rax, [rax + 24]
+    mov [rsp], rax
+    cmp qword [rsp], 0
+    jne .L_null_ok_55
+    mov rdi, 1
+    call _exit_program
+.L_null_ok_55:
+    sub rsp, 8
+    mov qword [rsp], 3
+    sub rsp, 8
+    mov qword [rsp], 0
+    sub rsp, 8
+    mov qword [rsp], 0
+    mov rax, [rsp + 24]
+    mov rax, [rax]
+    lea rbx, [rel prof_receivers]
+    inc qword [rbx + rax * 8 + 448]
+    jmp _VTable_Dispatch
+.L_ret_46:
+    add rsp, 8
+    sub rsp, 8
+    mov rax, .L_ret_56
+    mov [rsp], rax
+    sub rsp, 8
+    mov rax, [rbp - 8]
+    mov [rsp], rax
+    cmp qword [rsp], 0
+    jne .L_null_ok_57
+    mov rdi, 1
+    call _exit_program
+.L_null_ok_57:
+    sub rsp, 8
+    mov qword [rsp], 1
+    sub rsp, 8
+    mov qword [rsp], 2
+    sub rsp, 8
+    mov rax, [rbp - 8]
+    mov [rsp], rax
+    mov rax, [rsp + 24]
+    mov rax, [rax]
+    lea rbx, [rel prof_receivers]
+    inc qword [rbx + rax * 8 + 504]
+    jmp _VTable_Dispatch
+.L_ret_56:
+    add rsp, 8
+    sub rsp, 8
+    mov rax, .L_ret_58
+    mov [rsp], rax
+    sub rsp, 8
+    mov rax, [rbp - 8]
+    mov [rsp], rax
+    cmp qword [rsp], 0
+    jne .L_null_ok_59
+    mov rdi, 1
+    call _exit_program
+.L_null_ok_59:
+    sub rsp, 8
+    mov qword [rsp], 1
+    sub rsp, 8
+    mov qword [rsp], 2
+    sub rsp, 8
+    mov rax, [rbp - 8]
+    mov [rsp], rax
+    cmp qword [rsp], 0
+    jne .L_null_ok_60
+    mov rdi, 1
+    call _exit_program
+.L_null_ok_60:
+    mov rax, [rsp]
+    mov rax, [rax + 16]
+    mov [rsp], rax
+    mov rax, [rsp + 24]
+    mov rax, [rax]
+    lea rbx, [rel prof_receivers]
+    inc qword [rbx + rax * 8 + 560]
+    jmp _VTable_Dispatch
+.L_ret_58:
+    add rsp, 8
+    sub rsp, 8
+    mov rax, .L_ret_61
+    mov [rsp], rax
+    sub rsp, 8
+    mov rax, [rbp - 8]
+    mov [rsp], rax
+    cmp qword [rsp], 0
+    jne .L_null_ok_62
+    mov rdi, 1
+    call _exit_program
+.L_null_ok_62:
+    sub rsp, 8
+    mov qword [rsp], 1
+    sub rsp, 8
+    mov qword [rsp], 2
+    sub rsp, 8
+    mov rax, [rbp - 8]
+    mov [rsp], rax
+    cmp qword [rsp], 0
+    jne .L_null_ok_63
+    mov rdi, 1
+    call _exit_program
+.L_null_ok_63:
+    mov rax, [rsp]
+    mov rax, [rax + 16]
+    mov [rsp], rax
+    cmp qword [rsp], 0
+    jne .L_null_ok_64
+    mov rdi, 1
+    call _exit_program
+.L_null_ok_64:
+    mov rax, [rsp]
+    mov rax, [rax + 24]
+    mov [rsp], rax
+    cmp qword [rsp], 0
+    jne .L_null_ok_65
+    mov rdi, 1
+    call _exit_program
+.L_null_ok_65:
+    mov rax, [rsp]
+    mov rax, [rax + 8]
+    mov [rsp], rax
+    mov rax, [rsp + 24]
+    mov rax, [rax]
+    lea rbx, [rel prof_receivers]
+    inc qword [rbx + rax * 8 + 616]
+    jmp _VTable_Dispatch
+.L_ret_61:
+    add rsp, 8
+    sub rsp, 8
+    mov rax, .L_ret_66
+    mov [rsp], rax
+    sub rsp, 8
+    mov rax, [rbp - 8]
+    mov [rsp], rax
+    cmp qword [rsp], 0
+    jne .L_null_ok_67
+    mov rdi, 1
+    call _exit_program
+.L_null_ok_67:
+    sub rsp, 8
+    mov qword [rsp], 1
+    sub rsp, 8
+    mov qword [rsp], 2
+    sub rsp, 8
+    mov rax, [rbp - 8]
+    mov [rsp], rax
+    cmp qword [rsp], 0
+    jne .L_null_ok_68
+    mov rdi, 1
+    call _exit_program
+.L_null_ok_68:
+    mov rax, [rsp]
+    mov rax, [rax + 16]
+    mov [rsp], rax
+    cmp qword [rsp], 0
+    jne .L_null_ok_69
+    mov rdi, 1
+    call _exit_program
+.L_null_ok_69:
+    mov rax, [rsp]
+    mov rax, [rax + 24]
+    mov [rsp], rax
+    cmp qword [rsp], 0
+    jne .L_null_ok_70
+    mov rdi, 1
+    call _exit_program
+.L_null_ok_70:
+    mov rax, [rsp]
+    mov rax, [rax + 8]
+    mov [rsp], rax
+    cmp qword [rsp], 0
+    jne .L_null_ok_71
+    mov rdi, 1
+    call _exit_program
+.L_null_ok_71:
+    mov rax, [rsp]
+    mov rax, [rax + 32]
+    mov [rsp], rax
+    mov rax, [rsp + 24]
+    mov rax, [rax]
+    lea rbx, [rel prof_receivers]
+    inc qword [rbx + rax * 8 + 672]
+    jmp _VTable_Dispatch
+.L_ret_66:
+    add rsp, 8
+    sub rsp, 8
+    mov rax, .L_ret_72
+    mov [rsp], rax
+    sub rsp, 8
+    mov rax, [rbp - 8]
+    mov [rsp], rax
+    cmp qword [rsp], 0
+    jne .L_null_ok_73
+    mov rdi, 1
+    call _exit_program
+.L_null_ok_73:
+    sub rsp, 8
+    mov qword [rsp], 1
+    sub rsp, 8
+    mov qword [rsp], 2
+    sub rsp, 8
+    mov rax, [rbp - 8]
+    mov [rsp], rax
+    cmp qword [rsp], 0
+    jne .L_null_ok_74
+    mov rdi, 1
+    call _exit_program
+.L_null_ok_74:
+    mov rax, [rsp]
+    mov rax, [rax + 16]
+    mov [rsp], rax
+    cmp qword [rsp], 0
+    jne .L_null_ok_75
+    mov rdi, 1
+    call _exit_program
+.L_null_ok_75:
+    mov rax, [rsp]
+    mov rax, [rax + 24]
+    mov [rsp], rax
+    cmp qword [rsp], 0
+    jne .L_null_ok_76
+    mov rdi, 1
+    call _exit_program
+.L_null_ok_76:
+    mov rax, [rsp]
+    mov rax, [rax + 8]
+    mov [rsp], rax
+    cmp qword [rsp], 0
+    jne .L_null_ok_77
+    mov rdi, 1
+    call _exit_program
+.L_null_ok_77:
+    mov rax, [rsp]
+    mov rax, [rax + 32]
+    mov [rsp], rax
+    cmp qword [rsp], 0
+    jne .L_null_ok_78
+    mov rdi, 1
+    call _exit_program
+.L_null_ok_78:
+    mov rax, [rsp]
+    mov rax, [rax + 32]
+    mov [rsp], rax
+    mov rax, [rsp + 24]
+    mov rax, [rax]
+    lea rbx, [rel prof_receivers]
+    inc qword [rbx + rax * 8 + 728]
+    jmp _VTable_Dispatch
+.L_ret_72:
+    add rsp, 8
+    sub rsp, 8
+    mov rax, .L_ret_79
+    mov [rsp], rax
+    sub rsp, 8
+    mov rax, [rbp - 8]
+    mov [rsp], rax
+    cmp qword [rsp], 0
+    jne .L_null_ok_80
+    mov rdi, 1
+    call _exit_program
+.L_null_ok_80:
+    sub rsp, 8
+    mov qword [rsp], 1
+    sub rsp, 8
+    mov qword [rsp], 2
+    sub rsp, 8
+    mov rax, [rbp - 8]
+    mov [rsp], rax
+    cmp qword [rsp], 0
+    jne .L_null_ok_81
+    mov rdi, 1
+    call _exit_program
+.L_null_ok_81:
+    mov rax, [rsp]
+    mov rax, [rax + 16]
+    mov [rsp], rax
+    cmp qword [rsp], 0
+    jne .L_null_ok_82
+    mov rdi, 1
+    call _exit_program
+.L_null_ok_82:
+    mov rax, [rsp]
+    mov rax, [rax + 24]
+    mov [rsp], rax
+    cmp qword [rsp], 0
+    jne .L_null_ok_83
+    mov rdi, 1
+    call _exit_program
+.L_null_ok_83:
+    mov rax, [rsp]
+    mov rax, [rax + 8]
+    mov [rsp], rax
+    cmp qword [rsp], 0
+    jne .L_null_ok_84
+    mov rdi, 1
+    call _exit_program
+.L_null_ok_84:
+    mov rax, [rsp]
+    mov rax, [rax + 32]
+    mov [rsp], rax
+    cmp qword [rsp], 0
+    jne .L_null_ok_85
+    mov rdi, 1
+    call _exit_program
+.L_null_ok_85:
+    mov rax, [rsp]
+    mov rax, [rax + 32]
+    mov [rsp], rax
+    cmp qword [rsp], 0
+    jne .L_null_ok_86
+    mov rdi, 1
+    call _exit_program
+.L_null_ok_86:
+    mov rax, [rsp]
+    mov rax, [rax + 40]
+    mov [rsp], rax
+    mov rax, [rsp + 24]
+    mov rax, [rax]
+    lea rbx, [rel prof_receivers]
+    inc qword [rbx + rax * 8 + 784]
+    jmp _VTable_Dispatch
+.L_ret_79:
+    add rsp, 8
+    sub rsp, 8
+    mov rax, .L_ret_87
+    mov [rsp], rax
+    sub rsp, 8
+    mov rax, [rbp - 8]
+    mov [rsp], rax
+    cmp qword [rsp], 0
+    jne .L_null_ok_88
+    mov rdi, 1
+    call _exit_program
+.L_null_ok_88:
+    sub rsp, 8
+    mov qword [rsp], 1
+    sub rsp, 8
+    mov qword [rsp], 2
+    sub rsp, 8
+    mov rax, [rbp - 8]
+    mov [rsp], rax
+    cmp qword [rsp], 0
+    jne .L_null_ok_89
+    mov rdi, 1
+    call _exit_program
+.L_null_ok_89:
+    mov rax, [rsp]
+    mov rax, [rax + 16]
+    mov [rsp], rax
+    cmp qword [rsp], 0
+    jne .L_null_ok_90
+    mov rdi, 1
+    call _exit_program
+.L_null_ok_90:
+    mov rax, [rsp]
+    mov rax, [rax + 24]
+    mov [rsp], rax
+    cmp qword [rsp], 0
+    jne .L_null_ok_91
+    mov rdi, 1
+    call _exit_program
+.L_null_ok_91:
+    mov rax, [rsp]
+    mov rax, [rax + 8]
+    mov [rsp], rax
+    cmp qword [rsp], 0
+    jne .L_null_ok_92
+    mov rdi, 1
+    call _exit_program
+.L_null_ok_92:
+    mov rax, [rsp]
+    mov rax, [rax + 32]
+    mov [rsp], rax
+    cmp qword [rsp], 0
+    jne .L_null_ok_93
+    mov rdi, 1
+    call _exit_program
+.L_null_ok_93:
+    mov rax, [rsp]
+    mov rax, [rax + 32]
+    mov [rsp], rax
+    cmp qword [rsp], 0
+    jne .L_null_ok_94
+    mov rdi, 1
+    call _exit_program
+.L_null_ok_94:
+    mov rax, [rsp]
+    mov rax, [rax + 40]
+    mov [rsp], rax
+    cmp qword [rsp], 0
+    jne .L_null_ok_95
+    mov rdi, 1
+    call _exit_program
+.L_null_ok_95:
+    mov rax, [rsp]
+    mov rax, [rax + 16]
+    mov [rsp], rax
+    mov rax, [rsp + 24]
+    mov rax, [rax]
+    lea rbx, [rel prof_receivers]
+    inc qword [rbx + rax * 8 + 840]
+    jmp _VTable_Dispatch
+.L_ret_87:
+    add rsp, 8
+    sub rsp, 8
+    mov rax, .L_ret_96
+    mov [rsp], rax
+    sub rsp, 8
+    mov rax, [rbp - 8]
+    mov [rsp], rax
+    cmp qword [rsp], 0
+    jne .L_null_ok_97
+    mov rdi, 1
+    call _exit_program
+.L_null_ok_97:
+    sub rsp, 8
+    mov qword [rsp], 1
+    sub rsp, 8
+    mov qword [rsp], 2
+    sub rsp, 8
+    mov rax, [rbp - 8]
+    mov [rsp], rax
+    cmp qword [rsp], 0
+    jne .L_null_ok_98
+    mov rdi, 1
+    call _exit_program
+.L_null_ok_98:
+    mov rax, [rsp]
+    mov rax, [rax + 16]
+    mov [rsp], rax
+    cmp qword [rsp], 0
+    jne .L_null_ok_99
+    mov rdi, 1
+    call _exit_program
+.L_null_ok_99:
+    mov rax, [rsp]
+    mov rax, [rax + 24]
+    mov [rsp], rax
+    cmp qword [rsp], 0
+    jne .L_null_ok_100
+    mov rdi, 1
+    call _exit_program
+.L_null_ok_100:
+    mov rax, [rsp]
+    mov rax, [rax + 8]
+    mov [rsp], rax
+    cmp qword [rsp], 0
+    jne .L_null_ok_101
+    mov rdi, 1
+    call _exit_program
+.L_null_ok_101:
+    mov rax, [rsp]
+    mov rax, [rax + 32]
+    mov [rsp], rax
+    cmp qword [rsp], 0
+    jne .L_null_ok_102
+    mov rdi, 1
+    call _exit_program
+.L_null_ok_102:
+    mov rax, [rsp]
+    mov rax, [rax + 32]
+    mov [rsp], rax
+    cmp qword [rsp], 0
+    jne .L_null_ok_103
+    mov rdi, 1
+    call _exit_program
+.L_null_ok_103:
+    mov rax, [rsp]
+    mov rax, [rax + 40]
+    mov [rsp], rax
+    cmp qword [rsp], 0
+    jne .L_null_ok_104
+    mov rdi, 1
+    call _exit_program
+.L_null_ok_104:
+    mov rax, [rsp]
+    mov rax, [rax + 16]
+    mov [rsp], rax
+    cmp qword [rsp], 0
+    jne .L_null_ok_105
+    mov rdi, 1
+    call _exit_program
+.L_null_ok_105:
+    mov rax, [rsp]
+    mov rax, [rax + 24]
+    mov [rsp], rax
+    cmp qword [rsp], 0
+    jne .L_null_ok_106
+    mov rdi, 1
+    call _exit_program
+.L_null_ok_106:
+    mov rax, [rsp]
+    mov rax, [rax + 8]
+    mov [rsp], rax
+    mov rax, [rsp + 24]
+    mov rax, [rax]
+    lea rbx, [rel prof_receivers]
+    inc qword [rbx + rax * 8 + 896]
+    jmp _VTable_Dispatch
+.L_ret_96:
+    add rsp, 8
+    sub rsp, 8
+    mov rax, .L_ret_107
+    mov [rsp], rax
+    sub rsp, 8
+    mov rax, [rbp - 8]
+    mov [rsp], rax
+    cmp qword [rsp], 0
+    jne .L_null_ok_108
+    mov rdi, 1
+    call _exit_program
+.L_null_ok_108:
+    mov rax, [rsp]
+    mov rax, [rax + 16]
+    mov [rsp], rax
+    cmp qword [rsp], 0
+    jne .L_null_ok_109
+    mov rdi, 1
+    call _exit_program
+.L_null_ok_109:
+    mov rax, [rsp]
+    mov rax, [rax + 24]
+    mov [rsp], rax
+    cmp qword [rsp], 0
+    jne .L_null_ok_110
+    mov rdi, 1
+    call _exit_program
+.L_null_ok_110:
+    mov rax, [rsp]
+    mov rax, [rax + 8]
+    mov [rsp], rax
+    cmp qword [rsp], 0
+    jne .L_null_ok_111
+    mov rdi, 1
+    call _exit_program
+.L_null_ok_111:
+    mov rax, [rsp]
+    mov rax, [rax + 32]
+    mov [rsp], rax
+    cmp qword [rsp], 0
+    jne .L_null_ok_112
+    mov rdi, 1
+    call _exit_program
+.L_null_ok_112:
+    mov rax, [rsp]
+    mov rax, [rax + 32]
+    mov [rsp], rax
+    cmp qword [rsp], 0
+    jne .L_null_ok_113
+    mov rdi, 1
+    call _exit_program
+.L_null_ok_113:
+    mov rax, [rsp]
+    mov rax, [rax + 40]
+    mov [rsp], rax
+    cmp qword [rsp], 0
+    jne .L_null_ok_114
+    mov rdi, 1
+    call _exit_program
+.L_null_ok_114:
+    mov rax, [rsp]
+    mov rax, [rax + 16]
+    mov [rsp], rax
+    cmp qword [rsp], 0
+    jne .L_null_ok_115
+    mov rdi, 1
+    call _exit_program
+.L_null_ok_115:
+    mov rax, [rsp]
+    mov rax, [rax + 24]
+    mov [rsp], rax
+    cmp qword [rsp], 0
+    jne .L_null_ok_116
+    mov rdi, 1
+    call _exit_program
+.L_null_ok_116:
+    mov rax, [rsp]
+    mov rax, [rax + 8]
+    mov [rsp], rax
+    cmp qword [rsp], 0
+    jne .L_null_ok_117
+    mov rdi, 1
+    call _exit_program
+.L_null_ok_117:
+    sub rsp, 8
+    mov qword [rsp], 1
+    sub rsp, 8
+    mov qword [rsp], 2
+    sub rsp, 8
+    mov rax, [rbp - 8]
+    mov [rsp], rax
+    cmp qword [rsp], 0
+    jne .L_null_ok_118
+    mov rdi, 1
+    call _exit_program
+.L_null_ok_118:
+    mov rax, [rsp]
+    mov rax, [rax + 16]
+    mov [rsp], rax
+    cmp qword [rsp], 0
+    jne .L_null_ok_119
+    mov rdi, 1
+    call _exit_program
+.L_null_ok_119:
+    mov rax, [rsp]
+    mov rax, [rax + 24]
+    mov [rsp], rax
+    cmp qword [rsp], 0
+    jne .L_null_ok_120
+    mov rdi, 1
+    call _exit_program
+.L_null_ok_120:
+    mov rax, [rsp]
+    mov rax, [rax + 8]
+    mov [rsp], rax
+    cmp qword [rsp], 0
+    jne .L_null_ok_121
+    mov rdi, 1
+    call _exit_program
+.L_null_ok_121:
+    mov rax, [rsp]
+    mov rax, [rax + 32]
+    mov [rsp], rax
+    cmp qword [rsp], 0
+    jne .L_null_ok_122
+    mov rdi, 1
+    call _exit_program
+.L_null_ok_122:
+    mov rax, [rsp]
+    mov rax, [rax + 32]
+    mov [rsp], rax
+    cmp qword [rsp], 0
+    jne .L_null_ok_123
+    mov rdi, 1
+    call _exit_program
+.L_null_ok_123:
+    mov rax, [rsp]
+    mov rax, [rax + 40]
+    mov [rsp], rax
+    cmp qword [rsp], 0
+    jne .L_null_ok_124
+    mov rdi, 1
+    call _exit_program
+.L_null_ok_124:
+    mov rax, [rsp]
+    mov rax, [rax + 16]
+    mov [rsp], rax
+    cmp qword [rsp], 0
+    jne .L_null_ok_125
+    mov rdi, 1
+    call _exit_program
+.L_null_ok_125:
+    mov rax, [rsp]
+    mov rax, [rax + 24]
+    mov [rsp], rax
+    cmp qword [rsp], 0
+    jne .L_null_ok_126
+    mov rdi, 1
+    call _exit_program
+.L_null_ok_126:
+    mov rax, [rsp]
+    mov rax, [rax + 8]
+    mov [rsp], rax
+    mov rax, [rsp + 24]
+    mov rax, [rax]
+    lea rbx, [rel prof_receivers]
+    inc qword [rbx + rax * 8 + 952]
+    jmp _VTable_Dispatch
+.L_ret_107:
+    add rsp, 8
+    sub rsp, 8
+    mov qword [rsp], 33
+    sub rsp, 8
+    mov rax, [rbp - 8]
+    mov [rsp], rax
+    cmp qword [rsp], 0
+    jne .L_null_ok_127
+    mov rdi, 1
+    call _exit_program
+.L_null_ok_127:
+    mov rax, [rsp]
+    mov rax, [rax + 16]
+    mov [rsp], rax
+    cmp qword [rsp], 0
+    jne .L_null_ok_128
+    mov rdi, 1
+    call _exit_program
+.L_null_ok_128:
+    mov rax, [rsp]
+    mov rax, [rax + 24]
+    mov [rsp], rax
+    cmp qword [rsp], 0
+    jne .L_null_ok_129
+    mov rdi, 1
+    call _exit_program
+.L_null_ok_129:
+    mov rax, [rsp]
+    mov rax, [rax + 8]
+    mov [rsp], rax
+    cmp qword [rsp], 0
+    jne .L_null_ok_130
+    mov rdi, 1
+    call _exit_program
+.L_null_ok_130:
+    mov rbx, [rsp]
+    add rbx, 8
+    mov rax, [rsp + 8]
+    mov [rbx], rax
+    add rsp, 8
+    add rsp, 8
+    sub rsp, 8
+    mov rax, [rbp - 8]
+    mov [rsp], rax
+    cmp qword [rsp], 0
+    jne .L_null_ok_131
+    mov rdi, 1
+    call _exit_program
+.L_null_ok_131:
+    mov rax, [rsp]
+    mov rax, [rax + 16]
+    mov [rsp], rax
+    cmp qword [rsp], 0
+    jne .L_null_ok_132
+    mov rdi, 1
+    call _exit_program
+.L_null_ok_132:
+    mov rax, [rsp]
+    mov rax, [rax + 8]
+    mov [rsp], rax
+    mov rax, [rsp]
+    call _print_int
+    add rsp, 8
+    sub rsp, 8
+    mov rax, [rbp - 8]
+    mov [rsp], rax
+    cmp qword [rsp], 0
+    jne .L_null_ok_133
+    mov rdi, 1
+    call _exit_program
+.L_null_ok_133:
+    mov rax, [rsp]
+    mov rax, [rax + 16]
+    mov [rsp], rax
+    cmp qword [rsp], 0
+    jne .L_null_ok_134
+    mov rdi, 1
+    call _exit_program
+.L_null_ok_134:
+    mov rax, [rsp]
+    mov rax, [rax + 24]
+    mov [rsp], rax
+    cmp qword [rsp], 0
+    jne .L_null_ok_135
+    mov rdi, 1
+    call _exit_program
+.L_null_ok_135:
+    mov rax, [rsp]
+    mov rax, [rax + 8]
+    mov [rsp], rax
+    cmp qword [rsp], 0
+    jne .L_null_ok_136
+    mov rdi, 1
+    call _exit_program
+.L_null_ok_136:
+    mov rax, [rsp]
+    mov rax, [rax + 8]
+    mov [rsp], rax
+    mov rax, [rsp]
+    call _print_int
+    mov rdi, 0
+    call _exit_program
+class1method0: ; C1.init
+    push rbp
+    mov rbp, rsp
+    inc qword [rel prof_methods + 0]
+    sub rsp, 8
+    mov qword [rsp], 1024
+    mov rbx, [rbp + 32]
+    add rbx, 8
+    mov rax, [rsp]
+    mov [rbx], rax
+    add rsp, 8
+    mov rax, r15
+    add r15, 32
+    cmp r15, r13
+    ja ..@alloc_slow_137
+..@alloc_done_137:
+    mov qword [rax], 2
+    sub rsp, 8
+    mov [rsp], rax
+    mov rbx, [rbp + 32]
+    add rbx, 16
+    mov rax, [rsp]
+    mov [rbx], rax
+    mov rax, [rsp]
+    mov rsp, rbp
+    pop rbp
+    mov rbx, [rsp + 32]
+    add rsp, 40
+    sub rsp, 8
+    mov [rsp], rax
+    jmp rbx
+class1method1: ; C1.whoami
+    push rbp
+    mov rbp, rsp
+    inc qword [rel prof_methods + 8]
+    sub rsp, 8
+    mov qword [rsp], 1
+    mov rax, [rsp]
+    call _print_int
+    mov rax, [rsp]
+    mov rsp, rbp
+    pop rbp
+    mov rbx, [rsp + 32]
+    add rsp, 40
+    sub rsp, 8
+    mov [rsp], rax
+    jmp rbx
+class1method2: ; C1.testWho
+    push rbp
+    mov rbp, rsp
+    inc qword [rel prof_methods + 16]
+    sub rsp, 8
+    mov rax, .L_ret_138
+    mov [rsp], rax
+    sub rsp, 8
+    mov rax, [rbp + 8]
+    mov [rsp], rax
+    cmp qword [rsp], 0
+    jne .L_null_ok_139
+    mov rdi, 1
+    call _exit_program
+.L_null_ok_139:
+    sub rsp, 8
+    mov qword [rsp], 1
+    sub rsp, 8
+    mov qword [rsp], 1
+    sub rsp, 8
+    mov qword [rsp], 0
+    mov rax, [rsp + 24]
+    mov rax, [rax]
+    lea rbx, [rel prof_receivers]
+    inc qword [rbx + rax * 8 + 1008]
+    jmp _VTable_Dispatch
+.L_ret_138:
+    mov rax, [rsp]
+    mov rsp, rbp
+    pop rbp
+    mov rbx, [rsp + 32]
+    add rsp, 40
+    sub rsp, 8
+    mov [rsp], rax
+    jmp rbx
+class2method0: ; C2.init
+    push rbp
+    mov rbp, rsp
+    inc qword [rel prof_methods + 24]
+    mov rax, r15
+    add r15, 16
+    cmp r15, r13
+    ja ..@alloc_slow_140
+..@alloc_done_140:
+    mov qword [rax], 3
+    sub rsp, 8
+    mov [rsp], rax
+    mov rbx, [rbp + 32]
+    add rbx, 24
+    mov rax, [rsp]
+    mov [rbx], rax
+    mov rax, [rsp]
+    mov rsp, rbp
+    pop rbp
+    mov rbx, [rsp + 32]
+    add rsp, 40
+    sub rsp, 8
+    mov [rsp], rax
+    jmp rbx
+class2method1: ; C2.whoami
+    push rbp
+    mov rbp, rsp
+    inc qword [rel prof_methods + 32]
+    sub rsp, 8
+    mov qword [rsp], 2
+    mov rax, [rsp]
+    call _print_int
+    mov rax, [rsp]
+    mov rsp, rbp
+    pop rbp
+    mov rbx, [rsp + 32]
+    add rsp, 40
+    sub rsp, 8
+    mov [rsp], rax
+    jmp rbx
+class3method0: ; C3.init
+    push rbp
+    mov rbp, rsp
+    inc qword [rel prof_methods + 40]
+    mov rax, r15
+    add r15, 40
+    cmp r15, r13
+    ja ..@alloc_slow_141
+..@alloc_done_141:
+    mov qword [rax], 4
+    sub rsp, 8
+    mov [rsp], rax
+    mov rbx, [rbp + 32]
+    add rbx, 8
+    mov rax, [rsp]
+    mov [rbx], rax
+    mov rax, [rsp]
+    mov rsp, rbp
+    pop rbp
+    mov rbx, [rsp + 32]
+    add rsp, 40
+    sub rsp, 8
+    mov [rsp], rax
+    jmp rbx
+class3method1: ; C3.whoami
+    push rbp
+    mov rbp, rsp
+    inc qword [rel prof_methods + 48]
+    sub rsp, 8
+    mov qword [rsp], 3
+    mov rax, [rsp]
+    call _print_int
+    mov rax, [rsp]
+    mov rsp, rbp
+    pop rbp
+    mov rbx, [rsp + 32]
+    add rsp, 40
+    sub rsp, 8
+    mov [rsp], rax
+    jmp rbx
+class4method0: ; C4.init
+    push rbp
+    mov rbp, rsp
+    inc qword [rel prof_methods + 56]
+    mov rax, r15
+    add r15, 40
+    cmp r15, r13
+    ja ..@alloc_slow_142
+..@alloc_done_142:
+    mov qword [rax], 5
+    sub rsp, 8
+    mov [rsp], rax
+    mov rbx, [rbp + 32]
+    add rbx, 32
+    mov rax, [rsp]
+    mov [rbx], rax
+    mov rax, [rsp]
+    mov rsp, rbp
+    pop rbp
+    mov rbx, [rsp + 32]
+    add rsp, 40
+    sub rsp, 8
+    mov [rsp], rax
+    jmp rbx
+class4method1: ; C4.whoami
+    push rbp
+    mov rbp, rsp
+    inc qword [rel prof_methods + 64]
+    sub rsp, 8
+    mov qword [rsp], 4
+    mov rax, [rsp]
+    call _print_int
+    mov rax, [rsp]
+    mov rsp, rbp
+    pop rbp
+    mov rbx, [rsp + 32]
+    add rsp, 40
+    sub rsp, 8
+    mov [rsp], rax
+    jmp rbx
+class5method0: ; C5.init
+    push rbp
+    mov rbp, rsp
+    inc qword [rel prof_methods + 72]
+    mov rax, r15
+    add r15, 48
+    cmp r15, r13
+    ja ..@alloc_slow_143
+..@alloc_done_143:
+    mov qword [rax], 6
+    sub rsp, 8
+    mov [rsp], rax
+    mov rbx, [rbp + 32]
+    add rbx, 32
+    mov rax, [rsp]
+    mov [rbx], rax
+    mov rax, [rsp]
+    mov rsp, rbp
+    pop rbp
+    mov rbx, [rsp + 32]
+    add rsp, 40
+    sub rsp, 8
+    mov [rsp], rax
+    jmp rbx
+class5method1: ; C5.whoami
+    push rbp
+    mov rbp, rsp
+    inc qword [rel prof_methods + 80]
+    sub rsp, 8
+    mov qword [rsp], 5
+    mov rax, [rsp]
+    call _print_int
+    mov rax, [rsp]
+    mov rsp, rbp
+    pop rbp
+    mov rbx, [rsp + 32]
+    add rsp, 40
+    sub rsp, 8
+    mov [rsp], rax
+    jmp rbx
+class6method0: ; C6.init
+    push rbp
+    mov rbp, rsp
+    inc qword [rel prof_methods + 88]
+    mov rax, r15
+    add r15, 24
+    cmp r15, r13
+    ja ..@alloc_slow_144
+..@alloc_done_144:
+    mov qword [rax], 1
+    sub rsp, 8
+    mov [rsp], rax
+    mov rbx, [rbp + 32]
+    add rbx, 40
+    mov rax, [rsp]
+    mov [rbx], rax
+    mov rax, [rsp]
+    mov rsp, rbp
+    pop rbp
+    mov rbx, [rsp + 32]
+    add rsp, 40
+    sub rsp, 8
+    mov [rsp], rax
+    jmp rbx
+class6method1: ; C6.whoami
+    push rbp
+    mov rbp, rsp
+    inc qword [rel prof_methods + 96]
+    sub rsp, 8
+    mov qword [rsp], 6
+    mov rax, [rsp]
+    call _print_int
+    mov rax, [rsp]
+    mov rsp, rbp
+    pop rbp
+    mov rbx, [rsp + 32]
+    add rsp, 40
+    sub rsp, 8
+    mov [rsp], rax
+    jmp rbx
+_VTable_Dispatch:
+    mov rax, [rsp + 16]
+    cmp rax, 1
+    jne .L145
+    mov rax, [rsp + 8]
+    cmp rax, 0
+    jne .L145
+    mov rax, [rsp + 24]
+    mov rax, [rax]
+    cmp rax, 1
+    jne .L145
+    jmp class1method0
+.L145:
+    mov rax, [rsp + 16]
+    cmp rax, 1
+    jne .L146
+    mov rax, [rsp + 8]
+    cmp rax, 1
+    jne .L146
+    mov rax, [rsp + 24]
+    mov rax, [rax]
+    cmp rax, 1
+    jne .L146
+    jmp class1method1
+.L146:
+    mov rax, [rsp + 16]
+    cmp rax, 1
+    jne .L147
+    mov rax, [rsp + 8]
+    cmp rax, 2
+    jne .L147
+    mov rax, [rsp + 24]
+    mov rax, [rax]
+    cmp rax, 1
+    jne .L147
+    jmp class1method2
+.L147:
+    mov rax, [rsp + 16]
+    cmp rax, 2
+    jne .L148
+    mov rax, [rsp + 8]
+    cmp rax, 0
+    jne .L148
+    mov rax, [rsp + 24]
+    mov rax, [rax]
+    cmp rax, 2
+    jne .L148
+    jmp class2method0
+.L148:
+    mov rax, [rsp + 16]
+    cmp rax, 2
+    jne .L149
+    mov rax, [rsp + 8]
+    cmp rax, 1
+    jne .L149
+    mov rax, [rsp + 24]
+    mov rax, [rax]
+    cmp rax, 2
+    jne .L149
+    jmp class2method1
+.L149:
+    mov rax, [rsp + 16]
+    cmp rax, 1
+    jne .L150
+    mov rax, [rsp + 8]
+    cmp rax, 0
+    jne .L150
+    mov rax, [rsp + 24]
+    mov rax, [rax]
+    cmp rax, 2
+    jne .L150
+    jmp class2method0
+.L150:
+    mov rax, [rsp + 16]
+    cmp rax, 1
+    jne .L151
+    mov rax, [rsp + 8]
+    cmp rax, 1
+    jne .L151
+    mov rax, [rsp + 24]
+    mov rax, [rax]
+    cmp rax, 2
+    jne .L151
+    jmp class2method1
+.L151:
+    mov rax, [rsp + 16]
+    cmp rax, 1
+    jne .L152
+    mov rax, [rsp + 8]
+    cmp rax, 2
+    jne .L152
+    mov rax, [rsp + 24]
+    mov rax, [rax]
+    cmp rax, 2
+    jne .L152
+    jmp class1method2
+.L152:
+    mov rax, [rsp + 16]
+    cmp rax, 3
+    jne .L153
+    mov rax, [rsp + 8]
+    cmp rax, 0
+    jne .L153
+    mov rax, [rsp + 24]
+    mov rax, [rax]
+    cmp rax, 3
+    jne .L153
+    jmp class3method0
+.L153:
+    mov rax, [rsp + 16]
+    cmp rax, 3
+    jne .L154
+    mov rax, [rsp + 8]
+    cmp rax, 1
+    jne .L154
+    mov rax, [rsp + 24]
+    mov rax, [rax]
+    cmp rax, 3
+    jne .L154
+    jmp class3method1
+.L154:
+    mov rax, [rsp + 16]
+    cmp rax, 4
+    jne .L155
+    mov rax, [rsp + 8]
+    cmp rax, 0
+    jne .L155
+    mov rax, [rsp + 24]
+    mov rax, [rax]
+    cmp rax, 4
+    jne .L155
+    jmp class4method0
+.L155:
+    mov rax, [rsp + 16]
+    cmp rax, 4
+    jne .L156
+    mov rax, [rsp + 8]
+    cmp rax, 1
+    jne .L156
+    mov rax, [rsp + 24]
+    mov rax, [rax]
+    cmp rax, 4
+    jne .L156
+    jmp class4method1
+.L156:
+    mov rax, [rsp + 16]
+    cmp rax, 2
+    jne .L157
+    mov rax, [rsp + 8]
+    cmp rax, 0
+    jne .L157
+    mov rax, [rsp + 24]
+    mov rax, [rax]
+    cmp rax, 4
+    jne .L157
+    jmp class4method0
+.L157:
+    mov rax, [rsp + 16]
+    cmp rax, 2
+    jne .L158
+    mov rax, [rsp + 8]
+    cmp rax, 1
+    jne .L158
+    mov rax, [rsp + 24]
+    mov rax, [rax]
+    cmp rax, 4
+    jne .L158
+    jmp class4method1
+.L158:
+    mov rax, [rsp + 16]
+    cmp rax, 1
+    jne .L159
+    mov rax, [rsp + 8]
+    cmp rax, 0
+    jne .L159
+    mov rax, [rsp + 24]
+    mov rax, [rax]
+    cmp rax, 4
+    jne .L159
+    jmp class4method0
+.L159:
+    mov rax, [rsp + 16]
+    cmp rax, 1
+    jne .L160
+    mov rax, [rsp + 8]
+    cmp rax, 1
+    jne .L160
+    mov rax, [rsp + 24]
+    mov rax, [rax]
+    cmp rax, 4
+    jne .L160
+    jmp class4method1
+.L160:
+    mov rax, [rsp + 16]
+    cmp rax, 1
+    jne .L161
+    mov rax, [rsp + 8]
+    cmp rax, 2
+    jne .L161
+    mov rax, [rsp + 24]
+    mov rax, [rax]
+    cmp rax, 4
+    jne .L161
+    jmp class1method2
+.L161:
+    mov rax, [rsp + 16]
+    cmp rax, 5
+    jne .L162
+    mov rax, [rsp + 8]
+    cmp rax, 0
+    jne .L162
+    mov rax, [rsp + 24]
+    mov rax, [rax]
+    cmp rax, 5
+    jne .L162
+    jmp class5method0
+.L162:
+    mov rax, [rsp + 16]
+    cmp rax, 5
+    jne .L163
+    mov rax, [rsp + 8]
+    cmp rax, 1
+    jne .L163
+    mov rax, [rsp + 24]
+    mov rax, [rax]
+    cmp rax, 5
+    jne .L163
+    jmp class5method1
+.L163:
+    mov rax, [rsp + 16]
+    cmp rax, 2
+    jne .L164
+    mov rax, [rsp + 8]
+    cmp rax, 0
+    jne .L164
+    mov rax, [rsp + 24]
+    mov rax, [rax]
+    cmp rax, 5
+    jne .L164
+    jmp class5method0
+.L164:
+    mov rax, [rsp + 16]
+    cmp rax, 2
+    jne .L165
+    mov rax, [rsp + 8]
+    cmp rax, 1
+    jne .L165
+    mov rax, [rsp + 24]
+    mov rax, [rax]
+    cmp rax, 5
+    jne .L165
+    jmp class5method1
+.L165:
+    mov rax, [rsp + 16]
+    cmp rax, 1
+    jne .L166
+    mov rax, [rsp + 8]
+    cmp rax, 0
+    jne .L166
+    mov rax, [rsp + 24]
+    mov rax, [rax]
+    cmp rax, 5
+    jne .L166
+    jmp class5method0
+.L166:
+    mov rax, [rsp + 16]
+    cmp rax, 1
+    jne .L167
+    mov rax, [rsp + 8]
+    cmp rax, 1
+    jne .L167
+    mov rax, [rsp + 24]
+    mov rax, [rax]
+    cmp rax, 5
+    jne .L167
+    jmp class5method1
+.L167:
+    mov rax, [rsp + 16]
+    cmp rax, 1
+    jne .L168
+    mov rax, [rsp + 8]
+    cmp rax, 2
+    jne .L168
+    mov rax, [rsp + 24]
+    mov rax, [rax]
+    cmp rax, 5
+    jne .L168
+    jmp class1method2
+.L168:
+    mov rax, [rsp + 16]
+    cmp rax, 6
+    jne .L169
+    mov rax, [rsp + 8]
+    cmp rax, 0
+    jne .L169
+    mov rax, [rsp + 24]
+    mov rax, [rax]
+    cmp rax, 6
+    jne .L169
+    jmp class6method0
+.L169:
+    mov rax, [rsp + 16]
+    cmp rax, 6
+    jne .L170
+    mov rax, [rsp + 8]
+    cmp rax, 1
+    jne .L170
+    mov rax, [rsp + 24]
+    mov rax, [rax]
+    cmp rax, 6
+    jne .L170
+    jmp class6method1
+.L170:
+    mov rax, [rsp + 16]
+    cmp rax, 4
+    jne .L171
+    mov rax, [rsp + 8]
+    cmp rax, 0
+    jne .L171
+    mov rax, [rsp + 24]
+    mov rax, [rax]
+    cmp rax, 6
+    jne .L171
+    jmp class6method0
+.L171:
+    mov rax, [rsp + 16]
+    cmp rax, 4
+    jne .L172
+    mov rax, [rsp + 8]
+    cmp rax, 1
+    jne .L172
+    mov rax, [rsp + 24]
+    mov rax, [rax]
+    cmp rax, 6
+    jne .L172
+    jmp class6method1
+.L172:
+    mov rax, [rsp + 16]
+    cmp rax, 2
+    jne .L173
+    mov rax, [rsp + 8]
+    cmp rax, 0
+    jne .L173
+    mov rax, [rsp + 24]
+    mov rax, [rax]
+    cmp rax, 6
+    jne .L173
+    jmp class6method0
+.L173:
+    mov rax, [rsp + 16]
+    cmp rax, 2
+    jne .L174
+    mov rax, [rsp + 8]
+    cmp rax, 1
+    jne .L174
+    mov rax, [rsp + 24]
+    mov rax, [rax]
+    cmp rax, 6
+    jne .L174
+    jmp class6method1
+.L174:
+    mov rax, [rsp + 16]
+    cmp rax, 1
+    jne .L175
+    mov rax, [rsp + 8]
+    cmp rax, 0
+    jne .L175
+    mov rax, [rsp + 24]
+    mov rax, [rax]
+    cmp rax, 6
+    jne .L175
+    jmp class6method0
+.L175:
+    mov rax, [rsp + 16]
+    cmp rax, 1
+    jne .L176
+    mov rax, [rsp + 8]
+    cmp rax, 1
+    jne .L176
+    mov rax, [rsp + 24]
+    mov rax, [rax]
+    cmp rax, 6
+    jne .L176
+    jmp class6method1
+.L176:
+    mov rax, [rsp + 16]
+    cmp rax, 1
+    jne .L177
+    mov rax, [rsp + 8]
+    cmp rax, 2
+    jne .L177
+    mov rax, [rsp + 24]
+    mov rax, [rax]
+    cmp rax, 6
+    jne .L177
+    jmp class1method2
+.L177:
+    mov rdi, 44
+    call _exit_program
+..@alloc_slow_1:
+    call _alloc_slow
+    jmp ..@alloc_done_1
+..@alloc_slow_137:
+    call _alloc_slow
+    jmp ..@alloc_done_137
+..@alloc_slow_140:
+    call _alloc_slow
+    jmp ..@alloc_done_140
+..@alloc_slow_141:
+    call _alloc_slow
+    jmp ..@alloc_done_141
+..@alloc_slow_142:
+    call _alloc_slow
+    jmp ..@alloc_done_142
+..@alloc_slow_143:
+    call _alloc_slow
+    jmp ..@alloc_done_143
+..@alloc_slow_144:
+    call _alloc_slow
+    jmp ..@alloc_done_144
@@ -0,0 +1,1834 @@
+; File djrt.asm: The runtime of compiled DJ programs: printNat and
+; readNat with their buffers and the io_uring backend, the methods of
+; the intrinsic classes NatVector and NatMap, and the work-stealing
+; scheduler that runs spawned tasks. The Makefile assembles it once
+; into bin/libdjrt.a, which the driver links into every program; only
+; programs that print, read, use an intrinsic class, or spawn pull it
+; in.
+;
+; Its ABI, the entry points, what they take and keep, and the flags of
+; _djrt_init, is described in include/djrt.h. An incompatible change
+; to it bumps DJRT_ABI_VERSION there and the djrt_abi_N symbol below,
+; which programs refer to, so that a stale library fails to link.
+
+section .bss
+    ; Buffered output: printNat appends to output_current, which with
+    ; io_uring is one of two buffers, the other being written meanwhile
+    output_buffer resb 65536
+    output_buffer2 resb 65536
+    output_used resq 1
+    output_line_buffered resq 1 ; nonzero iff stdout is a terminal
+    output_writing resq 1       ; nonzero while output_other is written
+
+    ; Buffered input: readNat parses from input_next to input_end, in
+    ; input_buffer, in input_buffer2 with io_uring, or in stdin's mapping
+    input_buffer resb 65536
+    input_buffer2 resb 65536
+    input_next resq 1
+    input_end resq 1
+    input_reading resq 1 ; nonzero while input_ahead is read into
+
+    ; The io_uring backend: the ring, its parameters (a struct
+    ; io_uring_params), and the addresses of its parts in the mapping
+    uring_active resq 1 ; nonzero once set up
+    uring_fd resq 1
+    uring_params resb 120
+    uring_sqes resq 1
+    uring_sq_tail resq 1
+    uring_sq_array resq 1
+    uring_cq_head resq 1
+    uring_cq_tail resq 1
+    uring_cqes resq 1
+    uring_sq_mask resq 1
+    uring_cq_mask resq 1
+
+    ; By tag, 0 for the write of an output buffer and 1 for the read of
+    ; an input buffer: whether it is in flight, its last result, and the
+    ; iovec of its buffer
+    uring_pending resq 2
+    uring_results resq 2
+    uring_iovecs resq 4
+
+    ; The scheduler: its workers, one after the other, and their number
+    sched_workers resq 1
+    sched_count resq 1
+
+    ; The tasks: the table they are carved from, and how many of its
+    ; tasks workers have been given to carve
+    task_table resq 1
+    task_slots resq 1
+
+    ; The free list (72) and carving bounds (80, 88) of the tasks of a
+    ; program without worker threads, at the offsets a worker has them
+    inline_worker resq 12
+
+    ; Nonzero while a thread prints or reads (see _djrt_io_lock)
+    io_lock resq 1
+
+section .data
+output_current dq output_buffer
+output_other dq output_buffer2
+input_ahead dq input_buffer ; being read into
+input_spare dq input_buffer2
+env_io_uring db "DJ_IO_URING=", 0
+env_workers db "DJ_WORKERS=", 0
+
+; The powers of 10 that decide the number of digits _print_int writes,
+; from 0 so that 0 has a digit
+print_powers:
+    dq 0
+    dq 10
+    dq 100
+    dq 1000
+    dq 10000
+    dq 100000
+    dq 1000000
+    dq 10000000
+    dq 100000000
+    dq 1000000000
+    dq 10000000000
+    dq 100000000000
+    dq 1000000000000
+    dq 10000000000000
+    dq 100000000000000
+    dq 1000000000000000
+    dq 10000000000000000
+    dq 100000000000000000
+    dq 1000000000000000000
+    dq 10000000000000000000
+
+; The two digits of each number below 100
+print_pairs:
+    db "00010203040506070809"
+    db "10111213141516171819"
+    db "20212223242526272829"
+    db "30313233343536373839"
+    db "40414243444546474849"
+    db "50515253545556575859"
+    db "60616263646566676869"
+    db "70717273747576777879"
+    db "80818283848586878889"
+    db "90919293949596979899"
+
+; 10 to the 0 to 8, by which _read_int scales what it has parsed
+input_powers:
+    dq 1
+    dq 10
+    dq 100
+    dq 1000
+    dq 10000
+    dq 100000
+    dq 1000000
+    dq 10000000
+    dq 100000000
+
+section .text
+    global djrt_abi_1
+    global _djrt_init
+    global _print_int
+    global _flush_output
+    global _output_wait
+    global _read_int
+    global _djrt_vector_get
+    global _djrt_vector_set
+    global _djrt_vector_push
+    global _djrt_vector_size
+    global _djrt_map_get
+    global _djrt_map_has
+    global _djrt_map_put
+    global _djrt_map_size
+    global _djrt_sched_init
+    global _djrt_spawn
+    global _djrt_join
+    global _djrt_spawn_inline
+    global _djrt_join_inline
+    global _djrt_io_lock
+    global _djrt_io_unlock
+
+djrt_abi_1:
+
+; _djrt_init: sets up the runtime at startup, for the flags in RDI
+; (DJRT_INIT_*), given the process's initial stack pointer in RSI, from
+; which the environment is found. Output is line buffered iff stdout is
+; a terminal, i.e. TCGETS works on it (the output buffer, still unused,
+; takes the terminal settings). Keeps RBX, RBP, and R12 to R15.
+_djrt_init:
+    push rbx
+    push r12
+    push rdi
+    push rsi
+    test dil, 1 ; DJRT_INIT_OUTPUT
+    jz .no_output
+    mov rax, 16 ; ioctl
+    mov rdi, 1
+    mov rsi, 0x5401 ; TCGETS
+    lea rdx, [rel output_buffer]
+    syscall
+    test rax, rax
+    sete al
+    movzx eax, al
+    mov [rel output_line_buffered], rax
+.no_output:
+    test byte [rsp + 8], 2 ; DJRT_INIT_INPUT
+    jz .no_input
+    call _input_init
+.no_input:
+    test byte [rsp + 8], 4 ; DJRT_INIT_IO_URING
+    jz .done
+    mov rdi, [rsp]
+    call _uring_init
+.done:
+    pop rsi
+    pop rdi
+    pop r12
+    pop rbx
+    ret
+
+; _print_int: appends the nat in RAX and a newline to the output buffer,
+; after flushing it when they might not fit (21 bytes), and flushes it
+; at once when stdout is line buffered. The number of digits comes from
+; the nat's bit length, times log10(2) as 1233/4096, corrected by one
+; comparison with a power of 10. The digits are then written in place,
+; last first, two at a time from print_pairs, dividing by 100 with a
+; multiplication by its reciprocal, 2^66/100 rounded up, applied to the
+; nat over 4. Keeps every register but RAX.
+_print_int:
+    push rbx
+    push rcx
+    push rdx
+    push rsi
+    push rdi
+    cmp qword [rel output_used], 65515
+    jbe .room
+    call _flush_output
+.room:
+    mov rsi, rax
+    or rax, 1
+    bsr rax, rax
+    inc eax
+    imul eax, eax, 1233
+    shr eax, 12
+    lea rcx, [rel print_powers]
+    cmp rsi, [rcx + rax * 8]
+    sbb eax, -1
+    mov rdi, [rel output_current]
+    add rdi, [rel output_used]
+    add rdi, rax
+    mov byte [rdi], 10
+    lea rbx, [rdi + 1]
+    lea rcx, [rel print_pairs]
+.pairs:
+    cmp rsi, 100
+    jb .last
+    mov rax, rsi
+    shr rax, 2
+    mov rdx, 0x28F5C28F5C28F5C3
+    mul rdx
+    shr rdx, 2
+    imul rax, rdx, 100
+    sub rsi, rax
+    movzx eax, word [rcx + rsi * 2]
+    sub rdi, 2
+    mov [rdi], ax
+    mov rsi, rdx
+    jmp .pairs
+.last:
+    cmp rsi, 10
+    jb .last_digit
+    movzx eax, word [rcx + rsi * 2]
+    mov [rdi - 2], ax
+    jmp .converted
+.last_digit:
+    add esi, '0'
+    mov [rdi - 1], sil
+.converted:
+    sub rbx, [rel output_current]
+    mov [rel output_used], rbx
+    cmp qword [rel output_line_buffered], 0
+    je .printed
+    call _flush_output
+.printed:
+    pop rdi
+    pop rsi
+    pop rdx
+    pop rcx
+    pop rbx
+    ret
+
+; _flush_output: writes the output buffer to stdout and empties it,
+; keeping every register. It gives up on the rest of the buffer when a
+; write fails, e.g. on a closed pipe. With io_uring, it submits the
+; write of the buffer and switches to the other one, once the write of
+; that one is done (see _output_wait); it writes the buffer itself when
+; the submission fails.
+_flush_output:
+    cmp qword [rel uring_active], 0
+    jne .async
+.sync:
+    push rax
+    push rdi
+    push rsi
+    push rdx
+    push rcx
+    push r11
+    mov rsi, [rel output_current]
+    mov rdx, [rel output_used]
+.write:
+    test rdx, rdx
+    jz .flushed
+    mov rax, 1 ; write
+    mov rdi, 1
+    syscall
+    test rax, rax
+    jle .flushed
+    add rsi, rax
+    sub rdx, rax
+    jmp .write
+.flushed:
+    mov qword [rel output_used], 0
+    pop r11
+    pop rcx
+    pop rdx
+    pop rsi
+    pop rdi
+    pop rax
+    ret
+.async:
+    cmp qword [rel output_used], 0
+    je .async_done
+    call _output_wait
+    push rax
+    push rdx
+    push rsi
+    push rdi
+    mov rax, [rel output_current]
+    mov [rel uring_iovecs + 0], rax
+    mov rax, [rel output_used]
+    mov [rel uring_iovecs + 8], rax
+    mov edi, 0 ; the output tag
+    mov esi, 2 ; IORING_OP_WRITEV
+    mov edx, 1 ; stdout
+    call _uring_submit
+    cmp qword [rel uring_pending + 0], 0
+    je .submit_failed
+    mov qword [rel output_writing], 1
+    mov rax, [rel output_current]
+    mov rdx, [rel output_other]
+    mov [rel output_current], rdx
+    mov [rel output_other], rax
+    mov qword [rel output_used], 0
+    pop rdi
+    pop rsi
+    pop rdx
+    pop rax
+.async_done:
+    ret
+.submit_failed:
+    pop rdi
+    pop rsi
+    pop rdx
+    pop rax
+    jmp .sync
+
+; _read_int: returns in RAX the nat of the next whitespace-separated
+; token of stdin, its leading digits (0 if none), or 0 at the end of the
+; input; whitespace is any byte up to ' '. The rest of the token is
+; skipped. Keeps every other register.
+_read_int:
+    push rbx
+    push rcx
+    push rdx
+    push rsi
+    push rdi
+    push r8
+    push r9
+    mov rsi, [rel input_next]
+    mov rdi, [rel input_end]
+    xor eax, eax
+.skip_space:
+    cmp rsi, rdi
+    jne .space_byte
+    call _input_refill
+    cmp rsi, rdi
+    je .done
+.space_byte:
+    cmp byte [rsi], ' '
+    ja .digits
+    inc rsi
+    jmp .skip_space
+
+    ; 8 bytes at a time: a byte is a digit iff its high nibble is 3 and
+    ; adding 6 leaves it 3. A carry out of a byte that is not a digit
+    ; only changes the bytes after it, which are not parsed. The k
+    ; leading digits, less '0', shifted to the top of the word, are 8
+    ; digits with leading zeros, which three multiply-shift-mask steps
+    ; combine.
+.digits:
+    mov rcx, rdi
+    sub rcx, rsi
+    cmp rcx, 8
+    jb .digit_byte
+    mov rbx, [rsi]
+    mov r8, 0x3030303030303030
+    mov rcx, 0xF0F0F0F0F0F0F0F0
+    mov rdx, 0x0606060606060606
+    add rdx, rbx
+    and rdx, rcx
+    and rcx, rbx
+    xor rdx, r8
+    xor rcx, r8
+    or rcx, rdx ; nonzero in the bytes not digits
+    mov edx, 64
+    bsf rcx, rcx
+    cmovz ecx, edx
+    and ecx, -8 ; 8 times the leading digits
+    jz .token_rest
+    mov r9, rcx
+    sub rbx, r8
+    neg ecx
+    add ecx, 64
+    shl rbx, cl
+    imul rbx, rbx, 2561 ; 10 * 256 + 1
+    shr rbx, 8
+    mov rdx, 0x00FF00FF00FF00FF
+    and rbx, rdx
+    imul rbx, rbx, 6553601 ; 100 * 65536 + 1
+    shr rbx, 16
+    mov rdx, 0x0000FFFF0000FFFF
+    and rbx, rdx
+    mov rdx, 42949672960001 ; 10000 * 2^32 + 1
+    imul rbx, rdx
+    shr rbx, 32
+    shr r9, 3
+    lea rdx, [rel input_powers]
+    imul rax, [rdx + r9 * 8]
+    add rax, rbx
+    add rsi, r9
+    cmp r9, 8
+    je .digits
+    jmp .token_rest
+
+    ; Near the end of the buffer, a byte at a time
+.digit_byte:
+    test rcx, rcx
+    jnz .have_byte
+    call _input_refill
+    cmp rsi, rdi
+    je .done
+.have_byte:
+    movzx ecx, byte [rsi]
+    sub ecx, '0'
+    cmp ecx, 9
+    ja .token_rest
+    imul rax, rax, 10
+    add rax, rcx
+    inc rsi
+    jmp .digits
+
+    ; What follows the digits of a token, up to whitespace, is ignored
+.token_rest:
+    cmp rsi, rdi
+    jne .rest_byte
+    call _input_refill
+    cmp rsi, rdi
+    je .done
+.rest_byte:
+    cmp byte [rsi], ' '
+    jbe .done
+    inc rsi
+    jmp .token_rest
+
+.done:
+    mov [rel input_next], rsi
+    mov [rel input_end], rdi
+    pop r9
+    pop r8
+    pop rdi
+    pop rsi
+    pop rdx
+    pop rcx
+    pop rbx
+    ret
+
+; _input_init: maps stdin when it is a regular file with bytes left,
+; from its current offset, into the input buffer's place, and moves the
+; offset to the end of the file so that refills find nothing more.
+_input_init:
+    mov rax, 5 ; fstat
+    xor edi, edi
+    lea rsi, [rel input_buffer]
+    syscall
+    test rax, rax
+    jnz .done
+    mov eax, [rel input_buffer + 24] ; st_mode
+    and eax, 0xF000 ; S_IFMT
+    cmp eax, 0x8000 ; S_IFREG
+    jne .done
+    mov rbx, [rel input_buffer + 48] ; st_size
+    mov rax, 8 ; lseek
+    xor edi, edi
+    xor esi, esi
+    mov rdx, 1 ; SEEK_CUR
+    syscall
+    test rax, rax
+    js .done
+    cmp rax, rbx
+    jae .done
+    mov r12, rax
+    mov rax, 9 ; mmap
+    xor edi, edi
+    mov rsi, rbx
+    mov rdx, 1 ; PROT_READ
+    mov r10, 2 ; MAP_PRIVATE
+    xor r8d, r8d
+    xor r9d, r9d
+    syscall
+    cmp rax, -4096
+    ja .done
+    lea rcx, [rax + r12]
+    mov [rel input_next], rcx
+    lea rcx, [rax + rbx]
+    mov [rel input_end], rcx
+    mov rdi, rax
+    mov rax, 28 ; madvise
+    mov rsi, rbx
+    mov rdx, 2 ; MADV_SEQUENTIAL
+    syscall
+    mov rax, 8 ; lseek
+    xor edi, edi
+    xor esi, esi
+    mov rdx, 2 ; SEEK_END
+    syscall
+.done:
+    ret
+
+; _input_refill: reads the next part of the input into the buffer and
+; returns its start in RSI and end in RDI, equal at the end of the
+; input, after flushing the output, since it may wait for the input;
+; a prompt must show before the program waits. Both backends flush
+; here, and only here. It keeps every other register. With io_uring, the part is read into
+; one of two buffers while the other is parsed: _input_refill waits for
+; the read of the part it returns (submitting it first when none is in
+; flight), and then submits the read of the next part into the other
+; buffer. The read may be done (and reaped, by a wait for a write) long
+; before the part is needed, so input_reading tells whether there is
+; one to wait for. It reads the part itself when the read through the
+; ring fails.
+_input_refill:
+    call _flush_output
+    cmp qword [rel uring_active], 0
+    jne .async
+.sync:
+    push rax
+    push rcx
+    push rdx
+    push r11
+    xor eax, eax ; read
+    xor edi, edi
+    lea rsi, [rel input_buffer]
+    mov rdx, 65536
+    syscall
+    mov rdi, rsi
+    test rax, rax
+    jle .refilled
+    add rdi, rax
+.refilled:
+    pop r11
+    pop rdx
+    pop rcx
+    pop rax
+    ret
+.async:
+    push rax
+    push rdx
+    cmp qword [rel input_reading], 0
+    jne .wait
+    call .submit_read
+.wait:
+    mov edi, 1 ; the input tag
+    call _uring_wait
+    mov qword [rel input_reading], 0
+    mov rsi, [rel input_ahead]
+    mov rdi, rsi
+    mov rax, [rel uring_results + 8]
+    test rax, rax
+    js .read_failed
+    jz .async_done ; the end of the input
+    add rdi, rax
+    mov rax, [rel input_spare]
+    mov rdx, [rel input_ahead]
+    mov [rel input_ahead], rax
+    mov [rel input_spare], rdx
+    push rsi
+    push rdi
+    call .submit_read
+    pop rdi
+    pop rsi
+.async_done:
+    pop rdx
+    pop rax
+    ret
+.read_failed:
+    pop rdx
+    pop rax
+    jmp .sync
+
+    ; Submits the read of the next part of the input into input_ahead
+.submit_read:
+    mov rax, [rel input_ahead]
+    mov [rel uring_iovecs + 16], rax
+    mov qword [rel uring_iovecs + 24], 65536
+    mov qword [rel input_reading], 1
+    mov edi, 1 ; the input tag
+    mov esi, 1 ; IORING_OP_READV
+    xor edx, edx ; stdin
+    jmp _uring_submit
+
+; _env_lookup: returns in RAX the value of the environment variable
+; whose name and = are the string at RSI, given the process's initial
+; stack pointer in RDI, or 0 if it is not set. Keeps every other
+; register.
+_env_lookup:
+    push rbx
+    push rcx
+    push rdx
+    push rdi
+    mov rcx, [rdi]
+    lea rbx, [rdi + rcx * 8 + 16] ; envp
+.variable:
+    mov rdi, [rbx]
+    test rdi, rdi
+    jz .unset
+    mov rdx, rsi
+.byte:
+    mov cl, [rdx]
+    test cl, cl
+    jz .match
+    cmp cl, [rdi]
+    jne .next
+    inc rdx
+    inc rdi
+    jmp .byte
+.match:
+    mov rax, rdi
+    jmp .done
+.next:
+    add rbx, 8
+    jmp .variable
+.unset:
+    xor eax, eax
+.done:
+    pop rdi
+    pop rdx
+    pop rcx
+    pop rbx
+    ret
+
+; _uring_init: given the initial stack pointer in RDI, sets up a ring
+; (of 4 entries) and maps it, and sets uring_active when that all works,
+; unless the environment has DJ_IO_URING=0. The backend stays off on
+; kernels without io_uring, or without the features it needs (one
+; mapping for both rings, and reads and writes at the file position),
+; and where it is not allowed.
+_uring_init:
+    lea rsi, [rel env_io_uring]
+    call _env_lookup
+    test rax, rax
+    jz .env_done
+    cmp byte [rax], '0'
+    je .done
+.env_done:
+    mov rax, 425 ; io_uring_setup
+    mov rdi, 4
+    lea rsi, [rel uring_params]
+    syscall
+    test rax, rax
+    js .done
+    mov [rel uring_fd], rax
+    mov eax, [rel uring_params + 20] ; features
+    and eax, 9 ; IORING_FEAT_SINGLE_MMAP | IORING_FEAT_RW_CUR_POS
+    cmp eax, 9
+    jne .close
+
+    ; One mapping holds both rings: the larger of their sizes
+    mov eax, [rel uring_params + 0] ; sq_entries
+    shl eax, 2
+    add eax, [rel uring_params + 64] ; sq_off.array
+    mov ecx, [rel uring_params + 4] ; cq_entries
+    shl ecx, 4
+    add ecx, [rel uring_params + 100] ; cq_off.cqes
+    cmp eax, ecx
+    cmovb eax, ecx
+    mov rsi, rax
+    xor r9d, r9d
+    call .map
+    cmp rax, -4096
+    ja .close
+    mov rbx, rax
+    mov esi, [rel uring_params + 0]
+    shl esi, 6
+    mov r9d, 0x10000000 ; IORING_OFF_SQES
+    call .map
+    cmp rax, -4096
+    ja .close
+    mov [rel uring_sqes], rax
+    mov eax, [rel uring_params + 44] ; sq_off.tail
+    add rax, rbx
+    mov [rel uring_sq_tail], rax
+    mov eax, [rel uring_params + 64] ; sq_off.array
+    add rax, rbx
+    mov [rel uring_sq_array], rax
+    mov eax, [rel uring_params + 80] ; cq_off.head
+    add rax, rbx
+    mov [rel uring_cq_head], rax
+    mov eax, [rel uring_params + 84] ; cq_off.tail
+    add rax, rbx
+    mov [rel uring_cq_tail], rax
+    mov eax, [rel uring_params + 100] ; cq_off.cqes
+    add rax, rbx
+    mov [rel uring_cqes], rax
+    mov eax, [rel uring_params + 48] ; sq_off.ring_mask
+    mov eax, [rbx + rax]
+    mov [rel uring_sq_mask], rax
+    mov eax, [rel uring_params + 88] ; cq_off.ring_mask
+    mov eax, [rbx + rax]
+    mov [rel uring_cq_mask], rax
+    mov qword [rel uring_active], 1
+    ret
+.close:
+    mov rax, 3 ; close
+    mov rdi, [rel uring_fd]
+    syscall
+.done:
+    ret
+
+    ; Maps RSI bytes of the ring at offset R9
+.map:
+    mov rax, 9 ; mmap
+    xor edi, edi
+    mov rdx, 3 ; PROT_READ | PROT_WRITE
+    mov r10, 0x8001 ; MAP_SHARED | MAP_POPULATE
+    mov r8, [rel uring_fd]
+    syscall
+    ret
+
+; _uring_submit: submits the request tagged RDI, operation RSI on file
+; RDX with the tag's iovec, at the file position. When the kernel does
+; not take it, the request is failed at once. Keeps every register.
+_uring_submit:
+    push rax
+    push rcx
+    push r8
+    push r9
+    push r10
+    push r11
+    push rdx
+    push rsi
+    push rdi
+    mov r8, [rel uring_sq_tail]
+    mov ecx, [r8]
+    mov r9d, ecx
+    and r9, [rel uring_sq_mask] ; the entry's index
+    mov rax, r9
+    shl rax, 6
+    add rax, [rel uring_sqes]
+    xor r10d, r10d
+    mov [rax + 0], r10
+    mov [rax + 8], r10
+    mov [rax + 16], r10
+    mov [rax + 24], r10
+    mov [rax + 32], r10
+    mov [rax + 40], r10
+    mov [rax + 48], r10
+    mov [rax + 56], r10
+    mov [rax], sil ; the operation
+    mov [rax + 4], edx ; the file
+    mov qword [rax + 8], -1 ; at its position
+    mov r10, rdi
+    shl r10, 4
+    lea r11, [rel uring_iovecs]
+    add r10, r11
+    mov [rax + 16], r10 ; the iovec
+    mov dword [rax + 24], 1 ; only one
+    mov [rax + 32], rdi ; the tag
+    mov r10, [rel uring_sq_array]
+    mov [r10 + r9 * 4], r9d
+    inc ecx
+    mov [r8], ecx
+    lea r10, [rel uring_pending]
+    mov qword [r10 + rdi * 8], 1
+.enter:
+    mov rax, 426 ; io_uring_enter
+    mov rdi, [rel uring_fd]
+    mov esi, 1
+    xor edx, edx
+    xor r10d, r10d
+    xor r8d, r8d
+    xor r9d, r9d
+    syscall
+    cmp rax, -4 ; -EINTR
+    je .enter
+    test rax, rax
+    jns .submitted
+
+    ; The kernel took nothing: take the entry back and fail the request
+    mov r8, [rel uring_sq_tail]
+    dec dword [r8]
+    mov rdi, [rsp]
+    lea r10, [rel uring_pending]
+    mov qword [r10 + rdi * 8], 0
+    lea r10, [rel uring_results]
+    mov [r10 + rdi * 8], rax
+.submitted:
+    pop rdi
+    pop rsi
+    pop rdx
+    pop r11
+    pop r10
+    pop r9
+    pop r8
+    pop rcx
+    pop rax
+    ret
+
+; _uring_wait: waits until the request tagged RDI is done, reaping the
+; completions there are into the tags' results. Keeps every register.
+_uring_wait:
+    push rax
+    push rcx
+    push r8
+    push r9
+    push r10
+    push r11
+    push rdx
+    push rsi
+.check:
+    lea rax, [rel uring_pending]
+    cmp qword [rax + rdi * 8], 0
+    je .done
+    mov r8, [rel uring_cq_head]
+    mov r9, [rel uring_cq_tail]
+    mov ecx, [r8]
+.reap:
+    cmp ecx, [r9]
+    je .reaped
+    mov eax, ecx
+    and rax, [rel uring_cq_mask]
+    shl rax, 4
+    add rax, [rel uring_cqes]
+    mov rdx, [rax] ; the tag
+    movsxd rsi, dword [rax + 8] ; the result
+    lea r10, [rel uring_results]
+    mov [r10 + rdx * 8], rsi
+    lea r10, [rel uring_pending]
+    mov qword [r10 + rdx * 8], 0
+    inc ecx
+    mov [r8], ecx
+    jmp .reap
+.reaped:
+    lea rax, [rel uring_pending]
+    cmp qword [rax + rdi * 8], 0
+    je .done
+    push rdi
+    mov rax, 426 ; io_uring_enter
+    mov rdi, [rel uring_fd]
+    xor esi, esi
+    mov edx, 1
+    mov r10, 1 ; IORING_ENTER_GETEVENTS
+    xor r8d, r8d
+    xor r9d, r9d
+    syscall
+    pop rdi
+    cmp rax, -4 ; -EINTR
+    je .check
+    test rax, rax
+    jns .check
+
+    ; The ring failed: give the request up
+    lea r10, [rel uring_results]
+    mov [r10 + rdi * 8], rax
+    lea r10, [rel uring_pending]
+    mov qword [r10 + rdi * 8], 0
+.done:
+    pop rsi
+    pop rdx
+    pop r11
+    pop r10
+    pop r9
+    pop r8
+    pop rcx
+    pop rax
+    ret
+
+; _output_wait: waits for the write of the output buffer submitted last,
+; unless that is over, and writes what it left unwritten itself, so that
+; the buffer can be filled again. A wait for a read may have reaped the
+; write, so output_writing tells whether it is over. Keeps every
+; register; without io_uring, it returns at once.
+_output_wait:
+    cmp qword [rel output_writing], 0
+    je .done
+    mov qword [rel output_writing], 0
+    push rax
+    push rcx
+    push r8
+    push r9
+    push r10
+    push r11
+    push rdx
+    push rsi
+    push rdi
+    mov edi, 0 ; the output tag
+    call _uring_wait
+    mov rax, [rel uring_results + 0]
+    test rax, rax
+    js .written ; give up, as a failed write would
+    mov rsi, [rel uring_iovecs + 0]
+    mov rdx, [rel uring_iovecs + 8]
+    add rsi, rax
+    sub rdx, rax
+.write:
+    test rdx, rdx
+    jz .written
+    mov rax, 1 ; write
+    mov rdi, 1
+    syscall
+    test rax, rax
+    jle .written
+    add rsi, rax
+    sub rdx, rax
+    jmp .write
+.written:
+    pop rdi
+    pop rsi
+    pop rdx
+    pop r11
+    pop r10
+    pop r9
+    pop r8
+    pop rcx
+    pop rax
+.done:
+    ret
+
+; The storage of the intrinsic classes NatVector and NatMap (see
+; include/intrinsics.h). An object's state field points at its storage,
+; mapped on first use outside the heap, or is 0 before that.
+;
+; A vector's storage is its header, the number of elements (at 0), the
+; number there is room for (8), and the selected index (16), followed by
+; the elements from offset 32. It doubles in size, with mremap, when it
+; runs out of room; the memory past the last element is always 0.
+;
+; A map's storage is its header, the number of keys (at 0), the number
+; of entries less 1 (8), the selected key (16), and 64 less the log2 of
+; the number of entries (24), then the entry of key 0 (32), followed by
+; the entries from offset 64. An entry is a key and its value, 16 bytes,
+; and the key of an empty entry is 0, so key 0 keeps its entry apart,
+; where the key says whether it has one. Keys are hashed by Fibonacci
+; hashing, the top bits of their product with 2^64 over the golden
+; ratio, and collisions probed linearly; the number of entries, a power
+; of 2, doubles once more than half of them would be in use.
+
+; _vector_create: maps the storage of an empty vector, whose state field
+; is at RDI, and returns it in RAX. Keeps every other register.
+_vector_create:
+    mov eax, 4096
+    call _storage_map
+    mov qword [rax + 8], 508 ; (4096 - 32) / 8
+    mov [rdi], rax
+    ret
+
+; _vector_grow: doubles the storage of the vector at RAX, whose state
+; field is at RDI, until there is room for index RDX, and returns the
+; new storage in RAX. Keeps every other register.
+_vector_grow:
+    push rcx
+    push rdx
+    push rsi
+    push r8
+    push r10
+    push r11
+    mov rcx, [rax + 8]
+    lea rsi, [rcx * 8 + 32] ; the size now
+    mov rcx, rsi
+.double:
+    add rcx, rcx
+    jc _storage_exhausted
+    lea r8, [rcx - 32]
+    shr r8, 3 ; the room for elements
+    cmp rdx, r8
+    jae .double
+    push rdi
+    mov rdi, rax
+    mov rdx, rcx
+    mov r10d, 1 ; MREMAP_MAYMOVE
+    mov eax, 25 ; mremap
+    syscall
+    pop rdi
+    cmp rax, -4096
+    ja _storage_exhausted
+    mov [rax + 8], r8
+    mov [rdi], rax
+    pop r11
+    pop r10
+    pop r8
+    pop rsi
+    pop rdx
+    pop rcx
+    ret
+
+; _djrt_vector_get: returns in RAX element RSI of the vector whose state
+; field is at RDI, or 0 past its end, and selects index RSI. Keeps every
+; other register.
+_djrt_vector_get:
+    mov rax, [rdi]
+    test rax, rax
+    jz .create
+.created:
+    mov [rax + 16], rsi
+    cmp rsi, [rax]
+    jae .past_end
+    mov rax, [rax + rsi * 8 + 32]
+    ret
+.past_end:
+    xor eax, eax
+    ret
+.create:
+    call _vector_create
+    jmp .created
+
+; _djrt_vector_set: stores RSI as the selected element of the vector
+; whose state field is at RDI, which grows up to it, and returns RSI in
+; RAX. Keeps every other register.
+_djrt_vector_set:
+    mov rax, [rdi]
+    test rax, rax
+    jz .create
+.created:
+    push rdx
+    mov rdx, [rax + 16]
+    cmp rdx, [rax + 8]
+    jae .grow
+.store:
+    mov [rax + rdx * 8 + 32], rsi
+    inc rdx
+    cmp rdx, [rax]
+    jbe .stored
+    mov [rax], rdx
+.stored:
+    pop rdx
+    mov rax, rsi
+    ret
+.grow:
+    call _vector_grow
+    jmp .store
+.create:
+    call _vector_create
+    jmp .created
+
+; _djrt_vector_push: appends RSI to the vector whose state field is at
+; RDI and returns its new number of elements in RAX. Keeps every other
+; register.
+_djrt_vector_push:
+    mov rax, [rdi]
+    test rax, rax
+    jz .create
+.created:
+    push rdx
+    mov rdx, [rax]
+    cmp rdx, [rax + 8]
+    jae .grow
+.store:
+    mov [rax + rdx * 8 + 32], rsi
+    inc rdx
+    mov [rax], rdx
+    mov rax, rdx
+    pop rdx
+    ret
+.grow:
+    call _vector_grow
+    jmp .store
+.create:
+    call _vector_create
+    jmp .created
+
+; _djrt_vector_size: returns in RAX the number of elements of the vector
+; whose state field is at RDI. Keeps every other register.
+_djrt_vector_size:
+    mov rax, [rdi]
+    test rax, rax
+    jz .empty
+    mov rax, [rax]
+.empty:
+    ret
+
+; _map_create: maps the storage of an empty map of 256 entries, whose
+; state field is at RDI, and returns it in RAX. Keeps every other
+; register.
+_map_create:
+    mov eax, 4160 ; 64 + 256 * 16
+    call _storage_map
+    mov qword [rax + 8], 255
+    mov qword [rax + 24], 56
+    mov [rdi], rax
+    ret
+
+; _map_find: returns in RDX the offset, in the map at R8, of the entry
+; of the nonzero key RSI, or of the empty entry where it would go.
+; Clobbers RAX and RCX.
+_map_find:
+    mov rax, 0x9E3779B97F4A7C15
+    imul rax, rsi
+    mov rcx, [r8 + 24]
+    shr rax, cl
+.probe:
+    mov rdx, rax
+    shl rdx, 4
+    add rdx, 64
+    mov rcx, [r8 + rdx]
+    cmp rcx, rsi
+    je .found
+    test rcx, rcx
+    jz .found
+    inc rax
+    and rax, [r8 + 8]
+    jmp .probe
+.found:
+    ret
+
+; _map_grow: moves the map at R8, whose state field is at RDI, to new
+; storage with twice the entries, and returns that in R8. Keeps every
+; other register.
+_map_grow:
+    push rax
+    push rcx
+    push rdx
+    push rsi
+    push r9
+    push r10
+    push r11
+    mov r9, r8
+    mov rax, [r9 + 8]
+    inc rax
+    shl rax, 5 ; twice the entries, of 16 bytes
+    add rax, 64
+    call _storage_map
+    mov r8, rax
+    mov rax, [r9]
+    mov [r8], rax
+    mov rax, [r9 + 16]
+    mov [r8 + 16], rax
+    mov rax, [r9 + 32]
+    mov [r8 + 32], rax
+    mov rax, [r9 + 40]
+    mov [r8 + 40], rax
+    mov rax, [r9 + 8]
+    lea rax, [rax * 2 + 1]
+    mov [r8 + 8], rax
+    mov rax, [r9 + 24]
+    dec rax
+    mov [r8 + 24], rax
+    lea r10, [r9 + 64] ; the old entries
+    mov r11, [r9 + 8]
+    inc r11
+    shl r11, 4
+    add r11, r10 ; their end
+.reinsert:
+    mov rsi, [r10]
+    test rsi, rsi
+    jz .next
+    call _map_find
+    mov [r8 + rdx], rsi
+    mov rax, [r10 + 8]
+    mov [r8 + rdx + 8], rax
+.next:
+    add r10, 16
+    cmp r10, r11
+    jb .reinsert
+    push rdi
+    mov rdi, r9
+    mov rsi, r11
+    sub rsi, r9
+    mov eax, 11 ; munmap
+    syscall
+    pop rdi
+    mov [rdi], r8
+    pop r11
+    pop r10
+    pop r9
+    pop rsi
+    pop rdx
+    pop rcx
+    pop rax
+    ret
+
+; _djrt_map_get: returns in RAX the value of key RSI in the map whose
+; state field is at RDI, 0 if it has none, and selects key RSI. Keeps
+; every other register.
+_djrt_map_get:
+    mov rax, [rdi]
+    test rax, rax
+    jz .create
+.created:
+    mov [rax + 16], rsi
+    test rsi, rsi
+    jz .zero_key
+    push rcx
+    push rdx
+    push r8
+    mov r8, rax
+    call _map_find
+    mov rax, [r8 + rdx + 8] ; 0 in an empty entry
+    pop r8
+    pop rdx
+    pop rcx
+    ret
+.zero_key:
+    mov rax, [rax + 40]
+    ret
+.create:
+    call _map_create
+    jmp .created
+
+; _djrt_map_has: returns in RAX 1 if key RSI has a value in the map
+; whose state field is at RDI, 0 otherwise, and selects key RSI. Keeps
+; every other register.
+_djrt_map_has:
+    mov rax, [rdi]
+    test rax, rax
+    jz .create
+.created:
+    mov [rax + 16], rsi
+    test rsi, rsi
+    jz .zero_key
+    push rcx
+    push rdx
+    push r8
+    mov r8, rax
+    call _map_find
+    cmp qword [r8 + rdx], 0
+    setne al
+    movzx eax, al
+    pop r8
+    pop rdx
+    pop rcx
+    ret
+.zero_key:
+    mov rax, [rax + 32]
+    ret
+.create:
+    call _map_create
+    jmp .created
+
+; _djrt_map_put: stores RSI as the value of the selected key of the map
+; whose state field is at RDI, and returns RSI in RAX. A new key makes
+; the map grow first when more than half its entries would be in use.
+; Keeps every other register.
+_djrt_map_put:
+    mov rax, [rdi]
+    test rax, rax
+    jz .create
+.created:
+    push rcx
+    push rdx
+    push r8
+    push rsi
+    mov r8, rax
+    mov rsi, [r8 + 16]
+    test rsi, rsi
+    jz .zero_key
+    call _map_find
+    cmp qword [r8 + rdx], 0
+    jne .store
+    mov rax, [r8]
+    lea rax, [rax * 2 + 1]
+    cmp rax, [r8 + 8]
+    ja .grow
+.insert:
+    mov [r8 + rdx], rsi
+    inc qword [r8]
+.store:
+    pop rsi
+    mov [r8 + rdx + 8], rsi
+    mov rax, rsi
+    pop r8
+    pop rdx
+    pop rcx
+    ret
+.grow:
+    call _map_grow
+    call _map_find
+    jmp .insert
+.zero_key:
+    mov edx, 32
+    cmp qword [r8 + 32], 0
+    jne .store
+    mov esi, 1 ; the entry's key says it is in use
+    jmp .insert
+.create:
+    call _map_create
+    jmp .created
+
+; _djrt_map_size: returns in RAX the number of keys with a value in the
+; map whose state field is at RDI. Keeps every other register.
+_djrt_map_size:
+    mov rax, [rdi]
+    test rax, rax
+    jz .empty
+    mov rax, [rax]
+.empty:
+    ret
+
+; _storage_map: returns in RAX the address of RAX bytes of zeroed memory
+; for the storage of a collection. Keeps every other register.
+_storage_map:
+    push rcx
+    push rdx
+    push rsi
+    push rdi
+    push r8
+    push r9
+    push r10
+    push r11
+    mov rsi, rax
+    xor edi, edi
+    mov edx, 3 ; PROT_READ | PROT_WRITE
+    mov r10d, 0x22 ; MAP_PRIVATE | MAP_ANONYMOUS
+    mov r8, -1
+    xor r9d, r9d
+    mov eax, 9 ; mmap
+    syscall
+    cmp rax, -4096
+    ja _storage_exhausted
+    pop r11
+    pop r10
+    pop r9
+    pop r8
+    pop rdi
+    pop rsi
+    pop rdx
+    pop rcx
+    ret
+
+; _storage_exhausted: exits with code 45, as running out of heap does,
+; once the storage of a collection cannot grow, after writing out the
+; output. It ends every thread of the program.
+_storage_exhausted:
+    call _djrt_io_lock
+    call _flush_output
+    call _output_wait
+    mov eax, 231 ; exit_group
+    mov edi, 45
+    syscall
+
+; The scheduler of spawned tasks (see spawn and join in the README).
+; Each worker runs on a thread of its own, the first on the thread of
+; the main block, and keeps the tasks it spawns in a Chase-Lev deque:
+; it pushes and pops them at the bottom, while idle workers steal the
+; oldest from the top. A worker that joins a task not done yet runs
+; the tasks of its own deque, and then steals, until it is. Compiled
+; code keeps the address of its thread's worker in R12.
+;
+; A worker is 32896 bytes: the top of its deque (at 0), on a cache line
+; of its own since thieves write it, then the bottom (64), the first of
+; its free tasks (72), where it carves the next task from its task
+; storage (80) and where that ends (88), and the state of its random
+; number generator (96), which picks the workers it steals from; its
+; deque, 4096 task addresses, starts at offset 128. The top and the
+; bottom only grow (the bottom shrinks back by a pop), and index the
+; deque modulo 4096.
+;
+; A task is 64 bytes: the entry code gen emitted for its spawn site (at
+; 0), the receiver (8) and the argument (16) of its call, its result
+; (24), whether it is done (32), the next free task (40) once it is
+; joined, and its generation (48), a dword bumped when it is spawned
+; and when it is joined, so odd from its spawn to its join. Tasks live
+; in one table of 2^24, mapped as it is used, which workers carve 1024
+; at a time. A task's handle is its generation in the top 32 bits and
+; its index in the table plus 1 in the bottom 32, so a join can tell a
+; handle from any other nat, and from the handle of a task joined
+; already, whose generation has moved on.
+
+; _djrt_sched_init: sets up the scheduler, given the process's initial
+; stack pointer in RDI, from which the environment is found, and returns
+; the worker of the calling thread in RAX. There are as many workers as
+; DJ_WORKERS says, or else as CPUs the process may run on, from 1 to 64.
+; Each but the first gets a thread, cloned with the caller's R14, whose
+; R13 and R15 start out 0, so that its first allocation claims a heap
+; block; a worker whose thread cannot be started keeps an empty deque.
+; Keeps RBX, RBP, and R12 to R15.
+_djrt_sched_init:
+    push rbx
+    push rdi
+    lea rsi, [rel env_workers]
+    call _env_lookup
+    xor ecx, ecx
+    test rax, rax
+    jz .count_cpus
+.digit:
+    movzx edx, byte [rax]
+    sub edx, '0'
+    cmp edx, 9
+    ja .counted
+    imul rcx, rcx, 10
+    add rcx, rdx
+    inc rax
+    cmp rcx, 64
+    jbe .digit
+    jmp .counted
+.count_cpus:
+    ; The bits set in the affinity mask, of at most 1024 CPUs
+    sub rsp, 128
+    mov eax, 204 ; sched_getaffinity
+    xor edi, edi
+    mov esi, 128
+    mov rdx, rsp
+    syscall
+    xor ecx, ecx
+    test rax, rax
+    jle .mask_done
+.mask_byte:
+    dec rax
+    movzx edx, byte [rsp + rax]
+.mask_bit:
+    test edx, edx
+    jz .mask_next
+    lea esi, [rdx - 1]
+    and edx, esi
+    inc ecx
+    jmp .mask_bit
+.mask_next:
+    test rax, rax
+    jnz .mask_byte
+.mask_done:
+    add rsp, 128
+.counted:
+    mov eax, 1
+    test rcx, rcx
+    cmovz rcx, rax
+    mov eax, 64
+    cmp rcx, rax
+    cmova rcx, rax
+    mov [rel sched_count], rcx
+    call _task_table_init
+
+    ; The workers, zeroed, with distinct nonzero generator states
+    imul rax, rcx, 32896
+    call _storage_map
+    mov [rel sched_workers], rax
+    mov rdx, 0x9E3779B97F4A7C15
+    mov rsi, rdx
+.seed:
+    mov [rax + 96], rsi
+    add rsi, rdx
+    add rax, 32896
+    dec rcx
+    jnz .seed
+
+    ; The threads of the other workers, each on a stack of 64MB mapped
+    ; as it is used, whose top holds the worker
+    mov ebx, 1
+.thread:
+    cmp rbx, [rel sched_count]
+    jae .started
+    mov eax, 9 ; mmap
+    xor edi, edi
+    mov esi, 0x4000000
+    mov edx, 3 ; PROT_READ | PROT_WRITE
+    mov r10d, 0x24022 ; MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE | MAP_STACK
+    mov r8, -1
+    xor r9d, r9d
+    syscall
+    cmp rax, -4096
+    ja .started
+    lea rsi, [rax + 0x4000000 - 16]
+    imul rax, rbx, 32896
+    add rax, [rel sched_workers]
+    mov [rsi], rax
+    mov edi, 0x50f00 ; CLONE_VM | CLONE_FS | CLONE_FILES | CLONE_SIGHAND | CLONE_THREAD | CLONE_SYSVSEM
+    xor edx, edx
+    xor r10d, r10d
+    xor r8d, r8d
+    mov eax, 56 ; clone
+    syscall
+    test rax, rax
+    jz _worker_start ; in the new thread, on its stack
+    js .started
+    inc rbx
+    jmp .thread
+.started:
+    mov rax, [rel sched_workers]
+    pop rdi
+    pop rbx
+    ret
+
+; _worker_start: runs the tasks of the worker on top of the stack, its
+; own first and then stolen ones, on its thread, for as long as the
+; program runs. After 1024 looks in a row that find no task, it naps
+; for 50 microseconds before each next look, leaving the CPU to the
+; threads that have work.
+_worker_start:
+    pop r12
+    xor r13d, r13d ; no heap block yet
+    xor r15d, r15d
+    push 0 ; the looks in a row that found no task
+.look:
+    call _sched_find
+    test rax, rax
+    jz .idle
+    mov qword [rsp], 0
+    mov rdi, rax
+    call _run_task
+    jmp .look
+.idle:
+    inc qword [rsp]
+    cmp qword [rsp], 1024
+    jae .nap
+    pause
+    jmp .look
+.nap:
+    sub rsp, 16
+    mov qword [rsp], 0
+    mov qword [rsp + 8], 50000 ; nanoseconds
+    mov eax, 35 ; nanosleep
+    mov rdi, rsp
+    xor esi, esi
+    syscall
+    add rsp, 16
+    jmp .look
+
+; _djrt_spawn: queues a task that calls the entry at RDI with the
+; receiver in RSI and the argument in RDX, on the deque of the worker at
+; R12, and returns its handle in RAX. When the deque is full, the task
+; runs at once. Keeps only RBP, RSP, R12, and R14, as the task may run.
+_djrt_spawn:
+    call _task_alloc
+    mov [rax], rdi
+    mov [rax + 8], rsi
+    mov [rax + 16], rdx
+    mov qword [rax + 32], 0
+    inc dword [rax + 48]
+    mov rcx, [r12 + 64]
+    mov rdx, rcx
+    sub rdx, [r12]
+    cmp rdx, 4096
+    jae .full
+    mov rdx, rcx
+    and edx, 4095
+    mov [r12 + rdx * 8 + 128], rax
+    ; Stores are seen in order, so a thief that sees the new bottom
+    ; sees the task
+    inc rcx
+    mov [r12 + 64], rcx
+    jmp _task_handle
+.full:
+    push rax
+    mov rdi, rax
+    call _run_task
+    pop rax
+    jmp _task_handle
+
+; _djrt_join: returns in RAX the result of the task whose handle is RDI,
+; with RDX 0, once it is done, and frees the task to the free list of
+; the worker at R12. Until then, the worker runs other tasks: those of
+; its own deque, spawned after the task, and once that is empty (the
+; task was stolen), ones it steals. Returns at once with RDX 1 when RDI
+; is not the handle of a task spawned and not yet joined. Keeps only
+; RBP, RSP, R12, and R14, as the tasks run.
+_djrt_join:
+    call _task_claim
+    test rdx, rdx
+    jnz .invalid
+    push rdi
+.wait:
+    mov rdi, [rsp]
+    cmp qword [rdi + 32], 0
+    jne .done
+    call _sched_find
+    test rax, rax
+    jz .idle
+    mov rdi, rax
+    call _run_task
+    jmp .wait
+.idle:
+    pause
+    jmp .wait
+.done:
+    pop rdi
+    ; Loads are seen in order, so the result is there once done is
+    mov rax, [rdi + 24]
+    mov rcx, [r12 + 72]
+    mov [rdi + 40], rcx
+    mov [r12 + 72], rdi
+    xor edx, edx
+.invalid:
+    ret
+
+; _djrt_spawn_inline: returns in RAX the handle of a task, done already,
+; whose result is RDI, for a program that runs its spawned calls at once,
+; without worker threads. Keeps every other register.
+_djrt_spawn_inline:
+    push rcx
+    push r12
+    lea r12, [rel inline_worker]
+    call _task_table_init
+    call _task_alloc
+    mov [rax + 24], rdi
+    mov qword [rax + 32], 1
+    inc dword [rax + 48]
+    call _task_handle
+    pop r12
+    pop rcx
+    ret
+
+; _djrt_join_inline: returns in RAX the result of the task whose handle
+; is RDI, with RDX 0, for a program without worker threads, and frees
+; the task; or RDX 1 when RDI is not the handle of a task spawned and
+; not yet joined. Keeps every other register.
+_djrt_join_inline:
+    push rcx
+    push rdi
+    call _task_claim
+    test rdx, rdx
+    jnz .done
+    mov rax, [rdi + 24]
+    lea rcx, [rel inline_worker]
+    mov rdx, [rcx + 72]
+    mov [rdi + 40], rdx
+    mov [rcx + 72], rdi
+    xor edx, edx
+.done:
+    pop rdi
+    pop rcx
+    ret
+
+; _task_table_init: maps the task table, unless it is there, exiting
+; with code 45 when it cannot. Keeps every register.
+_task_table_init:
+    cmp qword [rel task_table], 0
+    jne .done
+    push rax
+    push rcx
+    push rdx
+    push rsi
+    push rdi
+    push r8
+    push r9
+    push r10
+    push r11
+    xor edi, edi
+    mov esi, 0x40000000 ; 2^24 tasks of 64 bytes
+    mov edx, 3 ; PROT_READ | PROT_WRITE
+    mov r10d, 0x4022 ; MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE
+    mov r8, -1
+    xor r9d, r9d
+    mov eax, 9 ; mmap
+    syscall
+    cmp rax, -4096
+    ja _storage_exhausted
+    mov [rel task_table], rax
+    pop r11
+    pop r10
+    pop r9
+    pop r8
+    pop rdi
+    pop rsi
+    pop rdx
+    pop rcx
+    pop rax
+.done:
+    ret
+
+; _task_alloc: returns in RAX a free task for the worker at R12, off its
+; free list, or else carved from its part of the task table, which gets
+; the next 1024 tasks of the table when it runs out. Exits with code 45
+; once the table has none left. Keeps every other register but RCX.
+_task_alloc:
+    mov rax, [r12 + 72]
+    test rax, rax
+    jz .carve
+    mov rcx, [rax + 40]
+    mov [r12 + 72], rcx
+    ret
+.carve:
+    mov rax, [r12 + 80]
+    cmp rax, [r12 + 88]
+    jb .carved
+    mov eax, 1024
+    lock xadd [rel task_slots], rax
+    cmp rax, 16776192 ; 2^24 - 1024
+    ja _storage_exhausted
+    shl rax, 6
+    add rax, [rel task_table]
+    lea rcx, [rax + 65536]
+    mov [r12 + 88], rcx
+.carved:
+    lea rcx, [rax + 64]
+    mov [r12 + 80], rcx
+    ret
+
+; _task_handle: returns in RAX the handle of the task at RAX. Keeps
+; every other register but RCX.
+_task_handle:
+    mov ecx, [rax + 48]
+    shl rcx, 32
+    sub rax, [rel task_table]
+    shr rax, 6
+    inc rax
+    or rax, rcx
+    ret
+
+; _task_claim: returns in RDI the task whose handle is RDI, with RDX 0,
+; once it has moved the task's generation on, so that no other join
+; takes it; or RDX 1 when RDI is not the handle of a task spawned and
+; not yet joined. Keeps every other register but RAX and RCX.
+_task_claim:
+    mov eax, edi ; the index, plus 1
+    test eax, eax
+    jz .invalid
+    cmp rax, [rel task_slots]
+    ja .invalid
+    cmp rax, 16777216 ; 2^24
+    ja .invalid
+    mov rcx, rdi
+    shr rcx, 32 ; the generation, odd from spawn to join
+    test ecx, 1
+    jz .invalid
+    dec eax
+    shl rax, 6
+    add rax, [rel task_table]
+    mov rdi, rax
+    mov eax, ecx
+    inc ecx
+    lock cmpxchg [rdi + 48], ecx
+    jne .invalid
+    xor edx, edx
+    ret
+.invalid:
+    mov edx, 1
+    ret
+
+; _run_task: runs the task at RDI, and marks it done once its result is
+; stored. Keeps only RBP, RSP, R12, and R14.
+_run_task:
+    push rdi
+    mov rsi, [rdi + 8]
+    mov rdx, [rdi + 16]
+    call qword [rdi]
+    pop rdi
+    mov [rdi + 24], rax
+    mov qword [rdi + 32], 1
+    ret
+
+; _sched_find: returns in RAX a task for the worker at R12 to run, the
+; one at the bottom of its deque, or else one stolen from the top of
+; the deque of a worker picked at random, or 0 if neither has any.
+; Keeps RBX, RBP, and R12 to R15.
+_sched_find:
+    call _sched_pop
+    test rax, rax
+    jnz .found
+    ; xorshift64
+    mov rax, [r12 + 96]
+    mov rcx, rax
+    shl rcx, 13
+    xor rax, rcx
+    mov rcx, rax
+    shr rcx, 7
+    xor rax, rcx
+    mov rcx, rax
+    shl rcx, 17
+    xor rax, rcx
+    mov [r12 + 96], rax
+    ; The top 32 bits, scaled to the number of workers
+    shr rax, 32
+    imul rax, [rel sched_count]
+    shr rax, 32
+    imul rdi, rax, 32896
+    add rdi, [rel sched_workers]
+    cmp rdi, r12
+    je .none
+    jmp _sched_steal
+.none:
+    xor eax, eax
+.found:
+    ret
+
+; _sched_pop: returns in RAX the task at the bottom of the deque of the
+; worker at R12, or 0 if it is empty. Only the last task can also be
+; stolen; the owner and the thieves then race for it with a
+; compare-and-swap of the top. Keeps RBX, RBP, RDI, and R12 to R15.
+_sched_pop:
+    mov rcx, [r12 + 64]
+    dec rcx
+    mov [r12 + 64], rcx
+    mfence ; thieves see the lower bottom before it reads the top
+    mov rdx, [r12]
+    cmp rdx, rcx
+    jg .empty
+    mov rax, rcx
+    and eax, 4095
+    mov rax, [r12 + rax * 8 + 128]
+    cmp rdx, rcx
+    jne .popped
+    mov r8, rax
+    lea rsi, [rdx + 1]
+    mov rax, rdx
+    lock cmpxchg [r12], rsi
+    mov rax, r8
+    je .last
+    xor eax, eax
+.last:
+    mov [r12 + 64], rsi
+.popped:
+    ret
+.empty:
+    inc rcx
+    mov [r12 + 64], rcx
+    xor eax, eax
+    ret
+
+; _sched_steal: returns in RAX the task at the top of the deque of the
+; worker at RDI, or 0 if it is empty or another thread took the task
+; first. Keeps RBX, RBP, RDI, and R12 to R15.
+_sched_steal:
+    mov rdx, [rdi]
+    mov rcx, [rdi + 64] ; loads are seen in order: after the top
+    cmp rdx, rcx
+    jge .empty
+    mov rax, rdx
+    and eax, 4095
+    mov r8, [rdi + rax * 8 + 128]
+    lea rsi, [rdx + 1]
+    mov rax, rdx
+    lock cmpxchg [rdi], rsi
+    jne .empty
+    mov rax, r8
+    ret
+.empty:
+    xor eax, eax
+    ret
+
+; _djrt_io_lock: waits until no other thread prints or reads, and keeps
+; the others from doing so until _djrt_io_unlock. Both keep every
+; register.
+_djrt_io_lock:
+    push rax
+.take:
+    mov eax, 1
+    xchg [rel io_lock], rax
+    test rax, rax
+    jz .taken
+.spin:
+    pause
+    cmp qword [rel io_lock], 0
+    jne .spin
+    jmp .take
+.taken:
+    pop rax
+    ret
+
+_djrt_io_unlock:
+    mov qword [rel io_lock], 0
+    ret
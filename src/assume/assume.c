@@ -0,0 +1,351 @@
+#include "../../include/assume.h"
+#include "../../include/intrinsics.h"
+#include <stdint.h>
+
+/* Most variables with known facts at any one point */
+#define MAX_FACTS 32
+
+/* Largest value a nat literal can hold (see fold.c) */
+#define MAX_NAT_LITERAL 2147483647LL
+
+/* Encapsulate what is known about one parameter or local variable:
+   the range [lo, hi] of a nat variable, or whether an object variable is
+   non-null. Nats compare as 64-bit signed values at run time. */
+typedef struct fact {
+  char *name;
+  int type;
+  int64_t lo;
+  int64_t hi;
+  int nonNull;
+} Fact;
+
+/* The facts that hold at one point of a method body */
+typedef struct factset {
+  int numFacts;
+  Fact facts[MAX_FACTS];
+} FactSet;
+
+/* The method whose body is being optimized (class -1 for the main block) */
+static int currClass, currMethod;
+
+/* Returns nonzero iff name refers to a parameter or local variable in the
+   current method, storing its type */
+static int variableType(char *name, int *type) {
+  if (currClass < 0) {
+    for (int i = 0; i < numMainBlockLocals; i++) {
+      if (strCompare(name, mainBlockST[i].varName)) {
+        *type = mainBlockST[i].type;
+        return 1;
+      }
+    }
+    return 0;
+  }
+
+  MethodDecl *method = &classesST[currClass].methodList[currMethod];
+  if (strCompare(name, method->paramName)) {
+    *type = method->paramType;
+    return 1;
+  }
+  for (int i = 0; i < method->numLocals; i++) {
+    if (strCompare(name, method->localST[i].varName)) {
+      *type = method->localST[i].type;
+      return 1;
+    }
+  }
+  return 0;
+}
+
+/* Returns the facts about the variable that the ID expression t reads,
+   or NULL if t is not such an expression. If create is set, an empty
+   entry gets added for a variable with no facts yet. */
+static Fact *variableFact(FactSet *set, ASTree *t, int create) {
+  int type;
+  if (t == NULL || t->typ != ID_EXPR ||
+      !variableType(t->children->data->idVal, &type))
+    return NULL;
+
+  char *name = t->children->data->idVal;
+  for (int i = 0; i < set->numFacts; i++)
+    if (strCompare(name, set->facts[i].name))
+      return &set->facts[i];
+  if (!create || set->numFacts == MAX_FACTS)
+    return NULL;
+
+  Fact *fact = &set->facts[set->numFacts++];
+  fact->name = name;
+  fact->type = type;
+  fact->lo = INT64_MIN;
+  fact->hi = INT64_MAX;
+  fact->nonNull = 0;
+  return fact;
+}
+
+/* Forgets the facts about every variable that t assigns */
+static void killAssigned(ASTree *t, FactSet *set) {
+  if (t == NULL)
+    return;
+  if (t->typ == ASSIGN_EXPR) {
+    for (int i = 0; i < set->numFacts; i++) {
+      if (strCompare(t->children->data->idVal, set->facts[i].name)) {
+        set->facts[i] = set->facts[--set->numFacts];
+        break;
+      }
+    }
+  }
+  for (ASTList *child = t->children; child != NULL; child = child->next)
+    killAssigned(child->data, set);
+}
+
+/* Narrows the range of fact to [lo, hi] */
+static void narrow(Fact *fact, int64_t lo, int64_t hi) {
+  if (fact->type != -1)
+    return;
+  if (lo > fact->lo)
+    fact->lo = lo;
+  if (hi < fact->hi)
+    fact->hi = hi;
+}
+
+/* Adds the facts that follow from cond evaluating to nonzero (if holds is
+   set) or to 0 (otherwise) */
+static void learn(ASTree *cond, int holds, FactSet *set) {
+  ASTree *first = cond->children ? cond->children->data : NULL;
+  ASTree *second = (cond->children && cond->children->next)
+                       ? cond->children->next->data
+                       : NULL;
+  unsigned int value;
+  Fact *fact;
+
+  switch (cond->typ) {
+  case NOT_EXPR:
+    learn(first, !holds, set);
+    break;
+
+  case OR_EXPR:
+    // !(A || B) means both !A and !B
+    if (!holds) {
+      learn(first, 0, set);
+      learn(second, 0, set);
+    }
+    break;
+
+  case LESS_THAN_EXPR:
+    if ((fact = variableFact(set, first, 1)) != NULL &&
+        isNatLiteral(second, &value)) {
+      if (holds)
+        narrow(fact, INT64_MIN, (int64_t)value - 1); // x < N
+      else
+        narrow(fact, value, INT64_MAX); // !(x < N)
+    } else if ((fact = variableFact(set, second, 1)) != NULL &&
+               isNatLiteral(first, &value)) {
+      if (holds)
+        narrow(fact, (int64_t)value + 1, INT64_MAX); // N < x
+      else
+        narrow(fact, INT64_MIN, value); // !(N < x)
+    }
+    break;
+
+  case EQUALITY_EXPR:
+    if ((fact = variableFact(set, first, 1)) == NULL) {
+      fact = variableFact(set, second, 1);
+      second = first;
+    }
+    if (fact == NULL)
+      break;
+    if (holds && isNatLiteral(second, &value))
+      narrow(fact, value, value); // x == N
+    else if (!holds && second->typ == NULL_EXPR && fact->type >= 0)
+      fact->nonNull = 1; // !(x == null)
+    break;
+
+  default:
+    break;
+  }
+}
+
+/* Returns a nat literal holding value after freeing t */
+static ASTree *replaceWithLiteral(ASTree *t, unsigned int value) {
+  ASTree *literal = newAST(NAT_LITERAL_EXPR, NULL, value, NULL, t->lineNumber);
+  literal->staticClassNum = t->staticClassNum;
+  literal->staticMemberNum = t->staticMemberNum;
+  freeAST(t);
+  return literal;
+}
+
+/* Decides the comparison t with the facts in set.
+   Returns 0 or 1 when it is decided, and -1 otherwise. */
+static int decideComparison(ASTree *t, FactSet *set) {
+  ASTree *first = t->children->data;
+  ASTree *second = t->children->next->data;
+  unsigned int value;
+  Fact *fact;
+
+  if (t->typ == LESS_THAN_EXPR) {
+    if ((fact = variableFact(set, first, 0)) != NULL && fact->type == -1 &&
+        isNatLiteral(second, &value)) {
+      if (fact->hi < (int64_t)value)
+        return 1;
+      if (fact->lo >= (int64_t)value)
+        return 0;
+    } else if ((fact = variableFact(set, second, 0)) != NULL &&
+               fact->type == -1 && isNatLiteral(first, &value)) {
+      if (fact->lo > (int64_t)value)
+        return 1;
+      if (fact->hi <= (int64_t)value)
+        return 0;
+    }
+    return -1;
+  }
+
+  // Equality: x == N or N == x, and x == null or null == x
+  if ((fact = variableFact(set, first, 0)) == NULL) {
+    fact = variableFact(set, second, 0);
+    second = first;
+  }
+  if (fact == NULL)
+    return -1;
+  if (fact->type == -1 && isNatLiteral(second, &value)) {
+    if ((int64_t)value < fact->lo || (int64_t)value > fact->hi)
+      return 0;
+    if (fact->lo == fact->hi)
+      return 1;
+  }
+  if (fact->nonNull && second->typ == NULL_EXPR)
+    return 0;
+  return -1;
+}
+
+static void applyFactsToExprs(ASTree *exprList, FactSet set, int *changed);
+
+/* Rewrites t using the facts in set.
+   Returns the expression that should replace t in its parent. */
+static ASTree *applyFacts(ASTree *t, FactSet *set, int *changed) {
+  if (t == NULL)
+    return NULL;
+
+  for (ASTList *child = t->children; child != NULL; child = child->next) {
+    if (child->data == NULL || child->data->typ == AST_ID)
+      continue;
+    if (child->data->typ == EXPR_LIST)
+      applyFactsToExprs(child->data, *set, changed);
+    else
+      child->data = applyFacts(child->data, set, changed);
+  }
+
+  Fact *fact;
+  int decided;
+  switch (t->typ) {
+  case ID_EXPR:
+    fact = variableFact(set, t, 0);
+    if (fact != NULL && fact->type == -1 && fact->lo == fact->hi &&
+        fact->lo >= 0 && fact->lo <= MAX_NAT_LITERAL) {
+      *changed = 1;
+      return replaceWithLiteral(t, (unsigned int)fact->lo);
+    }
+    break;
+
+  case LESS_THAN_EXPR:
+  case EQUALITY_EXPR:
+    decided = decideComparison(t, set);
+    if (decided >= 0) {
+      *changed = 1;
+      return replaceWithLiteral(t, decided);
+    }
+    break;
+
+  case DOT_ID_EXPR:
+  case DOT_ASSIGN_EXPR:
+  case DOT_METHOD_CALL_EXPR:
+    fact = variableFact(set, t->children->data, 0);
+    if (fact != NULL && fact->nonNull && !t->nonNullObject) {
+      t->nonNullObject = 1;
+      *changed = 1;
+    }
+    break;
+
+  default:
+    break;
+  }
+  return t;
+}
+
+/* Rewrites every expression in exprList using the facts in set, adding
+   the facts of each assert to the expressions after it */
+static void applyFactsToExprs(ASTree *exprList, FactSet set, int *changed) {
+  for (ASTList *expr = exprList->children; expr && expr->data;
+       expr = expr->next) {
+    killAssigned(expr->data, &set);
+    expr->data = applyFacts(expr->data, &set, changed);
+    if (expr->data->typ == ASSERT_EXPR)
+      learn(expr->data->children->data, 1, &set);
+  }
+}
+
+/* Applies assert facts to one method body, or to the main block */
+static void assumeInBody(int classNum, int methodNum, ASTree *body) {
+  FactSet set;
+  int changed = 0;
+  currClass = classNum;
+  currMethod = methodNum;
+  set.numFacts = 0;
+  applyFactsToExprs(body, set, &changed);
+  if (changed)
+    foldExprs(body);
+}
+
+/* Uses the conditions of assert expressions as facts about the program. */
+void assumeAssertedFacts() {
+  for (int i = 1; i < numClasses; i++)
+    for (int j = 0; j < classesST[i].numMethods && !isIntrinsicClass(i); j++)
+      assumeInBody(i, j, classesST[i].methodList[j].bodyExprs);
+  assumeInBody(-1, -1, mainExprs);
+}
+
+static void stripAssertsFromExprs(ASTree *exprList);
+
+/* Removes the asserts inside t.
+   Returns the expression that should replace t in its parent. */
+static ASTree *stripAssertsFromExpr(ASTree *t) {
+  if (t == NULL)
+    return NULL;
+  for (ASTList *child = t->children; child != NULL; child = child->next) {
+    if (child->data != NULL && child->data->typ == EXPR_LIST)
+      stripAssertsFromExprs(child->data);
+    else
+      child->data = stripAssertsFromExpr(child->data);
+  }
+  if (t->typ == ASSERT_EXPR)
+    return replaceWithLiteral(t, 1);
+  return t;
+}
+
+/* Removes the asserts in exprList and the lists nested inside it */
+static void stripAssertsFromExprs(ASTree *exprList) {
+  ASTList *prev = NULL;
+  ASTList *expr = exprList->children;
+  while (expr && expr->data) {
+    // An assert whose value is discarded disappears entirely
+    if (expr->data->typ == ASSERT_EXPR && expr->next != NULL) {
+      ASTList *next = expr->next;
+      if (prev == NULL)
+        exprList->children = next;
+      else
+        prev->next = next;
+      freeAST(expr->data);
+      free(expr);
+      expr = next;
+      continue;
+    }
+    expr->data = stripAssertsFromExpr(expr->data);
+    prev = expr;
+    expr = expr->next;
+  }
+}
+
+/* Removes every assert expression from the program. */
+void stripAsserts() {
+  for (int i = 1; i < numClasses; i++)
+    for (int j = 0; j < classesST[i].numMethods && !isIntrinsicClass(i); j++)
+      stripAssertsFromExprs(classesST[i].methodList[j].bodyExprs);
+  stripAssertsFromExprs(mainExprs);
+}
@@ -30,6 +30,11 @@ ASTree *newAST(ASTNodeType t, ASTree *child, unsigned int natAttribute,
   root->lineNumber = lineNum;
   root->children = childNode;
   root->childrenTail = childNode;
+  root->staticClassNum = 0;
+  root->staticMemberNum = 0;
+  root->callTarget = NULL;
+  root->nonNullObject = 0;
+  root->profileSite = 0;
 
   return root;
 }
@@ -44,6 +49,52 @@ void appendToChildrenList(ASTree *parent, ASTree *newChild) {
   parent->childrenTail = newChildNode;
 }
 
+/* Return a deep copy of the AST rooted at t, including node attributes
+   and identifier strings. */
+ASTree *copyAST(ASTree *t) {
+  if (t == NULL)
+    return NULL;
+
+  ASTree *copy = (ASTree *)malloc(sizeof(ASTree));
+  *copy = *t;
+  if (t->idVal != NULL)
+    copy->idVal = getID(t->idVal);
+  copy->children = NULL;
+  copy->childrenTail = NULL;
+
+  ASTList *child = t->children;
+  while (child != NULL) {
+    ASTList *childNode = (ASTList *)malloc(sizeof(ASTList));
+    childNode->data = copyAST(child->data);
+    childNode->next = NULL;
+    if (copy->children == NULL)
+      copy->children = childNode;
+    else
+      copy->childrenTail->next = childNode;
+    copy->childrenTail = childNode;
+    child = child->next;
+  }
+
+  return copy;
+}
+
+/* Free the AST rooted at t, including its lists of children and the
+   identifier strings of its AST_ID nodes. */
+void freeAST(ASTree *t) {
+  if (t == NULL)
+    return;
+
+  ASTList *child = t->children;
+  while (child != NULL) {
+    ASTList *next = child->next;
+    freeAST(child->data);
+    free(child);
+    child = next;
+  }
+  free(t->idVal);
+  free(t);
+}
+
 void printASTPreorder(ASTree *t, int level) {
   if (t == NULL)
     return;
@@ -142,6 +193,12 @@ void printASTPreorder(ASTree *t, int level) {
   case READ_EXPR:
     printf("READ_EXPR");
     break;
+  case SPAWN_EXPR:
+    printf("SPAWN_EXPR");
+    break;
+  case JOIN_EXPR:
+    printf("JOIN_EXPR");
+    break;
   case THIS_EXPR:
     printf("THIS_EXPR");
     break;
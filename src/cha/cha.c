@@ -0,0 +1,88 @@
+#include "../../include/cha.h"
+
+/* Finds the method body that a call dispatches to.
+   The call was statically resolved (during type checking) to method number
+   staticMethod of class staticClass, and the receiver object has dynamic
+   type dynamicType, which must be a subtype of staticClass.
+   The search climbs from dynamicType towards Object and stops at the first
+   class that declares a method with the same name.
+   On success, stores the declaring class and method number in *targetClass
+   and *targetMethod and returns nonzero; otherwise returns 0. */
+int resolveMethod(int dynamicType, int staticClass, int staticMethod,
+                  int *targetClass, int *targetMethod) {
+  if (staticClass <= 0 || staticClass >= numClasses ||
+      staticMethod >= classesST[staticClass].numMethods)
+    return 0;
+
+  char *methodName = classesST[staticClass].methodList[staticMethod].methodName;
+  int currClass = dynamicType;
+  while (currClass > 0) {
+    ClassDecl *class = &classesST[currClass];
+    for (int i = 0; i < class->numMethods; i++) {
+      if (strCompare(methodName, class->methodList[i].methodName)) {
+        *targetClass = currClass;
+        *targetMethod = i;
+        return 1;
+      }
+    }
+    // Never climb past the class the call was resolved against
+    if (currClass == staticClass)
+      break;
+    currClass = class->superclass;
+  }
+  return 0;
+}
+
+/* Returns the number of distinct method bodies that a call statically
+   resolved to (staticClass, staticMethod) may reach, considering every
+   class in the program that is a subtype of staticClass.
+   When exactly one body is reachable, it is stored in *targetClass and
+   *targetMethod. */
+int countCallTargets(int staticClass, int staticMethod, int *targetClass,
+                     int *targetMethod) {
+  int numTargets = 0;
+  int firstClass = -1, firstMethod = -1;
+  for (int i = 1; i < numClasses; i++) {
+    int cls, mth;
+    if (!isSubtype(i, staticClass) ||
+        !resolveMethod(i, staticClass, staticMethod, &cls, &mth))
+      continue;
+    if (numTargets == 0) {
+      firstClass = cls;
+      firstMethod = mth;
+      numTargets = 1;
+    } else if (cls != firstClass || mth != firstMethod) {
+      // Count each further body once by checking earlier subtypes
+      int seen = 0;
+      for (int j = 1; j < i && !seen; j++) {
+        int prevCls, prevMth;
+        if (isSubtype(j, staticClass) &&
+            resolveMethod(j, staticClass, staticMethod, &prevCls, &prevMth) &&
+            prevCls == cls && prevMth == mth)
+          seen = 1;
+      }
+      if (!seen)
+        numTargets++;
+    }
+  }
+  if (numTargets == 1) {
+    *targetClass = firstClass;
+    *targetMethod = firstMethod;
+  }
+  return numTargets;
+}
+
+/* Returns nonzero iff a call statically resolved to
+   (staticClass, staticMethod) may reach method number targetMethod of
+   class targetClass. */
+int callMayReach(int staticClass, int staticMethod, int targetClass,
+                 int targetMethod) {
+  for (int i = 1; i < numClasses; i++) {
+    int cls, mth;
+    if (isSubtype(i, staticClass) &&
+        resolveMethod(i, staticClass, staticMethod, &cls, &mth) &&
+        cls == targetClass && mth == targetMethod)
+      return 1;
+  }
+  return 0;
+}
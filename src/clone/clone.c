@@ -0,0 +1,70 @@
+#include "../../include/clone.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+int numMethodClones = 0;
+MethodClone *methodClones = NULL;
+
+/* Capacity of the methodClones array */
+static int clonesCapacity = 0;
+
+/* Labels handed out by methodLabel, indexed by class and method number */
+static char ***methodLabels = NULL;
+
+/* Returns the NASM label of method number methodNum of class classNum,
+   e.g. "class3method2". The string is shared and must not be freed. */
+char *methodLabel(int classNum, int methodNum) {
+  if (methodLabels == NULL) {
+    methodLabels = (char ***)malloc(sizeof(char **) * numClasses);
+    for (int i = 0; i < numClasses; i++)
+      methodLabels[i] = (char **)calloc(
+          classesST[i].numMethods ? classesST[i].numMethods : 1,
+          sizeof(char *));
+  }
+
+  if (methodLabels[classNum][methodNum] == NULL) {
+    char buffer[64];
+    snprintf(buffer, sizeof(buffer), "class%dmethod%d", classNum, methodNum);
+    methodLabels[classNum][methodNum] = strConcat(buffer, NULL);
+  }
+  return methodLabels[classNum][methodNum];
+}
+
+/* Copies the body of method number methodNum of class classNum and
+   registers the copy as a clone emitted under the given label.
+   Returns the new clone, which stays valid until the next call. */
+MethodClone *addMethodClone(int classNum, int methodNum, char *label) {
+  if (numMethodClones == clonesCapacity) {
+    clonesCapacity = clonesCapacity ? clonesCapacity * 2 : 8;
+    methodClones = (MethodClone *)realloc(
+        methodClones, sizeof(MethodClone) * clonesCapacity);
+  }
+
+  MethodClone *clone = &methodClones[numMethodClones++];
+  clone->classNum = classNum;
+  clone->methodNum = methodNum;
+  clone->label = label;
+  clone->bodyExprs =
+      copyAST(classesST[classNum].methodList[methodNum].bodyExprs);
+  clone->thisType = -1;
+  return clone;
+}
+
+/* Returns the clone emitted under the given label, or NULL if none. */
+MethodClone *findMethodClone(char *label) {
+  for (int i = 0; i < numMethodClones; i++)
+    if (strCompare(label, methodClones[i].label))
+      return &methodClones[i];
+  return NULL;
+}
+
+/* Returns the clone of method number methodNum of class classNum that is
+   customized for receivers of exact type thisType, or NULL if none. */
+MethodClone *findCustomizedClone(int classNum, int methodNum, int thisType) {
+  for (int i = 0; i < numMethodClones; i++)
+    if (methodClones[i].classNum == classNum &&
+        methodClones[i].methodNum == methodNum &&
+        methodClones[i].thisType == thisType)
+      return &methodClones[i];
+  return NULL;
+}
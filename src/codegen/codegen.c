@@ -1,4 +1,14 @@
 #include "../../include/codegen.h"
+#include "../../include/cha.h"
+#include "../../include/clone.h"
+#include "../../include/djrt.h"
+#include "../../include/heapdump.h"
+#include "../../include/intrinsics.h"
+#include "../../include/layout.h"
+#include "../../include/preeval.h"
+#include "../../include/prefetch.h"
+#include "../../include/profile.h"
+#include "../../include/rta.h"
 #include <stdarg.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -6,6 +16,34 @@
 
 #define WORD_SIZE 8
 
+/* The heap grows in chunks of this many bytes, the size of a huge page,
+   and its reservation is aligned to a chunk */
+#define HEAP_CHUNK (2 * 1024 * 1024)
+
+/* Largest heap with compressed references, whose offsets are 32 bits */
+#define MAX_COMPRESSED_HEAP (1LL << 32)
+
+/* Linux system calls and flags the heap runtime uses */
+#define SYS_MMAP 9
+#define SYS_MADVISE 28
+#define MAP_PRIVATE_ANONYMOUS 0x22
+#define MAP_FIXED 0x10
+#define MAP_NORESERVE 0x4000
+#define MAP_POPULATE 0x8000
+#define PROT_READ_WRITE 3
+#define MADV_DONTNEED 4
+#define MADV_HUGEPAGE 14
+
+/* Linux system call that ends every thread of the program */
+#define SYS_EXIT_GROUP 231
+
+/* Linux system calls and flags the heap dump runtime uses */
+#define SYS_RT_SIGACTION 13
+#define SYS_RT_SIGRETURN 15
+#define SIGUSR1 10
+#define SA_RESTORER 0x04000000
+#define SA_RESTART 0x10000000
+
 /* Global for the output file */
 FILE *fout;
 
@@ -15,6 +53,82 @@ unsigned int VTableLabel = 0;
 /* Global to the next unique label number to use */
 unsigned int labelNumber = 1;
 
+/* Heap settings compiled into the program; see configureHeap */
+static long long heapLimit = DEFAULT_HEAP_LIMIT;
+static int heapPopulate = 0;
+static int heapHugePages = 0;
+static int collectGarbage = 0;
+
+/* The file the program writes a heap dump to, or NULL; see dumpHeapTo */
+static char *heapDumpFile = NULL;
+
+/* Nonzero iff output flushes and input refills go through io_uring when
+   the kernel has it; see useIoUring */
+static int ioUring = 0;
+
+/* Nonzero iff the program counts its allocations, and the file it
+   reports them to (NULL for stderr); see countAllocations */
+static int allocStats = 0;
+static char *allocStatsFile = NULL;
+
+/* Encapsulate an allocation site: the class a `new` creates objects of
+   and its line. Copies of a `new` in method clones share a site. */
+typedef struct allocsite {
+  int classNum;
+  int lineNumber;
+} AllocSite;
+
+static AllocSite *allocSites = NULL;
+static int numAllocSites = 0;
+
+/* Encapsulate a safepoint, where the collector may run: the label of
+   the return address it is found by (..@<labelKind>_<label>), whether it
+   is in the main block, and the RBP-relative offsets of the frame slots
+   that hold references there */
+typedef struct safepoint {
+  const char *labelKind;
+  int label;
+  int inMain;
+  int numSlots;
+  int *slots;
+} Safepoint;
+
+/* The safepoints of the code generated so far, when collecting garbage */
+static Safepoint *safepoints = NULL;
+static int numSafepoints = 0;
+
+/* Whether each word the code being generated has pushed on the operand
+   stack, and still needs, holds a reference, bottom first. The words sit
+   right below the frame's locals. */
+static char *pendingRefs = NULL;
+static int numPending = 0;
+static int pendingCapacity = 0;
+
+/* The method the code being generated is in, or -1 in the main block */
+static int frameClass = -1;
+static int frameMethod = -1;
+
+/* Label numbers of the allocations whose slow paths are still to be
+   emitted (see genAllocSlowPaths) */
+static int *allocSlowPaths = NULL;
+static int numAllocSlowPaths = 0;
+
+/* Nonzero iff spawned tasks run in parallel, on the worker threads of
+   the runtime library's scheduler; see generateNASM */
+static int parallel = 0;
+
+/* Encapsulate a spawn site: the call its tasks make, and the label
+   number of the entry the scheduler runs them through (..@task_<label>) */
+typedef struct tasksite {
+  ASTree *call;
+  int label;
+} TaskSite;
+
+/* The spawn sites whose task entries are still to be emitted (see
+   genTaskEntries) */
+static TaskSite *taskSites = NULL;
+static int numTaskSites = 0;
+
 /* Forward Decls */
 void codeGenExpr(ASTree *, int, int);
 void codeGenExprs(ASTree *, int, int);
@@ -26,132 +140,227 @@ void genPrologue(int, int);
 void genEpilogue(int, int);
 void genBody(int, int);
 void genVTable();
-int getFieldOffset(int, char *);
+void genTypeIdLoad();
+void genFieldLoad(FieldSlot);
+void genFieldStore(FieldSlot);
+void genPrefetches(ASTree *, int, int);
+void genHeapImage();
+void genProfileData();
+void genProfileWrite();
+void genCounter(const char *, long long);
+void genMethods();
+void genCallJump(ASTree *);
+void genIntrinsicCall(ASTree *, int, int);
+void genSpawn(ASTree *, int, int);
+void genTaskEntries();
+void genImageWord(ImageWord);
+void genCompressedHeapStart();
+void genAllocation(int);
+void genAllocSlowPaths();
+void genHeapData();
+void genHeapHelpers();
+void genCollector();
+void genHeapDumpData();
+void genHeapDumper();
+void genAllocCounter(int, int);
+void genAllocStatsData();
+void genAllocReport();
+void genPeakUpdate();
+void genGCTables();
+void pushPending(int);
+void popPending(int);
+int isReference(ASTree *, int, int);
+void recordSafepoint(const char *, int);
 
 /* --- HELPER FUNCTIONS FOR ASM GENERATION --- */
 
 void genLibLessHelpers() {
-  // _exit_program (Unchanged)
+  // _exit_program writes out buffered output first, whatever the exit.
+  // With worker threads, it takes the output from any thread printing,
+  // and ends them all. io_uring may run requests on threads of the
+  // process too, so with it the program also exits with exit_group,
+  // whose code is the process's whatever threads remain.
   fprintf(fout, "\n_exit_program:\n");
-  fprintf(fout, "    mov rax, 60\n");
+  if (usesPrintNat()) {
+    if (parallel)
+      fprintf(fout, "    call _djrt_io_lock\n");
+    fprintf(fout, "    call _flush_output\n");
+    fprintf(fout, "    call _output_wait\n");
+  }
+  if (profileOutputFile() != NULL)
+    genProfileWrite();
+  if (heapDumpFile != NULL)
+    fprintf(fout, "    call _heap_dump\n");
+  if (allocStats)
+    fprintf(fout, "    call _alloc_report\n");
+  fprintf(fout, "    mov rax, %d\n",
+          parallel || ioUring ? SYS_EXIT_GROUP : 60);
   fprintf(fout, "    syscall\n");
 
-  // _print_int (FIXED)
-  fprintf(fout, "\n_print_int:\n");
-  fprintf(fout, "    push rbp\n");
-  fprintf(fout, "    mov rbp, rsp\n");
-  fprintf(fout, "    push rbx\n");
-  fprintf(fout, "    push rcx\n");
-  fprintf(fout, "    push rdx\n");
-  fprintf(fout, "    push rsi\n");
-  fprintf(fout, "    push rdi\n");
-  fprintf(fout, "    mov rcx, 0\n");
-  fprintf(fout, "    mov rbx, 10\n");
-  fprintf(fout, "    cmp rax, 0\n");
-  fprintf(fout, "    jne .convert_loop\n");
-  fprintf(fout, "    dec rsp\n");
-  fprintf(fout, "    mov byte [rsp], '0'\n");
-  fprintf(fout, "    inc rcx\n");
-  fprintf(fout, "    jmp .print_digits\n");
-  fprintf(fout, ".convert_loop:\n");
-  fprintf(fout, "    cmp rax, 0\n");
-  fprintf(fout, "    je .print_digits\n");
-  fprintf(fout, "    xor rdx, rdx\n");
-  fprintf(fout, "    div rbx\n");
-  fprintf(fout, "    add rdx, '0'\n");
-  fprintf(fout, "    dec rsp\n");
-  fprintf(fout, "    mov [rsp], dl\n");
-  fprintf(fout, "    inc rcx\n");
-  fprintf(fout, "    jmp .convert_loop\n");
-  fprintf(fout, ".print_digits:\n");
-  fprintf(fout, "    mov rax, 1\n");
-  fprintf(fout, "    mov rdi, 1\n");
-  fprintf(fout, "    mov rsi, rsp\n");
-  fprintf(fout, "    mov rdx, rcx\n"); // Move count to RDX
-  fprintf(fout, "    syscall\n");      // RCX is clobbered here!
+  genHeapHelpers();
+}
 
-  // *** FIX IS HERE: Use RDX instead of RCX ***
-  fprintf(fout, "    add rsp, rdx\n");
+/* Returns nonzero iff the program uses an intrinsic class, whose
+   methods are routines of the runtime library */
+static int usesIntrinsics() {
+  for (int i = 1; i < numClasses; i++)
+    if (isIntrinsicClass(i))
+      return 1;
+  return 0;
+}
 
-  fprintf(fout, "    dec rsp\n");
-  fprintf(fout, "    mov byte [rsp], 10\n");
-  fprintf(fout, "    mov rax, 1\n");
-  fprintf(fout, "    mov rdi, 1\n");
-  fprintf(fout, "    mov rsi, rsp\n");
-  fprintf(fout, "    mov rdx, 1\n");
-  fprintf(fout, "    syscall\n");
-  fprintf(fout, "    inc rsp\n");
-  fprintf(fout, "    pop rdi\n");
-  fprintf(fout, "    pop rsi\n");
-  fprintf(fout, "    pop rdx\n");
-  fprintf(fout, "    pop rcx\n");
-  fprintf(fout, "    pop rbx\n");
-  fprintf(fout, "    pop rbp\n");
-  fprintf(fout, "    ret\n");
+/* Returns nonzero iff t has a spawn expression in it */
+static int hasSpawn(ASTree *t) {
+  if (t == NULL)
+    return 0;
+  if (t->typ == SPAWN_EXPR)
+    return 1;
+  for (ASTList *child = t->children; child != NULL; child = child->next)
+    if (hasSpawn(child->data))
+      return 1;
+  return 0;
+}
 
-  // _read_int (Unchanged)
-  fprintf(fout, "\n_read_int:\n");
-  fprintf(fout, "    push rbp\n");
-  fprintf(fout, "    mov rbp, rsp\n");
-  fprintf(fout, "    push rbx\n");
-  fprintf(fout, "    push rcx\n");
-  fprintf(fout, "    push rdx\n");
-  fprintf(fout, "    push rsi\n");
-  fprintf(fout, "    push rdi\n");
-  fprintf(fout, "    mov rax, 0\n");
-  fprintf(fout, "    mov rdi, 0\n");
-  fprintf(fout, "    lea rsi, [rel input_buffer]\n");
-  fprintf(fout, "    mov rdx, 20\n");
-  fprintf(fout, "    syscall\n");
-  fprintf(fout, "    xor rax, rax\n");
-  fprintf(fout, "    lea rsi, [rel input_buffer]\n");
-  fprintf(fout, "    xor rbx, rbx\n");
-  fprintf(fout, ".parse_loop:\n");
-  fprintf(fout, "    mov bl, [rsi]\n");
-  fprintf(fout, "    cmp bl, 10\n");
-  fprintf(fout, "    je .parse_done\n");
-  fprintf(fout, "    cmp bl, '0'\n");
-  fprintf(fout, "    jl .parse_done\n");
-  fprintf(fout, "    cmp bl, '9'\n");
-  fprintf(fout, "    jg .parse_done\n");
-  fprintf(fout, "    sub bl, '0'\n");
-  fprintf(fout, "    imul rax, 10\n");
-  fprintf(fout, "    add rax, rbx\n");
-  fprintf(fout, "    inc rsi\n");
-  fprintf(fout, "    jmp .parse_loop\n");
-  fprintf(fout, ".parse_done:\n");
-  fprintf(fout, "    pop rdi\n");
-  fprintf(fout, "    pop rsi\n");
-  fprintf(fout, "    pop rdx\n");
-  fprintf(fout, "    pop rcx\n");
-  fprintf(fout, "    pop rbx\n");
-  fprintf(fout, "    pop rbp\n");
-  fprintf(fout, "    ret\n");
+/* Returns nonzero iff the main block or a method spawns a task */
+static int usesSpawn() {
+  if (hasSpawn(mainExprs))
+    return 1;
+  for (int i = 1; i < numClasses; i++)
+    for (int j = 0; j < classesST[i].numMethods; j++)
+      if (hasSpawn(classesST[i].methodList[j].bodyExprs))
+        return 1;
+  for (int i = 0; i < numMethodClones; i++)
+    if (hasSpawn(methodClones[i].bodyExprs))
+      return 1;
+  return 0;
 }
 
+/* Makes output flushes and input refills go through io_uring. */
+void useIoUring() { ioUring = 1; }
+
 /* Main Entry Point for Code Generation */
 void generateNASM(FILE *outputFile) {
   fout = outputFile;
 
+  // Spawned tasks run on worker threads, unless the program counts or
+  // walks its heap or profiles itself, none of which another thread may
+  // do meanwhile; they then run at once, as plain calls
+  parallel = usesSpawn() && !collectGarbage && heapDumpFile == NULL &&
+             !allocStats && profileOutputFile() == NULL;
+  if (usesSpawn() && !parallel) {
+    const char *flag = "--profile-generate";
+    if (collectGarbage)
+      flag = "--gc";
+    else if (heapDumpFile != NULL)
+      flag = "--heap-dump";
+    else if (allocStats)
+      flag = "--alloc-stats";
+    printf("Warning: spawned tasks run one at a time, as plain calls, "
+           "with %s\n",
+           flag);
+  }
+
   fprintf(fout, "section .bss\n");
-  fprintf(fout, "    heap_memory resq 65536\n");
-  fprintf(fout, "    input_buffer resb 21\n");
+  fprintf(fout, "    heap_end resq 1\n"); // end of the heap's reservation
+  if (heapDumpFile != NULL)
+    fprintf(fout, "    stack_top resq 1\n"); // the main block's RBP
+  genHeapData();
+  genHeapImage();
+  if (profileOutputFile() != NULL)
+    genProfileData();
+  if (heapDumpFile != NULL)
+    genHeapDumpData();
+  // Refers to the version of the runtime library the program calls into
+  int usesRuntime =
+      usesPrintNat() || usesReadNat() || usesIntrinsics() || usesSpawn();
+  if (usesRuntime) {
+    fprintf(fout, "\nsection .data\n");
+    fprintf(fout, "    djrt_abi dq %s\n", DJRT_ABI_SYMBOL);
+  }
 
   fprintf(fout, "\nsection .text\n");
   fprintf(fout, "    global _start\n");
+  if (usesRuntime)
+    fprintf(fout, "    extern %s\n", DJRT_ABI_SYMBOL);
+  if (usesPrintNat() || usesReadNat())
+    fprintf(fout, "    extern _djrt_init\n");
+  if (usesPrintNat()) {
+    fprintf(fout, "    extern _print_int\n");
+    fprintf(fout, "    extern _flush_output\n");
+    fprintf(fout, "    extern _output_wait\n");
+  }
+  if (usesReadNat())
+    fprintf(fout, "    extern _read_int\n");
+  if (parallel) {
+    fprintf(fout, "    extern _djrt_sched_init\n");
+    fprintf(fout, "    extern _djrt_spawn\n");
+    fprintf(fout, "    extern _djrt_join\n");
+    if (usesPrintNat() || usesReadNat()) {
+      fprintf(fout, "    extern _djrt_io_lock\n");
+      fprintf(fout, "    extern _djrt_io_unlock\n");
+    }
+  } else if (usesSpawn()) {
+    fprintf(fout, "    extern _djrt_spawn_inline\n");
+    fprintf(fout, "    extern _djrt_join_inline\n");
+  }
+  for (int i = 1; i < numClasses; i++)
+    for (int j = 0; j < classesST[i].numMethods && isIntrinsicClass(i); j++)
+      fprintf(fout, "    extern %s\n", intrinsicRoutine(i, j));
 
   genLibLessHelpers();
 
   fprintf(fout, "\n_start:\n");
   fprintf(fout, "    mov rbp, rsp\n");
 
-  // R15 will act as our Heap Pointer
-  fprintf(fout, "    lea r15, [rel heap_memory]\n");
+  // R15 will act as our Heap Pointer, and R13 holds the end of the part
+  // of the heap committed so far
+  fprintf(fout, "    call _heap_init\n");
+  if (referencesCompressed())
+    genCompressedHeapStart();
+
+  // The runtime library sets up its buffers (and maybe io_uring)
+  if (usesPrintNat() || usesReadNat()) {
+    int flags = 0;
+    if (usesPrintNat())
+      flags |= DJRT_INIT_OUTPUT;
+    if (usesReadNat())
+      flags |= DJRT_INIT_INPUT;
+    if (ioUring)
+      flags |= DJRT_INIT_IO_URING;
+    fprintf(fout, "    mov rdi, %d\n", flags);
+    fprintf(fout, "    mov rsi, rbp\n"); // the initial stack pointer
+    fprintf(fout, "    call _djrt_init\n");
+  }
+
+  // The scheduler starts the worker threads, which claim heap blocks
+  // past what the main block has committed; R12 holds the main block's
+  // worker
+  if (parallel) {
+    fprintf(fout, "    mov [rel heap_next], r13\n");
+    fprintf(fout, "    mov rdi, rbp\n"); // the initial stack pointer
+    fprintf(fout, "    call _djrt_sched_init\n");
+    fprintf(fout, "    mov r12, rax\n");
+  }
+
+  // SIGUSR1 makes the program write a heap dump
+  if (heapDumpFile != NULL) {
+    fprintf(fout, "    mov [rel stack_top], rbp\n");
+    fprintf(fout, "    mov rax, %d\n", SYS_RT_SIGACTION);
+    fprintf(fout, "    mov rdi, %d\n", SIGUSR1);
+    fprintf(fout, "    lea rsi, [rel dump_sigaction]\n");
+    fprintf(fout, "    xor edx, edx\n");
+    fprintf(fout, "    mov r10, 8\n"); // the size of a signal set
+    fprintf(fout, "    syscall\n");
+  }
 
-  // Initialize Main Block Locals (push 0s onto stack)
+  // Initialize Main Block Locals (push 0s, or the values pre-evaluation
+  // left them with, onto stack)
   for (int i = 0; i < numMainBlockLocals; i++) {
     decSP();
-    fprintf(fout, "    mov qword [rsp], 0\n");
+    if (mainLocalsImage == NULL)
+      fprintf(fout, "    mov qword [rsp], 0\n");
+    else
+      genImageWord(mainLocalsImage[i]);
   }
 
   // Generate code for main block expressions
@@ -161,21 +370,19 @@ void generateNASM(FILE *outputFile) {
   fprintf(fout, "    mov rdi, 0\n");
   fprintf(fout, "    call _exit_program\n");
 
-  // Generate Code for All Methods
-  ClassDecl *class;
-  for (int i = 1; i < numClasses; i++) {
-    class = &classesST[i];
-    for (int j = 0; j < class->numMethods; j++) {
-      fprintf(fout, "class%dmethod%d: ; %s.%s\n", i, j, class->className,
-              class->methodList[j].methodName);
-      genPrologue(i, j);
-      genBody(i, j);
-      genEpilogue(i, j);
-    }
-  }
+  // Generate Code for All Methods and Method Clones
+  genMethods();
 
   // Generate VTable (Dispatcher)
   genVTable();
+
+  genAllocSlowPaths();
+  genTaskEntries();
+
+  if (collectGarbage)
+    genGCTables();
+  if (allocStats)
+    genAllocStatsData();
 }
 
 void internalCGerror(const char *fmt, ...) {
@@ -205,11 +412,65 @@ void checkNullDereference() {
   labelNumber++;
 }
 
+/* Records that the code generated next runs with one more word on the
+   operand stack, a reference iff isRef */
+void pushPending(int isRef) {
+  if (numPending == pendingCapacity) {
+    pendingCapacity = pendingCapacity ? 2 * pendingCapacity : 16;
+    pendingRefs = (char *)realloc(pendingRefs, pendingCapacity);
+  }
+  pendingRefs[numPending++] = isRef != 0;
+}
+
+/* Records that the code generated next no longer has the last n words
+   pushPending recorded on the operand stack */
+void popPending(int n) { numPending -= n; }
+
+/* Returns nonzero iff the collector must treat the value of t as a
+   reference */
+int isReference(ASTree *t, int classNumber, int methodNumber) {
+  return collectGarbage && typeExpr(t, classNumber, methodNumber) >= 0;
+}
+
+/* Records a safepoint for the code being generated, found by the return
+   address ..@<labelKind>_<label>: the frame slots holding references
+   are the reference-typed locals, `this` and a reference-typed parameter
+   in methods, and the pending operand-stack words holding references */
+void recordSafepoint(const char *labelKind, int label) {
+  MethodDecl *method = NULL;
+  int numLocals = numMainBlockLocals;
+  VarDecl *locals = mainBlockST;
+  if (frameClass > 0) {
+    method = &classesST[frameClass].methodList[frameMethod];
+    numLocals = method->numLocals;
+    locals = method->localST;
+  }
+  int *slots = (int *)malloc(sizeof(int) * (numLocals + numPending + 2));
+  int numSlots = 0;
+  if (method != NULL) {
+    slots[numSlots++] = 4 * WORD_SIZE; // this, at [rbp + 32]
+    if (method->paramType >= 0)
+      slots[numSlots++] = WORD_SIZE; // the parameter, at [rbp + 8]
+  }
+  for (int i = 0; i < numLocals; i++)
+    if (locals[i].type >= 0)
+      slots[numSlots++] = -(i + 1) * WORD_SIZE;
+  for (int i = 0; i < numPending; i++)
+    if (pendingRefs[i])
+      slots[numSlots++] = -(numLocals + i + 1) * WORD_SIZE;
+
+  safepoints = (Safepoint *)realloc(safepoints,
+                                    sizeof(Safepoint) * (numSafepoints + 1));
+  Safepoint point = {labelKind, label, frameClass <= 0, numSlots, slots};
+  safepoints[numSafepoints++] = point;
+}
+
 /* Expression Code Generation */
 void codeGenExpr(ASTree *t, int classNumber, int methodNumber) {
   int endLabel, trueLabel, falseLabel;
-  int exprType, offset, methodReturnAddr;
+  int exprType, methodReturnAddr;
   char *idVal, *fieldName;
+  FieldSlot slot;
 
   if (classNumber == 0 && t->typ != NAT_LITERAL_EXPR)
     internalCGerror("Error in Object class codegen.");
@@ -225,44 +486,13 @@ void codeGenExpr(ASTree *t, int classNumber, int methodNumber) {
     fprintf(fout, "    mov qword [rsp], 0\n");
     break;
 
-  case NEW_EXPR: {
-    int objTyp = classNameToNumber(t->children->data->idVal);
-    int currTyp = objTyp;
-
-    // Allocate space for fields on heap (R15)
-    while (currTyp > 0) {
-      ClassDecl *class = &classesST[currTyp];
-      for (int i = 0; i < class->numVars; i++) {
-        fprintf(fout, "    mov qword [r15], 0\n");
-        fprintf(fout, "    add r15, %d\n", WORD_SIZE);
-      }
-      currTyp = class->superclass;
-    }
-
-    // Store Type ID at start of object (Wait, DJ objects store type ID first?)
-    // Based on DISM logic, it seems fields are allocated, but where is type ID?
-    // Actually, the simplest object model: [TypeID][Field1][Field2]...
-    // Let's alloc the type ID first.
-
-    // **Correction to match logic**: The old code pushed fields then ID.
-    // We will store TypeID at the address, and fields follow.
-    fprintf(fout, "    mov rax, %d\n", objTyp);
-    fprintf(fout, "    mov [r15], rax\n");
+  case NEW_EXPR:
+    genAllocCounter(classNameToNumber(t->children->data->idVal),
+                    t->lineNumber);
+    genAllocation(classNameToNumber(t->children->data->idVal));
     decSP();
-    fprintf(fout, "    mov [rsp], r15\n");         // Push Object Address
-    fprintf(fout, "    add r15, %d\n", WORD_SIZE); // Move heap past Type ID
-
-    // Now advance heap for all fields (init to 0)
-    currTyp = objTyp;
-    while (currTyp > 0) {
-      ClassDecl *class = &classesST[currTyp];
-      for (int i = 0; i < class->numVars; i++) {
-        fprintf(fout, "    mov qword [r15], 0\n");
-        fprintf(fout, "    add r15, %d\n", WORD_SIZE);
-      }
-      currTyp = class->superclass;
-    }
-  } break;
+    fprintf(fout, "    mov [rsp], rax\n"); // Push Object Address
+    break;
 
   case THIS_EXPR:
     // In our stack layout (see Prologue), 'this' is at [rbp + 32]
@@ -272,7 +502,11 @@ void codeGenExpr(ASTree *t, int classNumber, int methodNumber) {
     break;
 
   case READ_EXPR:
+    if (parallel)
+      fprintf(fout, "    call _djrt_io_lock\n");
     fprintf(fout, "    call _read_int\n");
+    if (parallel)
+      fprintf(fout, "    call _djrt_io_unlock\n");
     decSP();
     fprintf(fout, "    mov [rsp], rax\n");
     break;
@@ -280,45 +514,110 @@ void codeGenExpr(ASTree *t, int classNumber, int methodNumber) {
   case PRINT_EXPR:
     codeGenExpr(t->children->data, classNumber, methodNumber);
     fprintf(fout, "    mov rax, [rsp]\n");
+    if (parallel)
+      fprintf(fout, "    call _djrt_io_lock\n");
     fprintf(fout, "    call _print_int\n");
+    if (parallel)
+      fprintf(fout, "    call _djrt_io_unlock\n");
+    break;
+
+  case SPAWN_EXPR:
+    // Without worker threads, the call runs at once, and its handle is
+    // that of a task done already, with its result
+    if (parallel) {
+      genSpawn(t->children->data, classNumber, methodNumber);
+    } else {
+      codeGenExpr(t->children->data, classNumber, methodNumber);
+      fprintf(fout, "    mov rdi, [rsp]\n"); // the result
+      fprintf(fout, "    call _djrt_spawn_inline\n");
+      fprintf(fout, "    mov [rsp], rax\n");
+    }
+    break;
+
+  case JOIN_EXPR:
+    // RDX is nonzero when the nat is no handle of a task not yet joined
+    codeGenExpr(t->children->data, classNumber, methodNumber);
+    fprintf(fout, "    mov rdi, [rsp]\n"); // the handle
+    fprintf(fout, "    call %s\n",
+            parallel ? "_djrt_join" : "_djrt_join_inline");
+    fprintf(fout, "    mov [rsp], rax\n");
+    fprintf(fout, "    test rdx, rdx\n");
+    fprintf(fout, "    jz .L_join_ok_%d\n", labelNumber);
+    fprintf(fout, "    mov rdi, 1\n");
+    fprintf(fout, "    call _exit_program\n");
+    fprintf(fout, ".L_join_ok_%d:\n", labelNumber);
+    labelNumber++;
     break;
 
   case WHILE_EXPR: {
     int whileLabel = labelNumber++;
+    int bodyLabel = labelNumber++;
     endLabel = labelNumber++;
-    fprintf(fout, ".L%d:\n", whileLabel);
-    codeGenExpr(t->children->data, classNumber, methodNumber);
-    fprintf(fout, "    mov rax, [rsp]\n");
-    fprintf(fout, "    cmp rax, 0\n");
-    fprintf(fout, "    je .L%d\n", endLabel);
+    // A loop the profile shows iterating more often than it exits is
+    // rotated: the test sits after the body and jumps back while true
+    int rotate = branchCount(t, 1) > branchCount(t, 0);
+    if (rotate)
+      fprintf(fout, "    jmp .L%d\n", whileLabel);
+    else
+      fprintf(fout, ".L%d:\n", whileLabel);
+    if (!rotate) {
+      codeGenExpr(t->children->data, classNumber, methodNumber);
+      fprintf(fout, "    mov rax, [rsp]\n");
+      fprintf(fout, "    cmp rax, 0\n");
+      fprintf(fout, "    je .L%d\n", endLabel);
+    }
+    fprintf(fout, ".L%d:\n", bodyLabel);
     incSP(); // Pop condition
+    genCounter("prof_branches", 2 * (t->profileSite - 1));
+    genPrefetches(t->children->next->data, classNumber, methodNumber);
     codeGenExprs(t->children->next->data, classNumber, methodNumber);
-    fprintf(fout, "    jmp .L%d\n", whileLabel);
+    incSP(); // Pop body result, so iterations don't grow the stack
+    if (rotate) {
+      fprintf(fout, ".L%d:\n", whileLabel);
+      codeGenExpr(t->children->data, classNumber, methodNumber);
+      fprintf(fout, "    mov rax, [rsp]\n");
+      fprintf(fout, "    cmp rax, 0\n");
+      fprintf(fout, "    jne .L%d\n", bodyLabel);
+    } else {
+      fprintf(fout, "    jmp .L%d\n", whileLabel);
+    }
     fprintf(fout, ".L%d:\n", endLabel);
     incSP(); // Pop condition
+    genCounter("prof_branches", 2 * (t->profileSite - 1) + 1);
     decSP(); // Loop result 0
     fprintf(fout, "    mov qword [rsp], 0\n");
   } break;
 
-  case IF_THEN_ELSE_EXPR:
+  case IF_THEN_ELSE_EXPR: {
     codeGenExpr(t->children->data, classNumber, methodNumber);
     falseLabel = labelNumber++;
     endLabel = labelNumber++;
+    // Lay out the branch the profile shows more often first, so it falls
+    // through
+    int elseFirst = branchCount(t, 0) > branchCount(t, 1);
     fprintf(fout, "    mov rax, [rsp]\n");
     fprintf(fout, "    cmp rax, 0\n");
-    fprintf(fout, "    je .L%d\n", falseLabel);
-    incSP(); // Pop condition
-    codeGenExprs(t->children->next->data, classNumber, methodNumber);
-    fprintf(fout, "    jmp .L%d\n", endLabel);
-    fprintf(fout, ".L%d:\n", falseLabel);
-    incSP(); // Pop condition
-    codeGenExprs(t->children->next->next->data, classNumber, methodNumber);
+    fprintf(fout, "    %s .L%d\n", elseFirst ? "jne" : "je", falseLabel);
+    for (int branch = 0; branch < 2; branch++) {
+      int isThen = elseFirst ? branch == 1 : branch == 0;
+      if (branch == 1)
+        fprintf(fout, ".L%d:\n", falseLabel);
+      incSP(); // Pop condition
+      genCounter("prof_branches", 2 * (t->profileSite - 1) + !isThen);
+      codeGenExprs(isThen ? t->children->next->data
+                          : t->children->next->next->data,
+                   classNumber, methodNumber);
+      if (branch == 0)
+        fprintf(fout, "    jmp .L%d\n", endLabel);
+    }
     fprintf(fout, ".L%d:\n", endLabel);
-    break;
+  } break;
 
   case PLUS_EXPR:
     codeGenExpr(t->children->data, classNumber, methodNumber);
+    pushPending(isReference(t->children->data, classNumber, methodNumber));
     codeGenExpr(t->children->next->data, classNumber, methodNumber);
+    popPending(1);
     fprintf(fout, "    mov rax, [rsp + %d]\n", WORD_SIZE);
     fprintf(fout, "    mov rbx, [rsp]\n");
     fprintf(fout, "    add rax, rbx\n");
@@ -328,7 +627,9 @@ void codeGenExpr(ASTree *t, int classNumber, int methodNumber) {
 
   case MINUS_EXPR:
     codeGenExpr(t->children->data, classNumber, methodNumber);
+    pushPending(isReference(t->children->data, classNumber, methodNumber));
     codeGenExpr(t->children->next->data, classNumber, methodNumber);
+    popPending(1);
     fprintf(fout, "    mov rax, [rsp + %d]\n", WORD_SIZE);
     fprintf(fout, "    mov rbx, [rsp]\n");
     fprintf(fout, "    sub rax, rbx\n");
@@ -338,7 +639,9 @@ void codeGenExpr(ASTree *t, int classNumber, int methodNumber) {
 
   case TIMES_EXPR:
     codeGenExpr(t->children->data, classNumber, methodNumber);
+    pushPending(isReference(t->children->data, classNumber, methodNumber));
     codeGenExpr(t->children->next->data, classNumber, methodNumber);
+    popPending(1);
     fprintf(fout, "    mov rax, [rsp + %d]\n", WORD_SIZE);
     fprintf(fout, "    mov rbx, [rsp]\n");
     fprintf(fout, "    imul rax, rbx\n");
@@ -348,7 +651,9 @@ void codeGenExpr(ASTree *t, int classNumber, int methodNumber) {
 
   case EQUALITY_EXPR:
     codeGenExpr(t->children->data, classNumber, methodNumber);
+    pushPending(isReference(t->children->data, classNumber, methodNumber));
     codeGenExpr(t->children->next->data, classNumber, methodNumber);
+    popPending(1);
     trueLabel = labelNumber++;
     endLabel = labelNumber++;
     fprintf(fout, "    mov rax, [rsp + %d]\n", WORD_SIZE);
@@ -366,7 +671,9 @@ void codeGenExpr(ASTree *t, int classNumber, int methodNumber) {
 
   case LESS_THAN_EXPR:
     codeGenExpr(t->children->data, classNumber, methodNumber);
+    pushPending(isReference(t->children->data, classNumber, methodNumber));
     codeGenExpr(t->children->next->data, classNumber, methodNumber);
+    popPending(1);
     trueLabel = labelNumber++;
     endLabel = labelNumber++;
     fprintf(fout, "    mov rax, [rsp + %d]\n", WORD_SIZE);
@@ -431,6 +738,7 @@ void codeGenExpr(ASTree *t, int classNumber, int methodNumber) {
     codeGenExpr(t->children->next->data, classNumber, methodNumber);
     idVal = t->children->data->idVal;
     int found = 0;
+    FieldSlot storeSlot = {0, WORD_SIZE, 0}; // locals and the parameter
     if (classNumber > 0) {
       ClassDecl *class = &classesST[classNumber];
       MethodDecl *method = &class->methodList[methodNumber];
@@ -453,11 +761,11 @@ void codeGenExpr(ASTree *t, int classNumber, int methodNumber) {
         }
       }
       if (!found) {
-        offset = getFieldOffset(classNumber, idVal);
+        slot = getFieldSlot(classNumber, idVal);
         // Field: Load 'this' from [rbp + 32], add offset
         fprintf(fout, "    mov rbx, [rbp + 32]\n"); // this
-        fprintf(fout, "    add rbx, %d\n",
-                (offset + 1) * WORD_SIZE); // +1 for TypeID
+        fprintf(fout, "    add rbx, %d\n", slot.offset);
+        storeSlot = slot;
       }
     } else {
       for (int i = 0; i < numMainBlockLocals; i++) {
@@ -468,22 +776,29 @@ void codeGenExpr(ASTree *t, int classNumber, int methodNumber) {
       }
     }
     fprintf(fout, "    mov rax, [rsp]\n");
-    fprintf(fout, "    mov [rbx], rax\n");
+    genFieldStore(storeSlot);
     break;
 
   case DOT_ASSIGN_EXPR:
     codeGenExpr(t->children->next->next->data, classNumber,
-                methodNumber);                                 // Val
+                methodNumber); // Val
+    pushPending(isReference(t->children->next->next->data, classNumber,
+                            methodNumber));
     codeGenExpr(t->children->data, classNumber, methodNumber); // Obj
-    checkNullDereference();
+    popPending(1);
+    if (!t->nonNullObject)
+      checkNullDereference();
     exprType = typeExpr(t->children->data, classNumber, methodNumber);
     fieldName = t->children->next->data->idVal;
-    offset = getFieldOffset(exprType, fieldName);
-
-    fprintf(fout, "    mov rbx, [rsp]\n"); // Obj
-    fprintf(fout, "    add rbx, %d\n", (offset + 1) * WORD_SIZE);
-    fprintf(fout, "    mov rax, [rsp + %d]\n", WORD_SIZE); // Val
-    fprintf(fout, "    mov [rbx], rax\n");
+    slot = getFieldSlot(exprType, fieldName);
+
+    // Stores to fields removed from the layout only keep the null check
+    if (slot.width > 0) {
+      fprintf(fout, "    mov rbx, [rsp]\n"); // Obj
+      fprintf(fout, "    add rbx, %d\n", slot.offset);
+      fprintf(fout, "    mov rax, [rsp + %d]\n", WORD_SIZE); // Val
+      genFieldStore(slot);
+    }
     incSP(); // Pop Obj, leave Val
     break;
 
@@ -508,9 +823,8 @@ void codeGenExpr(ASTree *t, int classNumber, int methodNumber) {
         }
       }
       if (!foundID) {
-        int offset = getFieldOffset(classNumber, idVal);
         fprintf(fout, "    mov rax, [rbp + 32]\n"); // this
-        fprintf(fout, "    mov rax, [rax + %d]\n", (offset + 1) * WORD_SIZE);
+        genFieldLoad(getFieldSlot(classNumber, idVal));
       }
     } else {
       for (int i = 0; i < numMainBlockLocals; i++) {
@@ -524,22 +838,27 @@ void codeGenExpr(ASTree *t, int classNumber, int methodNumber) {
 
   case DOT_ID_EXPR:
     codeGenExpr(t->children->data, classNumber, methodNumber);
-    checkNullDereference();
+    if (!t->nonNullObject)
+      checkNullDereference();
     exprType = typeExpr(t->children->data, classNumber, methodNumber);
     fieldName = t->children->next->data->idVal;
-    offset = getFieldOffset(exprType, fieldName);
     fprintf(fout, "    mov rax, [rsp]\n");
-    fprintf(fout, "    mov rax, [rax + %d]\n", (offset + 1) * WORD_SIZE);
+    genFieldLoad(getFieldSlot(exprType, fieldName));
     fprintf(fout, "    mov [rsp], rax\n");
     break;
 
   case METHOD_CALL_EXPR:
   case DOT_METHOD_CALL_EXPR:
+    if (isIntrinsicClass(t->staticClassNum)) {
+      genIntrinsicCall(t, classNumber, methodNumber);
+      break;
+    }
     methodReturnAddr = labelNumber++;
     // 1. Push Return Address Label
     decSP();
     fprintf(fout, "    mov rax, .L_ret_%d\n", methodReturnAddr);
     fprintf(fout, "    mov [rsp], rax\n");
+    pushPending(0);
 
     // 2. Push 'this'
     if (t->typ == METHOD_CALL_EXPR) {
@@ -549,8 +868,10 @@ void codeGenExpr(ASTree *t, int classNumber, int methodNumber) {
       fprintf(fout, "    mov [rsp], rax\n");
     } else {
       codeGenExpr(t->children->data, classNumber, methodNumber);
-      checkNullDereference();
+      if (!t->nonNullObject)
+        checkNullDereference();
     }
+    pushPending(1);
 
     // 3. Static Class
     decSP();
@@ -564,10 +885,17 @@ void codeGenExpr(ASTree *t, int classNumber, int methodNumber) {
     ASTree *argExpr = (t->typ == METHOD_CALL_EXPR)
                           ? t->children->next->data
                           : t->children->next->next->data;
+    pushPending(0);
+    pushPending(0);
     codeGenExpr(argExpr, classNumber, methodNumber);
+    popPending(4);
 
-    fprintf(fout, "    jmp _VTable_Dispatch\n");
+    genCallJump(t);
     fprintf(fout, ".L_ret_%d:\n", methodReturnAddr);
+    if (collectGarbage) {
+      fprintf(fout, "..@ret_%d:\n", methodReturnAddr);
+      recordSafepoint("ret", methodReturnAddr);
+    }
     break;
 
   default:
@@ -587,6 +915,9 @@ void codeGenExprs(ASTree *exprList, int classNumber, int methodNumber) {
 }
 
 void genPrologue(int classNumber, int methodNumber) {
+  frameClass = classNumber;
+  frameMethod = methodNumber;
+
   // x86 Prologue
   fprintf(fout, "    push rbp\n");
   fprintf(fout, "    mov rbp, rsp\n");
@@ -678,70 +1009,1526 @@ void addDynamicMethodInfo(int staticClass, int staticMethod, int dynamicType,
 
   // Check Dynamic Type (Load 'this' -> Load TypeID)
   fprintf(fout, "    mov rax, [rsp + 24]\n"); // Load 'this' ptr
-  fprintf(fout, "    mov rax, [rax]\n");      // Load TypeID from [this]
+  genTypeIdLoad();                              // Load TypeID from [this]
   fprintf(fout, "    cmp rax, %d\n", dynamicType);
   fprintf(fout, "    jne .L%d\n", nextRowLabel);
 
-  // Dispatch
-  fprintf(fout, "    jmp class%dmethod%d\n", dynamicClassToCall,
-          dynamicMethodToCall);
+  // Dispatch, preferring a clone customized for this receiver type
+  MethodClone *clone =
+      findCustomizedClone(dynamicClassToCall, dynamicMethodToCall, dynamicType);
+  if (clone != NULL)
+    fprintf(fout, "    jmp %s\n", clone->label);
+  else
+    fprintf(fout, "    jmp class%dmethod%d\n", dynamicClassToCall,
+            dynamicMethodToCall);
 
   fprintf(fout, ".L%d:\n", nextRowLabel);
 }
 
+/* Encapsulate a method body to emit: method number methodNum of class
+   classNum, or, when cloneNum is not -1, the clone methodClones[cloneNum] */
+typedef struct codeunit {
+  int classNum, methodNum, cloneNum;
+  long long entries; // profiled entry count
+} CodeUnit;
+
+/* Orders code units by decreasing entry count, then in program order */
+static int compareCodeUnits(const void *a, const void *b) {
+  const CodeUnit *u1 = (const CodeUnit *)a;
+  const CodeUnit *u2 = (const CodeUnit *)b;
+  if (u1->entries != u2->entries)
+    return u1->entries < u2->entries ? 1 : -1;
+  if (u1->cloneNum != u2->cloneNum)
+    return u1->cloneNum - u2->cloneNum;
+  if (u1->classNum != u2->classNum)
+    return u1->classNum - u2->classNum;
+  return u1->methodNum - u2->methodNum;
+}
+
+/* Generates the code of every live method and method clone; with a
+   profile, the most frequently entered come first, so hot code shares
+   cache lines and pages */
+void genMethods() {
+  int numUnits = numMethodClones;
+  for (int i = 1; i < numClasses; i++)
+    numUnits += classesST[i].numMethods;
+  CodeUnit *units = (CodeUnit *)malloc(sizeof(CodeUnit) * (numUnits + 1));
+
+  numUnits = 0;
+  for (int i = 1; i < numClasses; i++) {
+    for (int j = 0; j < classesST[i].numMethods; j++) {
+      if (!isMethodLive(i, j) || isIntrinsicClass(i))
+        continue;
+      CodeUnit unit = {i, j, -1, methodEntryCount(i, j)};
+      units[numUnits++] = unit;
+    }
+  }
+  for (int i = 0; i < numMethodClones; i++) {
+    if (!isCloneLive(i))
+      continue;
+    MethodClone *clone = &methodClones[i];
+    CodeUnit unit = {clone->classNum, clone->methodNum, i,
+                     methodEntryCount(clone->classNum, clone->methodNum)};
+    units[numUnits++] = unit;
+  }
+  if (haveProfile())
+    qsort(units, numUnits, sizeof(CodeUnit), compareCodeUnits);
+
+  for (int i = 0; i < numUnits; i++) {
+    int c = units[i].classNum, m = units[i].methodNum;
+    ClassDecl *class = &classesST[c];
+    if (units[i].cloneNum < 0) {
+      fprintf(fout, "class%dmethod%d: ; %s.%s\n", c, m, class->className,
+              class->methodList[m].methodName);
+      genPrologue(c, m);
+      genCounter("prof_methods", profileMethodIndex(c, m));
+      genPrefetches(class->methodList[m].bodyExprs, c, m);
+      genBody(c, m);
+    } else {
+      MethodClone *clone = &methodClones[units[i].cloneNum];
+      fprintf(fout, "%s: ; %s.%s\n", clone->label, class->className,
+              class->methodList[m].methodName);
+      genPrologue(c, m);
+      genCounter("prof_methods", profileMethodIndex(c, m));
+      genPrefetches(clone->bodyExprs, c, m);
+      codeGenExprs(clone->bodyExprs, c, m);
+    }
+    genEpilogue(c, m);
+  }
+  free(units);
+}
+
+/* Emits a call of a method of an intrinsic class, which goes straight
+   to its runtime routine: the receiver and the argument are evaluated
+   and checked as for any call, and the routine gets the address of the
+   receiver's state field and the argument, and leaves the result in
+   place of the receiver. Only a DOT_METHOD_CALL_EXPR can get here, as
+   intrinsic classes have no DJ code to call a method on `this` in. */
+void genIntrinsicCall(ASTree *call, int classNumber, int methodNumber) {
+  codeGenExpr(call->children->data, classNumber, methodNumber);
+  if (!call->nonNullObject)
+    checkNullDereference();
+  pushPending(1);
+  codeGenExpr(call->children->next->next->data, classNumber, methodNumber);
+  popPending(1);
+
+  FieldSlot slot = getFieldSlot(call->staticClassNum, INTRINSIC_STATE_FIELD);
+  fprintf(fout, "    mov rsi, [rsp]\n"); // Arg
+  incSP();
+  fprintf(fout, "    mov rdi, [rsp]\n"); // Obj
+  fprintf(fout, "    add rdi, %d\n", slot.offset);
+  fprintf(fout, "    call %s\n",
+          intrinsicRoutine(call->staticClassNum, call->staticMemberNum));
+  fprintf(fout, "    mov [rsp], rax\n");
+}
+
+/* Emits a spawn of the method call `call` on a worker thread: the
+   receiver and the argument are evaluated and checked as for the call,
+   and the runtime library's _djrt_spawn queues a task that makes the
+   call through the entry of the spawn site, leaving its handle in place
+   of the receiver. */
+void genSpawn(ASTree *call, int classNumber, int methodNumber) {
+  ASTree *argExpr;
+  if (call->typ == METHOD_CALL_EXPR) {
+    decSP();
+    fprintf(fout, "    mov rax, [rbp + 32]\n"); // this
+    fprintf(fout, "    mov [rsp], rax\n");
+    argExpr = call->children->next->data;
+  } else {
+    codeGenExpr(call->children->data, classNumber, methodNumber);
+    if (!call->nonNullObject)
+      checkNullDereference();
+    argExpr = call->children->next->next->data;
+  }
+  pushPending(1);
+  codeGenExpr(argExpr, classNumber, methodNumber);
+  popPending(1);
+
+  int label = labelNumber++;
+  fprintf(fout, "    mov rdx, [rsp]\n"); // Arg
+  incSP();
+  fprintf(fout, "    mov rsi, [rsp]\n"); // This
+  fprintf(fout, "    lea rdi, [rel ..@task_%d]\n", label);
+  fprintf(fout, "    call _djrt_spawn\n");
+  fprintf(fout, "    mov [rsp], rax\n"); // the task's handle
+
+  taskSites =
+      (TaskSite *)realloc(taskSites, sizeof(TaskSite) * (numTaskSites + 1));
+  TaskSite site = {call, label};
+  taskSites[numTaskSites++] = site;
+}
+
+/* Emits the entries of the spawn sites' tasks, which the scheduler calls
+   with the receiver in RSI and the argument in RDX. Each makes its
+   site's call, with the arguments pushed as the caller would, and
+   returns the result in RAX. */
+void genTaskEntries() {
+  for (int i = 0; i < numTaskSites; i++) {
+    ASTree *call = taskSites[i].call;
+    int label = taskSites[i].label;
+    fprintf(fout, "..@task_%d:\n", label);
+    fprintf(fout, "    lea rax, [rel ..@task_ret_%d]\n", label);
+    fprintf(fout, "    push rax\n"); // RetAddr
+    fprintf(fout, "    push rsi\n"); // This
+    decSP();
+    fprintf(fout, "    mov qword [rsp], %d\n", call->staticClassNum);
+    decSP();
+    fprintf(fout, "    mov qword [rsp], %d\n", call->staticMemberNum);
+    fprintf(fout, "    push rdx\n"); // Arg
+    genCallJump(call);
+    fprintf(fout, "..@task_ret_%d:\n", label);
+    fprintf(fout, "    pop rax\n");
+    fprintf(fout, "    ret\n");
+  }
+}
+
+/* Returns the label of the body a call reaches for receivers of exact
+   type dynamicType, preferring a clone customized for that type, or NULL
+   if that body never runs */
+static char *dispatchTarget(ASTree *call, int dynamicType) {
+  int targetClass, targetMethod;
+  if (!resolveMethod(dynamicType, call->staticClassNum, call->staticMemberNum,
+                     &targetClass, &targetMethod))
+    return NULL;
+  MethodClone *clone =
+      findCustomizedClone(targetClass, targetMethod, dynamicType);
+  if (clone != NULL)
+    return isCloneLive(clone - methodClones) ? clone->label : NULL;
+  if (!isMethodLive(targetClass, targetMethod))
+    return NULL;
+  return methodLabel(targetClass, targetMethod);
+}
+
+/* Emits the jump into the method a call runs, with the call's arguments
+   on the stack: [Arg] [SMethod] [SClass] [This] [RetAddr]. */
+void genCallJump(ASTree *call) {
+  // Count the receiver type when instrumenting
+  if (profileOutputFile() != NULL && call->profileSite > 0) {
+    fprintf(fout, "    mov rax, [rsp + 24]\n"); // this
+    genTypeIdLoad();                              // its type id
+    fprintf(fout, "    lea rbx, [rel prof_receivers]\n");
+    fprintf(fout, "    inc qword [rbx + rax * 8 + %lld]\n",
+            (long long)(call->profileSite - 1) * numClasses * WORD_SIZE);
+  }
+
+  // Calls the optimizer resolved to a single body skip the dispatcher
+  if (call->callTarget != NULL) {
+    fprintf(fout, "    jmp %s\n", call->callTarget);
+    return;
+  }
+
+  // A receiver type that dominates the profile gets a guarded direct jump
+  int hotType = dominantReceiver(call);
+  char *hotTarget = hotType > 0 ? dispatchTarget(call, hotType) : NULL;
+  if (hotTarget != NULL) {
+    fprintf(fout, "    mov rax, [rsp + 24]\n"); // this
+    fprintf(fout, "    cmp %s [rax], %d\n",
+            getHeaderSize() == WORD_SIZE ? "qword" : "dword", hotType);
+    fprintf(fout, "    je %s\n", hotTarget);
+  }
+  fprintf(fout, "    jmp _VTable_Dispatch\n");
+}
+
 void genVTable() {
   fprintf(fout, "_VTable_Dispatch:\n");
-  int found, methodIndex;
+  int targetClass, targetMethod;
   for (int i = 1; i < numClasses; i++) {
-    ClassDecl *class = &classesST[i];
-    for (int j = 0; j < class->numMethods; j++)
-      addDynamicMethodInfo(i, j, i, i, j);
-    int superclassType = class->superclass;
-    while (superclassType > 0) {
-      ClassDecl *superclass = &classesST[superclassType];
-      for (int j = 0; j < superclass->numMethods; j++) {
-        found = 0;
-        methodIndex = 0;
-        for (int k = 0; k < class->numMethods; k++) {
-          if (strCompare(superclass->methodList[j].methodName,
-                         class->methodList[k].methodName)) {
-            found = 1;
-            methodIndex = k;
-            break;
-          }
-        }
-        if (found)
-          addDynamicMethodInfo(superclassType, j, i, i, methodIndex);
-        else
-          addDynamicMethodInfo(superclassType, j, i, superclassType, j);
-      }
-      superclassType = superclass->superclass;
+    // Calls on objects of intrinsic classes never dispatch
+    if (isIntrinsicClass(i))
+      continue;
+    // One row per method visible in class i, including inherited ones
+    int staticClass = i;
+    while (staticClass > 0) {
+      ClassDecl *class = &classesST[staticClass];
+      for (int j = 0; j < class->numMethods; j++)
+        if (isDispatchRowLive(staticClass, j, i) &&
+            resolveMethod(i, staticClass, j, &targetClass, &targetMethod))
+          addDynamicMethodInfo(staticClass, j, i, targetClass, targetMethod);
+      staticClass = class->superclass;
     }
   }
   fprintf(fout, "    mov rdi, 44\n");
   fprintf(fout, "    call _exit_program\n");
 }
 
-int getFieldOffset(int objType, char *fieldName) {
-  int offset = 0;
-  int found = 0;
-  int padding = 0;
-  ClassDecl *currClass;
-  int classType = objType;
-  while (classType > 0) {
-    currClass = &classesST[classType];
-    for (int i = 0; i < currClass->numVars; i++) {
-      if (found) {
-        padding++;
-      } else if (strCompare(fieldName, currClass->varList[i].varName)) {
-        offset = i;
-        found = 1;
-        break;
-      }
+/* Loads the type id of the object whose address is in RAX into RAX */
+void genTypeIdLoad() {
+  if (getHeaderSize() == WORD_SIZE)
+    fprintf(fout, "    mov rax, [rax]\n");
+  else // writing EAX zeroes the upper half of RAX
+    fprintf(fout, "    mov eax, dword [rax]\n");
+}
+
+/* Loads the field in the given slot of the object whose address is in RAX
+   into RAX, zero-extending narrow slots and decoding compressed
+   references */
+void genFieldLoad(FieldSlot slot) {
+  if (slot.compressed) {
+    fprintf(fout, "    mov eax, dword [rax + %d]\n", slot.offset);
+    fprintf(fout, "    lea rcx, [r14 + rax]\n");
+    fprintf(fout, "    test eax, eax\n"); // 0 stays null
+    fprintf(fout, "    cmovnz rax, rcx\n");
+    return;
+  }
+  switch (slot.width) {
+  case 1:
+    fprintf(fout, "    movzx rax, byte [rax + %d]\n", slot.offset);
+    break;
+  case 2:
+    fprintf(fout, "    movzx rax, word [rax + %d]\n", slot.offset);
+    break;
+  case 4:
+    // Writing EAX zeroes the upper half of RAX
+    fprintf(fout, "    mov eax, dword [rax + %d]\n", slot.offset);
+    break;
+  default:
+    fprintf(fout, "    mov rax, [rax + %d]\n", slot.offset);
+  }
+}
+
+/* Emits the prefetches recorded for the start of anchor: loads each
+   pointer-chasing field and prefetches the object it points to, so the
+   cache miss overlaps with the work before that object is used */
+void genPrefetches(ASTree *anchor, int classNumber, int methodNumber) {
+  for (int i = 0; i < numPrefetchSites; i++) {
+    PrefetchSite *site = &prefetchSites[i];
+    if (site->anchor != anchor)
+      continue;
+    FieldSlot slot = getFieldSlot(site->baseType, site->field);
+    if (slot.width == 0)
+      continue;
+    int skipLabel = labelNumber++;
+    codeGenExpr(site->baseExpr, classNumber, methodNumber);
+    fprintf(fout, "    mov rax, [rsp]\n");
+    incSP();
+    if (site->baseExpr->typ != THIS_EXPR) {
+      fprintf(fout, "    test rax, rax\n");
+      fprintf(fout, "    jz .L%d\n", skipLabel);
+    }
+    genFieldLoad(slot);
+    fprintf(fout, "    prefetcht0 [rax]\n");
+    // Objects larger than a cache line span two lines
+    if (getObjectSize(site->targetType) > 64)
+      fprintf(fout, "    prefetcht0 [rax + 64]\n");
+    fprintf(fout, ".L%d:\n", skipLabel);
+  }
+}
+
+/* Emits an increment of counter number index of the profile array called
+   name, when instrumenting the program for a profile */
+void genCounter(const char *name, long long index) {
+  if (profileOutputFile() == NULL || index < 0)
+    return;
+  fprintf(fout, "    inc qword [rel %s + %lld]\n", name, index * WORD_SIZE);
+}
+
+/* Emits the profile of an instrumented program: a header, then the
+   method-entry, branch, call-site identity, and receiver-type arrays,
+   which _exit_program writes out as they are */
+void genProfileData() {
+  fprintf(fout, "\nsection .data\n");
+  fprintf(fout, "    align 8\n");
+  fprintf(fout, "prof_data:\n");
+  fprintf(fout, "    db \"DJPROF01\"\n");
+  fprintf(fout, "    dq %d, %d, %d, %d\n", numProfileMethods,
+          numProfileBranches, numProfileCalls, numClasses);
+  fprintf(fout, "prof_methods:\n");
+  fprintf(fout, "    times %d dq 0\n", numProfileMethods);
+  fprintf(fout, "prof_branches:\n");
+  fprintf(fout, "    times %d dq 0\n", 2 * numProfileBranches);
+  for (int i = 0; i < numProfileCalls; i++)
+    fprintf(fout, "    dq %lld\n", profileCallIdentity(i));
+  fprintf(fout, "prof_receivers:\n");
+  fprintf(fout, "    times %lld dq 0\n",
+          (long long)numProfileCalls * numClasses);
+  fprintf(fout, "prof_end:\n");
+  fprintf(fout, "prof_file:\n");
+  fprintf(fout, "    db \"%s\", 0\n", profileOutputFile());
+}
+
+/* Emits the part of _exit_program that writes the profile to its file,
+   keeping the exit code in RDI */
+void genProfileWrite() {
+  fprintf(fout, "    push rdi\n");
+  fprintf(fout, "    mov rax, 2\n"); // open
+  fprintf(fout, "    lea rdi, [rel prof_file]\n");
+  fprintf(fout, "    mov rsi, 577\n"); // O_WRONLY | O_CREAT | O_TRUNC
+  fprintf(fout, "    mov rdx, 420\n"); // 0644
+  fprintf(fout, "    syscall\n");
+  fprintf(fout, "    test rax, rax\n");
+  fprintf(fout, "    js .profile_done\n");
+  fprintf(fout, "    push rax\n");
+  fprintf(fout, "    mov rdi, rax\n");
+  fprintf(fout, "    mov rax, 1\n"); // write
+  fprintf(fout, "    lea rsi, [rel prof_data]\n");
+  fprintf(fout, "    mov rdx, prof_end - prof_data\n");
+  fprintf(fout, "    syscall\n");
+  fprintf(fout, "    pop rdi\n");
+  fprintf(fout, "    mov rax, 3\n"); // close
+  fprintf(fout, "    syscall\n");
+  fprintf(fout, ".profile_done:\n");
+  fprintf(fout, "    pop rdi\n");
+}
+
+/* Emits the objects pre-evaluation created as initialized data, so they
+   exist from the start without any code running */
+void genHeapImage() {
+  if (heapImageWords == 0)
+    return;
+  fprintf(fout, "\nsection .data\n");
+  fprintf(fout, "    align 64\n");
+  fprintf(fout, "heap_image:\n");
+  for (int i = 0; i < heapImageWords; i++) {
+    if (heapImage[i].isRef)
+      fprintf(fout, "    dq heap_image + %lld\n", heapImage[i].value);
+    else
+      fprintf(fout, "    dq %lld\n", heapImage[i].value);
+  }
+}
+
+/* Sets up the heap for compressed references: R14 holds the start of the
+   heap, which compressed references are offsets from, the heap image is
+   copied there, and R15 starts after it (or, when collecting garbage,
+   after the chunk it is in, where the first semispace starts). Offset 0
+   stays unused, since it encodes null. */
+void genCompressedHeapStart() {
+  fprintf(fout, "    mov r14, r15\n");
+  int used = heapImageWords > 1 ? heapImageWords : 1;
+  fprintf(fout, "    add r15, %d\n", used * WORD_SIZE);
+  fprintf(fout, "    call _heap_commit\n"); // commit the first chunk
+  if (heapImageWords > 0) {
+    fprintf(fout, "    lea rsi, [rel heap_image]\n");
+    fprintf(fout, "    mov rdi, r14\n");
+    fprintf(fout, "    mov rcx, %d\n", heapImageWords);
+    fprintf(fout, "    rep movsq\n");
+  }
+  if (collectGarbage)
+    fprintf(fout, "    mov r15, r13\n");
+}
+
+/* Sets the heap settings compiled into the program. */
+void configureHeap(long long limit, int populate, int hugePages, int collect) {
+  heapLimit = limit;
+  heapPopulate = populate;
+  heapHugePages = hugePages;
+  collectGarbage = collect;
+}
+
+/* Returns the largest heap limit: with compressed references, offsets
+   from the heap start are 32 bits, and the semispaces start a chunk in */
+static long long maxHeapLimit() {
+  if (!referencesCompressed())
+    return -1;
+  return MAX_COMPRESSED_HEAP - (collectGarbage ? HEAP_CHUNK : 0);
+}
+
+/* Emits the heap settings, which _heap_init may override from the
+   environment, and the names of the environment variables */
+void genHeapData() {
+  long long limit = heapLimit;
+  if (maxHeapLimit() >= 0 && limit > maxHeapLimit())
+    limit = maxHeapLimit();
+  fprintf(fout, "\nsection .data\n");
+  fprintf(fout, "    heap_limit dq %lld\n", limit);
+  fprintf(fout, "    heap_map_flags dq %d\n",
+          MAP_PRIVATE_ANONYMOUS | MAP_FIXED | (heapPopulate ? MAP_POPULATE : 0));
+  fprintf(fout, "    heap_huge_pages dq %d\n", heapHugePages);
+  fprintf(fout, "    env_heap_limit db \"%s=\", 0\n", HEAP_LIMIT_ENV);
+  fprintf(fout, "    env_heap_populate db \"%s=\", 0\n", HEAP_POPULATE_ENV);
+  fprintf(fout, "    env_heap_huge_pages db \"%s=\", 0\n", HEAP_HUGE_PAGES_ENV);
+  // With worker threads, the start of the heap not yet claimed as some
+  // thread's block
+  if (parallel)
+    fprintf(fout, "    heap_next dq 0\n");
+  if (!collectGarbage)
+    return;
+  // The semispaces: the one in use, the other, and their size
+  fprintf(fout, "    gc_space_start dq 0\n");
+  fprintf(fout, "    gc_other_start dq 0\n");
+  fprintf(fout, "    gc_half dq 0\n");
+  fprintf(fout, "    gc_threshold dq %lld\n", GC_MIN_THRESHOLD);
+  // The allocation in progress when a collection runs, its size, its
+  // return address, and the bytes of the space in use committed
+  fprintf(fout, "    gc_pending dq 0\n");
+  fprintf(fout, "    gc_pending_size dq 0\n");
+  fprintf(fout, "    gc_site dq 0\n");
+  fprintf(fout, "    gc_committed dq 0\n");
+}
+
+/* Emits the heap runtime:
+   _heap_init reads the heap settings from the environment, reserves
+   address space for the whole heap without committing any of it, and
+   starts R15 and R13 at its start.
+   _alloc_slow runs when R15 passes R13. It collects garbage when that is
+   on and the space in use has grown past the collection threshold or is
+   full, and has _heap_commit commit the heap up to R15, a chunk at a
+   time, mapping the chunks (prefaulted with MAP_POPULATE, and with a
+   transparent huge page hint, when those are set). With worker threads,
+   each thread bumps through a block of its own: the slow path claims
+   the next whole chunks of the heap from heap_next, with an atomic add,
+   and moves the allocation to their start. Past the limit, it exits
+   with code 45.
+   _env_value and _parse_size are the helpers _heap_init reads the
+   environment with. */
+void genHeapHelpers() {
+  // _heap_init: called first thing, with RBP at argc
+  fprintf(fout, "\n_heap_init:\n");
+  fprintf(fout, "    mov rcx, [rbp]\n");
+  fprintf(fout, "    lea rbx, [rbp + rcx * 8 + 16]\n"); // envp
+  fprintf(fout, ".env_loop:\n");
+  fprintf(fout, "    mov rdi, [rbx]\n");
+  fprintf(fout, "    test rdi, rdi\n");
+  fprintf(fout, "    jz .env_done\n");
+  fprintf(fout, "    lea rsi, [rel env_heap_limit]\n");
+  fprintf(fout, "    call _env_value\n");
+  fprintf(fout, "    test rax, rax\n");
+  fprintf(fout, "    jz .not_limit\n");
+  fprintf(fout, "    call _parse_size\n");
+  fprintf(fout, "    mov [rel heap_limit], rax\n");
+  fprintf(fout, "    jmp .env_next\n");
+  fprintf(fout, ".not_limit:\n");
+  fprintf(fout, "    mov rdi, [rbx]\n");
+  fprintf(fout, "    lea rsi, [rel env_heap_populate]\n");
+  fprintf(fout, "    call _env_value\n");
+  fprintf(fout, "    test rax, rax\n");
+  fprintf(fout, "    jz .not_populate\n");
+  fprintf(fout, "    and qword [rel heap_map_flags], %d\n", ~MAP_POPULATE);
+  fprintf(fout, "    cmp byte [rax], '1'\n");
+  fprintf(fout, "    jne .env_next\n");
+  fprintf(fout, "    or qword [rel heap_map_flags], %d\n", MAP_POPULATE);
+  fprintf(fout, "    jmp .env_next\n");
+  fprintf(fout, ".not_populate:\n");
+  fprintf(fout, "    mov rdi, [rbx]\n");
+  fprintf(fout, "    lea rsi, [rel env_heap_huge_pages]\n");
+  fprintf(fout, "    call _env_value\n");
+  fprintf(fout, "    test rax, rax\n");
+  fprintf(fout, "    jz .env_next\n");
+  fprintf(fout, "    movzx rax, byte [rax]\n");
+  fprintf(fout, "    cmp rax, '1'\n");
+  fprintf(fout, "    sete al\n");
+  fprintf(fout, "    mov [rel heap_huge_pages], rax\n");
+  fprintf(fout, ".env_next:\n");
+  fprintf(fout, "    add rbx, 8\n");
+  fprintf(fout, "    jmp .env_loop\n");
+  fprintf(fout, ".env_done:\n");
+  if (maxHeapLimit() >= 0) {
+    fprintf(fout, "    mov rax, %lld\n", maxHeapLimit());
+    fprintf(fout, "    cmp [rel heap_limit], rax\n");
+    fprintf(fout, "    jbe .limit_ok\n");
+    fprintf(fout, "    mov [rel heap_limit], rax\n");
+    fprintf(fout, ".limit_ok:\n");
+  }
+  if (collectGarbage) {
+    // Each semispace gets half the limit, in whole chunks
+    fprintf(fout, "    mov rax, [rel heap_limit]\n");
+    fprintf(fout, "    shr rax, 1\n");
+    fprintf(fout, "    and rax, %d\n", -HEAP_CHUNK);
+    fprintf(fout, "    mov rcx, %d\n", HEAP_CHUNK);
+    fprintf(fout, "    cmp rax, rcx\n");
+    fprintf(fout, "    cmovb rax, rcx\n");
+    fprintf(fout, "    mov [rel gc_half], rax\n");
+  }
+  // Reserve the limit (or both semispaces and a chunk for the heap image)
+  // plus a chunk, to align the start to a chunk
+  fprintf(fout, "    mov rax, %d\n", SYS_MMAP);
+  fprintf(fout, "    xor edi, edi\n");
+  if (collectGarbage) {
+    fprintf(fout, "    mov rsi, [rel gc_half]\n");
+    fprintf(fout, "    lea rsi, [rsi * 2 + %d]\n", 2 * HEAP_CHUNK);
+  } else {
+    fprintf(fout, "    mov rsi, [rel heap_limit]\n");
+    fprintf(fout, "    add rsi, %d\n", HEAP_CHUNK);
+  }
+  fprintf(fout, "    xor edx, edx\n"); // PROT_NONE
+  fprintf(fout, "    mov r10, %d\n", MAP_PRIVATE_ANONYMOUS | MAP_NORESERVE);
+  fprintf(fout, "    mov r8, -1\n");
+  fprintf(fout, "    xor r9d, r9d\n");
+  fprintf(fout, "    syscall\n");
+  fprintf(fout, "    cmp rax, -4096\n");
+  fprintf(fout, "    ja _heap_exhausted\n");
+  fprintf(fout, "    add rax, %d\n", HEAP_CHUNK - 1);
+  fprintf(fout, "    and rax, %d\n", -HEAP_CHUNK);
+  fprintf(fout, "    mov r15, rax\n");
+  fprintf(fout, "    mov r13, rax\n"); // nothing committed yet
+  if (collectGarbage) {
+    // The first semispace is in use; with compressed references it
+    // starts a chunk in, after the heap image
+    if (referencesCompressed())
+      fprintf(fout, "    add rax, %d\n", HEAP_CHUNK);
+    fprintf(fout, "    mov [rel gc_space_start], rax\n");
+    fprintf(fout, "    add rax, [rel gc_half]\n");
+    fprintf(fout, "    mov [rel gc_other_start], rax\n");
+  } else {
+    fprintf(fout, "    add rax, [rel heap_limit]\n");
+  }
+  fprintf(fout, "    mov [rel heap_end], rax\n");
+  fprintf(fout, "    ret\n");
+
+  // _alloc_slow: R15 is past the committed end in R13
+  fprintf(fout, "\n_alloc_slow:\n");
+  const char *saved[] = {"rax", "rcx", "rdx", "rsi", "rdi", "r8", "r9",
+                         "r10", "r11"};
+  int numSaved = sizeof(saved) / sizeof(saved[0]);
+  for (int i = 0; i < numSaved; i++)
+    fprintf(fout, "    push %s\n", saved[i]);
+  if (allocStats)
+    genPeakUpdate(); // the heap in use only shrinks past here
+  if (collectGarbage) {
+    fprintf(fout, "    mov rax, r13\n");
+    fprintf(fout, "    sub rax, [rel gc_space_start]\n");
+    fprintf(fout, "    cmp rax, [rel gc_threshold]\n");
+    fprintf(fout, "    jae .collect\n");
+  }
+  if (parallel) {
+    fprintf(fout, "    mov rcx, r15\n");
+    fprintf(fout, "    sub rcx, rax\n"); // the bytes the allocation takes
+    fprintf(fout, "    lea rsi, [rcx + %d]\n", HEAP_CHUNK - 1);
+    fprintf(fout, "    and rsi, %d\n", -HEAP_CHUNK);
+    fprintf(fout, "    lock xadd [rel heap_next], rsi\n");
+    fprintf(fout, "    mov [rsp + %d], rsi\n", (numSaved - 1) * WORD_SIZE);
+    fprintf(fout, "    mov r13, rsi\n"); // nothing of the block committed
+    fprintf(fout, "    lea r15, [rsi + rcx]\n");
+  }
+  fprintf(fout, "    call _heap_commit\n");
+  fprintf(fout, "    test rax, rax\n");
+  fprintf(fout, "    jz .done\n");
+  if (collectGarbage) {
+    fprintf(fout, ".collect:\n");
+    fprintf(fout, "    call _gc_collect\n");
+    fprintf(fout, "    cmp r15, r13\n");
+    fprintf(fout, "    jbe .done\n");
+    fprintf(fout, "    call _heap_commit\n");
+    fprintf(fout, "    test rax, rax\n");
+    fprintf(fout, "    jz .done\n");
+  }
+  fprintf(fout, "    jmp _heap_exhausted\n");
+  fprintf(fout, ".done:\n");
+  for (int i = numSaved - 1; i >= 0; i--)
+    fprintf(fout, "    pop %s\n", saved[i]);
+  fprintf(fout, "    ret\n");
+
+  // _heap_commit: commits the heap up to R15, returning 0 in RAX, or
+  // nonzero if that is past the end of the heap (or its space in use)
+  fprintf(fout, "\n_heap_commit:\n");
+  fprintf(fout, "    mov rsi, r15\n");
+  fprintf(fout, "    add rsi, %d\n", HEAP_CHUNK - 1);
+  fprintf(fout, "    and rsi, %d\n", -HEAP_CHUNK);
+  fprintf(fout, "    mov rax, [rel heap_end]\n");
+  fprintf(fout, "    cmp rsi, rax\n");
+  fprintf(fout, "    cmova rsi, rax\n");
+  fprintf(fout, "    cmp r15, rsi\n");
+  fprintf(fout, "    ja .commit_failed\n");
+  fprintf(fout, "    mov rdi, r13\n");
+  fprintf(fout, "    sub rsi, r13\n");
+  fprintf(fout, "    mov rdx, %d\n", PROT_READ_WRITE);
+  fprintf(fout, "    mov r10, [rel heap_map_flags]\n");
+  fprintf(fout, "    mov r8, -1\n");
+  fprintf(fout, "    xor r9d, r9d\n");
+  fprintf(fout, "    mov rax, %d\n", SYS_MMAP);
+  fprintf(fout, "    syscall\n");
+  fprintf(fout, "    cmp rax, -4096\n");
+  fprintf(fout, "    ja .commit_failed\n");
+  fprintf(fout, "    cmp qword [rel heap_huge_pages], 0\n");
+  fprintf(fout, "    je .committed\n");
+  fprintf(fout, "    mov rax, %d\n", SYS_MADVISE); // only a hint
+  fprintf(fout, "    mov rdx, %d\n", MADV_HUGEPAGE);
+  fprintf(fout, "    syscall\n");
+  fprintf(fout, ".committed:\n");
+  fprintf(fout, "    add r13, rsi\n");
+  fprintf(fout, "    xor eax, eax\n");
+  fprintf(fout, "    ret\n");
+  fprintf(fout, ".commit_failed:\n");
+  fprintf(fout, "    mov eax, 1\n");
+  fprintf(fout, "    ret\n");
+
+  fprintf(fout, "\n_heap_exhausted:\n");
+  fprintf(fout, "    mov rdi, 45\n");
+  fprintf(fout, "    call _exit_program\n");
+
+  if (collectGarbage)
+    genCollector();
+  if (heapDumpFile != NULL)
+    genHeapDumper();
+  if (allocStats)
+    genAllocReport();
+
+  // _env_value: returns in RAX the value of the environment string at RDI
+  // if it starts with the name= string at RSI, or else 0
+  fprintf(fout, "\n_env_value:\n");
+  fprintf(fout, "    mov cl, [rsi]\n");
+  fprintf(fout, "    test cl, cl\n");
+  fprintf(fout, "    jz .match\n");
+  fprintf(fout, "    cmp cl, [rdi]\n");
+  fprintf(fout, "    jne .no_match\n");
+  fprintf(fout, "    inc rsi\n");
+  fprintf(fout, "    inc rdi\n");
+  fprintf(fout, "    jmp _env_value\n");
+  fprintf(fout, ".match:\n");
+  fprintf(fout, "    mov rax, rdi\n");
+  fprintf(fout, "    ret\n");
+  fprintf(fout, ".no_match:\n");
+  fprintf(fout, "    xor eax, eax\n");
+  fprintf(fout, "    ret\n");
+
+  // _parse_size: returns in RAX the size in the string at RAX, a decimal
+  // number of bytes with an optional K, M, or G suffix
+  fprintf(fout, "\n_parse_size:\n");
+  fprintf(fout, "    mov rsi, rax\n");
+  fprintf(fout, "    xor eax, eax\n");
+  fprintf(fout, ".digit:\n");
+  fprintf(fout, "    movzx ecx, byte [rsi]\n");
+  fprintf(fout, "    sub ecx, '0'\n");
+  fprintf(fout, "    cmp ecx, 9\n");
+  fprintf(fout, "    ja .suffix\n");
+  fprintf(fout, "    imul rax, rax, 10\n");
+  fprintf(fout, "    add rax, rcx\n");
+  fprintf(fout, "    inc rsi\n");
+  fprintf(fout, "    jmp .digit\n");
+  fprintf(fout, ".suffix:\n");
+  const char *suffixes = "KMG";
+  for (int i = 0; i < 3; i++) {
+    fprintf(fout, "    cmp byte [rsi], '%c'\n", suffixes[i]);
+    fprintf(fout, "    jne .not_%c\n", suffixes[i]);
+    fprintf(fout, "    shl rax, %d\n", 10 * (i + 1));
+    fprintf(fout, ".not_%c:\n", suffixes[i]);
+  }
+  fprintf(fout, "    ret\n");
+}
+
+/* Makes the program write a heap dump to fileName when it exits or gets
+   SIGUSR1. */
+void dumpHeapTo(char *fileName) { heapDumpFile = fileName; }
+
+/* Emits the part of a heap dump code gen knows (see heapdump.h), which
+   _heap_dump writes out first, with the address compressed references
+   are offsets from filled in; the header of the segment being written;
+   the dump's file name; and the SIGUSR1 handler's sigaction */
+void genHeapDumpData() {
+  fprintf(fout, "\nsection .data\n");
+  fprintf(fout, "    align 8\n");
+  fprintf(fout, "dump_data:\n");
+  fprintf(fout, "    db \"%s\"\n", HEAP_DUMP_MAGIC);
+  fprintf(fout, "    dq %d, %d\n", numClasses, referencesCompressed());
+  fprintf(fout, "dump_base:\n");
+  fprintf(fout, "    dq 0\n");
+  for (int i = 0; i < numClasses; i++) {
+    int numRefs = 0;
+    for (int c = i; c > 0; c = classesST[c].superclass)
+      for (int j = 0; j < classesST[c].numVars; j++)
+        if (classesST[c].varList[j].type >= 0 && getFieldWidth(c, j) > 0)
+          numRefs++;
+    fprintf(fout, "    dq %d, %d\n", getObjectSize(i), numRefs);
+    for (int c = i; c > 0; c = classesST[c].superclass)
+      for (int j = 0; j < classesST[c].numVars; j++)
+        if (classesST[c].varList[j].type >= 0 && getFieldWidth(c, j) > 0)
+          fprintf(fout, "    dq %d\n",
+                  getFieldSlot(c, classesST[c].varList[j].varName).offset);
+    int nameLength = strlen(classesST[i].className);
+    fprintf(fout, "    dq %d\n", nameLength);
+    fprintf(fout, "    db \"%s\"\n", classesST[i].className);
+    int padding = (WORD_SIZE - nameLength % WORD_SIZE) % WORD_SIZE;
+    if (padding > 0)
+      fprintf(fout, "    times %d db 0\n", padding);
+  }
+  fprintf(fout, "dump_data_end:\n");
+  fprintf(fout, "dump_segment:\n");
+  fprintf(fout, "    dq 0, 0, 0\n"); // kind, start, length
+  fprintf(fout, "    heap_busy dq 0\n"); // a collection or dump is running
+  fprintf(fout, "    dump_pending dq 0\n"); // a signal asked for one then
+  fprintf(fout, "dump_sigaction:\n");
+  fprintf(fout, "    dq _heap_dump_signal, %d, _heap_dump_restorer, 0\n",
+          SA_RESTORER | SA_RESTART);
+  fprintf(fout, "dump_file:\n");
+  fprintf(fout, "    db \"%s\", 0\n", heapDumpFile);
+}
+
+/* Emits the heap dump runtime:
+   _heap_dump writes the heap dump, keeping every register: the part in
+   dump_data, then the stack, the heap image, and the rest of the heap up
+   to R15 (or R13, if R15 is past it).
+   Objects between the heap start and R15 whose allocation has not
+   stored their type id yet read as gaps.
+   _heap_dump_signal, the SIGUSR1 handler, writes the dump unless a
+   collection (or a dump) is running, which then writes it when done.
+   _dump_segment writes the segment described at dump_segment, and
+   _dump_write the RDX bytes at RSI, to the file RBX holds. */
+void genHeapDumper() {
+  fprintf(fout, "\n_heap_dump_signal:\n");
+  fprintf(fout, "    cmp qword [rel heap_busy], 0\n");
+  fprintf(fout, "    je _heap_dump\n");
+  fprintf(fout, "    mov qword [rel dump_pending], 1\n");
+  fprintf(fout, "    ret\n");
+
+  fprintf(fout, "\n_heap_dump_restorer:\n");
+  fprintf(fout, "    mov rax, %d\n", SYS_RT_SIGRETURN);
+  fprintf(fout, "    syscall\n");
+
+  fprintf(fout, "\n_heap_dump:\n");
+  const char *saved[] = {"rax", "rbx", "rcx", "rdx", "rsi",
+                         "rdi", "r8",  "r9",  "r10", "r11"};
+  int numSaved = sizeof(saved) / sizeof(saved[0]);
+  for (int i = 0; i < numSaved; i++)
+    fprintf(fout, "    push %s\n", saved[i]);
+  fprintf(fout, "    mov qword [rel heap_busy], 1\n");
+  if (referencesCompressed())
+    fprintf(fout, "    mov [rel dump_base], r14\n");
+  fprintf(fout, "    mov rax, 2\n"); // open
+  fprintf(fout, "    lea rdi, [rel dump_file]\n");
+  fprintf(fout, "    mov rsi, 577\n"); // O_WRONLY | O_CREAT | O_TRUNC
+  fprintf(fout, "    mov rdx, 420\n"); // 0644
+  fprintf(fout, "    syscall\n");
+  fprintf(fout, "    test rax, rax\n");
+  fprintf(fout, "    js .done\n");
+  fprintf(fout, "    mov rbx, rax\n");
+  fprintf(fout, "    lea rsi, [rel dump_data]\n");
+  fprintf(fout, "    mov rdx, dump_data_end - dump_data\n");
+  fprintf(fout, "    call _dump_write\n");
+
+  // The stack, from here up to the main block's frame
+  fprintf(fout, "    mov qword [rel dump_segment], %d\n", DUMP_SEGMENT_STACK);
+  fprintf(fout, "    mov [rel dump_segment + 8], rsp\n");
+  fprintf(fout, "    mov rax, [rel stack_top]\n");
+  fprintf(fout, "    sub rax, rsp\n");
+  fprintf(fout, "    mov [rel dump_segment + 16], rax\n");
+  fprintf(fout, "    call _dump_segment\n");
+
+  // The heap image, which may start a heap without semispaces
+  int imageStartsHeap =
+      heapImageWords > 0 && referencesCompressed() && !collectGarbage;
+  if (heapImageWords > 0) {
+    fprintf(fout, "    mov qword [rel dump_segment], %d\n",
+            DUMP_SEGMENT_IMAGE);
+    if (referencesCompressed())
+      fprintf(fout, "    mov [rel dump_segment + 8], r14\n");
+    else {
+      fprintf(fout, "    lea rax, [rel heap_image]\n");
+      fprintf(fout, "    mov [rel dump_segment + 8], rax\n");
     }
-    classType = currClass->superclass;
+    fprintf(fout, "    mov qword [rel dump_segment + 16], %d\n",
+            heapImageWords * WORD_SIZE);
+    fprintf(fout, "    call _dump_segment\n");
+  }
+
+  // The heap (the space in use, with semispaces), past the image, up to
+  // R15
+  fprintf(fout, "    mov qword [rel dump_segment], %d\n", DUMP_SEGMENT_HEAP);
+  if (collectGarbage)
+    fprintf(fout, "    mov rax, [rel gc_space_start]\n");
+  else if (imageStartsHeap)
+    fprintf(fout, "    lea rax, [r14 + %d]\n", heapImageWords * WORD_SIZE);
+  else {
+    fprintf(fout, "    mov rax, [rel heap_end]\n");
+    fprintf(fout, "    sub rax, [rel heap_limit]\n");
+  }
+  fprintf(fout, "    mov [rel dump_segment + 8], rax\n");
+  fprintf(fout, "    mov rcx, r15\n");
+  fprintf(fout, "    cmp rcx, r13\n");
+  fprintf(fout, "    cmova rcx, r13\n");
+  fprintf(fout, "    sub rcx, rax\n");
+  fprintf(fout, "    mov [rel dump_segment + 16], rcx\n");
+  fprintf(fout, "    call _dump_segment\n");
+
+  fprintf(fout, "    mov rdi, rbx\n");
+  fprintf(fout, "    mov rax, 3\n"); // close
+  fprintf(fout, "    syscall\n");
+  fprintf(fout, ".done:\n");
+  fprintf(fout, "    mov qword [rel heap_busy], 0\n");
+  for (int i = numSaved - 1; i >= 0; i--)
+    fprintf(fout, "    pop %s\n", saved[i]);
+  fprintf(fout, "    ret\n");
+
+  fprintf(fout, "\n_dump_segment:\n");
+  fprintf(fout, "    lea rsi, [rel dump_segment]\n");
+  fprintf(fout, "    mov rdx, 24\n");
+  fprintf(fout, "    call _dump_write\n");
+  fprintf(fout, "    mov rsi, [rel dump_segment + 8]\n");
+  fprintf(fout, "    mov rdx, [rel dump_segment + 16]\n");
+  fprintf(fout, "    jmp _dump_write\n");
+
+  // Writes may be partial; an error gives up on the rest
+  fprintf(fout, "\n_dump_write:\n");
+  fprintf(fout, "    test rdx, rdx\n");
+  fprintf(fout, "    jz .done\n");
+  fprintf(fout, "    mov rax, 1\n"); // write
+  fprintf(fout, "    mov rdi, rbx\n");
+  fprintf(fout, "    syscall\n");
+  fprintf(fout, "    test rax, rax\n");
+  fprintf(fout, "    jle .done\n");
+  fprintf(fout, "    add rsi, rax\n");
+  fprintf(fout, "    sub rdx, rax\n");
+  fprintf(fout, "    jmp _dump_write\n");
+  fprintf(fout, ".done:\n");
+  fprintf(fout, "    ret\n");
+}
+
+/* Makes the program count the objects each allocation site creates and
+   report them at exit. */
+void countAllocations(char *fileName) {
+  allocStats = 1;
+  allocStatsFile = fileName;
+}
+
+/* Emits an increment of the counter of the allocation site of a `new`
+   of class classNum on line lineNumber, when counting allocations */
+void genAllocCounter(int classNum, int lineNumber) {
+  if (!allocStats)
+    return;
+  int site = 0;
+  while (site < numAllocSites && (allocSites[site].classNum != classNum ||
+                                  allocSites[site].lineNumber != lineNumber))
+    site++;
+  if (site == numAllocSites) {
+    allocSites = (AllocSite *)realloc(allocSites,
+                                      sizeof(AllocSite) * (numAllocSites + 1));
+    AllocSite newSite = {classNum, lineNumber};
+    allocSites[numAllocSites++] = newSite;
+  }
+  fprintf(fout, "    inc qword [rel alloc_counts + %d]\n", site * WORD_SIZE);
+}
+
+/* Emits the number of allocation sites, their counters, and what
+   _alloc_report needs besides: the object size of each site, its description (a
+   pointer and a length, newline included), the order to report the
+   sites in, sorted at exit, and the report's fixed text */
+void genAllocStatsData() {
+  fprintf(fout, "\nsection .data\n");
+  fprintf(fout, "    align 8\n");
+  fprintf(fout, "alloc_num_sites dq %d\n", numAllocSites);
+  fprintf(fout, "alloc_counts:\n");
+  fprintf(fout, "    times %d dq 0\n", numAllocSites);
+  fprintf(fout, "alloc_sizes:\n");
+  for (int i = 0; i < numAllocSites; i++) {
+    // An aligned object takes its size rounded up to its alignment
+    int size = getObjectSize(allocSites[i].classNum);
+    int alignment = getObjectAlignment(allocSites[i].classNum);
+    fprintf(fout, "    dq %d\n",
+            (size + alignment - 1) / alignment * alignment);
+  }
+  fprintf(fout, "alloc_order:\n");
+  for (int i = 0; i < numAllocSites; i++)
+    fprintf(fout, "    dq %d\n", i);
+  fprintf(fout, "alloc_names:\n");
+  for (int i = 0; i < numAllocSites; i++) {
+    char line[32];
+    sprintf(line, ", line %d", allocSites[i].lineNumber);
+    fprintf(fout, "    dq alloc_name_%d, %d\n", i,
+            (int)(strlen(classesST[allocSites[i].classNum].className) +
+                  strlen(line) + 1));
+  }
+  for (int i = 0; i < numAllocSites; i++)
+    fprintf(fout, "alloc_name_%d:\n    db \"%s, line %d\", 10\n", i,
+            classesST[allocSites[i].classNum].className,
+            allocSites[i].lineNumber);
+  fprintf(fout, "alloc_peak dq 0\n");
+  fprintf(fout, "alloc_total_bytes dq 0\n");
+  fprintf(fout, "alloc_total_objects dq 0\n");
+  fprintf(fout, "alloc_line:\n");
+  fprintf(fout, "    times 32 db 0\n");
+  fprintf(fout, "alloc_header:\n");
+  fprintf(fout, "    db \"****** allocation sites ******\", 10\n");
+  fprintf(fout, "    db \"         bytes      objects  site\", 10\n");
+  fprintf(fout, "alloc_header_end:\n");
+  fprintf(fout, "alloc_total_name:\n");
+  fprintf(fout, "    db \"total\", 10\n");
+  fprintf(fout, "alloc_peak_name:\n");
+  fprintf(fout, "    db \"peak heap in use\", 10\n");
+  fprintf(fout, "alloc_footer:\n");
+  fprintf(fout, "    db \"****** end allocation sites ******\", 10\n");
+  fprintf(fout, "alloc_footer_end:\n");
+  if (allocStatsFile != NULL)
+    fprintf(fout, "alloc_file:\n    db \"%s\", 0\n", allocStatsFile);
+}
+
+/* Emits code that raises alloc_peak to the bytes of heap in use up to
+   R15, when that is more; uses RAX */
+void genPeakUpdate() {
+  fprintf(fout, "    mov rax, r15\n");
+  if (collectGarbage)
+    fprintf(fout, "    sub rax, [rel gc_space_start]\n");
+  else {
+    fprintf(fout, "    sub rax, [rel heap_end]\n");
+    fprintf(fout, "    add rax, [rel heap_limit]\n");
+  }
+  fprintf(fout, "    cmp rax, [rel alloc_peak]\n");
+  fprintf(fout, "    jbe .peak_kept\n");
+  fprintf(fout, "    mov [rel alloc_peak], rax\n");
+  fprintf(fout, ".peak_kept:\n");
+}
+
+/* Emits the allocation report runtime:
+   _alloc_report, called by _exit_program, writes the sites that created
+   objects, the most bytes first, then the totals and the peak heap in
+   use, to stderr or the report file. It keeps RDI, the exit code.
+   _alloc_row writes a row: the bytes in RAX, the objects in RDX (or a
+   blank for -1), and the RCX bytes of description at RSI.
+   _alloc_number writes RAX right-aligned in the RCX bytes that end at
+   RDI. _alloc_write writes the RDX bytes at RSI to the file in R12. */
+void genAllocReport() {
+  fprintf(fout, "\n_alloc_report:\n");
+  fprintf(fout, "    push rdi\n");
+  fprintf(fout, "    push rbx\n");
+  fprintf(fout, "    push r12\n");
+  genPeakUpdate();
+  fprintf(fout, "    mov r12, 2\n"); // stderr
+  if (allocStatsFile != NULL) {
+    fprintf(fout, "    mov rax, 2\n"); // open
+    fprintf(fout, "    lea rdi, [rel alloc_file]\n");
+    fprintf(fout, "    mov rsi, 577\n"); // O_WRONLY | O_CREAT | O_TRUNC
+    fprintf(fout, "    mov rdx, 420\n"); // 0644
+    fprintf(fout, "    syscall\n");
+    fprintf(fout, "    test rax, rax\n");
+    fprintf(fout, "    js .done\n");
+    fprintf(fout, "    mov r12, rax\n");
+  }
+
+  // Insertion sort of the sites by bytes, most first
+  fprintf(fout, "    lea r8, [rel alloc_order]\n");
+  fprintf(fout, "    lea r10, [rel alloc_counts]\n");
+  fprintf(fout, "    lea r11, [rel alloc_sizes]\n");
+  fprintf(fout, "    mov rcx, 1\n");
+  fprintf(fout, ".sort:\n");
+  fprintf(fout, "    cmp rcx, [rel alloc_num_sites]\n");
+  fprintf(fout, "    jae .sorted\n");
+  fprintf(fout, "    mov r9, [r8 + rcx * 8]\n");
+  fprintf(fout, "    mov rsi, [r10 + r9 * 8]\n");
+  fprintf(fout, "    imul rsi, [r11 + r9 * 8]\n");
+  fprintf(fout, "    mov rdx, rcx\n");
+  fprintf(fout, ".shift:\n");
+  fprintf(fout, "    test rdx, rdx\n");
+  fprintf(fout, "    jz .insert\n");
+  fprintf(fout, "    mov rdi, [r8 + rdx * 8 - 8]\n");
+  fprintf(fout, "    mov rax, [r10 + rdi * 8]\n");
+  fprintf(fout, "    imul rax, [r11 + rdi * 8]\n");
+  fprintf(fout, "    cmp rax, rsi\n");
+  fprintf(fout, "    jae .insert\n");
+  fprintf(fout, "    mov [r8 + rdx * 8], rdi\n");
+  fprintf(fout, "    dec rdx\n");
+  fprintf(fout, "    jmp .shift\n");
+  fprintf(fout, ".insert:\n");
+  fprintf(fout, "    mov [r8 + rdx * 8], r9\n");
+  fprintf(fout, "    inc rcx\n");
+  fprintf(fout, "    jmp .sort\n");
+  fprintf(fout, ".sorted:\n");
+
+  fprintf(fout, "    lea rsi, [rel alloc_header]\n");
+  fprintf(fout, "    mov rdx, alloc_header_end - alloc_header\n");
+  fprintf(fout, "    call _alloc_write\n");
+  fprintf(fout, "    xor ebx, ebx\n");
+  fprintf(fout, ".site:\n");
+  fprintf(fout, "    cmp rbx, [rel alloc_num_sites]\n");
+  fprintf(fout, "    jae .sites_done\n");
+  fprintf(fout, "    lea rax, [rel alloc_order]\n");
+  fprintf(fout, "    mov r8, [rax + rbx * 8]\n");
+  fprintf(fout, "    lea rax, [rel alloc_counts]\n");
+  fprintf(fout, "    mov rdx, [rax + r8 * 8]\n");
+  fprintf(fout, "    test rdx, rdx\n");
+  fprintf(fout, "    jz .next_site\n");
+  fprintf(fout, "    lea rax, [rel alloc_sizes]\n");
+  fprintf(fout, "    mov rax, [rax + r8 * 8]\n");
+  fprintf(fout, "    imul rax, rdx\n");
+  fprintf(fout, "    add [rel alloc_total_bytes], rax\n");
+  fprintf(fout, "    add [rel alloc_total_objects], rdx\n");
+  fprintf(fout, "    shl r8, 4\n");
+  fprintf(fout, "    lea rsi, [rel alloc_names]\n");
+  fprintf(fout, "    mov rcx, [rsi + r8 + 8]\n");
+  fprintf(fout, "    mov rsi, [rsi + r8]\n");
+  fprintf(fout, "    call _alloc_row\n");
+  fprintf(fout, ".next_site:\n");
+  fprintf(fout, "    inc rbx\n");
+  fprintf(fout, "    jmp .site\n");
+  fprintf(fout, ".sites_done:\n");
+  fprintf(fout, "    mov rax, [rel alloc_total_bytes]\n");
+  fprintf(fout, "    mov rdx, [rel alloc_total_objects]\n");
+  fprintf(fout, "    lea rsi, [rel alloc_total_name]\n");
+  fprintf(fout, "    mov rcx, alloc_peak_name - alloc_total_name\n");
+  fprintf(fout, "    call _alloc_row\n");
+  fprintf(fout, "    mov rax, [rel alloc_peak]\n");
+  fprintf(fout, "    mov rdx, -1\n");
+  fprintf(fout, "    lea rsi, [rel alloc_peak_name]\n");
+  fprintf(fout, "    mov rcx, alloc_footer - alloc_peak_name\n");
+  fprintf(fout, "    call _alloc_row\n");
+  fprintf(fout, "    lea rsi, [rel alloc_footer]\n");
+  fprintf(fout, "    mov rdx, alloc_footer_end - alloc_footer\n");
+  fprintf(fout, "    call _alloc_write\n");
+  if (allocStatsFile != NULL) {
+    fprintf(fout, "    mov rdi, r12\n");
+    fprintf(fout, "    mov rax, 3\n"); // close
+    fprintf(fout, "    syscall\n");
+    fprintf(fout, ".done:\n");
+  }
+  fprintf(fout, "    pop r12\n");
+  fprintf(fout, "    pop rbx\n");
+  fprintf(fout, "    pop rdi\n");
+  fprintf(fout, "    ret\n");
+
+  // _alloc_row: the bytes and objects columns are 14 and 12 wide
+  fprintf(fout, "\n_alloc_row:\n");
+  fprintf(fout, "    push rsi\n");
+  fprintf(fout, "    push rcx\n");
+  fprintf(fout, "    mov r9, rdx\n");
+  fprintf(fout, "    lea rdi, [rel alloc_line + 14]\n");
+  fprintf(fout, "    mov rcx, 14\n");
+  fprintf(fout, "    call _alloc_number\n");
+  fprintf(fout, "    mov byte [rel alloc_line + 14], ' '\n");
+  fprintf(fout, "    lea rdi, [rel alloc_line + 27]\n");
+  fprintf(fout, "    mov rcx, 12\n");
+  fprintf(fout, "    mov rax, r9\n");
+  fprintf(fout, "    cmp rax, -1\n");
+  fprintf(fout, "    jne .objects\n");
+  fprintf(fout, ".blank:\n");
+  fprintf(fout, "    dec rdi\n");
+  fprintf(fout, "    mov byte [rdi], ' '\n");
+  fprintf(fout, "    dec rcx\n");
+  fprintf(fout, "    jnz .blank\n");
+  fprintf(fout, "    jmp .columns_done\n");
+  fprintf(fout, ".objects:\n");
+  fprintf(fout, "    call _alloc_number\n");
+  fprintf(fout, ".columns_done:\n");
+  fprintf(fout, "    mov word [rel alloc_line + 27], 0x2020\n"); // 2 spaces
+  fprintf(fout, "    lea rsi, [rel alloc_line]\n");
+  fprintf(fout, "    mov rdx, 29\n");
+  fprintf(fout, "    call _alloc_write\n");
+  fprintf(fout, "    pop rdx\n");
+  fprintf(fout, "    pop rsi\n");
+  fprintf(fout, "    jmp _alloc_write\n");
+
+  fprintf(fout, "\n_alloc_number:\n");
+  fprintf(fout, "    mov r8, 10\n");
+  fprintf(fout, ".digit:\n");
+  fprintf(fout, "    xor edx, edx\n");
+  fprintf(fout, "    div r8\n");
+  fprintf(fout, "    add dl, '0'\n");
+  fprintf(fout, "    dec rdi\n");
+  fprintf(fout, "    mov [rdi], dl\n");
+  fprintf(fout, "    dec rcx\n");
+  fprintf(fout, "    test rax, rax\n");
+  fprintf(fout, "    jnz .digit\n");
+  fprintf(fout, ".pad:\n");
+  fprintf(fout, "    cmp rcx, 0\n");
+  fprintf(fout, "    jle .padded\n");
+  fprintf(fout, "    dec rdi\n");
+  fprintf(fout, "    mov byte [rdi], ' '\n");
+  fprintf(fout, "    dec rcx\n");
+  fprintf(fout, "    jmp .pad\n");
+  fprintf(fout, ".padded:\n");
+  fprintf(fout, "    ret\n");
+
+  fprintf(fout, "\n_alloc_write:\n");
+  fprintf(fout, "    test rdx, rdx\n");
+  fprintf(fout, "    jz .done\n");
+  fprintf(fout, "    mov rax, 1\n"); // write
+  fprintf(fout, "    mov rdi, r12\n");
+  fprintf(fout, "    syscall\n");
+  fprintf(fout, "    test rax, rax\n");
+  fprintf(fout, "    jle .done\n");
+  fprintf(fout, "    add rsi, rax\n");
+  fprintf(fout, "    sub rdx, rax\n");
+  fprintf(fout, "    jmp _alloc_write\n");
+  fprintf(fout, ".done:\n");
+  fprintf(fout, "    ret\n");
+}
+
+/* Emits the copying collector, which _alloc_slow calls with the
+   allocation in progress in its saved RAX.
+   _gc_collect maps the other semispace afresh and copies into it every
+   object reachable from the roots: the frame slots the stack maps list,
+   walking the frames from the allocation's up to the main block's, and
+   the reference fields of the heap image. It then scans the copies in
+   order, Cheney style, copying the objects they reference in turn, swaps
+   the spaces, releases the old one, and moves the allocation in progress
+   after the copies. R12 points past the last copy throughout.
+   _gc_forward (_gc_forward_compressed) updates the reference (compressed
+   reference) at RDI, copying the object it references if that is in the
+   space in use. _gc_copy returns in RAX the copy of the object at RAX,
+   making one and leaving its address behind in the header if there is
+   none yet. _gc_scan forwards the reference fields of the object at RBX
+   and moves RBX past it. */
+void genCollector() {
+  int compressed = referencesCompressed();
+  const char *forwardField =
+      compressed ? "_gc_forward_compressed" : "_gc_forward";
+  int maxAlignment = WORD_SIZE;
+  for (int i = 1; i < numClasses; i++)
+    if (getObjectAlignment(i) > maxAlignment)
+      maxAlignment = getObjectAlignment(i);
+
+  fprintf(fout, "\n_gc_collect:\n");
+  fprintf(fout, "    push rbx\n");
+  fprintf(fout, "    push r12\n");
+  fprintf(fout, "    push rbp\n");
+  if (heapDumpFile != NULL)
+    fprintf(fout, "    mov qword [rel heap_busy], 1\n");
+  // Past these, the return address into _alloc_slow, and its saved
+  // registers, are its saved RAX and the slow path's return address
+  fprintf(fout, "    mov rax, [rsp + 96]\n");
+  fprintf(fout, "    mov [rel gc_pending], rax\n");
+  fprintf(fout, "    mov rcx, r15\n");
+  fprintf(fout, "    sub rcx, rax\n");
+  fprintf(fout, "    mov [rel gc_pending_size], rcx\n");
+  fprintf(fout, "    mov rax, [rsp + 104]\n");
+  fprintf(fout, "    mov [rel gc_site], rax\n");
+  // Map the other space afresh, as far as the space in use is committed
+  fprintf(fout, "    mov rsi, r13\n");
+  fprintf(fout, "    sub rsi, [rel gc_space_start]\n");
+  fprintf(fout, "    mov [rel gc_committed], rsi\n");
+  fprintf(fout, "    mov rdi, [rel gc_other_start]\n");
+  fprintf(fout, "    mov rdx, %d\n", PROT_READ_WRITE);
+  fprintf(fout, "    mov r10, [rel heap_map_flags]\n");
+  fprintf(fout, "    mov r8, -1\n");
+  fprintf(fout, "    xor r9d, r9d\n");
+  fprintf(fout, "    mov rax, %d\n", SYS_MMAP);
+  fprintf(fout, "    syscall\n");
+  fprintf(fout, "    cmp rax, -4096\n");
+  fprintf(fout, "    ja _heap_exhausted\n");
+  fprintf(fout, "    mov r12, [rel gc_other_start]\n");
+
+  // Roots in the frames: find the stack map of the frame's return
+  // address in RDX, and forward the slots it lists
+  fprintf(fout, "    mov rdx, [rel gc_site]\n");
+  fprintf(fout, ".frame:\n");
+  fprintf(fout, "    lea rsi, [rel gc_stack_maps]\n");
+  fprintf(fout, ".find_map:\n");
+  fprintf(fout, "    mov rax, [rsi]\n");
+  fprintf(fout, "    test rax, rax\n");
+  fprintf(fout, "    jz _gc_no_map\n");
+  fprintf(fout, "    cmp rax, rdx\n");
+  fprintf(fout, "    je .map_found\n");
+  fprintf(fout, "    mov rax, [rsi + 16]\n");
+  fprintf(fout, "    lea rsi, [rsi + rax * 8 + 24]\n");
+  fprintf(fout, "    jmp .find_map\n");
+  fprintf(fout, ".map_found:\n");
+  fprintf(fout, "    mov rcx, [rsi + 16]\n");
+  fprintf(fout, "    lea rbx, [rsi + 24]\n");
+  fprintf(fout, ".slot:\n");
+  fprintf(fout, "    test rcx, rcx\n");
+  fprintf(fout, "    jz .slots_done\n");
+  fprintf(fout, "    mov rdi, [rbx]\n");
+  fprintf(fout, "    add rdi, rbp\n");
+  fprintf(fout, "    call _gc_forward\n"); // frames hold whole addresses
+  fprintf(fout, "    add rbx, 8\n");
+  fprintf(fout, "    dec rcx\n");
+  fprintf(fout, "    jmp .slot\n");
+  fprintf(fout, ".slots_done:\n");
+  fprintf(fout, "    cmp qword [rsi + 8], 0\n"); // the main block's is last
+  fprintf(fout, "    jne .frames_done\n");
+  fprintf(fout, "    mov rdx, [rbp + 40]\n");
+  fprintf(fout, "    mov rbp, [rbp]\n");
+  fprintf(fout, "    jmp .frame\n");
+  fprintf(fout, ".frames_done:\n");
+
+  // Roots in the heap image, past the unused word at offset 0 when it
+  // was copied to the start of a compressed heap
+  int imageStart = compressed ? WORD_SIZE : 0;
+  if (heapImageWords * WORD_SIZE > imageStart) {
+    const char *image = compressed ? "r14" : "rel heap_image";
+    fprintf(fout, "    lea rbx, [%s + %d]\n", image, imageStart);
+    fprintf(fout, ".image:\n");
+    fprintf(fout, "    lea rax, [%s + %d]\n", image,
+            heapImageWords * WORD_SIZE);
+    fprintf(fout, "    cmp rbx, rax\n");
+    fprintf(fout, "    jae .image_done\n");
+    fprintf(fout, "    call _gc_scan\n");
+    fprintf(fout, "    jmp .image\n");
+    fprintf(fout, ".image_done:\n");
+  }
+
+  // Scan the copies, which copies what they reference after them
+  fprintf(fout, "    mov rbx, [rel gc_other_start]\n");
+  fprintf(fout, ".scan:\n");
+  fprintf(fout, "    cmp rbx, r12\n");
+  fprintf(fout, "    jae .scan_done\n");
+  fprintf(fout, "    call _gc_scan\n");
+  fprintf(fout, "    jmp .scan\n");
+  fprintf(fout, ".scan_done:\n");
+
+  // Release the old space's memory, and swap the spaces
+  fprintf(fout, "    mov rdi, [rel gc_space_start]\n");
+  fprintf(fout, "    mov rsi, [rel gc_committed]\n");
+  fprintf(fout, "    mov rdx, %d\n", MADV_DONTNEED);
+  fprintf(fout, "    mov rax, %d\n", SYS_MADVISE);
+  fprintf(fout, "    syscall\n");
+  fprintf(fout, "    mov rax, [rel gc_other_start]\n");
+  fprintf(fout, "    mov rcx, [rel gc_space_start]\n");
+  fprintf(fout, "    mov [rel gc_space_start], rax\n");
+  fprintf(fout, "    mov [rel gc_other_start], rcx\n");
+  fprintf(fout, "    mov r13, rax\n");
+  fprintf(fout, "    add r13, [rel gc_committed]\n");
+  fprintf(fout, "    mov rcx, rax\n");
+  fprintf(fout, "    add rcx, [rel gc_half]\n");
+  fprintf(fout, "    mov [rel heap_end], rcx\n");
+
+  // Collect next when the space in use holds twice what is live now
+  fprintf(fout, "    mov rcx, r12\n");
+  fprintf(fout, "    sub rcx, rax\n");
+  fprintf(fout, "    add rcx, rcx\n");
+  fprintf(fout, "    mov rdx, %lld\n", GC_MIN_THRESHOLD);
+  fprintf(fout, "    cmp rcx, rdx\n");
+  fprintf(fout, "    cmovb rcx, rdx\n");
+  fprintf(fout, "    mov [rel gc_threshold], rcx\n");
+
+  // Move the allocation in progress after the copies, keeping a cache
+  // line alignment it had
+  fprintf(fout, "    mov rax, r12\n");
+  if (maxAlignment > WORD_SIZE) {
+    fprintf(fout, "    test qword [rel gc_pending], %d\n", maxAlignment - 1);
+    fprintf(fout, "    jnz .placed\n");
+    fprintf(fout, "    add rax, %d\n", maxAlignment - 1);
+    fprintf(fout, "    and rax, %d\n", -maxAlignment);
+    fprintf(fout, ".placed:\n");
+  }
+  fprintf(fout, "    mov r15, rax\n");
+  fprintf(fout, "    add r15, [rel gc_pending_size]\n");
+  if (heapDumpFile != NULL) {
+    // Write a heap dump a signal asked for during the collection
+    fprintf(fout, "    mov qword [rel heap_busy], 0\n");
+    fprintf(fout, "    cmp qword [rel dump_pending], 0\n");
+    fprintf(fout, "    je .no_dump\n");
+    fprintf(fout, "    mov qword [rel dump_pending], 0\n");
+    fprintf(fout, "    call _heap_dump\n");
+    fprintf(fout, ".no_dump:\n");
+  }
+  fprintf(fout, "    pop rbp\n");
+  fprintf(fout, "    pop r12\n");
+  fprintf(fout, "    pop rbx\n");
+  fprintf(fout, "    mov [rsp + 72], rax\n"); // _alloc_slow's saved RAX
+  fprintf(fout, "    ret\n");
+
+  fprintf(fout, "\n_gc_no_map:\n"); // a return address without a stack map
+  fprintf(fout, "    mov rdi, 46\n");
+  fprintf(fout, "    call _exit_program\n");
+
+  // _gc_forward: RDI is the address of a reference
+  fprintf(fout, "\n_gc_forward:\n");
+  fprintf(fout, "    mov rax, [rdi]\n");
+  fprintf(fout, "    cmp rax, [rel gc_space_start]\n");
+  fprintf(fout, "    jb .done\n");
+  fprintf(fout, "    cmp rax, [rel heap_end]\n");
+  fprintf(fout, "    jae .done\n");
+  fprintf(fout, "    call _gc_copy\n");
+  fprintf(fout, "    mov [rdi], rax\n");
+  fprintf(fout, ".done:\n");
+  fprintf(fout, "    ret\n");
+
+  if (compressed) {
+    // _gc_forward_compressed: RDI is the address of a compressed reference
+    fprintf(fout, "\n_gc_forward_compressed:\n");
+    fprintf(fout, "    mov eax, [rdi]\n");
+    fprintf(fout, "    test eax, eax\n");
+    fprintf(fout, "    jz .done\n");
+    fprintf(fout, "    add rax, r14\n");
+    fprintf(fout, "    cmp rax, [rel gc_space_start]\n");
+    fprintf(fout, "    jb .done\n");
+    fprintf(fout, "    cmp rax, [rel heap_end]\n");
+    fprintf(fout, "    jae .done\n");
+    fprintf(fout, "    call _gc_copy\n");
+    fprintf(fout, "    sub rax, r14\n");
+    fprintf(fout, "    mov [rdi], eax\n");
+    fprintf(fout, ".done:\n");
+    fprintf(fout, "    ret\n");
+  }
+
+  // _gc_copy: a copied object's header holds the copy's address, or, in
+  // a compressed header, a type id of -1 and then the copy's offset
+  fprintf(fout, "\n_gc_copy:\n");
+  fprintf(fout, "    push rcx\n");
+  fprintf(fout, "    push rdx\n");
+  fprintf(fout, "    push rsi\n");
+  fprintf(fout, "    push rdi\n");
+  if (compressed) {
+    fprintf(fout, "    mov edx, [rax]\n");
+    fprintf(fout, "    cmp edx, -1\n");
+    fprintf(fout, "    jne .copy\n");
+    fprintf(fout, "    mov eax, [rax + 4]\n");
+    fprintf(fout, "    add rax, r14\n");
+  } else {
+    fprintf(fout, "    mov rdx, [rax]\n");
+    fprintf(fout, "    cmp rdx, %d\n", numClasses);
+    fprintf(fout, "    jb .copy\n");
+    fprintf(fout, "    mov rax, rdx\n");
+  }
+  fprintf(fout, "    jmp .copied\n");
+  fprintf(fout, ".copy:\n");
+  fprintf(fout, "    lea rcx, [rel gc_class_aligns]\n");
+  fprintf(fout, "    mov rcx, [rcx + rdx * 8]\n");
+  fprintf(fout, "    dec rcx\n");
+  fprintf(fout, "    add r12, rcx\n");
+  fprintf(fout, "    not rcx\n");
+  fprintf(fout, "    and r12, rcx\n");
+  fprintf(fout, "    lea rcx, [rel gc_class_sizes]\n");
+  fprintf(fout, "    mov rcx, [rcx + rdx * 8]\n");
+  fprintf(fout, "    mov rdx, rcx\n");
+  fprintf(fout, "    mov rsi, rax\n");
+  fprintf(fout, "    mov rdi, r12\n");
+  fprintf(fout, "    shr rcx, 3\n");
+  fprintf(fout, "    rep movsq\n");
+  if (compressed) {
+    fprintf(fout, "    mov dword [rax], -1\n");
+    fprintf(fout, "    mov rcx, r12\n");
+    fprintf(fout, "    sub rcx, r14\n");
+    fprintf(fout, "    mov [rax + 4], ecx\n");
+  } else {
+    fprintf(fout, "    mov [rax], r12\n");
+  }
+  fprintf(fout, "    mov rax, r12\n");
+  fprintf(fout, "    add r12, rdx\n");
+  fprintf(fout, ".copied:\n");
+  fprintf(fout, "    pop rdi\n");
+  fprintf(fout, "    pop rsi\n");
+  fprintf(fout, "    pop rdx\n");
+  fprintf(fout, "    pop rcx\n");
+  fprintf(fout, "    ret\n");
+
+  // _gc_scan: a zero type id is a gap alignment left, or an Object
+  fprintf(fout, "\n_gc_scan:\n");
+  if (compressed)
+    fprintf(fout, "    mov edx, [rbx]\n");
+  else
+    fprintf(fout, "    mov rdx, [rbx]\n");
+  fprintf(fout, "    test rdx, rdx\n");
+  fprintf(fout, "    jnz .object\n");
+  fprintf(fout, "    add rbx, %d\n", WORD_SIZE);
+  fprintf(fout, "    ret\n");
+  fprintf(fout, ".object:\n");
+  fprintf(fout, "    lea rsi, [rel gc_class_refs]\n");
+  fprintf(fout, "    mov rsi, [rsi + rdx * 8]\n");
+  fprintf(fout, ".field:\n");
+  fprintf(fout, "    mov edi, [rsi]\n");
+  fprintf(fout, "    test edi, edi\n");
+  fprintf(fout, "    jz .fields_done\n");
+  fprintf(fout, "    add rdi, rbx\n");
+  fprintf(fout, "    call %s\n", forwardField);
+  fprintf(fout, "    add rsi, 4\n");
+  fprintf(fout, "    jmp .field\n");
+  fprintf(fout, ".fields_done:\n");
+  fprintf(fout, "    lea rcx, [rel gc_class_sizes]\n");
+  fprintf(fout, "    add rbx, [rcx + rdx * 8]\n");
+  fprintf(fout, "    ret\n");
+}
+
+/* Emits the tables the collector reads: the size, alignment, and
+   reference-field offsets (a zero-terminated list) of each class,
+   indexed by type id; and the stack maps, each the return address of its
+   safepoint, 1 if it is in the main block (or else 0), the number of
+   slots, and their RBP-relative offsets, ending with a zero address */
+void genGCTables() {
+  fprintf(fout, "\nsection .data\n");
+  fprintf(fout, "    align 8\n");
+  fprintf(fout, "gc_class_sizes:\n");
+  for (int i = 0; i < numClasses; i++)
+    fprintf(fout, "    dq %d\n", getObjectSize(i));
+  fprintf(fout, "gc_class_aligns:\n");
+  for (int i = 0; i < numClasses; i++)
+    fprintf(fout, "    dq %d\n", getObjectAlignment(i));
+  fprintf(fout, "gc_class_refs:\n");
+  for (int i = 0; i < numClasses; i++)
+    fprintf(fout, "    dq gc_refs_%d\n", i);
+  for (int i = 0; i < numClasses; i++) {
+    fprintf(fout, "gc_refs_%d:\n", i);
+    for (int c = i; c > 0; c = classesST[c].superclass)
+      for (int j = 0; j < classesST[c].numVars; j++)
+        if (classesST[c].varList[j].type >= 0 && getFieldWidth(c, j) > 0)
+          fprintf(fout, "    dd %d\n",
+                  getFieldSlot(c, classesST[c].varList[j].varName).offset);
+    fprintf(fout, "    dd 0\n");
+  }
+
+  fprintf(fout, "    align 8\n");
+  fprintf(fout, "gc_stack_maps:\n");
+  for (int i = 0; i < numSafepoints; i++) {
+    Safepoint *point = &safepoints[i];
+    fprintf(fout, "    dq ..@%s_%d, %d, %d\n", point->labelKind, point->label,
+            point->inMain, point->numSlots);
+    for (int j = 0; j < point->numSlots; j++)
+      fprintf(fout, "    dq %d\n", point->slots[j]);
+  }
+  fprintf(fout, "    dq 0\n");
+}
+
+/* Allocates an object of class classNum and leaves its address in RAX.
+   The fast path bumps R15 once by the object's size and compares it with
+   the heap limit in R13, branching to an out-of-line slow path when the
+   heap is exhausted. It then stores the type id. The fields need no
+   zeroing: heap memory past R15 has never been used, since it is fresh
+   from an anonymous mapping, and the collector releases a space with
+   MADV_DONTNEED, which zeroes it, before allocating in it again. */
+void genAllocation(int classNum) {
+  int size = getObjectSize(classNum);
+  int alignment = getObjectAlignment(classNum);
+  if (alignment > WORD_SIZE) {
+    fprintf(fout, "    add r15, %d\n", alignment - 1);
+    fprintf(fout, "    and r15, %d\n", -alignment);
+  }
+  int label = labelNumber++;
+  fprintf(fout, "    mov rax, r15\n");
+  fprintf(fout, "    add r15, %d\n", size);
+  fprintf(fout, "    cmp r15, r13\n");
+  fprintf(fout, "    ja ..@alloc_slow_%d\n", label);
+  fprintf(fout, "..@alloc_done_%d:\n", label);
+  allocSlowPaths =
+      (int *)realloc(allocSlowPaths, sizeof(int) * (numAllocSlowPaths + 1));
+  allocSlowPaths[numAllocSlowPaths++] = label;
+  if (collectGarbage)
+    recordSafepoint("alloc_back", label);
+
+  // A qword store also zeroes the rest of a compressed header's word
+  fprintf(fout, "    mov qword [rax], %d\n", classNum);
+}
+
+/* Emits the slow paths of the allocations, out of line so the fast paths
+   fall through. Each calls _alloc_slow, with R15 already bumped past the
+   object at RAX, and resumes its fast path. ..@ labels do not end the
+   scope of the local labels of the method the allocation is in. */
+void genAllocSlowPaths() {
+  for (int i = 0; i < numAllocSlowPaths; i++) {
+    fprintf(fout, "..@alloc_slow_%d:\n", allocSlowPaths[i]);
+    fprintf(fout, "    call _alloc_slow\n");
+    if (collectGarbage)
+      fprintf(fout, "..@alloc_back_%d:\n", allocSlowPaths[i]);
+    fprintf(fout, "    jmp ..@alloc_done_%d\n", allocSlowPaths[i]);
+  }
+}
+
+/* Stores a word of pre-evaluated state at [RSP] */
+void genImageWord(ImageWord word) {
+  if (word.isRef && referencesCompressed()) {
+    // The image was copied to the start of the heap
+    fprintf(fout, "    lea rax, [r14 + %lld]\n", word.value);
+    fprintf(fout, "    mov [rsp], rax\n");
+  } else if (word.isRef) {
+    fprintf(fout, "    lea rax, [rel heap_image + %lld]\n", word.value);
+    fprintf(fout, "    mov [rsp], rax\n");
+  } else if (word.value == 0) {
+    fprintf(fout, "    mov qword [rsp], 0\n");
+  } else {
+    fprintf(fout, "    mov rax, %lld\n", word.value);
+    fprintf(fout, "    mov [rsp], rax\n");
+  }
+}
+
+/* Stores RAX into the given slot at address RBX, truncating to the width
+   of narrow slots and encoding compressed references */
+void genFieldStore(FieldSlot slot) {
+  if (slot.compressed) {
+    fprintf(fout, "    mov rcx, rax\n");
+    fprintf(fout, "    sub rcx, r14\n");
+    fprintf(fout, "    test rax, rax\n"); // null stays 0
+    fprintf(fout, "    cmovz rcx, rax\n");
+    fprintf(fout, "    mov [rbx], ecx\n");
+    return;
+  }
+  switch (slot.width) {
+  case 0:
+    break; // the field was removed from the layout
+  case 1:
+    fprintf(fout, "    mov [rbx], al\n");
+    break;
+  case 2:
+    fprintf(fout, "    mov [rbx], ax\n");
+    break;
+  case 4:
+    fprintf(fout, "    mov [rbx], eax\n");
+    break;
+  default:
+    fprintf(fout, "    mov [rbx], rax\n");
   }
-  if (!found)
-    internalCGerror("Couldn't get field offset.");
-  return padding + offset;
 }
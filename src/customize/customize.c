@@ -0,0 +1,163 @@
+#include "../../include/customize.h"
+#include "../../include/profile.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+/* How much more a call on `this` inside a while loop counts */
+#define LOOP_WEIGHT 8
+
+/* Encapsulate a method that could be customized for a subclass: the
+   method, the subclass that inherits it, and the estimated benefit and
+   cost of the clone. */
+typedef struct candidate {
+  int classNum;
+  int methodNum;
+  int thisType;
+  long long benefit;
+  int size;
+} Candidate;
+
+/* Returns the number of AST nodes in t */
+static int countNodes(ASTree *t) {
+  if (t == NULL)
+    return 0;
+  int count = 1;
+  for (ASTList *child = t->children; child != NULL; child = child->next)
+    count += countNodes(child->data);
+  return count;
+}
+
+/* Returns nonzero iff t calls a method on `this` */
+static int isSelfCall(ASTree *t) {
+  return t->typ == METHOD_CALL_EXPR ||
+         (t->typ == DOT_METHOD_CALL_EXPR &&
+          t->children->data->typ == THIS_EXPR);
+}
+
+/* Returns the weighted number of calls on `this` inside t */
+static int countSelfCalls(ASTree *t, int weight) {
+  if (t == NULL)
+    return 0;
+  int count = isSelfCall(t) ? weight : 0;
+  if (t->typ == WHILE_EXPR)
+    weight *= LOOP_WEIGHT;
+  for (ASTList *child = t->children; child != NULL; child = child->next)
+    count += countSelfCalls(child->data, weight);
+  return count;
+}
+
+/* Returns the number of calls on `this` inside t that the profile saw
+   with receivers of exact type thisType */
+static long long countProfiledSelfCalls(ASTree *t, int thisType) {
+  if (t == NULL)
+    return 0;
+  long long count = isSelfCall(t) ? receiverCount(t, thisType) : 0;
+  for (ASTList *child = t->children; child != NULL; child = child->next)
+    count += countProfiledSelfCalls(child->data, thisType);
+  return count;
+}
+
+/* Points every call on `this` inside t at the body it reaches when `this`
+   has exact type thisType */
+static void bindSelfCalls(ASTree *t, int thisType) {
+  if (t == NULL)
+    return;
+
+  if (isSelfCall(t) && t->callTarget == NULL) {
+    int targetClass, targetMethod;
+    if (resolveMethod(thisType, t->staticClassNum, t->staticMemberNum,
+                      &targetClass, &targetMethod)) {
+      MethodClone *clone =
+          findCustomizedClone(targetClass, targetMethod, thisType);
+      t->callTarget = clone ? clone->label
+                            : methodLabel(targetClass, targetMethod);
+    }
+  }
+
+  for (ASTList *child = t->children; child != NULL; child = child->next)
+    bindSelfCalls(child->data, thisType);
+}
+
+/* Orders candidates by decreasing benefit, then by increasing size */
+static int compareCandidates(const void *a, const void *b) {
+  const Candidate *c1 = (const Candidate *)a;
+  const Candidate *c2 = (const Candidate *)b;
+  if (c1->benefit != c2->benefit)
+    return c1->benefit < c2->benefit ? 1 : -1;
+  return c1->size - c2->size;
+}
+
+/* Customizes inherited methods for the subclasses that inherit them.
+   A method declared in class C is compiled once and runs for receivers of
+   C and of every subclass that does not override it, so calls on `this`
+   inside it must go through the dispatcher. For a subclass D inheriting
+   such a method, a clone customized for receivers of exact type D resolves
+   every call on `this` at compile time into a direct jump.
+   Candidates are ranked by the number of calls on `this` they contain
+   (calls inside while loops count more), or, when a profile has been
+   read, by the number of those calls the profile saw with receivers of
+   the subclass; clones are made while the cloned bodies fit within
+   budget AST nodes.
+   The dispatcher routes receivers of type D to their customized clones.
+   This method assumes setupSymbolTables() and typecheckProgram() have
+   already executed. */
+void customizeInheritedMethods(int budget) {
+  // Collect every (method, inheriting subclass) pair worth a clone
+  int numCandidates = 0, capacity = 16;
+  Candidate *candidates = (Candidate *)malloc(sizeof(Candidate) * capacity);
+  for (int i = 1; i < numClasses; i++) {
+    for (int j = 0; j < classesST[i].numMethods; j++) {
+      ASTree *body = classesST[i].methodList[j].bodyExprs;
+      int benefit = countSelfCalls(body, 1);
+      if (benefit == 0)
+        continue;
+      for (int sub = 1; sub < numClasses; sub++) {
+        int targetClass, targetMethod;
+        if (sub == i || !isSubtype(sub, i) ||
+            !resolveMethod(sub, i, j, &targetClass, &targetMethod) ||
+            targetClass != i || targetMethod != j)
+          continue;
+        if (numCandidates == capacity) {
+          capacity *= 2;
+          candidates =
+              (Candidate *)realloc(candidates, sizeof(Candidate) * capacity);
+        }
+        candidates[numCandidates].classNum = i;
+        candidates[numCandidates].methodNum = j;
+        candidates[numCandidates].thisType = sub;
+        // A profile replaces the static estimate with the calls actually
+        // made on receivers of this subclass
+        candidates[numCandidates].benefit =
+            haveProfile() ? countProfiledSelfCalls(body, sub) : benefit;
+        if (candidates[numCandidates].benefit == 0)
+          continue;
+        candidates[numCandidates].size = countNodes(body);
+        numCandidates++;
+      }
+    }
+  }
+
+  // Clone the most profitable candidates that fit in the budget
+  qsort(candidates, numCandidates, sizeof(Candidate), compareCandidates);
+  int firstClone = numMethodClones;
+  for (int i = 0; i < numCandidates; i++) {
+    if (candidates[i].size > budget)
+      continue;
+    budget -= candidates[i].size;
+
+    char suffix[32];
+    snprintf(suffix, sizeof(suffix), "_for%d", candidates[i].thisType);
+    char *label = strConcat(
+        methodLabel(candidates[i].classNum, candidates[i].methodNum), suffix,
+        NULL);
+    MethodClone *clone = addMethodClone(candidates[i].classNum,
+                                        candidates[i].methodNum, label);
+    clone->thisType = candidates[i].thisType;
+  }
+  free(candidates);
+
+  // Resolve the calls on `this` in every new clone, now that the set of
+  // customized clones they may jump to is known
+  for (int i = firstClone; i < numMethodClones; i++)
+    bindSelfCalls(methodClones[i].bodyExprs, methodClones[i].thisType);
+}
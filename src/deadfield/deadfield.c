@@ -0,0 +1,128 @@
+#include "../../include/deadfield.h"
+#include "../../include/intrinsics.h"
+#include <stdlib.h>
+
+/* Whether some expression reads each field, indexed by class number and
+   then variable number */
+static int **fieldRead;
+
+/* The method whose body is being scanned (class -1 for the main block) */
+static int currClass, currMethod;
+
+/* Finds the field called name in class classNum or its superclasses.
+   Returns nonzero iff found, storing the declaring class and the index
+   into its varList. */
+static int findField(int classNum, char *name, int *declClass,
+                     int *declIndex) {
+  while (classNum > 0) {
+    ClassDecl *class = &classesST[classNum];
+    for (int i = 0; i < class->numVars; i++) {
+      if (strCompare(name, class->varList[i].varName)) {
+        *declClass = classNum;
+        *declIndex = i;
+        return 1;
+      }
+    }
+    classNum = class->superclass;
+  }
+  return 0;
+}
+
+/* Returns nonzero iff the identifier name refers to a field of `this`
+   in the current method, following code gen's lookup order (parameter,
+   then locals, then fields). */
+static int isThisField(char *name, int *declClass, int *declIndex) {
+  if (currClass < 0)
+    return 0;
+  MethodDecl *method = &classesST[currClass].methodList[currMethod];
+  if (strCompare(name, method->paramName))
+    return 0;
+  for (int i = 0; i < method->numLocals; i++)
+    if (strCompare(name, method->localST[i].varName))
+      return 0;
+  return findField(currClass, name, declClass, declIndex);
+}
+
+/* Marks every field read inside t */
+static void markReads(ASTree *t) {
+  if (t == NULL)
+    return;
+
+  int declClass, declIndex;
+  if (t->typ == ID_EXPR &&
+      isThisField(t->children->data->idVal, &declClass, &declIndex))
+    fieldRead[declClass][declIndex] = 1;
+  else if (t->typ == DOT_ID_EXPR &&
+           findField(typeExpr(t->children->data, currClass, currMethod),
+                     t->children->next->data->idVal, &declClass,
+                     &declIndex))
+    fieldRead[declClass][declIndex] = 1;
+
+  for (ASTList *child = t->children; child != NULL; child = child->next)
+    markReads(child->data);
+}
+
+/* Returns the value child of the assignment t after freeing the rest */
+static ASTree *replaceWithValue(ASTree *t) {
+  ASTree *value = t->childrenTail->data;
+  t->childrenTail->data = NULL;
+  freeAST(t);
+  return value;
+}
+
+/* Eliminates the stores to removed fields inside t.
+   Returns the expression that should replace t in its parent. */
+static ASTree *removeDeadStores(ASTree *t) {
+  if (t == NULL)
+    return NULL;
+
+  for (ASTList *child = t->children; child != NULL; child = child->next)
+    child->data = removeDeadStores(child->data);
+
+  int declClass, declIndex;
+  if (t->typ == ASSIGN_EXPR &&
+      isThisField(t->children->data->idVal, &declClass, &declIndex) &&
+      !fieldRead[declClass][declIndex])
+    return replaceWithValue(t);
+  if (t->typ == DOT_ASSIGN_EXPR && t->children->data->typ == THIS_EXPR &&
+      findField(currClass, t->children->next->data->idVal, &declClass,
+                &declIndex) &&
+      !fieldRead[declClass][declIndex])
+    return replaceWithValue(t);
+  return t;
+}
+
+/* Removes fields that are never read from the object layout. */
+void eliminateDeadFields() {
+  fieldRead = (int **)malloc(sizeof(int *) * numClasses);
+  for (int i = 0; i < numClasses; i++)
+    fieldRead[i] = (int *)calloc(classesST[i].numVars + 1, sizeof(int));
+
+  for (int i = 1; i < numClasses; i++) {
+    for (int j = 0; j < classesST[i].numMethods; j++) {
+      currClass = i;
+      currMethod = j;
+      markReads(classesST[i].methodList[j].bodyExprs);
+    }
+  }
+  currClass = -1;
+  currMethod = -1;
+  markReads(mainExprs);
+
+  // The runtime reads the state of intrinsic classes
+  for (int i = 1; i < numClasses; i++)
+    for (int j = 0; j < classesST[i].numVars; j++)
+      if (!fieldRead[i][j] && !isIntrinsicClass(i))
+        setFieldWidth(i, j, 0);
+
+  for (int i = 1; i < numClasses; i++) {
+    for (int j = 0; j < classesST[i].numMethods; j++) {
+      currClass = i;
+      currMethod = j;
+      removeDeadStores(classesST[i].methodList[j].bodyExprs);
+    }
+  }
+  currClass = -1;
+  currMethod = -1;
+  removeDeadStores(mainExprs);
+}
@@ -126,17 +126,19 @@ extern int yydebug;
     IF = 275,                      /* IF  */
     ELSE = 276,                    /* ELSE  */
     WHILE = 277,                   /* WHILE  */
-    ASSIGN = 278,                  /* ASSIGN  */
-    NUL = 279,                     /* NUL  */
-    NEW = 280,                     /* NEW  */
-    THIS = 281,                    /* THIS  */
-    DOT = 282,                     /* DOT  */
-    SEMICOLON = 283,               /* SEMICOLON  */
-    LBRACE = 284,                  /* LBRACE  */
-    RBRACE = 285,                  /* RBRACE  */
-    LPAREN = 286,                  /* LPAREN  */
-    RPAREN = 287,                  /* RPAREN  */
-    ENDOFFILE = 288                /* ENDOFFILE  */
+    SPAWN = 278,                   /* SPAWN  */
+    JOIN = 279,                    /* JOIN  */
+    ASSIGN = 280,                  /* ASSIGN  */
+    NUL = 281,                     /* NUL  */
+    NEW = 282,                     /* NEW  */
+    THIS = 283,                    /* THIS  */
+    DOT = 284,                     /* DOT  */
+    SEMICOLON = 285,               /* SEMICOLON  */
+    LBRACE = 286,                  /* LBRACE  */
+    RBRACE = 287,                  /* RBRACE  */
+    LPAREN = 288,                  /* LPAREN  */
+    RPAREN = 289,                  /* RPAREN  */
+    ENDOFFILE = 290                /* ENDOFFILE  */
   };
   typedef enum yytokentype yytoken_kind_t;
 #endif
@@ -160,7 +162,13 @@ int yyparse (void);
   #include "../include/ast.h"
   #include "../include/symtbl.h"
   #include "../include/typecheck.h"
+  #include "../include/profile.h"
+  #include "../include/passes.h"
   #include "../include/codegen.h"
+  #include "../include/djrt.h"
+  #include "../include/options.h"
+  #include <string.h>
+  #include <unistd.h>
     
   #define DEBUG_SYMTBL 0
   #define DEBUG_AST 0
@@ -179,7 +187,23 @@ int yyparse (void);
     exit(-1);
   }
 
-#line 184 "src/dj.tab.c"
+  /* Writes to path the runtime library's path, next to the compiler's
+     executable (e.g. bin/libdjrt.a), or its bare name if that is unknown */
+  void runtimeLibraryPath(char *path, size_t size) {
+    ssize_t length = readlink("/proc/self/exe", path, size - 1);
+    char *slash = NULL;
+    if (length > 0) {
+      path[length] = '\0';
+      slash = strrchr(path, '/');
+    }
+    if (slash == NULL ||
+        (size_t)(slash + 1 - path) + strlen(DJRT_LIBRARY) >= size)
+      snprintf(path, size, "%s", DJRT_LIBRARY);
+    else
+      strcpy(slash + 1, DJRT_LIBRARY);
+  }
+
+#line 208 "src/dj.tab.c"
 
 
 /* Symbol kind.  */
@@ -209,30 +233,32 @@ enum yysymbol_kind_t
   YYSYMBOL_IF = 20,                        /* IF  */
   YYSYMBOL_ELSE = 21,                      /* ELSE  */
   YYSYMBOL_WHILE = 22,                     /* WHILE  */
-  YYSYMBOL_ASSIGN = 23,                    /* ASSIGN  */
-  YYSYMBOL_NUL = 24,                       /* NUL  */
-  YYSYMBOL_NEW = 25,                       /* NEW  */
-  YYSYMBOL_THIS = 26,                      /* THIS  */
-  YYSYMBOL_DOT = 27,                       /* DOT  */
-  YYSYMBOL_SEMICOLON = 28,                 /* SEMICOLON  */
-  YYSYMBOL_LBRACE = 29,                    /* LBRACE  */
-  YYSYMBOL_RBRACE = 30,                    /* RBRACE  */
-  YYSYMBOL_LPAREN = 31,                    /* LPAREN  */
-  YYSYMBOL_RPAREN = 32,                    /* RPAREN  */
-  YYSYMBOL_ENDOFFILE = 33,                 /* ENDOFFILE  */
-  YYSYMBOL_YYACCEPT = 34,                  /* $accept  */
-  YYSYMBOL_pgm = 35,                       /* pgm  */
-  YYSYMBOL_dj = 36,                        /* dj  */
-  YYSYMBOL_class_list = 37,                /* class_list  */
-  YYSYMBOL_class = 38,                     /* class  */
-  YYSYMBOL_method_list = 39,               /* method_list  */
-  YYSYMBOL_method = 40,                    /* method  */
-  YYSYMBOL_variable_declaration_list = 41, /* variable_declaration_list  */
-  YYSYMBOL_variable_declaration = 42,      /* variable_declaration  */
-  YYSYMBOL_expression_list = 43,           /* expression_list  */
-  YYSYMBOL_expression = 44,                /* expression  */
-  YYSYMBOL_data_type = 45,                 /* data_type  */
-  YYSYMBOL_identifier = 46                 /* identifier  */
+  YYSYMBOL_SPAWN = 23,                     /* SPAWN  */
+  YYSYMBOL_JOIN = 24,                      /* JOIN  */
+  YYSYMBOL_ASSIGN = 25,                    /* ASSIGN  */
+  YYSYMBOL_NUL = 26,                       /* NUL  */
+  YYSYMBOL_NEW = 27,                       /* NEW  */
+  YYSYMBOL_THIS = 28,                      /* THIS  */
+  YYSYMBOL_DOT = 29,                       /* DOT  */
+  YYSYMBOL_SEMICOLON = 30,                 /* SEMICOLON  */
+  YYSYMBOL_LBRACE = 31,                    /* LBRACE  */
+  YYSYMBOL_RBRACE = 32,                    /* RBRACE  */
+  YYSYMBOL_LPAREN = 33,                    /* LPAREN  */
+  YYSYMBOL_RPAREN = 34,                    /* RPAREN  */
+  YYSYMBOL_ENDOFFILE = 35,                 /* ENDOFFILE  */
+  YYSYMBOL_YYACCEPT = 36,                  /* $accept  */
+  YYSYMBOL_pgm = 37,                       /* pgm  */
+  YYSYMBOL_dj = 38,                        /* dj  */
+  YYSYMBOL_class_list = 39,                /* class_list  */
+  YYSYMBOL_class = 40,                     /* class  */
+  YYSYMBOL_method_list = 41,               /* method_list  */
+  YYSYMBOL_method = 42,                    /* method  */
+  YYSYMBOL_variable_declaration_list = 43, /* variable_declaration_list  */
+  YYSYMBOL_variable_declaration = 44,      /* variable_declaration  */
+  YYSYMBOL_expression_list = 45,           /* expression_list  */
+  YYSYMBOL_expression = 46,                /* expression  */
+  YYSYMBOL_data_type = 47,                 /* data_type  */
+  YYSYMBOL_identifier = 48                 /* identifier  */
 };
 typedef enum yysymbol_kind_t yysymbol_kind_t;
 
@@ -560,19 +586,19 @@ union yyalloc
 /* YYFINAL -- State number of the termination state.  */
 #define YYFINAL  12
 /* YYLAST -- Last index in YYTABLE.  */
-#define YYLAST   595
+#define YYLAST   599
 
 /* YYNTOKENS -- Number of terminals.  */
-#define YYNTOKENS  34
+#define YYNTOKENS  36
 /* YYNNTS -- Number of nonterminals.  */
 #define YYNNTS  13
 /* YYNRULES -- Number of rules.  */
-#define YYNRULES  53
+#define YYNRULES  55
 /* YYNSTATES -- Number of states.  */
-#define YYNSTATES  154
+#define YYNSTATES  158
 
 /* YYMAXUTOK -- Last valid token kind.  */
-#define YYMAXUTOK   288
+#define YYMAXUTOK   290
 
 
 /* YYTRANSLATE(TOKEN-NUM) -- Symbol number corresponding to TOKEN-NUM
@@ -614,19 +640,20 @@ static const yytype_int8 yytranslate[] =
        2,     2,     2,     2,     2,     2,     1,     2,     3,     4,
        5,     6,     7,     8,     9,    10,    11,    12,    13,    14,
       15,    16,    17,    18,    19,    20,    21,    22,    23,    24,
-      25,    26,    27,    28,    29,    30,    31,    32,    33
+      25,    26,    27,    28,    29,    30,    31,    32,    33,    34,
+      35
 };
 
 #if YYDEBUG
 /* YYRLINE[YYN] -- Source line where rule number YYN was defined.  */
 static const yytype_int16 yyrline[] =
 {
-       0,    50,    50,    57,    62,    67,    72,    81,    85,    91,
-      97,   103,   109,   115,   121,   127,   133,   142,   146,   152,
-     160,   168,   176,   187,   191,   197,   204,   208,   214,   217,
-     220,   223,   226,   230,   233,   236,   240,   245,   249,   253,
-     257,   261,   265,   268,   272,   276,   281,   286,   290,   293,
-     296,   302,   305,   311
+       0,    73,    73,    80,    85,    90,    95,   104,   108,   114,
+     120,   126,   132,   138,   144,   150,   156,   165,   169,   175,
+     183,   191,   199,   210,   214,   220,   227,   231,   237,   240,
+     243,   246,   249,   253,   256,   259,   263,   268,   272,   276,
+     280,   284,   288,   291,   294,   297,   301,   305,   310,   315,
+     319,   322,   325,   331,   334,   340
 };
 #endif
 
@@ -645,8 +672,8 @@ static const char *const yytname[] =
   "\"end of file\"", "error", "\"invalid token\"", "FINAL", "CLASS", "ID",
   "EXTENDS", "MAIN", "NATTYPE", "NATLITERAL", "PRINTNAT", "READNAT",
   "PLUS", "MINUS", "TIMES", "EQUALITY", "LESS", "ASSERT", "OR", "NOT",
-  "IF", "ELSE", "WHILE", "ASSIGN", "NUL", "NEW", "THIS", "DOT",
-  "SEMICOLON", "LBRACE", "RBRACE", "LPAREN", "RPAREN", "ENDOFFILE",
+  "IF", "ELSE", "WHILE", "SPAWN", "JOIN", "ASSIGN", "NUL", "NEW", "THIS",
+  "DOT", "SEMICOLON", "LBRACE", "RBRACE", "LPAREN", "RPAREN", "ENDOFFILE",
   "$accept", "pgm", "dj", "class_list", "class", "method_list", "method",
   "variable_declaration_list", "variable_declaration", "expression_list",
   "expression", "data_type", "identifier", YY_NULLPTR
@@ -659,12 +686,12 @@ yysymbol_name (yysymbol_kind_t yysymbol)
 }
 #endif
 
-#define YYPACT_NINF (-90)
+#define YYPACT_NINF (-65)
 
 #define yypact_value_is_default(Yyn) \
   ((Yyn) == YYPACT_NINF)
 
-#define YYTABLE_NINF (-53)
+#define YYTABLE_NINF (-55)
 
 #define yytable_value_is_error(Yyn) \
   ((Yyn) == YYTABLE_NINF)
@@ -673,22 +700,22 @@ yysymbol_name (yysymbol_kind_t yysymbol)
    STATE-NUM.  */
 static const yytype_int16 yypact[] =
 {
-     117,    -3,     5,   -18,    20,    -6,   126,   -90,     5,   -90,
-      23,   214,   -90,   -90,     7,   -90,    34,     5,   -90,   -90,
-      22,    41,   445,   445,    43,    49,   -90,     5,   -90,   445,
-     214,    60,   247,   528,     5,    -1,   214,     5,    61,   445,
-      62,   552,    10,    85,   445,   445,    71,   169,    65,   265,
-     -90,   -90,   545,   445,   445,   445,   445,   445,   445,     5,
-     -90,   -90,   445,   445,   214,   283,    72,     9,   465,   -90,
-     472,   493,    74,   -90,   -90,   -90,   -90,    -9,    -9,    80,
-      69,   562,   568,    33,   552,   500,   301,   -90,    16,    63,
-     -90,    39,   -90,    40,     5,   -90,   -90,    86,    88,   -90,
-     445,   445,   -90,   -90,   -90,    46,    47,     5,   -90,   -90,
-       5,   -90,    55,    78,   445,   445,   552,   521,   -90,   -90,
-      70,    83,    78,   -90,    63,   319,   337,   -90,   -90,    63,
-       5,   102,   -90,     5,   104,   105,   107,   108,   445,   114,
-     214,   355,   214,   214,   373,   -90,   214,   391,   409,   -90,
-     427,   -90,   -90,   -90
+      82,    15,    37,    -7,    56,    32,   171,   -65,    37,   -65,
+      68,   162,   -65,   -65,    42,   -65,    70,    37,   -65,   -65,
+      45,    47,   421,   421,    61,    64,   421,   421,   -65,    37,
+     -65,   421,   162,    74,   182,   533,    37,    -4,   162,    37,
+      79,   421,    83,   559,   -15,    31,   421,   421,    69,    69,
+      90,   443,    95,   207,   -65,   -65,   540,   421,   421,   421,
+     421,   421,   421,    37,   -65,   -65,   421,   421,   162,   241,
+     102,    -1,   450,   -65,   473,   480,    94,   -65,   -65,   -65,
+     -65,    -6,    -6,    69,   438,   552,   570,    29,   559,   503,
+     261,   -65,     8,    27,   -65,     9,   -65,    17,    37,   -65,
+     -65,   105,   110,   -65,   421,   421,   -65,   -65,   -65,    50,
+      67,    37,   -65,   -65,    37,   -65,    97,   114,   421,   421,
+     559,   510,   -65,   -65,    98,   116,   114,   -65,    27,   281,
+     301,   -65,   -65,    27,    37,   122,   -65,    37,   123,   125,
+     124,   133,   421,   137,   162,   321,   162,   162,   341,   -65,
+     162,   361,   381,   -65,   401,   -65,   -65,   -65
 };
 
 /* YYDEFACT[STATE-NUM] -- Default reduction number in state STATE-NUM.
@@ -696,36 +723,36 @@ static const yytype_int16 yypact[] =
    means the default is an error.  */
 static const yytype_int8 yydefact[] =
 {
-       0,     0,     0,     0,     0,     0,     0,     8,     0,    53,
-       0,     0,     1,     2,     0,     7,     0,     0,    51,    29,
-       0,     0,     0,     0,     0,     0,    28,     0,    31,     0,
-       0,     0,     0,     0,     0,    30,     0,     0,     0,     0,
-       0,    48,    30,    42,     0,     0,     0,     0,     0,     0,
-      24,     3,     0,     0,     0,     0,     0,     0,     0,     0,
-      27,    25,     0,     0,     0,     0,     0,     0,     0,    50,
-       0,     0,     0,    34,    23,     4,    26,    37,    38,    39,
-      40,    41,    43,    35,    44,     0,     0,     5,     0,     0,
-       9,     0,    18,     0,     0,    52,    49,     0,     0,    33,
-       0,     0,    32,     6,    13,     0,     0,     0,    11,    17,
-       0,    10,     0,    25,     0,     0,    45,     0,    15,    14,
-       0,     0,     0,    12,     0,     0,     0,    36,    16,     0,
-       0,     0,    47,     0,     0,     0,     0,     0,     0,     0,
-       0,     0,     0,     0,     0,    46,     0,     0,     0,    19,
-       0,    21,    20,    22
+       0,     0,     0,     0,     0,     0,     0,     8,     0,    55,
+       0,     0,     1,     2,     0,     7,     0,     0,    53,    29,
+       0,     0,     0,     0,     0,     0,     0,     0,    28,     0,
+      31,     0,     0,     0,     0,     0,     0,    30,     0,     0,
+       0,     0,     0,    50,    30,    42,     0,     0,    43,    44,
+       0,     0,     0,     0,    24,     3,     0,     0,     0,     0,
+       0,     0,     0,     0,    27,    25,     0,     0,     0,     0,
+       0,     0,     0,    52,     0,     0,     0,    34,    23,     4,
+      26,    37,    38,    39,    40,    41,    45,    35,    46,     0,
+       0,     5,     0,     0,     9,     0,    18,     0,     0,    54,
+      51,     0,     0,    33,     0,     0,    32,     6,    13,     0,
+       0,     0,    11,    17,     0,    10,     0,    25,     0,     0,
+      47,     0,    15,    14,     0,     0,     0,    12,     0,     0,
+       0,    36,    16,     0,     0,     0,    49,     0,     0,     0,
+       0,     0,     0,     0,     0,     0,     0,     0,     0,    48,
+       0,     0,     0,    19,     0,    21,    20,    22
 };
 
 /* YYPGOTO[NTERM-NUM].  */
 static const yytype_int16 yypgoto[] =
 {
-     -90,   -90,   -90,   -90,   143,   -80,   -89,   -29,   -27,    31,
-     103,    87,    -2
+     -65,   -65,   -65,   -65,   170,   -64,   -32,   -33,   -29,    19,
+      93,   -45,    -2
 };
 
 /* YYDEFGOTO[NTERM-NUM].  */
 static const yytype_int8 yydefgoto[] =
 {
-       0,     4,     5,     6,     7,    91,    92,    30,    31,    32,
-      33,    34,    42
+       0,     4,     5,     6,     7,    95,    96,    32,    33,    34,
+      35,    36,    44
 };
 
 /* YYTABLE[YYPACT[STATE-NUM]] -- What to do in state STATE-NUM.  If
@@ -733,163 +760,163 @@ static const yytype_int8 yydefgoto[] =
    number is the opposite.  If YYTABLE_NINF, syntax error.  */
 static const yytype_int16 yytable[] =
 {
-      10,     8,   109,    48,   -52,    55,    16,    64,   105,    35,
-       9,    11,    89,   112,     9,    38,   109,    18,    59,    89,
-      12,     9,    62,   109,    18,    46,   120,    13,    35,    17,
-      63,   109,    61,    62,    35,    66,    36,    48,    93,    90,
-      37,    63,    89,    89,     9,     9,   104,    18,    18,    89,
-      89,     9,     9,    39,    18,    18,   100,    83,    89,   106,
-       9,    49,    35,    18,   101,    95,    48,    65,     9,   108,
-     111,    18,    40,    89,    44,     9,   118,   119,    18,    48,
-      45,    53,    54,    55,   -53,   123,    95,    95,    50,    95,
-      67,    95,   113,    74,    69,    86,    59,    53,    54,    55,
-     128,    88,    72,    95,    95,   121,    99,    59,   122,   124,
-      95,   143,    59,   146,   129,   114,    48,   115,    95,    48,
-       1,     2,    95,   135,     3,    41,    43,    95,   134,     1,
-       2,   136,    47,    14,   138,    52,   137,   140,    35,   139,
-      35,    35,    68,   142,    35,   125,   126,    70,    71,    15,
-       0,     0,    52,     0,    94,     0,    77,    78,    79,    80,
-      81,    82,     0,     0,     0,    84,    85,     0,    52,   141,
-       0,   144,     0,   147,   148,    94,   107,   150,   110,     0,
-      94,    53,    54,    55,    56,    57,     0,    58,     0,    52,
-       0,     0,   110,    94,     0,     0,    59,     0,     0,   110,
-       0,    73,     0,   116,   117,     0,     0,   110,     0,     0,
-       0,   130,     0,     0,     0,     0,   133,     0,     0,     9,
-       0,     0,    18,    19,    20,    21,     0,     0,    52,    52,
-       0,    22,     0,    23,    24,     0,    25,     0,    26,    27,
-      28,     0,     0,     0,    52,    29,     0,    52,     0,     0,
-      52,    52,     9,    52,     0,     0,    19,    20,    21,     0,
-       0,     0,     0,     0,    22,     0,    23,    24,     0,    25,
-       9,    26,    27,    28,    19,    20,    21,    51,    29,     0,
-       0,     0,    22,     0,    23,    24,     0,    25,     9,    26,
-      27,    28,    19,    20,    21,    75,    29,     0,     0,     0,
-      22,     0,    23,    24,     0,    25,     9,    26,    27,    28,
-      19,    20,    21,    87,    29,     0,     0,     0,    22,     0,
-      23,    24,     0,    25,     9,    26,    27,    28,    19,    20,
-      21,   103,    29,     0,     0,     0,    22,     0,    23,    24,
-       0,    25,     9,    26,    27,    28,    19,    20,    21,   131,
-      29,     0,     0,     0,    22,     0,    23,    24,     0,    25,
-       9,    26,    27,    28,    19,    20,    21,   132,    29,     0,
-       0,     0,    22,     0,    23,    24,     0,    25,     9,    26,
-      27,    28,    19,    20,    21,   145,    29,     0,     0,     0,
-      22,     0,    23,    24,     0,    25,     9,    26,    27,    28,
-      19,    20,    21,   149,    29,     0,     0,     0,    22,     0,
-      23,    24,     0,    25,     9,    26,    27,    28,    19,    20,
-      21,   151,    29,     0,     0,     0,    22,     0,    23,    24,
-       0,    25,     9,    26,    27,    28,    19,    20,    21,   152,
-      29,     0,     0,     0,    22,     0,    23,    24,     0,    25,
-       9,    26,    27,    28,    19,    20,    21,   153,    29,     0,
-       0,     0,    22,     0,    23,    24,     0,    25,     0,    26,
-      27,    28,     0,     0,     0,     0,    29,    53,    54,    55,
-      56,    57,     0,    58,    53,    54,    55,    56,    57,     0,
-      58,     0,    59,     0,     0,     0,     0,    96,     0,    59,
-       0,     0,     0,     0,    97,    53,    54,    55,    56,    57,
-       0,    58,    53,    54,    55,    56,    57,     0,    58,     0,
-      59,     0,     0,     0,     0,    98,     0,    59,     0,     0,
-       0,     0,   102,    53,    54,    55,    56,    57,     0,    58,
-      53,    54,    55,    56,    57,     0,    58,     0,    59,     0,
-       0,     0,     0,   127,     0,    59,    60,    53,    54,    55,
-      56,    57,     0,    58,    53,    54,    55,    56,    57,     0,
-      58,     0,    59,    76,    53,    54,    55,    56,   -53,    59,
-      53,    54,    55,    56,    57,     0,     0,     0,     0,    59,
-       0,     0,     0,     0,     0,    59
+      10,   -54,    93,    52,     9,    68,    16,    18,    59,    37,
+      66,    93,    93,     9,     9,    40,    18,    18,    67,     8,
+      93,    66,     9,    63,    11,    18,    98,    50,   109,    67,
+      37,    94,     9,   116,    65,    18,    37,    70,    97,    52,
+     108,   112,     9,    57,    58,    59,   124,    98,   111,   115,
+     114,    53,    98,    93,   104,     9,    12,    69,    18,   110,
+      63,    87,   105,   113,   114,    98,    37,    13,    52,    99,
+      93,   114,     9,    38,    17,    18,    39,   113,    41,   114,
+      42,    52,   122,   134,   113,     1,     2,    90,   137,     3,
+      99,    99,   113,    99,    46,    99,   117,    47,    63,   123,
+      93,    93,     9,     9,    54,    18,    18,    99,    99,   125,
+      71,   147,   126,   150,    99,    43,    45,    73,    52,    48,
+      49,    52,    99,    76,    51,    78,    99,    56,   103,   127,
+     132,    99,   138,    92,    72,   140,   118,   129,   130,    74,
+      75,   119,    37,   139,    37,    37,    56,   128,    37,   133,
+      81,    82,    83,    84,    85,    86,   142,   141,   143,    88,
+      89,   145,    56,   148,   144,   151,   152,     9,   146,   154,
+      18,    19,    20,    21,     1,     2,    15,     0,    14,    22,
+       0,    23,    24,    56,    25,    26,    27,     9,    28,    29,
+      30,    19,    20,    21,     0,    31,     0,   120,   121,    22,
+       0,    23,    24,     0,    25,    26,    27,     0,    28,    29,
+      30,     0,     9,     0,    55,    31,    19,    20,    21,     0,
+       0,     0,    56,    56,    22,     0,    23,    24,     0,    25,
+      26,    27,     0,    28,    29,    30,     0,     0,    56,    79,
+      31,    56,     0,     0,    56,    56,     9,    56,     0,     0,
+      19,    20,    21,     0,     0,     0,     0,     0,    22,     0,
+      23,    24,     0,    25,    26,    27,     9,    28,    29,    30,
+      19,    20,    21,    91,    31,     0,     0,     0,    22,     0,
+      23,    24,     0,    25,    26,    27,     9,    28,    29,    30,
+      19,    20,    21,   107,    31,     0,     0,     0,    22,     0,
+      23,    24,     0,    25,    26,    27,     9,    28,    29,    30,
+      19,    20,    21,   135,    31,     0,     0,     0,    22,     0,
+      23,    24,     0,    25,    26,    27,     9,    28,    29,    30,
+      19,    20,    21,   136,    31,     0,     0,     0,    22,     0,
+      23,    24,     0,    25,    26,    27,     9,    28,    29,    30,
+      19,    20,    21,   149,    31,     0,     0,     0,    22,     0,
+      23,    24,     0,    25,    26,    27,     9,    28,    29,    30,
+      19,    20,    21,   153,    31,     0,     0,     0,    22,     0,
+      23,    24,     0,    25,    26,    27,     9,    28,    29,    30,
+      19,    20,    21,   155,    31,     0,     0,     0,    22,     0,
+      23,    24,     0,    25,    26,    27,     9,    28,    29,    30,
+      19,    20,    21,   156,    31,     0,     0,     0,    22,     0,
+      23,    24,     0,    25,    26,    27,     9,    28,    29,    30,
+      19,    20,    21,   157,    31,     0,     0,     0,    22,     0,
+      23,    24,     0,    25,    26,    27,     0,    28,    29,    30,
+      57,    58,    59,   -55,    31,    57,    58,    59,    60,    61,
+       0,    62,    57,    58,    59,    60,    61,    63,    62,     0,
+       0,     0,    63,     0,     0,     0,     0,    77,     0,    63,
+       0,     0,     0,     0,   100,    57,    58,    59,    60,    61,
+       0,    62,    57,    58,    59,    60,    61,     0,    62,     0,
+       0,     0,    63,     0,     0,     0,     0,   101,     0,    63,
+       0,     0,     0,     0,   102,    57,    58,    59,    60,    61,
+       0,    62,    57,    58,    59,    60,    61,     0,    62,     0,
+       0,     0,    63,     0,     0,     0,     0,   106,     0,    63,
+       0,     0,     0,     0,   131,    57,    58,    59,    60,    61,
+       0,    62,    57,    58,    59,    60,    61,     0,    62,     0,
+       0,     0,    63,    64,    57,    58,    59,    60,   -55,    63,
+      80,    57,    58,    59,    60,    61,     0,    62,     0,     0,
+       0,    63,    57,    58,    59,    60,    61,     0,    63,     0,
+       0,     0,     0,     0,     0,     0,     0,     0,     0,    63
 };
 
 static const yytype_int16 yycheck[] =
 {
-       2,     4,    91,    30,     5,    14,     8,    36,    88,    11,
-       5,    29,     3,    93,     5,    17,   105,     8,    27,     3,
-       0,     5,    23,   112,     8,    27,   106,    33,    30,     6,
-      31,   120,    34,    23,    36,    37,    29,    64,    67,    30,
-       6,    31,     3,     3,     5,     5,    30,     8,     8,     3,
-       3,     5,     5,    31,     8,     8,    23,    59,     3,    88,
-       5,    30,    64,     8,    31,    67,    93,    36,     5,    30,
-      30,     8,    31,     3,    31,     5,    30,    30,     8,   106,
-      31,    12,    13,    14,    15,    30,    88,    89,    28,    91,
-      29,    93,    94,    28,    32,    64,    27,    12,    13,    14,
-      30,    29,    31,   105,   106,   107,    32,    27,   110,    31,
-     112,   140,    27,   142,    31,    29,   143,    29,   120,   146,
-       3,     4,   124,    21,     7,    22,    23,   129,   130,     3,
-       4,   133,    29,     7,    29,    32,    32,    29,   140,    32,
-     142,   143,    39,    29,   146,   114,   115,    44,    45,     6,
-      -1,    -1,    49,    -1,    67,    -1,    53,    54,    55,    56,
-      57,    58,    -1,    -1,    -1,    62,    63,    -1,    65,   138,
-      -1,   140,    -1,   142,   143,    88,    89,   146,    91,    -1,
-      93,    12,    13,    14,    15,    16,    -1,    18,    -1,    86,
-      -1,    -1,   105,   106,    -1,    -1,    27,    -1,    -1,   112,
-      -1,    32,    -1,   100,   101,    -1,    -1,   120,    -1,    -1,
-      -1,   124,    -1,    -1,    -1,    -1,   129,    -1,    -1,     5,
-      -1,    -1,     8,     9,    10,    11,    -1,    -1,   125,   126,
-      -1,    17,    -1,    19,    20,    -1,    22,    -1,    24,    25,
-      26,    -1,    -1,    -1,   141,    31,    -1,   144,    -1,    -1,
-     147,   148,     5,   150,    -1,    -1,     9,    10,    11,    -1,
-      -1,    -1,    -1,    -1,    17,    -1,    19,    20,    -1,    22,
-       5,    24,    25,    26,     9,    10,    11,    30,    31,    -1,
-      -1,    -1,    17,    -1,    19,    20,    -1,    22,     5,    24,
-      25,    26,     9,    10,    11,    30,    31,    -1,    -1,    -1,
-      17,    -1,    19,    20,    -1,    22,     5,    24,    25,    26,
-       9,    10,    11,    30,    31,    -1,    -1,    -1,    17,    -1,
-      19,    20,    -1,    22,     5,    24,    25,    26,     9,    10,
-      11,    30,    31,    -1,    -1,    -1,    17,    -1,    19,    20,
-      -1,    22,     5,    24,    25,    26,     9,    10,    11,    30,
-      31,    -1,    -1,    -1,    17,    -1,    19,    20,    -1,    22,
-       5,    24,    25,    26,     9,    10,    11,    30,    31,    -1,
-      -1,    -1,    17,    -1,    19,    20,    -1,    22,     5,    24,
-      25,    26,     9,    10,    11,    30,    31,    -1,    -1,    -1,
-      17,    -1,    19,    20,    -1,    22,     5,    24,    25,    26,
-       9,    10,    11,    30,    31,    -1,    -1,    -1,    17,    -1,
-      19,    20,    -1,    22,     5,    24,    25,    26,     9,    10,
-      11,    30,    31,    -1,    -1,    -1,    17,    -1,    19,    20,
-      -1,    22,     5,    24,    25,    26,     9,    10,    11,    30,
-      31,    -1,    -1,    -1,    17,    -1,    19,    20,    -1,    22,
-       5,    24,    25,    26,     9,    10,    11,    30,    31,    -1,
-      -1,    -1,    17,    -1,    19,    20,    -1,    22,    -1,    24,
-      25,    26,    -1,    -1,    -1,    -1,    31,    12,    13,    14,
-      15,    16,    -1,    18,    12,    13,    14,    15,    16,    -1,
-      18,    -1,    27,    -1,    -1,    -1,    -1,    32,    -1,    27,
-      -1,    -1,    -1,    -1,    32,    12,    13,    14,    15,    16,
+       2,     5,     3,    32,     5,    38,     8,     8,    14,    11,
+      25,     3,     3,     5,     5,    17,     8,     8,    33,     4,
+       3,    25,     5,    29,    31,     8,    71,    29,    92,    33,
+      32,    32,     5,    97,    36,     8,    38,    39,    71,    68,
+      32,    32,     5,    12,    13,    14,   110,    92,    93,    32,
+      95,    32,    97,     3,    25,     5,     0,    38,     8,    92,
+      29,    63,    33,    95,   109,   110,    68,    35,    97,    71,
+       3,   116,     5,    31,     6,     8,     6,   109,    33,   124,
+      33,   110,    32,   128,   116,     3,     4,    68,   133,     7,
+      92,    93,   124,    95,    33,    97,    98,    33,    29,    32,
+       3,     3,     5,     5,    30,     8,     8,   109,   110,   111,
+      31,   144,   114,   146,   116,    22,    23,    34,   147,    26,
+      27,   150,   124,    33,    31,    30,   128,    34,    34,    32,
+      32,   133,   134,    31,    41,   137,    31,   118,   119,    46,
+      47,    31,   144,    21,   146,   147,    53,    33,   150,    33,
+      57,    58,    59,    60,    61,    62,    31,    34,    34,    66,
+      67,   142,    69,   144,    31,   146,   147,     5,    31,   150,
+       8,     9,    10,    11,     3,     4,     6,    -1,     7,    17,
+      -1,    19,    20,    90,    22,    23,    24,     5,    26,    27,
+      28,     9,    10,    11,    -1,    33,    -1,   104,   105,    17,
+      -1,    19,    20,    -1,    22,    23,    24,    -1,    26,    27,
+      28,    -1,     5,    -1,    32,    33,     9,    10,    11,    -1,
+      -1,    -1,   129,   130,    17,    -1,    19,    20,    -1,    22,
+      23,    24,    -1,    26,    27,    28,    -1,    -1,   145,    32,
+      33,   148,    -1,    -1,   151,   152,     5,   154,    -1,    -1,
+       9,    10,    11,    -1,    -1,    -1,    -1,    -1,    17,    -1,
+      19,    20,    -1,    22,    23,    24,     5,    26,    27,    28,
+       9,    10,    11,    32,    33,    -1,    -1,    -1,    17,    -1,
+      19,    20,    -1,    22,    23,    24,     5,    26,    27,    28,
+       9,    10,    11,    32,    33,    -1,    -1,    -1,    17,    -1,
+      19,    20,    -1,    22,    23,    24,     5,    26,    27,    28,
+       9,    10,    11,    32,    33,    -1,    -1,    -1,    17,    -1,
+      19,    20,    -1,    22,    23,    24,     5,    26,    27,    28,
+       9,    10,    11,    32,    33,    -1,    -1,    -1,    17,    -1,
+      19,    20,    -1,    22,    23,    24,     5,    26,    27,    28,
+       9,    10,    11,    32,    33,    -1,    -1,    -1,    17,    -1,
+      19,    20,    -1,    22,    23,    24,     5,    26,    27,    28,
+       9,    10,    11,    32,    33,    -1,    -1,    -1,    17,    -1,
+      19,    20,    -1,    22,    23,    24,     5,    26,    27,    28,
+       9,    10,    11,    32,    33,    -1,    -1,    -1,    17,    -1,
+      19,    20,    -1,    22,    23,    24,     5,    26,    27,    28,
+       9,    10,    11,    32,    33,    -1,    -1,    -1,    17,    -1,
+      19,    20,    -1,    22,    23,    24,     5,    26,    27,    28,
+       9,    10,    11,    32,    33,    -1,    -1,    -1,    17,    -1,
+      19,    20,    -1,    22,    23,    24,    -1,    26,    27,    28,
+      12,    13,    14,    15,    33,    12,    13,    14,    15,    16,
+      -1,    18,    12,    13,    14,    15,    16,    29,    18,    -1,
+      -1,    -1,    29,    -1,    -1,    -1,    -1,    34,    -1,    29,
+      -1,    -1,    -1,    -1,    34,    12,    13,    14,    15,    16,
+      -1,    18,    12,    13,    14,    15,    16,    -1,    18,    -1,
+      -1,    -1,    29,    -1,    -1,    -1,    -1,    34,    -1,    29,
+      -1,    -1,    -1,    -1,    34,    12,    13,    14,    15,    16,
+      -1,    18,    12,    13,    14,    15,    16,    -1,    18,    -1,
+      -1,    -1,    29,    -1,    -1,    -1,    -1,    34,    -1,    29,
+      -1,    -1,    -1,    -1,    34,    12,    13,    14,    15,    16,
       -1,    18,    12,    13,    14,    15,    16,    -1,    18,    -1,
-      27,    -1,    -1,    -1,    -1,    32,    -1,    27,    -1,    -1,
-      -1,    -1,    32,    12,    13,    14,    15,    16,    -1,    18,
-      12,    13,    14,    15,    16,    -1,    18,    -1,    27,    -1,
-      -1,    -1,    -1,    32,    -1,    27,    28,    12,    13,    14,
-      15,    16,    -1,    18,    12,    13,    14,    15,    16,    -1,
-      18,    -1,    27,    28,    12,    13,    14,    15,    16,    27,
-      12,    13,    14,    15,    16,    -1,    -1,    -1,    -1,    27,
-      -1,    -1,    -1,    -1,    -1,    27
+      -1,    -1,    29,    30,    12,    13,    14,    15,    16,    29,
+      30,    12,    13,    14,    15,    16,    -1,    18,    -1,    -1,
+      -1,    29,    12,    13,    14,    15,    16,    -1,    29,    -1,
+      -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    29
 };
 
 /* YYSTOS[STATE-NUM] -- The symbol kind of the accessing symbol of
    state STATE-NUM.  */
 static const yytype_int8 yystos[] =
 {
-       0,     3,     4,     7,    35,    36,    37,    38,     4,     5,
-      46,    29,     0,    33,     7,    38,    46,     6,     8,     9,
-      10,    11,    17,    19,    20,    22,    24,    25,    26,    31,
-      41,    42,    43,    44,    45,    46,    29,     6,    46,    31,
-      31,    44,    46,    44,    31,    31,    46,    44,    42,    43,
-      28,    30,    44,    12,    13,    14,    15,    16,    18,    27,
-      28,    46,    23,    31,    41,    43,    46,    29,    44,    32,
-      44,    44,    31,    32,    28,    30,    28,    44,    44,    44,
-      44,    44,    44,    46,    44,    44,    43,    30,    29,     3,
-      30,    39,    40,    41,    45,    46,    32,    32,    32,    32,
-      23,    31,    32,    30,    30,    39,    41,    45,    30,    40,
-      45,    30,    39,    46,    29,    29,    44,    44,    30,    30,
-      39,    46,    46,    30,    31,    43,    43,    32,    30,    31,
-      45,    30,    30,    45,    46,    21,    46,    32,    29,    32,
-      29,    43,    29,    41,    43,    30,    41,    43,    43,    30,
-      43,    30,    30,    30
+       0,     3,     4,     7,    37,    38,    39,    40,     4,     5,
+      48,    31,     0,    35,     7,    40,    48,     6,     8,     9,
+      10,    11,    17,    19,    20,    22,    23,    24,    26,    27,
+      28,    33,    43,    44,    45,    46,    47,    48,    31,     6,
+      48,    33,    33,    46,    48,    46,    33,    33,    46,    46,
+      48,    46,    44,    45,    30,    32,    46,    12,    13,    14,
+      15,    16,    18,    29,    30,    48,    25,    33,    43,    45,
+      48,    31,    46,    34,    46,    46,    33,    34,    30,    32,
+      30,    46,    46,    46,    46,    46,    46,    48,    46,    46,
+      45,    32,    31,     3,    32,    41,    42,    43,    47,    48,
+      34,    34,    34,    34,    25,    33,    34,    32,    32,    41,
+      43,    47,    32,    42,    47,    32,    41,    48,    31,    31,
+      46,    46,    32,    32,    41,    48,    48,    32,    33,    45,
+      45,    34,    32,    33,    47,    32,    32,    47,    48,    21,
+      48,    34,    31,    34,    31,    45,    31,    43,    45,    32,
+      43,    45,    45,    32,    45,    32,    32,    32
 };
 
 /* YYR1[RULE-NUM] -- Symbol kind of the left-hand side of rule RULE-NUM.  */
 static const yytype_int8 yyr1[] =
 {
-       0,    34,    35,    36,    36,    36,    36,    37,    37,    38,
-      38,    38,    38,    38,    38,    38,    38,    39,    39,    40,
-      40,    40,    40,    41,    41,    42,    43,    43,    44,    44,
-      44,    44,    44,    44,    44,    44,    44,    44,    44,    44,
-      44,    44,    44,    44,    44,    44,    44,    44,    44,    44,
-      44,    45,    45,    46
+       0,    36,    37,    38,    38,    38,    38,    39,    39,    40,
+      40,    40,    40,    40,    40,    40,    40,    41,    41,    42,
+      42,    42,    42,    43,    43,    44,    45,    45,    46,    46,
+      46,    46,    46,    46,    46,    46,    46,    46,    46,    46,
+      46,    46,    46,    46,    46,    46,    46,    46,    46,    46,
+      46,    46,    46,    47,    47,    48
 };
 
 /* YYR2[RULE-NUM] -- Number of symbols on the right-hand side of rule RULE-NUM.  */
@@ -899,8 +926,8 @@ static const yytype_int8 yyr2[] =
        7,     7,     8,     7,     8,     8,     9,     2,     1,     9,
       10,    10,    11,     3,     2,     2,     3,     2,     1,     1,
        1,     1,     4,     4,     3,     3,     6,     3,     3,     3,
-       3,     3,     2,     3,     3,     5,    11,     7,     2,     4,
-       3,     1,     1,     1
+       3,     3,     2,     2,     2,     3,     3,     5,    11,     7,
+       2,     4,     3,     1,     1,     1
 };
 
 
@@ -1364,178 +1391,178 @@ yyreduce:
   switch (yyn)
     {
   case 2: /* pgm: dj ENDOFFILE  */
-#line 50 "src/dj.y"
+#line 73 "src/dj.y"
                    {
         pgmAST = yyvsp[-1];
         return 0;
     }
-#line 1374 "src/dj.tab.c"
+#line 1401 "src/dj.tab.c"
     break;
 
   case 3: /* dj: MAIN LBRACE expression_list RBRACE  */
-#line 57 "src/dj.y"
+#line 80 "src/dj.y"
                                          {
         yyval = newAST(PROGRAM, newAST(CLASS_DECL_LIST, NULL, 0, NULL, 0), 0, NULL, yylineno);
         appendToChildrenList(yyval, newAST(VAR_DECL_LIST, NULL, 0, NULL, 0));
         appendToChildrenList(yyval, yyvsp[-1]);
     }
-#line 1384 "src/dj.tab.c"
+#line 1411 "src/dj.tab.c"
     break;
 
   case 4: /* dj: MAIN LBRACE variable_declaration_list expression_list RBRACE  */
-#line 62 "src/dj.y"
+#line 85 "src/dj.y"
                                                                    {
         yyval = newAST(PROGRAM, newAST(CLASS_DECL_LIST, NULL, 0, NULL, 0), 0, NULL, yylineno);
         appendToChildrenList(yyval, yyvsp[-2]);
         appendToChildrenList(yyval, yyvsp[-1]);
     }
-#line 1394 "src/dj.tab.c"
+#line 1421 "src/dj.tab.c"
     break;
 
   case 5: /* dj: class_list MAIN LBRACE expression_list RBRACE  */
-#line 67 "src/dj.y"
+#line 90 "src/dj.y"
                                                     {
         yyval = newAST(PROGRAM, yyvsp[-4], 0, NULL, yylineno);
         appendToChildrenList(yyval, newAST(VAR_DECL_LIST, NULL, 0, NULL, 0));
         appendToChildrenList(yyval, yyvsp[-1]);
     }
-#line 1404 "src/dj.tab.c"
+#line 1431 "src/dj.tab.c"
     break;
 
   case 6: /* dj: class_list MAIN LBRACE variable_declaration_list expression_list RBRACE  */
-#line 72 "src/dj.y"
+#line 95 "src/dj.y"
                                                                               {
         yyval = newAST(PROGRAM, yyvsp[-5], 0, NULL, yylineno);
         appendToChildrenList(yyval, yyvsp[-2]);
         appendToChildrenList(yyval, yyvsp[-1]);
     }
-#line 1414 "src/dj.tab.c"
+#line 1441 "src/dj.tab.c"
     break;
 
   case 7: /* class_list: class_list class  */
-#line 81 "src/dj.y"
+#line 104 "src/dj.y"
                        {
         yyval = yyvsp[-1];
         appendToChildrenList(yyval, yyvsp[0]);
     }
-#line 1423 "src/dj.tab.c"
+#line 1450 "src/dj.tab.c"
     break;
 
   case 8: /* class_list: class  */
-#line 85 "src/dj.y"
+#line 108 "src/dj.y"
             {
         yyval = newAST(CLASS_DECL_LIST, yyvsp[0], 0, NULL, yylineno);
     }
-#line 1431 "src/dj.tab.c"
+#line 1458 "src/dj.tab.c"
     break;
 
   case 9: /* class: CLASS identifier EXTENDS identifier LBRACE RBRACE  */
-#line 91 "src/dj.y"
+#line 114 "src/dj.y"
                                                         {
         yyval = newAST(NONFINAL_CLASS_DECL, yyvsp[-4], 0, NULL, yylineno);
         appendToChildrenList(yyval, yyvsp[-2]);
         appendToChildrenList(yyval, newAST(VAR_DECL_LIST, NULL, 0, NULL, 0));
         appendToChildrenList(yyval, newAST(METHOD_DECL_LIST, NULL, 0, NULL, 0));
     }
-#line 1442 "src/dj.tab.c"
+#line 1469 "src/dj.tab.c"
     break;
 
   case 10: /* class: CLASS identifier EXTENDS identifier LBRACE variable_declaration_list RBRACE  */
-#line 97 "src/dj.y"
+#line 120 "src/dj.y"
                                                                                   {
         yyval = newAST(NONFINAL_CLASS_DECL, yyvsp[-5], 0, NULL, yylineno);
         appendToChildrenList(yyval, yyvsp[-3]);
         appendToChildrenList(yyval, yyvsp[-1]);
         appendToChildrenList(yyval, newAST(METHOD_DECL_LIST, NULL, 0, NULL, 0));
     }
-#line 1453 "src/dj.tab.c"
+#line 1480 "src/dj.tab.c"
     break;
 
   case 11: /* class: CLASS identifier EXTENDS identifier LBRACE method_list RBRACE  */
-#line 103 "src/dj.y"
+#line 126 "src/dj.y"
                                                                     {
         yyval = newAST(NONFINAL_CLASS_DECL, yyvsp[-5], 0, NULL, yylineno);
         appendToChildrenList(yyval, yyvsp[-3]);
         appendToChildrenList(yyval, newAST(VAR_DECL_LIST, NULL, 0, NULL, 0));
         appendToChildrenList(yyval, yyvsp[-1]);
     }
-#line 1464 "src/dj.tab.c"
+#line 1491 "src/dj.tab.c"
     break;
 
   case 12: /* class: CLASS identifier EXTENDS identifier LBRACE variable_declaration_list method_list RBRACE  */
-#line 109 "src/dj.y"
+#line 132 "src/dj.y"
                                                                                               {
         yyval = newAST(NONFINAL_CLASS_DECL, yyvsp[-6], 0, NULL, yylineno);
         appendToChildrenList(yyval, yyvsp[-4]);
         appendToChildrenList(yyval, yyvsp[-2]);
         appendToChildrenList(yyval, yyvsp[-1]);
     }
-#line 1475 "src/dj.tab.c"
+#line 1502 "src/dj.tab.c"
     break;
 
   case 13: /* class: FINAL CLASS identifier EXTENDS identifier LBRACE RBRACE  */
-#line 115 "src/dj.y"
+#line 138 "src/dj.y"
                                                               {
         yyval = newAST(FINAL_CLASS_DECL, yyvsp[-4], 0, NULL, yylineno);
         appendToChildrenList(yyval, yyvsp[-2]);
         appendToChildrenList(yyval, newAST(VAR_DECL_LIST, NULL, 0, NULL, 0));
         appendToChildrenList(yyval, newAST(METHOD_DECL_LIST, NULL, 0, NULL, 0));
     }
-#line 1486 "src/dj.tab.c"
+#line 1513 "src/dj.tab.c"
     break;
 
   case 14: /* class: FINAL CLASS identifier EXTENDS identifier LBRACE variable_declaration_list RBRACE  */
-#line 121 "src/dj.y"
+#line 144 "src/dj.y"
                                                                                         {
         yyval = newAST(FINAL_CLASS_DECL, yyvsp[-5], 0, NULL, yylineno);
         appendToChildrenList(yyval, yyvsp[-3]);
         appendToChildrenList(yyval, yyvsp[-1]);
         appendToChildrenList(yyval, newAST(METHOD_DECL_LIST, NULL, 0, NULL, 0));
     }
-#line 1497 "src/dj.tab.c"
+#line 1524 "src/dj.tab.c"
     break;
 
   case 15: /* class: FINAL CLASS identifier EXTENDS identifier LBRACE method_list RBRACE  */
-#line 127 "src/dj.y"
+#line 150 "src/dj.y"
                                                                           {
         yyval = newAST(FINAL_CLASS_DECL, yyvsp[-5], 0, NULL, yylineno);
         appendToChildrenList(yyval, yyvsp[-3]);
         appendToChildrenList(yyval, newAST(VAR_DECL_LIST, NULL, 0, NULL, 0));
         appendToChildrenList(yyval, yyvsp[-1]);   
     }
-#line 1508 "src/dj.tab.c"
+#line 1535 "src/dj.tab.c"
     break;
 
   case 16: /* class: FINAL CLASS identifier EXTENDS identifier LBRACE variable_declaration_list method_list RBRACE  */
-#line 133 "src/dj.y"
+#line 156 "src/dj.y"
                                                                                                     {
         yyval = newAST(FINAL_CLASS_DECL, yyvsp[-6], 0, NULL, yylineno);
         appendToChildrenList(yyval, yyvsp[-4]);
         appendToChildrenList(yyval, yyvsp[-2]);
         appendToChildrenList(yyval, yyvsp[-1]);
     }
-#line 1519 "src/dj.tab.c"
+#line 1546 "src/dj.tab.c"
     break;
 
   case 17: /* method_list: method_list method  */
-#line 142 "src/dj.y"
+#line 165 "src/dj.y"
                          {
         yyval = yyvsp[-1];
         appendToChildrenList(yyval, yyvsp[0]);
     }
-#line 1528 "src/dj.tab.c"
+#line 1555 "src/dj.tab.c"
     break;
 
   case 18: /* method_list: method  */
-#line 146 "src/dj.y"
+#line 169 "src/dj.y"
              {
         yyval = newAST(METHOD_DECL_LIST, yyvsp[0], 0, NULL, yylineno);
     }
-#line 1536 "src/dj.tab.c"
+#line 1563 "src/dj.tab.c"
     break;
 
   case 19: /* method: data_type identifier LPAREN data_type identifier RPAREN LBRACE expression_list RBRACE  */
-#line 152 "src/dj.y"
+#line 175 "src/dj.y"
                                                                                             {
         yyval = newAST(NONFINAL_METHOD_DECL, yyvsp[-8], 0, NULL, yylineno);
         appendToChildrenList(yyval, yyvsp[-7]);
@@ -1544,11 +1571,11 @@ yyreduce:
         appendToChildrenList(yyval, newAST(VAR_DECL_LIST, NULL, 0, NULL, 0));
         appendToChildrenList(yyval, yyvsp[-1]);
     }
-#line 1549 "src/dj.tab.c"
+#line 1576 "src/dj.tab.c"
     break;
 
   case 20: /* method: data_type identifier LPAREN data_type identifier RPAREN LBRACE variable_declaration_list expression_list RBRACE  */
-#line 160 "src/dj.y"
+#line 183 "src/dj.y"
                                                                                                                       {
         yyval = newAST(NONFINAL_METHOD_DECL, yyvsp[-9], 0, NULL, yylineno);
         appendToChildrenList(yyval, yyvsp[-8]);
@@ -1557,11 +1584,11 @@ yyreduce:
         appendToChildrenList(yyval, yyvsp[-2]);
         appendToChildrenList(yyval, yyvsp[-1]);
     }
-#line 1562 "src/dj.tab.c"
+#line 1589 "src/dj.tab.c"
     break;
 
   case 21: /* method: FINAL data_type identifier LPAREN data_type identifier RPAREN LBRACE expression_list RBRACE  */
-#line 168 "src/dj.y"
+#line 191 "src/dj.y"
                                                                                                   {
         yyval = newAST(FINAL_METHOD_DECL, yyvsp[-8], 0, NULL, yylineno);
         appendToChildrenList(yyval, yyvsp[-7]);
@@ -1570,11 +1597,11 @@ yyreduce:
         appendToChildrenList(yyval, newAST(VAR_DECL_LIST, NULL, 0, NULL, 0));
         appendToChildrenList(yyval, yyvsp[-1]);
     }
-#line 1575 "src/dj.tab.c"
+#line 1602 "src/dj.tab.c"
     break;
 
   case 22: /* method: FINAL data_type identifier LPAREN data_type identifier RPAREN LBRACE variable_declaration_list expression_list RBRACE  */
-#line 176 "src/dj.y"
+#line 199 "src/dj.y"
                                                                                                                             {
         yyval = newAST(FINAL_METHOD_DECL, yyvsp[-9], 0, NULL, yylineno);
         appendToChildrenList(yyval, yyvsp[-8]);
@@ -1583,278 +1610,294 @@ yyreduce:
         appendToChildrenList(yyval, yyvsp[-2]);
         appendToChildrenList(yyval, yyvsp[-1]);
     }
-#line 1588 "src/dj.tab.c"
+#line 1615 "src/dj.tab.c"
     break;
 
   case 23: /* variable_declaration_list: variable_declaration_list variable_declaration SEMICOLON  */
-#line 187 "src/dj.y"
+#line 210 "src/dj.y"
                                                                {
         yyval = yyvsp[-2];
         appendToChildrenList(yyval, yyvsp[-1]);
     }
-#line 1597 "src/dj.tab.c"
+#line 1624 "src/dj.tab.c"
     break;
 
   case 24: /* variable_declaration_list: variable_declaration SEMICOLON  */
-#line 191 "src/dj.y"
+#line 214 "src/dj.y"
                                      {
         yyval = newAST(VAR_DECL_LIST, yyvsp[-1], 0, NULL, yylineno);
     }
-#line 1605 "src/dj.tab.c"
+#line 1632 "src/dj.tab.c"
     break;
 
   case 25: /* variable_declaration: data_type identifier  */
-#line 197 "src/dj.y"
+#line 220 "src/dj.y"
                            {
         yyval = newAST(VAR_DECL, yyvsp[-1], 0, NULL, yylineno);
         appendToChildrenList(yyval, yyvsp[0]);
     }
-#line 1614 "src/dj.tab.c"
+#line 1641 "src/dj.tab.c"
     break;
 
   case 26: /* expression_list: expression_list expression SEMICOLON  */
-#line 204 "src/dj.y"
+#line 227 "src/dj.y"
                                            {
         yyval = yyvsp[-2];
         appendToChildrenList(yyval, yyvsp[-1]);
     }
-#line 1623 "src/dj.tab.c"
+#line 1650 "src/dj.tab.c"
     break;
 
   case 27: /* expression_list: expression SEMICOLON  */
-#line 208 "src/dj.y"
+#line 231 "src/dj.y"
                            {
         yyval = newAST(EXPR_LIST, yyvsp[-1], 0, NULL, yylineno);
     }
-#line 1631 "src/dj.tab.c"
+#line 1658 "src/dj.tab.c"
     break;
 
   case 28: /* expression: NUL  */
-#line 214 "src/dj.y"
+#line 237 "src/dj.y"
           { 
         yyval = newAST(NULL_EXPR, NULL, 0, NULL, yylineno);
     }
-#line 1639 "src/dj.tab.c"
+#line 1666 "src/dj.tab.c"
     break;
 
   case 29: /* expression: NATLITERAL  */
-#line 217 "src/dj.y"
+#line 240 "src/dj.y"
                  { 
         yyval = newAST(NAT_LITERAL_EXPR, NULL, atoi(yytext), NULL, yylineno);
     }
-#line 1647 "src/dj.tab.c"
+#line 1674 "src/dj.tab.c"
     break;
 
   case 30: /* expression: identifier  */
-#line 220 "src/dj.y"
+#line 243 "src/dj.y"
                  { 
         yyval = newAST(ID_EXPR, yyvsp[0], 0, NULL, yylineno);
     }
-#line 1655 "src/dj.tab.c"
+#line 1682 "src/dj.tab.c"
     break;
 
   case 31: /* expression: THIS  */
-#line 223 "src/dj.y"
+#line 246 "src/dj.y"
            { 
         yyval = newAST(THIS_EXPR, NULL, 0, NULL, yylineno); 
     }
-#line 1663 "src/dj.tab.c"
+#line 1690 "src/dj.tab.c"
     break;
 
   case 32: /* expression: identifier LPAREN expression RPAREN  */
-#line 226 "src/dj.y"
+#line 249 "src/dj.y"
                                           { 
         yyval = newAST(METHOD_CALL_EXPR, yyvsp[-3], 0, NULL, yylineno); 
         appendToChildrenList(yyval, yyvsp[-1]); 
     }
-#line 1672 "src/dj.tab.c"
+#line 1699 "src/dj.tab.c"
     break;
 
   case 33: /* expression: NEW identifier LPAREN RPAREN  */
-#line 230 "src/dj.y"
+#line 253 "src/dj.y"
                                    { 
         yyval = newAST(NEW_EXPR, yyvsp[-2], 0, NULL, yylineno); 
     }
-#line 1680 "src/dj.tab.c"
+#line 1707 "src/dj.tab.c"
     break;
 
   case 34: /* expression: LPAREN expression RPAREN  */
-#line 233 "src/dj.y"
+#line 256 "src/dj.y"
                                { 
         yyval = yyvsp[-1];
     }
-#line 1688 "src/dj.tab.c"
+#line 1715 "src/dj.tab.c"
     break;
 
   case 35: /* expression: expression DOT identifier  */
-#line 236 "src/dj.y"
+#line 259 "src/dj.y"
                                 {
         yyval = newAST(DOT_ID_EXPR, yyvsp[-2], 0, NULL, yylineno);
         appendToChildrenList(yyval, yyvsp[0]);
     }
-#line 1697 "src/dj.tab.c"
+#line 1724 "src/dj.tab.c"
     break;
 
   case 36: /* expression: expression DOT identifier LPAREN expression RPAREN  */
-#line 240 "src/dj.y"
+#line 263 "src/dj.y"
                                                          {
         yyval = newAST(DOT_METHOD_CALL_EXPR, yyvsp[-5], 0, NULL, yylineno);
         appendToChildrenList(yyval, yyvsp[-3]);
         appendToChildrenList(yyval, yyvsp[-1]);
     }
-#line 1707 "src/dj.tab.c"
+#line 1734 "src/dj.tab.c"
     break;
 
   case 37: /* expression: expression PLUS expression  */
-#line 245 "src/dj.y"
+#line 268 "src/dj.y"
                                  {
         yyval = newAST(PLUS_EXPR, yyvsp[-2], 0, NULL, yylineno);
         appendToChildrenList(yyval, yyvsp[0]);
     }
-#line 1716 "src/dj.tab.c"
+#line 1743 "src/dj.tab.c"
     break;
 
   case 38: /* expression: expression MINUS expression  */
-#line 249 "src/dj.y"
+#line 272 "src/dj.y"
                                   {
         yyval = newAST(MINUS_EXPR, yyvsp[-2], 0, NULL, yylineno);
         appendToChildrenList(yyval, yyvsp[0]);
     }
-#line 1725 "src/dj.tab.c"
+#line 1752 "src/dj.tab.c"
     break;
 
   case 39: /* expression: expression TIMES expression  */
-#line 253 "src/dj.y"
+#line 276 "src/dj.y"
                                   {
         yyval = newAST(TIMES_EXPR, yyvsp[-2], 0, NULL, yylineno);
         appendToChildrenList(yyval, yyvsp[0]);
     }
-#line 1734 "src/dj.tab.c"
+#line 1761 "src/dj.tab.c"
     break;
 
   case 40: /* expression: expression EQUALITY expression  */
-#line 257 "src/dj.y"
+#line 280 "src/dj.y"
                                      {
         yyval = newAST(EQUALITY_EXPR, yyvsp[-2], 0, NULL, yylineno);
         appendToChildrenList(yyval, yyvsp[0]);
     }
-#line 1743 "src/dj.tab.c"
+#line 1770 "src/dj.tab.c"
     break;
 
   case 41: /* expression: expression LESS expression  */
-#line 261 "src/dj.y"
+#line 284 "src/dj.y"
                                  {
         yyval = newAST(LESS_THAN_EXPR, yyvsp[-2], 0, NULL, yylineno);
         appendToChildrenList(yyval, yyvsp[0]);
     }
-#line 1752 "src/dj.tab.c"
+#line 1779 "src/dj.tab.c"
     break;
 
   case 42: /* expression: NOT expression  */
-#line 265 "src/dj.y"
+#line 288 "src/dj.y"
                      {
         yyval = newAST(NOT_EXPR, yyvsp[0], 0, NULL, yylineno);
     }
-#line 1760 "src/dj.tab.c"
+#line 1787 "src/dj.tab.c"
     break;
 
-  case 43: /* expression: expression OR expression  */
-#line 268 "src/dj.y"
+  case 43: /* expression: SPAWN expression  */
+#line 291 "src/dj.y"
+                       {
+        yyval = newAST(SPAWN_EXPR, yyvsp[0], 0, NULL, yylineno);
+    }
+#line 1795 "src/dj.tab.c"
+    break;
+
+  case 44: /* expression: JOIN expression  */
+#line 294 "src/dj.y"
+                      {
+        yyval = newAST(JOIN_EXPR, yyvsp[0], 0, NULL, yylineno);
+    }
+#line 1803 "src/dj.tab.c"
+    break;
+
+  case 45: /* expression: expression OR expression  */
+#line 297 "src/dj.y"
                                {
         yyval = newAST(OR_EXPR, yyvsp[-2], 0, NULL, yylineno);
         appendToChildrenList(yyval, yyvsp[0]);
     }
-#line 1769 "src/dj.tab.c"
+#line 1812 "src/dj.tab.c"
     break;
 
-  case 44: /* expression: identifier ASSIGN expression  */
-#line 272 "src/dj.y"
+  case 46: /* expression: identifier ASSIGN expression  */
+#line 301 "src/dj.y"
                                    {
         yyval = newAST(ASSIGN_EXPR, yyvsp[-2], 0, NULL, yylineno);
         appendToChildrenList(yyval, yyvsp[0]);
     }
-#line 1778 "src/dj.tab.c"
+#line 1821 "src/dj.tab.c"
     break;
 
-  case 45: /* expression: expression DOT identifier ASSIGN expression  */
-#line 276 "src/dj.y"
+  case 47: /* expression: expression DOT identifier ASSIGN expression  */
+#line 305 "src/dj.y"
                                                   {
         yyval = newAST(DOT_ASSIGN_EXPR, yyvsp[-4], 0, NULL, yylineno);
         appendToChildrenList(yyval, yyvsp[-2]);
         appendToChildrenList(yyval, yyvsp[0]);
     }
-#line 1788 "src/dj.tab.c"
+#line 1831 "src/dj.tab.c"
     break;
 
-  case 46: /* expression: IF LPAREN expression RPAREN LBRACE expression_list RBRACE ELSE LBRACE expression_list RBRACE  */
-#line 281 "src/dj.y"
+  case 48: /* expression: IF LPAREN expression RPAREN LBRACE expression_list RBRACE ELSE LBRACE expression_list RBRACE  */
+#line 310 "src/dj.y"
                                                                                                    {
         yyval = newAST(IF_THEN_ELSE_EXPR, yyvsp[-8], 0, NULL, yylineno);
         appendToChildrenList(yyval, yyvsp[-5]);
         appendToChildrenList(yyval, yyvsp[-1]);
     }
-#line 1798 "src/dj.tab.c"
+#line 1841 "src/dj.tab.c"
     break;
 
-  case 47: /* expression: WHILE LPAREN expression RPAREN LBRACE expression_list RBRACE  */
-#line 286 "src/dj.y"
+  case 49: /* expression: WHILE LPAREN expression RPAREN LBRACE expression_list RBRACE  */
+#line 315 "src/dj.y"
                                                                    {
         yyval = newAST(WHILE_EXPR, yyvsp[-4], 0, NULL, yylineno);
         appendToChildrenList(yyval, yyvsp[-1]);
     }
-#line 1807 "src/dj.tab.c"
+#line 1850 "src/dj.tab.c"
     break;
 
-  case 48: /* expression: ASSERT expression  */
-#line 290 "src/dj.y"
+  case 50: /* expression: ASSERT expression  */
+#line 319 "src/dj.y"
                         {
         yyval = newAST(ASSERT_EXPR, yyvsp[0], 0, NULL, yylineno);
     }
-#line 1815 "src/dj.tab.c"
+#line 1858 "src/dj.tab.c"
     break;
 
-  case 49: /* expression: PRINTNAT LPAREN expression RPAREN  */
-#line 293 "src/dj.y"
+  case 51: /* expression: PRINTNAT LPAREN expression RPAREN  */
+#line 322 "src/dj.y"
                                         {
         yyval = newAST(PRINT_EXPR, yyvsp[-1], 0, NULL, yylineno);
     }
-#line 1823 "src/dj.tab.c"
+#line 1866 "src/dj.tab.c"
     break;
 
-  case 50: /* expression: READNAT LPAREN RPAREN  */
-#line 296 "src/dj.y"
+  case 52: /* expression: READNAT LPAREN RPAREN  */
+#line 325 "src/dj.y"
                             {
         yyval = newAST(READ_EXPR, NULL, 0, NULL, yylineno);
     }
-#line 1831 "src/dj.tab.c"
+#line 1874 "src/dj.tab.c"
     break;
 
-  case 51: /* data_type: NATTYPE  */
-#line 302 "src/dj.y"
+  case 53: /* data_type: NATTYPE  */
+#line 331 "src/dj.y"
               {
         yyval = newAST(NAT_TYPE, NULL, 0, NULL, yylineno);
     }
-#line 1839 "src/dj.tab.c"
+#line 1882 "src/dj.tab.c"
     break;
 
-  case 52: /* data_type: identifier  */
-#line 305 "src/dj.y"
+  case 54: /* data_type: identifier  */
+#line 334 "src/dj.y"
                  {
         yyval = yyvsp[0];
     }
-#line 1847 "src/dj.tab.c"
+#line 1890 "src/dj.tab.c"
     break;
 
-  case 53: /* identifier: ID  */
-#line 311 "src/dj.y"
+  case 55: /* identifier: ID  */
+#line 340 "src/dj.y"
          {
         yyval = newAST(AST_ID, NULL, 0, getID(yytext), yylineno);
     }
-#line 1855 "src/dj.tab.c"
+#line 1898 "src/dj.tab.c"
     break;
 
 
-#line 1859 "src/dj.tab.c"
+#line 1902 "src/dj.tab.c"
 
       default: break;
     }
@@ -2047,17 +2090,14 @@ yyreturnlab:
   return yyresult;
 }
 
-#line 316 "src/dj.y"
+#line 345 "src/dj.y"
 
 
 int main(int argc, char **argv) {
-  if(argc!=2) {
-    printf("Usage: parsedj filename\n");
-    exit(-1);
-  }
-  yyin = fopen(argv[1],"r");
+  parseCommandLine(argc, argv);
+  yyin = fopen(options.sourceFile,"r");
   if(yyin==NULL) {
-    printf("ERROR: could not open file %s\n",argv[1]);
+    printf("ERROR: could not open file %s\n",options.sourceFile);
     exit(-1);
   }
   
@@ -2088,7 +2128,28 @@ int main(int argc, char **argv) {
 
 	/* typecheck the input program */
   typecheckProgram();
- 
+
+  /* set up profiling, before anything changes the program */
+  if (options.profileGenerate != NULL || options.profileUse != NULL)
+    numberProfileSites();
+  if (options.profileGenerate != NULL)
+    instrumentForProfile(options.profileGenerate);
+  if (options.profileUse != NULL)
+    readProfile(options.profileUse);
+
+  /* set up the heap of the compiled program */
+  configureHeap(options.heapLimit, options.heapPopulate, options.heapHugePages,
+                options.collectGarbage);
+  if (options.heapDump != NULL)
+    dumpHeapTo(options.heapDump);
+  if (options.allocStats)
+    countAllocations(options.allocStatsFile);
+  if (options.ioUring)
+    useIoUring();
+
+  /* optimize the input program */
+  runPasses();
+
   /* generate NASM code */
 	FILE *out = fopen("program.asm", "w");
 	if (out == NULL) {
@@ -2106,13 +2167,20 @@ int main(int argc, char **argv) {
       return 1;
   }
 
-  int ldStatus = system("ld program.o -o program");
+  // Link in the runtime library, whose parts the program calls
+  char library[4096];
+  char linkCommand[4200];
+  runtimeLibraryPath(library, sizeof(library));
+  snprintf(linkCommand, sizeof(linkCommand), "ld program.o '%s' -o program",
+           library);
+  int ldStatus = system(linkCommand);
   if (ldStatus != 0) {
       fprintf(stderr, "Error: Linker failed.\n");
       return 1;
   }
 
-  // Run the generated program
+  // Run the generated program, after the compiler's warnings
+  fflush(stdout);
   int runStatus = system("./program");
   printf("\n--- Program exited with code: %d ---\n", runStatus);
   
@@ -5,7 +5,13 @@
   #include "../include/ast.h"
   #include "../include/symtbl.h"
   #include "../include/typecheck.h"
+  #include "../include/profile.h"
+  #include "../include/passes.h"
   #include "../include/codegen.h"
+  #include "../include/djrt.h"
+  #include "../include/options.h"
+  #include <string.h>
+  #include <unistd.h>
     
   #define DEBUG_SYMTBL 0
   #define DEBUG_AST 0
@@ -23,11 +29,27 @@
     printf("syntax error.)\n");
     exit(-1);
   }
+
+  /* Writes to path the runtime library's path, next to the compiler's
+     executable (e.g. bin/libdjrt.a), or its bare name if that is unknown */
+  void runtimeLibraryPath(char *path, size_t size) {
+    ssize_t length = readlink("/proc/self/exe", path, size - 1);
+    char *slash = NULL;
+    if (length > 0) {
+      path[length] = '\0';
+      slash = strrchr(path, '/');
+    }
+    if (slash == NULL ||
+        (size_t)(slash + 1 - path) + strlen(DJRT_LIBRARY) >= size)
+      snprintf(path, size, "%s", DJRT_LIBRARY);
+    else
+      strcpy(slash + 1, DJRT_LIBRARY);
+  }
 }
 
 %token FINAL CLASS ID EXTENDS MAIN NATTYPE 
 %token NATLITERAL PRINTNAT READNAT PLUS MINUS TIMES EQUALITY LESS
-%token ASSERT OR NOT IF ELSE WHILE
+%token ASSERT OR NOT IF ELSE WHILE SPAWN JOIN
 %token ASSIGN NUL NEW THIS DOT 
 %token SEMICOLON LBRACE RBRACE LPAREN RPAREN
 %token ENDOFFILE
@@ -42,6 +64,7 @@
 %right NOT
 %left PLUS MINUS
 %left TIMES
+%right SPAWN JOIN
 %right DOT
 
 %%
@@ -265,6 +288,12 @@ expression
     | NOT expression {
         $$ = newAST(NOT_EXPR, $2, 0, NULL, yylineno);
     }
+    | SPAWN expression {
+        $$ = newAST(SPAWN_EXPR, $2, 0, NULL, yylineno);
+    }
+    | JOIN expression {
+        $$ = newAST(JOIN_EXPR, $2, 0, NULL, yylineno);
+    }
     | expression OR expression {
         $$ = newAST(OR_EXPR, $1, 0, NULL, yylineno);
         appendToChildrenList($$, $3);
@@ -316,13 +345,10 @@ identifier
 %%
 
 int main(int argc, char **argv) {
-  if(argc!=2) {
-    printf("Usage: parsedj filename\n");
-    exit(-1);
-  }
-  yyin = fopen(argv[1],"r");
+  parseCommandLine(argc, argv);
+  yyin = fopen(options.sourceFile,"r");
   if(yyin==NULL) {
-    printf("ERROR: could not open file %s\n",argv[1]);
+    printf("ERROR: could not open file %s\n",options.sourceFile);
     exit(-1);
   }
   
@@ -353,7 +379,28 @@ int main(int argc, char **argv) {
 
 	/* typecheck the input program */
   typecheckProgram();
- 
+
+  /* set up profiling, before anything changes the program */
+  if (options.profileGenerate != NULL || options.profileUse != NULL)
+    numberProfileSites();
+  if (options.profileGenerate != NULL)
+    instrumentForProfile(options.profileGenerate);
+  if (options.profileUse != NULL)
+    readProfile(options.profileUse);
+
+  /* set up the heap of the compiled program */
+  configureHeap(options.heapLimit, options.heapPopulate, options.heapHugePages,
+                options.collectGarbage);
+  if (options.heapDump != NULL)
+    dumpHeapTo(options.heapDump);
+  if (options.allocStats)
+    countAllocations(options.allocStatsFile);
+  if (options.ioUring)
+    useIoUring();
+
+  /* optimize the input program */
+  runPasses();
+
   /* generate NASM code */
 	FILE *out = fopen("program.asm", "w");
 	if (out == NULL) {
@@ -371,13 +418,20 @@ int main(int argc, char **argv) {
       return 1;
   }
 
-  int ldStatus = system("ld program.o -o program");
+  // Link in the runtime library, whose parts the program calls
+  char library[4096];
+  char linkCommand[4200];
+  runtimeLibraryPath(library, sizeof(library));
+  snprintf(linkCommand, sizeof(linkCommand), "ld program.o '%s' -o program",
+           library);
+  int ldStatus = system(linkCommand);
   if (ldStatus != 0) {
       fprintf(stderr, "Error: Linker failed.\n");
       return 1;
   }
 
-  // Run the generated program
+  // Run the generated program, after the compiler's warnings
+  fflush(stdout);
   int runStatus = system("./program");
   printf("\n--- Program exited with code: %d ---\n", runStatus);
   
@@ -0,0 +1,130 @@
+#include "../../include/fieldorder.h"
+#include <stdlib.h>
+
+/* Access weight of each field, indexed by class number and then variable
+   number; allocated by countAccesses */
+static long long **fieldWeights = NULL;
+
+/* The method whose code is being scanned (class -1 for the main block) */
+static int currClass, currMethod;
+
+/* Finds the field called name in class classNum or its superclasses.
+   Returns nonzero iff found, storing the declaring class and the index
+   into its varList. */
+static int findField(int classNum, char *name, int *declClass,
+                     int *declIndex) {
+  while (classNum > 0) {
+    ClassDecl *class = &classesST[classNum];
+    for (int i = 0; i < class->numVars; i++) {
+      if (strCompare(name, class->varList[i].varName)) {
+        *declClass = classNum;
+        *declIndex = i;
+        return 1;
+      }
+    }
+    classNum = class->superclass;
+  }
+  return 0;
+}
+
+/* Returns nonzero iff the identifier name refers to a field of `this`
+   in the current method, following code gen's lookup order (parameter,
+   then locals, then fields). */
+static int isThisField(char *name, int *declClass, int *declIndex) {
+  if (currClass < 0)
+    return 0;
+  MethodDecl *method = &classesST[currClass].methodList[currMethod];
+  if (strCompare(name, method->paramName))
+    return 0;
+  for (int i = 0; i < method->numLocals; i++)
+    if (strCompare(name, method->localST[i].varName))
+      return 0;
+  return findField(currClass, name, declClass, declIndex);
+}
+
+/* Adds weight to the field accesses inside t. depth is the number of
+   while loops around t. */
+static void addAccesses(ASTree *t, long long weight, int depth) {
+  if (t == NULL)
+    return;
+
+  int declClass, declIndex, found = 0;
+  if (t->typ == ID_EXPR || t->typ == ASSIGN_EXPR)
+    found = isThisField(t->children->data->idVal, &declClass, &declIndex);
+  else if (t->typ == DOT_ID_EXPR || t->typ == DOT_ASSIGN_EXPR)
+    found = findField(typeExpr(t->children->data, currClass, currMethod),
+                      t->children->next->data->idVal, &declClass,
+                      &declIndex);
+  if (found)
+    fieldWeights[declClass][declIndex] += weight;
+
+  if (t->typ == WHILE_EXPR) {
+    // The test runs once more than the body
+    addAccesses(t->children->data, weight, depth);
+    if (haveProfile())
+      weight = branchCount(t, 1);
+    else if (depth < MAX_LOOP_DEPTH)
+      weight *= LOOP_WEIGHT;
+    addAccesses(t->children->next->data, weight, depth + 1);
+    return;
+  }
+  for (ASTList *child = t->children; child != NULL; child = child->next)
+    addAccesses(child->data, weight, depth);
+}
+
+/* Scans the body of method number methodNum of class classNum */
+static void addMethodAccesses(int classNum, int methodNum, ASTree *body) {
+  currClass = classNum;
+  currMethod = methodNum;
+  addAccesses(body, haveProfile() ? methodEntryCount(classNum, methodNum) : 1,
+              0);
+}
+
+/* Computes the access weight of every field, once */
+static void countAccesses() {
+  if (fieldWeights != NULL)
+    return;
+  fieldWeights = (long long **)malloc(sizeof(long long *) * numClasses);
+  for (int i = 0; i < numClasses; i++)
+    fieldWeights[i] =
+        (long long *)calloc(classesST[i].numVars + 1, sizeof(long long));
+
+  currClass = -1;
+  currMethod = -1;
+  addAccesses(mainExprs, 1, 0);
+  for (int i = 1; i < numClasses; i++)
+    for (int j = 0; j < classesST[i].numMethods; j++)
+      addMethodAccesses(i, j, classesST[i].methodList[j].bodyExprs);
+  for (int i = 0; i < numMethodClones; i++)
+    addMethodAccesses(methodClones[i].classNum, methodClones[i].methodNum,
+                      methodClones[i].bodyExprs);
+}
+
+/* Orders each class's own fields by how often they are accessed. */
+void orderFieldsByAccess() {
+  countAccesses();
+  for (int i = 1; i < numClasses; i++)
+    for (int j = 0; j < classesST[i].numVars; j++)
+      setFieldWeight(i, j, fieldWeights[i][j]);
+}
+
+/* Aligns objects of hot classes to cache lines. */
+void alignHotClasses() {
+  countAccesses();
+  long long total = 0;
+  long long *declared = (long long *)calloc(numClasses, sizeof(long long));
+  for (int i = 1; i < numClasses; i++) {
+    for (int j = 0; j < classesST[i].numVars; j++)
+      declared[i] += fieldWeights[i][j];
+    total += declared[i];
+  }
+
+  for (int i = 1; i < numClasses; i++) {
+    long long weight = 0;
+    for (int c = i; c > 0; c = classesST[c].superclass)
+      weight += declared[c];
+    if (weight > 0 && weight * 100 >= total * HOT_CLASS_PERCENT)
+      setObjectAlignment(i, CACHE_LINE_SIZE);
+  }
+  free(declared);
+}
@@ -0,0 +1,246 @@
+#include "../../include/fold.h"
+#include <stdint.h>
+
+/* Largest value a nat literal can hold. Code gen emits literals as
+   sign-extended 32-bit immediates, so folded results must stay below it. */
+#define MAX_NAT_LITERAL 2147483647LL
+
+/* Returns nonzero iff t is a nat literal, storing its value in *value. */
+int isNatLiteral(ASTree *t, unsigned int *value) {
+  if (t == NULL || t->typ != NAT_LITERAL_EXPR)
+    return 0;
+  *value = t->natVal;
+  return 1;
+}
+
+/* Returns the run-time value of a nat literal holding value, which code
+   gen emits as a sign-extended 32-bit immediate */
+static int64_t runtimeValue(unsigned int value) {
+  return (int32_t)value;
+}
+
+/* Returns a new nat literal carrying t's line number and attributes */
+static ASTree *newLiteral(ASTree *t, unsigned int value) {
+  ASTree *literal = newAST(NAT_LITERAL_EXPR, NULL, value, NULL, t->lineNumber);
+  literal->staticClassNum = t->staticClassNum;
+  literal->staticMemberNum = t->staticMemberNum;
+  return literal;
+}
+
+/* Returns keep, one of t's children, after freeing t and its other
+   children */
+static ASTree *replaceWithChild(ASTree *t, ASTree *keep) {
+  for (ASTList *child = t->children; child != NULL; child = child->next)
+    if (child->data == keep)
+      child->data = NULL;
+  freeAST(t);
+  return keep;
+}
+
+/* Returns a nat literal holding value after freeing t */
+static ASTree *replaceWithLiteral(ASTree *t, unsigned int value) {
+  ASTree *literal = newLiteral(t, value);
+  freeAST(t);
+  return literal;
+}
+
+/* Returns nonzero iff evaluating t has no effect other than its value */
+static int isPure(ASTree *t) {
+  return t->typ == NAT_LITERAL_EXPR || t->typ == NULL_EXPR ||
+         t->typ == THIS_EXPR || t->typ == ID_EXPR;
+}
+
+/* Returns the number of expressions in the EXPR_LIST exprList */
+static int countExprs(ASTree *exprList) {
+  int count = 0;
+  for (ASTList *expr = exprList->children; expr && expr->data;
+       expr = expr->next)
+    count++;
+  return count;
+}
+
+/* Folds the expression t, whose subexpressions get folded first.
+   Returns the expression that should replace t in its parent, which is t
+   itself when nothing could be folded at the top level.
+   Sets *changed to 1 if anything in the tree changed. */
+ASTree *foldExpr(ASTree *t, int *changed) {
+  unsigned int left, right;
+
+  // Fold subexpressions and nested expression lists first
+  for (ASTList *child = t->children; child != NULL; child = child->next) {
+    if (child->data == NULL || child->data->typ == AST_ID)
+      continue;
+    if (child->data->typ == EXPR_LIST) {
+      if (foldExprs(child->data))
+        *changed = 1;
+    } else {
+      child->data = foldExpr(child->data, changed);
+    }
+  }
+
+  ASTree *first = t->children ? t->children->data : NULL;
+  ASTree *second =
+      (t->children && t->children->next) ? t->children->next->data : NULL;
+
+  switch (t->typ) {
+  case PLUS_EXPR:
+  case MINUS_EXPR:
+  case TIMES_EXPR:
+    if (isNatLiteral(first, &left) && isNatLiteral(second, &right)) {
+      // Nats are 64-bit two's complement values at run time
+      int64_t result;
+      uint64_t a = (uint64_t)runtimeValue(left);
+      uint64_t b = (uint64_t)runtimeValue(right);
+      if (t->typ == PLUS_EXPR)
+        result = (int64_t)(a + b);
+      else if (t->typ == MINUS_EXPR)
+        result = (int64_t)(a - b);
+      else
+        result = (int64_t)(a * b);
+      if (result >= 0 && result <= MAX_NAT_LITERAL) {
+        *changed = 1;
+        return replaceWithLiteral(t, (unsigned int)result);
+      }
+    }
+    // Algebraic identities: E+0, 0+E, E-0, E*1, 1*E
+    if ((t->typ != TIMES_EXPR && isNatLiteral(second, &right) && right == 0) ||
+        (t->typ == TIMES_EXPR && isNatLiteral(second, &right) && right == 1)) {
+      *changed = 1;
+      return replaceWithChild(t, first);
+    }
+    if ((t->typ == PLUS_EXPR && isNatLiteral(first, &left) && left == 0) ||
+        (t->typ == TIMES_EXPR && isNatLiteral(first, &left) && left == 1)) {
+      *changed = 1;
+      return replaceWithChild(t, second);
+    }
+    break;
+
+  case EQUALITY_EXPR:
+    if (isNatLiteral(first, &left) && isNatLiteral(second, &right)) {
+      *changed = 1;
+      return replaceWithLiteral(t, left == right);
+    }
+    break;
+
+  case LESS_THAN_EXPR:
+    if (isNatLiteral(first, &left) && isNatLiteral(second, &right)) {
+      *changed = 1;
+      // Code gen compares nats as signed 64-bit values (jl)
+      return replaceWithLiteral(t, runtimeValue(left) < runtimeValue(right));
+    }
+    break;
+
+  case NOT_EXPR:
+    if (isNatLiteral(first, &left)) {
+      *changed = 1;
+      return replaceWithLiteral(t, left == 0);
+    }
+    break;
+
+  case OR_EXPR:
+    // The right operand only runs when the left one is 0
+    if (isNatLiteral(first, &left) && left != 0) {
+      *changed = 1;
+      return replaceWithLiteral(t, 1);
+    }
+    if (isNatLiteral(first, &left) && isNatLiteral(second, &right)) {
+      *changed = 1;
+      return replaceWithLiteral(t, right != 0);
+    }
+    break;
+
+  case IF_THEN_ELSE_EXPR:
+    // A single-expression branch can stand in for the whole if-then-else;
+    // longer branches get spliced into the enclosing list by foldExprs()
+    if (isNatLiteral(first, &left)) {
+      ASTree *branch = left ? second : t->children->next->next->data;
+      if (countExprs(branch) == 1) {
+        ASTree *onlyExpr = branch->children->data;
+        branch->children->data = NULL;
+        freeAST(t);
+        *changed = 1;
+        return onlyExpr;
+      }
+    }
+    break;
+
+  case WHILE_EXPR:
+    // A loop that never runs evaluates to 0
+    if (isNatLiteral(first, &left) && left == 0) {
+      *changed = 1;
+      return replaceWithLiteral(t, 0);
+    }
+    break;
+
+  case ASSERT_EXPR:
+    // An assertion that always holds evaluates to its condition
+    if (isNatLiteral(first, &left) && left != 0) {
+      *changed = 1;
+      return replaceWithChild(t, first);
+    }
+    break;
+
+  default:
+    break;
+  }
+  return t;
+}
+
+/* Folds every expression in the EXPR_LIST exprList.
+   If-then-else expressions with a constant condition are replaced by the
+   expressions of the branch that always runs, and expressions with no
+   side effects whose value is discarded get removed.
+   Returns nonzero iff anything changed. */
+int foldExprs(ASTree *exprList) {
+  int changed = 0;
+  ASTList *prev = NULL;
+  ASTList *expr = exprList->children;
+
+  while (expr && expr->data) {
+    unsigned int cond;
+    expr->data = foldExpr(expr->data, &changed);
+
+    // Splice the live branch of a constant if-then-else into this list
+    if (expr->data->typ == IF_THEN_ELSE_EXPR &&
+        isNatLiteral(expr->data->children->data, &cond)) {
+      ASTree *ifExpr = expr->data;
+      ASTree *branch = cond ? ifExpr->children->next->data
+                            : ifExpr->children->next->next->data;
+      ASTList *first = branch->children;
+      ASTList *last = branch->childrenTail;
+      branch->children = NULL;
+      branch->childrenTail = NULL;
+
+      last->next = expr->next;
+      if (exprList->childrenTail == expr)
+        exprList->childrenTail = last;
+      if (prev == NULL)
+        exprList->children = first;
+      else
+        prev->next = first;
+      freeAST(ifExpr);
+      free(expr);
+      changed = 1;
+      expr = first;
+      continue;
+    }
+
+    // Drop side-effect-free expressions whose value is discarded
+    if (expr->next != NULL && isPure(expr->data)) {
+      ASTList *next = expr->next;
+      if (prev == NULL)
+        exprList->children = next;
+      else
+        prev->next = next;
+      freeAST(expr->data);
+      free(expr);
+      changed = 1;
+      expr = next;
+      continue;
+    }
+
+    prev = expr;
+    expr = expr->next;
+  }
+  return changed;
+}
@@ -0,0 +1,137 @@
+#include "../../include/intrinsics.h"
+
+/* Encapsulate one method of an intrinsic class: its name, the name of
+   its parameter, and the runtime routine that implements it. */
+typedef struct intrinsicmethod {
+  char *methodName;
+  char *paramName;
+  char *routine;
+} IntrinsicMethod;
+
+#define MAX_INTRINSIC_METHODS 4
+
+/* Encapsulate one intrinsic class: its name, its methods, and its class
+   number in the program, or -1 when the program does not use it. */
+typedef struct intrinsicclass {
+  char *className;
+  int numMethods;
+  IntrinsicMethod methods[MAX_INTRINSIC_METHODS];
+  int classNum;
+} IntrinsicClass;
+
+/* The intrinsic classes, described in intrinsics.h */
+static IntrinsicClass intrinsics[] = {
+    {"NatVector",
+     4,
+     {{"get", "index", "_djrt_vector_get"},
+      {"set", "value", "_djrt_vector_set"},
+      {"push", "value", "_djrt_vector_push"},
+      {"size", "unused", "_djrt_vector_size"}},
+     -1},
+    {"NatMap",
+     4,
+     {{"get", "key", "_djrt_map_get"},
+      {"has", "key", "_djrt_map_has"},
+      {"put", "value", "_djrt_map_put"},
+      {"size", "unused", "_djrt_map_size"}},
+     -1},
+};
+
+#define NUM_INTRINSICS ((int)(sizeof(intrinsics) / sizeof(intrinsics[0])))
+
+/* Whether each intrinsic class is needed, as countIntrinsicClasses found */
+static int needed[NUM_INTRINSICS];
+
+/* Returns nonzero iff some identifier in t is name */
+static int mentions(ASTree *t, char *name) {
+  if (t == NULL)
+    return 0;
+  if (t->typ == AST_ID && strCompare(t->idVal, name))
+    return 1;
+  for (ASTList *child = t->children; child != NULL; child = child->next)
+    if (mentions(child->data, name))
+      return 1;
+  return 0;
+}
+
+/* Returns nonzero iff the program whose AST is program declares a class
+   called name */
+static int declaresClass(ASTree *program, char *name) {
+  for (ASTList *c = program->children->data->children; c && c->data;
+       c = c->next)
+    if (strCompare(c->data->children->data->idVal, name))
+      return 1;
+  return 0;
+}
+
+/* Returns the number of intrinsic classes a program needs. */
+int countIntrinsicClasses(ASTree *program) {
+  int count = 0;
+  for (int i = 0; i < NUM_INTRINSICS; i++) {
+    needed[i] = !declaresClass(program, intrinsics[i].className) &&
+                mentions(program, intrinsics[i].className);
+    intrinsics[i].classNum = -1;
+    count += needed[i];
+  }
+  return count;
+}
+
+/* Fills in the symbol-table entries of the intrinsic classes. */
+void setupIntrinsicClasses(int firstClass) {
+  int classNum = firstClass;
+  for (int i = 0; i < NUM_INTRINSICS; i++) {
+    if (!needed[i])
+      continue;
+    IntrinsicClass *intrinsic = &intrinsics[i];
+    ClassDecl *class = &classesST[classNum];
+    intrinsic->classNum = classNum++;
+
+    class->className = intrinsic->className;
+    class->classNameLineNumber = 0;
+    class->superclass = 0;
+    class->superclassLineNumber = 0;
+    class->isFinal = 1;
+
+    class->numVars = 1;
+    class->varList = (VarDecl *)malloc(sizeof(VarDecl));
+    class->varList[0].varName = INTRINSIC_STATE_FIELD;
+    class->varList[0].varNameLineNumber = 0;
+    class->varList[0].type = -1;
+    class->varList[0].typeLineNumber = 0;
+
+    class->numMethods = intrinsic->numMethods;
+    class->methodList =
+        (MethodDecl *)malloc(sizeof(MethodDecl) * intrinsic->numMethods);
+    for (int j = 0; j < intrinsic->numMethods; j++) {
+      MethodDecl *method = &class->methodList[j];
+      method->methodName = intrinsic->methods[j].methodName;
+      method->methodNameLineNumber = 0;
+      method->returnType = -1;
+      method->returnTypeLineNumber = 0;
+      method->paramName = intrinsic->methods[j].paramName;
+      method->paramNameLineNumber = 0;
+      method->paramType = -1;
+      method->paramTypeLineNumber = 0;
+      method->isFinal = 1;
+      method->numLocals = 0;
+      method->localST = NULL;
+      method->bodyExprs = NULL; // the runtime routine is the body
+    }
+  }
+}
+
+/* Returns the intrinsic class that is class number classNum, or NULL */
+static IntrinsicClass *findIntrinsic(int classNum) {
+  for (int i = 0; i < NUM_INTRINSICS; i++)
+    if (intrinsics[i].classNum == classNum && classNum > 0)
+      return &intrinsics[i];
+  return NULL;
+}
+
+/* Returns nonzero iff class number classNum is an intrinsic class */
+int isIntrinsicClass(int classNum) { return findIntrinsic(classNum) != NULL; }
+
+/* Returns the runtime routine of a method of an intrinsic class. */
+char *intrinsicRoutine(int classNum, int methodNum) {
+  return findIntrinsic(classNum)->methods[methodNum].routine;
+}
@@ -0,0 +1,263 @@
+#include "../../include/ipcp.h"
+#include "../../include/intrinsics.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+/* Most distinct literals tracked per method when looking for hot ones */
+#define MAX_TRACKED_LITERALS 8
+
+/* Most rounds of collection and propagation; folding one method can expose
+   new constant arguments in the calls it makes */
+#define MAX_ROUNDS 4
+
+typedef enum { ARG_NO_CALLS, ARG_CONSTANT, ARG_VARYING } ArgLatticeKind;
+
+/* Encapsulate what is known about the argument of one method:
+   its lattice value over all call sites, and how often each literal is
+   passed at call sites that can only reach this method. */
+typedef struct arglattice {
+  ArgLatticeKind kind;
+  unsigned int value; // the constant, when kind is ARG_CONSTANT
+
+  int numLiterals;
+  unsigned int literals[MAX_TRACKED_LITERALS];
+  int literalSites[MAX_TRACKED_LITERALS];
+
+  int specialized; // the method body already had its parameter replaced
+  int numClones;   // clones made for this method so far
+} ArgLattice;
+
+/* Lattice values, indexed by class number and then method number */
+static ArgLattice **lattices;
+
+/* Returns the argument expression of a method-call expression */
+static ASTree *callArgument(ASTree *call) {
+  return call->typ == METHOD_CALL_EXPR ? call->children->next->data
+                                       : call->children->next->next->data;
+}
+
+/* Merges one call site's argument into the lattice of a method it reaches */
+static void mergeArgument(ArgLattice *lattice, ASTree *arg, int monomorphic) {
+  unsigned int value;
+  if (!isNatLiteral(arg, &value)) {
+    lattice->kind = ARG_VARYING;
+    return;
+  }
+
+  if (lattice->kind == ARG_NO_CALLS) {
+    lattice->kind = ARG_CONSTANT;
+    lattice->value = value;
+  } else if (lattice->kind == ARG_CONSTANT && lattice->value != value)
+    lattice->kind = ARG_VARYING;
+
+  // Only call sites with a single target can be retargeted to a clone
+  if (!monomorphic)
+    return;
+  for (int i = 0; i < lattice->numLiterals; i++) {
+    if (lattice->literals[i] == value) {
+      lattice->literalSites[i]++;
+      return;
+    }
+  }
+  if (lattice->numLiterals < MAX_TRACKED_LITERALS) {
+    lattice->literals[lattice->numLiterals] = value;
+    lattice->literalSites[lattice->numLiterals] = 1;
+    lattice->numLiterals++;
+  }
+}
+
+/* Merges the arguments of every call in t into the lattices */
+static void collectCalls(ASTree *t) {
+  if (t == NULL)
+    return;
+
+  if (t->typ == METHOD_CALL_EXPR || t->typ == DOT_METHOD_CALL_EXPR) {
+    // Calls already retargeted to a clone stay conservative: they count
+    // towards every method the call could reach, but not as hot sites
+    int targetClass, targetMethod;
+    int monomorphic =
+        t->callTarget == NULL &&
+        countCallTargets(t->staticClassNum, t->staticMemberNum, &targetClass,
+                         &targetMethod) == 1;
+    for (int i = 1; i < numClasses; i++)
+      for (int j = 0; j < classesST[i].numMethods; j++)
+        if (callMayReach(t->staticClassNum, t->staticMemberNum, i, j))
+          mergeArgument(&lattices[i][j], callArgument(t), monomorphic);
+  }
+
+  for (ASTList *child = t->children; child != NULL; child = child->next)
+    collectCalls(child->data);
+}
+
+/* Returns nonzero iff t assigns to the variable with the given name */
+static int assignsVariable(ASTree *t, char *name) {
+  if (t == NULL)
+    return 0;
+  if (t->typ == ASSIGN_EXPR && strCompare(t->children->data->idVal, name))
+    return 1;
+  for (ASTList *child = t->children; child != NULL; child = child->next)
+    if (assignsVariable(child->data, name))
+      return 1;
+  return 0;
+}
+
+/* Replaces every read of the variable with the given name inside t by a
+   nat literal holding value */
+static void replaceVariableReads(ASTree *t, char *name, unsigned int value) {
+  for (ASTList *child = t->children; child != NULL; child = child->next) {
+    if (child->data == NULL)
+      continue;
+    if (child->data->typ == ID_EXPR &&
+        strCompare(child->data->children->data->idVal, name)) {
+      ASTree *literal = newAST(NAT_LITERAL_EXPR, NULL, value, NULL,
+                               child->data->lineNumber);
+      literal->staticClassNum = child->data->staticClassNum;
+      literal->staticMemberNum = child->data->staticMemberNum;
+      freeAST(child->data);
+      child->data = literal;
+    } else
+      replaceVariableReads(child->data, name, value);
+  }
+}
+
+/* Specializes the method body exprs of method number methodNum of class
+   classNum for the argument value, and folds it */
+static void specializeBody(ASTree *exprs, int classNum, int methodNum,
+                           unsigned int value) {
+  replaceVariableReads(exprs, classesST[classNum].methodList[methodNum].paramName,
+                       value);
+  while (foldExprs(exprs))
+    ;
+}
+
+/* Points every call in t that can only reach method number methodNum of
+   class classNum and passes value at the clone with the given label */
+static void retargetCalls(ASTree *t, int classNum, int methodNum,
+                          unsigned int value, char *label) {
+  if (t == NULL)
+    return;
+
+  unsigned int argValue;
+  if ((t->typ == METHOD_CALL_EXPR || t->typ == DOT_METHOD_CALL_EXPR) &&
+      t->callTarget == NULL && isNatLiteral(callArgument(t), &argValue) &&
+      argValue == value) {
+    int targetClass, targetMethod;
+    if (countCallTargets(t->staticClassNum, t->staticMemberNum, &targetClass,
+                         &targetMethod) == 1 &&
+        targetClass == classNum && targetMethod == methodNum)
+      t->callTarget = label;
+  }
+
+  for (ASTList *child = t->children; child != NULL; child = child->next)
+    retargetCalls(child->data, classNum, methodNum, value, label);
+}
+
+/* Retargets calls in every method body, clone, and the main block */
+static void retargetAllCalls(int classNum, int methodNum, unsigned int value,
+                             char *label) {
+  for (int i = 1; i < numClasses; i++)
+    for (int j = 0; j < classesST[i].numMethods; j++)
+      retargetCalls(classesST[i].methodList[j].bodyExprs, classNum, methodNum,
+                    value, label);
+  for (int i = 0; i < numMethodClones; i++)
+    retargetCalls(methodClones[i].bodyExprs, classNum, methodNum, value,
+                  label);
+  retargetCalls(mainExprs, classNum, methodNum, value, label);
+}
+
+/* Makes clones of a method whose argument varies, one per hot literal.
+   Returns nonzero iff a clone was made. */
+static int cloneForHotLiterals(int classNum, int methodNum) {
+  ArgLattice *lattice = &lattices[classNum][methodNum];
+  int cloned = 0;
+
+  while (lattice->numClones < IPCP_MAX_CLONES) {
+    // Pick the literal passed at the most call sites
+    int hottest = -1;
+    for (int i = 0; i < lattice->numLiterals; i++)
+      if (lattice->literalSites[i] >= IPCP_HOT_SITES &&
+          (hottest < 0 ||
+           lattice->literalSites[i] > lattice->literalSites[hottest]))
+        hottest = i;
+    if (hottest < 0)
+      break;
+
+    unsigned int value = lattice->literals[hottest];
+    lattice->literalSites[hottest] = 0;
+
+    char suffix[32];
+    snprintf(suffix, sizeof(suffix), "_arg%u", value);
+    char *label = strConcat(methodLabel(classNum, methodNum), suffix, NULL);
+    if (findMethodClone(label) != NULL) {
+      free(label);
+      continue;
+    }
+
+    MethodClone *clone = addMethodClone(classNum, methodNum, label);
+    specializeBody(clone->bodyExprs, classNum, methodNum, value);
+    retargetAllCalls(classNum, methodNum, value, label);
+    lattice->numClones++;
+    cloned = 1;
+  }
+  return cloned;
+}
+
+/* Propagates constant method arguments across the whole program.
+   For every method, the arguments passed at all call sites that may reach
+   it are merged into a lattice value: no calls seen, one constant, or
+   varying.
+   When every call passes the same nat literal, the literal replaces the
+   parameter inside the method body, which is then folded.
+   When a few literals dominate, clones such as class3method2_arg1 are
+   specialized for them and folded, and call sites that can only reach the
+   method and pass the literal get retargeted to the clone.
+   This method assumes setupSymbolTables() and typecheckProgram() have
+   already executed. */
+void propagateArgumentConstants() {
+  lattices = (ArgLattice **)malloc(sizeof(ArgLattice *) * numClasses);
+  for (int i = 0; i < numClasses; i++)
+    lattices[i] = (ArgLattice *)calloc(
+        classesST[i].numMethods ? classesST[i].numMethods : 1,
+        sizeof(ArgLattice));
+
+  int changed = 1;
+  for (int round = 0; round < MAX_ROUNDS && changed; round++) {
+    changed = 0;
+
+    // Reset the lattices, keeping track of the work already done
+    for (int i = 1; i < numClasses; i++) {
+      for (int j = 0; j < classesST[i].numMethods; j++) {
+        lattices[i][j].kind = ARG_NO_CALLS;
+        lattices[i][j].numLiterals = 0;
+      }
+    }
+
+    // Merge the arguments of every call in the program
+    for (int i = 1; i < numClasses; i++)
+      for (int j = 0; j < classesST[i].numMethods; j++)
+        collectCalls(classesST[i].methodList[j].bodyExprs);
+    for (int i = 0; i < numMethodClones; i++)
+      collectCalls(methodClones[i].bodyExprs);
+    collectCalls(mainExprs);
+
+    // Specialize every method whose argument is known
+    for (int i = 1; i < numClasses; i++) {
+      for (int j = 0; j < classesST[i].numMethods; j++) {
+        MethodDecl *method = &classesST[i].methodList[j];
+        ArgLattice *lattice = &lattices[i][j];
+        if (isIntrinsicClass(i) || method->paramType != -1 ||
+            assignsVariable(method->bodyExprs, method->paramName))
+          continue;
+
+        if (lattice->kind == ARG_CONSTANT && !lattice->specialized) {
+          specializeBody(method->bodyExprs, i, j, lattice->value);
+          lattice->specialized = 1;
+          changed = 1;
+        } else if (lattice->kind == ARG_VARYING) {
+          if (cloneForHotLiterals(i, j))
+            changed = 1;
+        }
+      }
+    }
+  }
+}
@@ -0,0 +1,236 @@
+#include "../../include/layout.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+/* Encapsulate the layout of one class: the size and alignment of its
+   objects and, for each variable the class itself declares, the width,
+   offset, and access weight of its slot. */
+typedef struct classlayout {
+  int computed;
+  int size;
+  int alignment;
+  int *widths;
+  int *offsets;
+  long long *weights;
+} ClassLayout;
+
+/* Layouts, indexed by class number; allocated on first use */
+static ClassLayout *layouts = NULL;
+
+/* Whether reference fields and type ids are compressed */
+static int compressed = 0;
+
+/* Allocates the layout table with every slot full width */
+static void initLayouts() {
+  if (layouts != NULL)
+    return;
+  layouts = (ClassLayout *)calloc(numClasses, sizeof(ClassLayout));
+  for (int i = 0; i < numClasses; i++) {
+    int numVars = classesST[i].numVars;
+    layouts[i].widths = (int *)malloc(sizeof(int) * (numVars + 1));
+    layouts[i].offsets = (int *)malloc(sizeof(int) * (numVars + 1));
+    layouts[i].weights = (long long *)calloc(numVars + 1, sizeof(long long));
+    layouts[i].alignment = SLOT_SIZE;
+    for (int j = 0; j < numVars; j++)
+      layouts[i].widths[j] = SLOT_SIZE;
+  }
+}
+
+/* Returns nonzero iff variable a of a class goes before variable b when
+   the class is laid out: heavier first, then wider first, then in
+   declaration order */
+static int goesBefore(ClassLayout *layout, int a, int b) {
+  if (layout->weights[a] != layout->weights[b])
+    return layout->weights[a] > layout->weights[b];
+  if (layout->widths[a] != layout->widths[b])
+    return layout->widths[a] > layout->widths[b];
+  return a < b;
+}
+
+/* Lays out class classNum after its superclass, so that the superclass's
+   slots form a prefix of every subclass's. Its own variables are placed
+   in goesBefore order, each at the lowest offset aligned to its width
+   that is still free, so narrow slots fill the padding wider ones leave */
+static void computeLayout(int classNum) {
+  ClassLayout *layout = &layouts[classNum];
+  if (layout->computed)
+    return;
+
+  int start = getHeaderSize(); // the type id
+  ClassDecl *class = &classesST[classNum];
+  if (classNum > 0 && class->superclass > 0) {
+    computeLayout(class->superclass);
+    start = layouts[class->superclass].size;
+  }
+
+  int *order = (int *)malloc(sizeof(int) * (class->numVars + 1));
+  int numOrdered = 0, maxEnd = start;
+  for (int i = 0; i < class->numVars; i++) {
+    layout->offsets[i] = 0; // removed fields have no slot
+    if (layout->widths[i] == 0)
+      continue;
+    int j = numOrdered++;
+    for (; j > 0 && goesBefore(layout, i, order[j - 1]); j--)
+      order[j] = order[j - 1];
+    order[j] = i;
+    maxEnd += 2 * layout->widths[i];
+  }
+
+  // used[b] is nonzero iff byte start + b of the object holds a slot
+  char *used = (char *)calloc(maxEnd - start + 1, 1);
+  int end = start;
+  for (int k = 0; k < numOrdered; k++) {
+    int width = layout->widths[order[k]];
+    int offset = (start + width - 1) / width * width;
+    for (;; offset += width) {
+      int b = 0;
+      while (b < width && !used[offset - start + b])
+        b++;
+      if (b == width)
+        break;
+    }
+    for (int b = 0; b < width; b++)
+      used[offset - start + b] = 1;
+    layout->offsets[order[k]] = offset;
+    if (offset + width > end)
+      end = offset + width;
+  }
+  free(used);
+  free(order);
+
+  layout->size = (end + SLOT_SIZE - 1) / SLOT_SIZE * SLOT_SIZE;
+  layout->computed = 1;
+}
+
+/* Sets the width in bytes of the slot for a variable. */
+void setFieldWidth(int classNum, int varNum, int width) {
+  initLayouts();
+  layouts[classNum].widths[varNum] = width;
+}
+
+/* Returns the width in bytes of the slot for a variable. */
+int getFieldWidth(int classNum, int varNum) {
+  initLayouts();
+  return layouts[classNum].widths[varNum];
+}
+
+/* Returns the slot of the field called fieldName in objects of static type
+   objType. */
+FieldSlot getFieldSlot(int objType, char *fieldName) {
+  initLayouts();
+  int classNum = objType;
+  while (classNum > 0) {
+    ClassDecl *class = &classesST[classNum];
+    for (int i = 0; i < class->numVars; i++) {
+      if (strCompare(fieldName, class->varList[i].varName)) {
+        computeLayout(classNum);
+        FieldSlot slot;
+        slot.offset = layouts[classNum].offsets[i];
+        slot.width = layouts[classNum].widths[i];
+        slot.compressed = compressed && slot.width == COMPRESSED_SIZE &&
+                          class->varList[i].type >= 0;
+        return slot;
+      }
+    }
+    classNum = class->superclass;
+  }
+
+  printf("Internal Error: Couldn't get field offset.\n");
+  exit(EXIT_FAILURE);
+}
+
+/* Returns the size in bytes of objects of class classNum. */
+int getObjectSize(int classNum) {
+  initLayouts();
+  if (classNum <= 0)
+    return SLOT_SIZE;
+  computeLayout(classNum);
+  return layouts[classNum].size;
+}
+
+/* Switches to compressed references. */
+void compressReferences() {
+  initLayouts();
+  compressed = 1;
+  for (int i = 1; i < numClasses; i++)
+    for (int j = 0; j < classesST[i].numVars; j++)
+      if (classesST[i].varList[j].type >= 0 && layouts[i].widths[j] > 0)
+        layouts[i].widths[j] = COMPRESSED_SIZE;
+}
+
+/* Returns nonzero iff references are compressed */
+int referencesCompressed() { return compressed; }
+
+/* Returns the size in bytes of the type id header of every object. */
+int getHeaderSize() { return compressed ? COMPRESSED_SIZE : SLOT_SIZE; }
+
+/* Sets the access weight of the slot for a variable. */
+void setFieldWeight(int classNum, int varNum, long long weight) {
+  initLayouts();
+  layouts[classNum].weights[varNum] = weight;
+}
+
+/* Sets the alignment in bytes of objects of a class. */
+void setObjectAlignment(int classNum, int alignment) {
+  initLayouts();
+  layouts[classNum].alignment = alignment;
+}
+
+/* Returns the alignment in bytes of objects of class classNum. */
+int getObjectAlignment(int classNum) {
+  initLayouts();
+  if (classNum <= 0)
+    return SLOT_SIZE;
+  return layouts[classNum].alignment;
+}
+
+/* Prints the slots class classNum declares, in offset order, then the
+   variables removed from its layout */
+static void printOwnSlots(int classNum) {
+  ClassDecl *class = &classesST[classNum];
+  ClassLayout *layout = &layouts[classNum];
+  for (int offset = 0; offset < layout->size; offset++) {
+    for (int i = 0; i < class->numVars; i++) {
+      if (layout->widths[i] == 0 || layout->offsets[i] != offset)
+        continue;
+      printf("    offset %4d  width %d  %s.%s%s  (weight %lld)\n", offset,
+             layout->widths[i], class->className, class->varList[i].varName,
+             compressed && class->varList[i].type >= 0 ? " (compressed)" : "",
+             layout->weights[i]);
+    }
+  }
+  for (int i = 0; i < class->numVars; i++)
+    if (layout->widths[i] == 0)
+      printf("    removed              %s.%s  (weight %lld)\n",
+             class->className, class->varList[i].varName,
+             layout->weights[i]);
+}
+
+/* Prints the layout of every class. */
+void printLayoutReport() {
+  initLayouts();
+  printf("****** object layouts ******\n");
+  for (int i = 1; i < numClasses; i++) {
+    computeLayout(i);
+    ClassLayout *layout = &layouts[i];
+    // An object starting anywhere its alignment allows touches at most
+    // this many cache lines
+    int lines = (layout->size + CACHE_LINE_SIZE - layout->alignment +
+                 CACHE_LINE_SIZE - 1) /
+                CACHE_LINE_SIZE;
+    if (layout->alignment >= CACHE_LINE_SIZE)
+      lines = (layout->size + CACHE_LINE_SIZE - 1) / CACHE_LINE_SIZE;
+    printf("class %s: %d bytes, aligned to %d, cache lines %d\n",
+           classesST[i].className, layout->size, layout->alignment, lines);
+    printf("    offset    0  width %d  type id\n", getHeaderSize());
+
+    // Superclass slots first, outermost class first, as they are laid out
+    int chain[numClasses];
+    int depth = 0;
+    for (int c = i; c > 0; c = classesST[c].superclass)
+      chain[depth++] = c;
+    while (depth > 0)
+      printOwnSlots(chain[--depth]);
+  }
+  printf("****** end object layouts ******\n");
+}
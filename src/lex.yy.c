@@ -374,8 +374,8 @@ static void yynoreturn yy_fatal_error ( const char* msg  );
 	(yy_hold_char) = *yy_cp; \
 	*yy_cp = '\0'; \
 	(yy_c_buf_p) = yy_cp;
-#define YY_NUM_RULES 34
-#define YY_END_OF_BUFFER 35
+#define YY_NUM_RULES 36
+#define YY_END_OF_BUFFER 37
 /* This struct is not used in this scanner,
    but its presence is necessary. */
 struct yy_trans_info
@@ -383,19 +383,20 @@ struct yy_trans_info
 	flex_int32_t yy_verify;
 	flex_int32_t yy_nxt;
 	};
-static const flex_int16_t yy_accept[97] =
+static const flex_int16_t yy_accept[106] =
     {   0,
-        0,    0,   35,   33,    1,    1,   17,   32,   29,   30,
-       12,   10,   11,   25,   33,   31,   31,   26,   14,   21,
-       32,   32,   32,   32,   32,   32,   32,   32,   32,   32,
-       32,   27,   33,   28,    1,   32,    2,   31,   13,   32,
-       32,   32,   32,   32,   18,   32,   32,   32,   32,   32,
-       32,   32,   32,   16,    2,    2,   32,   32,   32,   32,
-       32,   32,    7,   23,   32,   32,   32,   32,   32,   32,
-       32,   19,   32,   32,    6,   22,   32,   32,   24,   32,
-       32,    4,   32,    3,   32,   32,   20,   15,   32,   32,
-       32,    5,   32,    9,    8,    0
-
+        0,    0,   37,   35,    1,    1,   17,   34,   31,   32,
+       12,   10,   11,   27,   35,   33,   33,   28,   14,   21,
+       34,   34,   34,   34,   34,   34,   34,   34,   34,   34,
+       34,   34,   34,   29,   35,   30,    1,   34,    2,   33,
+       13,   34,   34,   34,   34,   34,   18,   34,   34,   34,
+       34,   34,   34,   34,   34,   34,   34,   16,    2,    2,
+       34,   34,   34,   34,   34,   34,   34,    7,   23,   34,
+       34,   34,   34,   34,   34,   34,   34,   19,   34,   34,
+       26,    6,   22,   34,   34,   34,   24,   34,   34,    4,
+       34,    3,   34,   34,   25,   20,   15,   34,   34,   34,
+
+        5,   34,    9,    8,    0
     } ;
 
 static const YY_CHAR yy_ec[256] =
@@ -411,9 +412,9 @@ static const YY_CHAR yy_ec[256] =
         5,    5,    5,    5,    5,    5,    5,    5,    5,    5,
         1,    1,    1,    1,    5,    1,   19,    5,   20,   21,
 
-       22,   23,    5,   24,   25,    5,    5,   26,   27,   28,
-        5,   29,    5,   30,   31,   32,   33,    5,   34,   35,
-        5,    5,   36,   37,   38,    1,    1,    1,    1,    1,
+       22,   23,    5,   24,   25,   26,    5,   27,   28,   29,
+       30,   31,    5,   32,   33,   34,   35,    5,   36,   37,
+        5,    5,   38,   39,   40,    1,    1,    1,    1,    1,
         1,    1,    1,    1,    1,    1,    1,    1,    1,    1,
         1,    1,    1,    1,    1,    1,    1,    1,    1,    1,
         1,    1,    1,    1,    1,    1,    1,    1,    1,    1,
@@ -430,89 +431,107 @@ static const YY_CHAR yy_ec[256] =
         1,    1,    1,    1,    1
     } ;
 
-static const YY_CHAR yy_meta[39] =
+static const YY_CHAR yy_meta[41] =
     {   0,
-        1,    1,    1,    1,    2,    1,    1,    1,    1,    1,
-        1,    1,    2,    2,    1,    1,    1,    2,    2,    2,
-        2,    2,    2,    2,    2,    2,    2,    2,    2,    2,
-        2,    2,    2,    2,    2,    1,    1,    1
+        1,    1,    1,    1,    1,    1,    1,    1,    1,    1,
+        1,    1,    1,    1,    1,    1,    1,    1,    1,    1,
+        1,    1,    1,    1,    1,    1,    1,    1,    1,    1,
+        1,    1,    1,    1,    1,    1,    1,    1,    1,    1
     } ;
 
-static const flex_int16_t yy_base[99] =
+static const flex_int16_t yy_base[106] =
     {   0,
-        0,    0,  110,  111,   37,   39,  111,    0,  111,  111,
-      111,  111,  111,  111,   97,  111,   30,  111,  111,   91,
-       76,   80,   19,   80,   81,   84,   27,   72,   79,   76,
-       75,  111,   61,  111,   45,    0,   94,   37,  111,   65,
-       76,   63,   61,   64,    0,   66,   58,   55,   62,   62,
-       67,   60,   59,  111,   80,  111,   60,   50,   58,   57,
-       59,   49,    0,    0,   50,   47,   53,   42,   46,   41,
-       39,    0,   41,   42,    0,    0,   35,   48,    0,   43,
-       32,    0,   42,    0,   41,   39,    0,    0,   26,   37,
-       23,    0,   21,    0,    0,  111,   50,   60
-
+        0,    0,   41,  172,   40,    0,  172,   39,  172,  172,
+      172,  172,  172,  172,   33,  172,   33,  172,  172,   31,
+       16,   23,   50,   26,   31,   25,   37,   59,   47,   58,
+       51,   59,   60,  172,   46,  172,    0,    0,   94,    0,
+      172,   53,   69,   56,   56,   62,    0,   67,   68,  101,
+      100,  110,  113,  120,  121,  116,  117,  172,    0,  172,
+      121,  111,  123,  124,  128,  119,  120,    0,    0,  123,
+      122,  131,  117,  121,  128,  124,  124,    0,  129,  132,
+        0,    0,    0,  126,  143,  133,    0,  141,  130,    0,
+      144,    0,  148,  148,    0,    0,    0,  135,  150,  136,
+
+        0,  137,    0,    0,  172
     } ;
 
-static const flex_int16_t yy_def[99] =
+static const flex_int16_t yy_def[106] =
     {   0,
-       96,    1,   96,   96,   96,   96,   96,   97,   96,   96,
-       96,   96,   96,   96,   96,   96,   96,   96,   96,   96,
-       97,   97,   97,   97,   97,   97,   97,   97,   97,   97,
-       97,   96,   96,   96,   96,   97,   98,   96,   96,   97,
-       97,   97,   97,   97,   97,   97,   97,   97,   97,   97,
-       97,   97,   97,   96,   98,   96,   97,   97,   97,   97,
-       97,   97,   97,   97,   97,   97,   97,   97,   97,   97,
-       97,   97,   97,   97,   97,   97,   97,   97,   97,   97,
-       97,   97,   97,   97,   97,   97,   97,   97,   97,   97,
-       97,   97,   97,   97,   97,    0,   96,   96
-
+      105,    1,  105,  105,  105,    5,  105,  105,  105,  105,
+      105,  105,  105,  105,  105,  105,  105,  105,  105,  105,
+        8,    8,    8,    8,    8,    8,    8,    8,    8,    8,
+        8,    8,    8,  105,  105,  105,    5,    8,  105,   17,
+      105,    8,    8,    8,    8,    8,    8,    8,    8,    8,
+        8,    8,    8,    8,    8,    8,    8,  105,   39,  105,
+        8,    8,    8,    8,    8,    8,    8,    8,    8,    8,
+        8,    8,    8,    8,    8,    8,    8,    8,    8,    8,
+        8,    8,    8,    8,    8,    8,    8,    8,    8,    8,
+        8,    8,    8,    8,    8,    8,    8,    8,    8,    8,
+
+        8,    8,    8,    8,    0
     } ;
 
-static const flex_int16_t yy_nxt[150] =
+static const flex_int16_t yy_nxt[213] =
     {   0,
         4,    5,    6,    7,    8,    9,   10,   11,   12,   13,
        14,   15,   16,   17,   18,   19,   20,    8,   21,   22,
-        8,   23,   24,    8,   25,    8,   26,   27,   28,   29,
-        8,   30,    8,   31,    8,   32,   33,   34,   35,   35,
-       35,   35,   38,   38,   42,   47,   35,   35,   48,   38,
-       38,   36,   95,   43,   94,   93,   92,   91,   90,   49,
-       55,   55,   89,   88,   87,   86,   85,   84,   83,   82,
-       81,   80,   79,   78,   77,   76,   75,   74,   73,   72,
-       71,   70,   56,   69,   68,   67,   66,   65,   64,   63,
-       62,   61,   60,   59,   58,   57,   56,   54,   53,   52,
-
-       51,   50,   46,   45,   44,   41,   40,   39,   37,   96,
-        3,   96,   96,   96,   96,   96,   96,   96,   96,   96,
-       96,   96,   96,   96,   96,   96,   96,   96,   96,   96,
-       96,   96,   96,   96,   96,   96,   96,   96,   96,   96,
-       96,   96,   96,   96,   96,   96,   96,   96,   96
+        8,   23,   24,    8,   25,   26,    8,   27,   28,    8,
+       29,   30,   31,   32,    8,   33,    8,   34,   35,   36,
+      105,   37,   37,   38,   39,   40,   40,   41,   42,   43,
+       46,   38,   38,   47,   48,   49,   38,   38,   38,   38,
+       38,   38,   38,   38,   38,   38,   38,   38,   38,   38,
+       38,   38,   38,   38,   38,   38,   44,   50,   53,   54,
+       51,   55,   56,   57,   58,   61,   45,   62,   63,   64,
+       65,   66,   67,   52,   59,   59,   60,   59,   59,   59,
+
+       59,   59,   59,   59,   59,   59,   59,   59,   59,   59,
+       59,   59,   59,   59,   59,   59,   59,   59,   59,   59,
+       59,   59,   59,   59,   59,   59,   59,   59,   59,   59,
+       59,   59,   59,   59,   68,   69,   70,   71,   72,   73,
+       74,   75,   76,   77,   78,   79,   80,   81,   82,   83,
+       84,   85,   86,   87,   88,   89,   90,   91,   92,   93,
+       94,   95,   96,   97,   98,   99,  100,  101,  102,  103,
+      104,    3,  105,  105,  105,  105,  105,  105,  105,  105,
+      105,  105,  105,  105,  105,  105,  105,  105,  105,  105,
+      105,  105,  105,  105,  105,  105,  105,  105,  105,  105,
+
+      105,  105,  105,  105,  105,  105,  105,  105,  105,  105,
+      105,  105
     } ;
 
-static const flex_int16_t yy_chk[150] =
+static const flex_int16_t yy_chk[213] =
     {   0,
         1,    1,    1,    1,    1,    1,    1,    1,    1,    1,
         1,    1,    1,    1,    1,    1,    1,    1,    1,    1,
         1,    1,    1,    1,    1,    1,    1,    1,    1,    1,
-        1,    1,    1,    1,    1,    1,    1,    1,    5,    5,
-        6,    6,   17,   17,   23,   27,   35,   35,   27,   38,
-       38,   97,   93,   23,   91,   90,   89,   86,   85,   27,
-       98,   98,   83,   81,   80,   78,   77,   74,   73,   71,
-       70,   69,   68,   67,   66,   65,   62,   61,   60,   59,
-       58,   57,   55,   53,   52,   51,   50,   49,   48,   47,
-       46,   44,   43,   42,   41,   40,   37,   33,   31,   30,
-
-       29,   28,   26,   25,   24,   22,   21,   20,   15,    3,
-       96,   96,   96,   96,   96,   96,   96,   96,   96,   96,
-       96,   96,   96,   96,   96,   96,   96,   96,   96,   96,
-       96,   96,   96,   96,   96,   96,   96,   96,   96,   96,
-       96,   96,   96,   96,   96,   96,   96,   96,   96
+        1,    1,    1,    1,    1,    1,    1,    1,    1,    1,
+        3,    5,    5,    8,   15,   17,   17,   20,   21,   22,
+       24,    8,    8,   25,   26,   27,    8,    8,    8,    8,
+        8,    8,    8,    8,    8,    8,    8,    8,    8,    8,
+        8,    8,    8,    8,    8,    8,   23,   28,   29,   30,
+       28,   31,   32,   33,   35,   42,   23,   43,   44,   45,
+       46,   48,   49,   28,   39,   39,   39,   39,   39,   39,
+
+       39,   39,   39,   39,   39,   39,   39,   39,   39,   39,
+       39,   39,   39,   39,   39,   39,   39,   39,   39,   39,
+       39,   39,   39,   39,   39,   39,   39,   39,   39,   39,
+       39,   39,   39,   39,   50,   51,   52,   53,   54,   55,
+       56,   57,   61,   62,   63,   64,   65,   66,   67,   70,
+       71,   72,   73,   74,   75,   76,   77,   79,   80,   84,
+       85,   86,   88,   89,   91,   93,   94,   98,   99,  100,
+      102,  105,  105,  105,  105,  105,  105,  105,  105,  105,
+      105,  105,  105,  105,  105,  105,  105,  105,  105,  105,
+      105,  105,  105,  105,  105,  105,  105,  105,  105,  105,
+
+      105,  105,  105,  105,  105,  105,  105,  105,  105,  105,
+      105,  105
     } ;
 
 /* Table of booleans, true if rule could match eol. */
-static const flex_int32_t yy_rule_can_match_eol[35] =
+static const flex_int32_t yy_rule_can_match_eol[37] =
     {   0,
 1, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 
-    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,     };
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,     };
 
 static yy_state_type yy_last_accepting_state;
 static char *yy_last_accepting_cpos;
@@ -534,8 +553,8 @@ char *yytext;
   #define DEBUG_SCAN 0
   typedef int Token;
   Token scanned(Token t);
-#line 537 "src/lex.yy.c"
-#line 538 "src/lex.yy.c"
+#line 556 "src/lex.yy.c"
+#line 557 "src/lex.yy.c"
 
 #define INITIAL 0
 
@@ -755,7 +774,7 @@ YY_DECL
 #line 17 "src/dj.l"
 
 
-#line 758 "src/lex.yy.c"
+#line 777 "src/lex.yy.c"
 
 	while ( /*CONSTCOND*/1 )		/* loops until end-of-file is reached */
 		{
@@ -782,13 +801,13 @@ yy_match:
 			while ( yy_chk[yy_base[yy_current_state] + yy_c] != yy_current_state )
 				{
 				yy_current_state = (int) yy_def[yy_current_state];
-				if ( yy_current_state >= 97 )
+				if ( yy_current_state >= 106 )
 					yy_c = yy_meta[yy_c];
 				}
 			yy_current_state = yy_nxt[yy_base[yy_current_state] + yy_c];
 			++yy_cp;
 			}
-		while ( yy_base[yy_current_state] != 111 );
+		while ( yy_base[yy_current_state] != 172 );
 
 yy_find_action:
 		yy_act = yy_accept[yy_current_state];
@@ -947,60 +966,70 @@ YY_RULE_SETUP
 case 25:
 YY_RULE_SETUP
 #line 43 "src/dj.l"
-{if(DEBUG_SCAN) printf("DOT "); return DOT;}
+{if(DEBUG_SCAN) printf("SPAWN "); return SPAWN;}
 	YY_BREAK
 case 26:
 YY_RULE_SETUP
 #line 44 "src/dj.l"
-{if(DEBUG_SCAN) printf("SEMICOLON "); return SEMICOLON;}
+{if(DEBUG_SCAN) printf("JOIN "); return JOIN;}
 	YY_BREAK
 case 27:
 YY_RULE_SETUP
 #line 45 "src/dj.l"
-{if(DEBUG_SCAN) printf("LBRACE "); return LBRACE;}
+{if(DEBUG_SCAN) printf("DOT "); return DOT;}
 	YY_BREAK
 case 28:
 YY_RULE_SETUP
 #line 46 "src/dj.l"
-{if(DEBUG_SCAN) printf("RBRACE "); return RBRACE;}
+{if(DEBUG_SCAN) printf("SEMICOLON "); return SEMICOLON;}
 	YY_BREAK
 case 29:
 YY_RULE_SETUP
 #line 47 "src/dj.l"
-{if(DEBUG_SCAN) printf("LPAREN "); return LPAREN;}
+{if(DEBUG_SCAN) printf("LBRACE "); return LBRACE;}
 	YY_BREAK
 case 30:
 YY_RULE_SETUP
 #line 48 "src/dj.l"
-{if(DEBUG_SCAN) printf("RPAREN "); return RPAREN;}
+{if(DEBUG_SCAN) printf("RBRACE "); return RBRACE;}
 	YY_BREAK
 case 31:
 YY_RULE_SETUP
 #line 49 "src/dj.l"
-{if(DEBUG_SCAN) printf("NATLITERAL(%s) ", yytext); return NATLITERAL;}
+{if(DEBUG_SCAN) printf("LPAREN "); return LPAREN;}
 	YY_BREAK
 case 32:
 YY_RULE_SETUP
 #line 50 "src/dj.l"
+{if(DEBUG_SCAN) printf("RPAREN "); return RPAREN;}
+	YY_BREAK
+case 33:
+YY_RULE_SETUP
+#line 51 "src/dj.l"
+{if(DEBUG_SCAN) printf("NATLITERAL(%s) ", yytext); return NATLITERAL;}
+	YY_BREAK
+case 34:
+YY_RULE_SETUP
+#line 52 "src/dj.l"
 {if(DEBUG_SCAN) printf("ID(%s) ", yytext); return ID;}
 	YY_BREAK
 case YY_STATE_EOF(INITIAL):
-#line 51 "src/dj.l"
+#line 53 "src/dj.l"
 {if(DEBUG_SCAN) printf("ENDOFFILE\n"); return ENDOFFILE;}
 	YY_BREAK
-case 33:
+case 35:
 YY_RULE_SETUP
-#line 52 "src/dj.l"
+#line 54 "src/dj.l"
 {if(DEBUG_SCAN) printf("\n");
              printf("Lex error on line %d: Illegal character %s\n", yylineno, yytext);
              exit(-1);}
 	YY_BREAK
-case 34:
+case 36:
 YY_RULE_SETUP
-#line 55 "src/dj.l"
+#line 57 "src/dj.l"
 ECHO;
 	YY_BREAK
-#line 1003 "src/lex.yy.c"
+#line 1032 "src/lex.yy.c"
 
 	case YY_END_OF_BUFFER:
 		{
@@ -1295,7 +1324,7 @@ static int yy_get_next_buffer (void)
 		while ( yy_chk[yy_base[yy_current_state] + yy_c] != yy_current_state )
 			{
 			yy_current_state = (int) yy_def[yy_current_state];
-			if ( yy_current_state >= 97 )
+			if ( yy_current_state >= 106 )
 				yy_c = yy_meta[yy_c];
 			}
 		yy_current_state = yy_nxt[yy_base[yy_current_state] + yy_c];
@@ -1323,11 +1352,11 @@ static int yy_get_next_buffer (void)
 	while ( yy_chk[yy_base[yy_current_state] + yy_c] != yy_current_state )
 		{
 		yy_current_state = (int) yy_def[yy_current_state];
-		if ( yy_current_state >= 97 )
+		if ( yy_current_state >= 106 )
 			yy_c = yy_meta[yy_c];
 		}
 	yy_current_state = yy_nxt[yy_base[yy_current_state] + yy_c];
-	yy_is_jam = (yy_current_state == 96);
+	yy_is_jam = (yy_current_state == 105);
 
 		return yy_is_jam ? 0 : yy_current_state;
 }
@@ -2015,6 +2044,6 @@ void yyfree (void * ptr )
 
 #define YYTABLES_NAME "yytables"
 
-#line 55 "src/dj.l"
+#line 57 "src/dj.l"
 
 
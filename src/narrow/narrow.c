@@ -0,0 +1,466 @@
+#include "../../include/narrow.h"
+#include "../../include/intrinsics.h"
+#include <stdint.h>
+#include <stdlib.h>
+
+/* Most variables and fields with a known guard at any one point */
+#define MAX_GUARDS 32
+
+/* How often a field's range may grow by single steps before it gets
+   widened to the next slot size */
+#define MAX_WIDENINGS 4
+
+/* Bounds beyond which arithmetic on a range is not tracked, so that the
+   bounds of the result cannot overflow */
+#define MAX_TRACKED_BOUND 2147483648LL
+
+/* A range [lo, hi] of 64-bit signed values, which is how nats compare at
+   run time */
+typedef struct range {
+  int64_t lo;
+  int64_t hi;
+} Range;
+
+static const Range FULL = {INT64_MIN, INT64_MAX};
+
+/* A range that holds for a variable or field of `this` because of an
+   enclosing if/while condition */
+typedef struct guard {
+  char *name;
+  Range range;
+} Guard;
+
+/* The guards that hold at one point of a method body */
+typedef struct guardset {
+  int numGuards;
+  Guard guards[MAX_GUARDS];
+} GuardSet;
+
+/* Ranges of every nat field and how often each one grew, indexed by
+   class number and then variable number */
+static Range **fieldRanges;
+static int **fieldGrowth;
+
+/* Whether any field range grew during the current pass */
+static int rangesChanged;
+
+/* The method whose body is being analyzed (class -1 for the main block) */
+static int currClass, currMethod;
+
+/* Returns the range of values in both a and b */
+static Range joinRanges(Range a, Range b) {
+  Range r;
+  r.lo = a.lo < b.lo ? a.lo : b.lo;
+  r.hi = a.hi > b.hi ? a.hi : b.hi;
+  return r;
+}
+
+/* Returns the range of values in a that are also in b */
+static Range meetRanges(Range a, Range b) {
+  Range r;
+  r.lo = a.lo > b.lo ? a.lo : b.lo;
+  r.hi = a.hi < b.hi ? a.hi : b.hi;
+  return r;
+}
+
+/* Returns a range holding just value */
+static Range singleValue(int64_t value) {
+  Range r;
+  r.lo = value;
+  r.hi = value;
+  return r;
+}
+
+/* Returns nonzero iff r is small enough for arithmetic to be tracked */
+static int isTracked(Range r) {
+  return r.lo >= -MAX_TRACKED_BOUND && r.hi <= MAX_TRACKED_BOUND;
+}
+
+/* Finds the field called name in class classNum or its superclasses.
+   Returns nonzero iff found, storing the declaring class and the index
+   into its varList. */
+static int findField(int classNum, char *name, int *declClass,
+                     int *declIndex) {
+  while (classNum > 0) {
+    ClassDecl *class = &classesST[classNum];
+    for (int i = 0; i < class->numVars; i++) {
+      if (strCompare(name, class->varList[i].varName)) {
+        *declClass = classNum;
+        *declIndex = i;
+        return 1;
+      }
+    }
+    classNum = class->superclass;
+  }
+  return 0;
+}
+
+/* Returns nonzero iff the identifier name refers to a field of `this`
+   in the current method, following code gen's lookup order (parameter,
+   then locals, then fields). */
+static int isThisField(char *name, int *declClass, int *declIndex) {
+  if (currClass < 0)
+    return 0;
+  MethodDecl *method = &classesST[currClass].methodList[currMethod];
+  if (strCompare(name, method->paramName))
+    return 0;
+  for (int i = 0; i < method->numLocals; i++)
+    if (strCompare(name, method->localST[i].varName))
+      return 0;
+  return findField(currClass, name, declClass, declIndex);
+}
+
+/* Returns the guard for the identifier name, or NULL */
+static Guard *findGuard(GuardSet *set, char *name) {
+  for (int i = 0; i < set->numGuards; i++)
+    if (strCompare(name, set->guards[i].name))
+      return &set->guards[i];
+  return NULL;
+}
+
+/* Forgets the guard for the identifier name, if any */
+static void killGuard(GuardSet *set, char *name) {
+  Guard *guard = findGuard(set, name);
+  if (guard != NULL)
+    *guard = set->guards[--set->numGuards];
+}
+
+/* Forgets the guards that may stop holding somewhere inside t: those of
+   variables t assigns, those of fields of `this` that t may store into
+   through another reference, and those of all fields of `this` if t calls
+   a method or joins a task. */
+static void killGuards(ASTree *t, GuardSet *set) {
+  if (t == NULL)
+    return;
+
+  int declClass, declIndex;
+  switch (t->typ) {
+  case ASSIGN_EXPR:
+    killGuard(set, t->children->data->idVal);
+    break;
+  case DOT_ASSIGN_EXPR:
+    killGuard(set, t->children->next->data->idVal);
+    break;
+  case METHOD_CALL_EXPR:
+  case DOT_METHOD_CALL_EXPR:
+  case JOIN_EXPR: // may run tasks, and sees what the joined one stored
+    for (int i = set->numGuards - 1; i >= 0; i--)
+      if (isThisField(set->guards[i].name, &declClass, &declIndex))
+        killGuard(set, set->guards[i].name);
+    break;
+  default:
+    break;
+  }
+
+  for (ASTList *child = t->children; child != NULL; child = child->next)
+    killGuards(child->data, set);
+}
+
+/* Narrows the guard of the variable or field of `this` read by the
+   ID expression t to range r */
+static void addGuard(GuardSet *set, ASTree *t, Range r) {
+  if (t == NULL || t->typ != ID_EXPR)
+    return;
+  char *name = t->children->data->idVal;
+  Guard *guard = findGuard(set, name);
+  if (guard != NULL) {
+    guard->range = meetRanges(guard->range, r);
+  } else if (set->numGuards < MAX_GUARDS) {
+    guard = &set->guards[set->numGuards++];
+    guard->name = name;
+    guard->range = r;
+  }
+}
+
+/* Adds the guards that follow from cond evaluating to nonzero (if holds
+   is set) or to 0 (otherwise) */
+static void learnGuards(ASTree *cond, int holds, GuardSet *set) {
+  ASTree *first = cond->children ? cond->children->data : NULL;
+  ASTree *second = (cond->children && cond->children->next)
+                       ? cond->children->next->data
+                       : NULL;
+  Range r = FULL;
+
+  switch (cond->typ) {
+  case NOT_EXPR:
+    learnGuards(first, !holds, set);
+    break;
+
+  case OR_EXPR:
+    // !(A || B) means both !A and !B
+    if (!holds) {
+      learnGuards(first, 0, set);
+      learnGuards(second, 0, set);
+    }
+    break;
+
+  case LESS_THAN_EXPR:
+    if (second->typ == NAT_LITERAL_EXPR) {
+      if (holds)
+        r.hi = (int64_t)second->natVal - 1; // x < N
+      else
+        r.lo = second->natVal; // !(x < N)
+      addGuard(set, first, r);
+    } else if (first->typ == NAT_LITERAL_EXPR) {
+      if (holds)
+        r.lo = (int64_t)first->natVal + 1; // N < x
+      else
+        r.hi = first->natVal; // !(N < x)
+      addGuard(set, second, r);
+    }
+    break;
+
+  case EQUALITY_EXPR:
+    if (holds && second->typ == NAT_LITERAL_EXPR)
+      addGuard(set, first, singleValue(second->natVal));
+    else if (holds && first->typ == NAT_LITERAL_EXPR)
+      addGuard(set, second, singleValue(first->natVal));
+    break;
+
+  default:
+    break;
+  }
+}
+
+static Range rangeOfExprs(ASTree *exprList, GuardSet *set);
+
+/* Returns a range covering every value t may evaluate to */
+static Range rangeOf(ASTree *t, GuardSet *set) {
+  ASTree *first = t->children ? t->children->data : NULL;
+  ASTree *second =
+      (t->children && t->children->next) ? t->children->next->data : NULL;
+  int declClass, declIndex, objType;
+  Range a, b, r;
+  Guard *guard;
+
+  switch (t->typ) {
+  case NAT_LITERAL_EXPR:
+    return singleValue(t->natVal);
+
+  case EQUALITY_EXPR:
+  case LESS_THAN_EXPR:
+  case NOT_EXPR:
+  case OR_EXPR:
+    r.lo = 0;
+    r.hi = 1;
+    return r;
+
+  case WHILE_EXPR:
+    return singleValue(0);
+
+  case ASSERT_EXPR:
+  case PRINT_EXPR:
+    return rangeOf(first, set);
+
+  case ASSIGN_EXPR:
+    return rangeOf(second, set);
+
+  case DOT_ASSIGN_EXPR:
+    return rangeOf(t->children->next->next->data, set);
+
+  case IF_THEN_ELSE_EXPR:
+    return joinRanges(rangeOfExprs(second, set),
+                      rangeOfExprs(t->children->next->next->data, set));
+
+  case PLUS_EXPR:
+  case MINUS_EXPR:
+  case TIMES_EXPR:
+    a = rangeOf(first, set);
+    b = rangeOf(second, set);
+    if (!isTracked(a) || !isTracked(b))
+      return FULL;
+    if (t->typ == PLUS_EXPR) {
+      r.lo = a.lo + b.lo;
+      r.hi = a.hi + b.hi;
+    } else if (t->typ == MINUS_EXPR) {
+      r.lo = a.lo - b.hi;
+      r.hi = a.hi - b.lo;
+    } else {
+      int64_t products[4] = {a.lo * b.lo, a.lo * b.hi, a.hi * b.lo,
+                             a.hi * b.hi};
+      r.lo = r.hi = products[0];
+      for (int i = 1; i < 4; i++) {
+        if (products[i] < r.lo)
+          r.lo = products[i];
+        if (products[i] > r.hi)
+          r.hi = products[i];
+      }
+    }
+    return r;
+
+  case ID_EXPR:
+    r = FULL;
+    if (isThisField(first->idVal, &declClass, &declIndex) &&
+        classesST[declClass].varList[declIndex].type == -1)
+      r = fieldRanges[declClass][declIndex];
+    guard = findGuard(set, first->idVal);
+    if (guard != NULL)
+      r = meetRanges(r, guard->range);
+    return r;
+
+  case DOT_ID_EXPR:
+    objType = typeExpr(first, currClass, currMethod);
+    if (findField(objType, second->idVal, &declClass, &declIndex) &&
+        classesST[declClass].varList[declIndex].type == -1)
+      return fieldRanges[declClass][declIndex];
+    return FULL;
+
+  default:
+    return FULL;
+  }
+}
+
+/* Returns a range covering every value the expression list exprList may
+   evaluate to */
+static Range rangeOfExprs(ASTree *exprList, GuardSet *set) {
+  // Guards only hold for the last expression if no expression breaks them
+  GuardSet listGuards = *set;
+  killGuards(exprList, &listGuards);
+  return rangeOf(exprList->childrenTail->data, &listGuards);
+}
+
+/* Widens the range of a nat field to cover the values in r */
+static void recordStore(int declClass, int declIndex, Range r) {
+  if (classesST[declClass].varList[declIndex].type != -1)
+    return;
+  Range old = fieldRanges[declClass][declIndex];
+  Range joined = joinRanges(old, r);
+  if (joined.lo == old.lo && joined.hi == old.hi)
+    return;
+  if (++fieldGrowth[declClass][declIndex] > MAX_WIDENINGS) {
+    // Jump to the largest value of the smallest slot that holds the range,
+    // so counters bounded by a guard still converge
+    joined.lo = joined.lo >= 0 ? 0 : INT64_MIN;
+    if (joined.hi <= 0xFFLL)
+      joined.hi = 0xFFLL;
+    else if (joined.hi <= 0xFFFFLL)
+      joined.hi = 0xFFFFLL;
+    else if (joined.hi <= 0xFFFFFFFFLL)
+      joined.hi = 0xFFFFFFFFLL;
+    else
+      joined.hi = INT64_MAX;
+  }
+  fieldRanges[declClass][declIndex] = joined;
+  rangesChanged = 1;
+}
+
+static void analyzeExprs(ASTree *exprList, GuardSet set);
+
+/* Records the ranges of every field store inside t */
+static void analyzeExpr(ASTree *t, GuardSet *set) {
+  if (t == NULL)
+    return;
+
+  int declClass, declIndex;
+  GuardSet branchGuards;
+  switch (t->typ) {
+  case IF_THEN_ELSE_EXPR:
+    analyzeExpr(t->children->data, set);
+    branchGuards = *set;
+    learnGuards(t->children->data, 1, &branchGuards);
+    analyzeExprs(t->children->next->data, branchGuards);
+    branchGuards = *set;
+    learnGuards(t->children->data, 0, &branchGuards);
+    analyzeExprs(t->children->next->next->data, branchGuards);
+    return;
+
+  case WHILE_EXPR:
+    analyzeExpr(t->children->data, set);
+    branchGuards = *set;
+    learnGuards(t->children->data, 1, &branchGuards);
+    analyzeExprs(t->children->next->data, branchGuards);
+    return;
+
+  case ASSIGN_EXPR:
+    if (isThisField(t->children->data->idVal, &declClass, &declIndex))
+      recordStore(declClass, declIndex,
+                  rangeOf(t->children->next->data, set));
+    break;
+
+  case DOT_ASSIGN_EXPR:
+    if (findField(typeExpr(t->children->data, currClass, currMethod),
+                  t->children->next->data->idVal, &declClass, &declIndex))
+      recordStore(declClass, declIndex,
+                  rangeOf(t->children->next->next->data, set));
+    break;
+
+  default:
+    break;
+  }
+
+  for (ASTList *child = t->children; child != NULL; child = child->next) {
+    if (child->data != NULL && child->data->typ == EXPR_LIST)
+      analyzeExprs(child->data, *set);
+    else
+      analyzeExpr(child->data, set);
+  }
+}
+
+/* Records the ranges of every field store in exprList */
+static void analyzeExprs(ASTree *exprList, GuardSet set) {
+  for (ASTList *expr = exprList->children; expr && expr->data;
+       expr = expr->next) {
+    // The value stored by an assignment is computed before the store, so
+    // a guard on the assigned variable still holds for it (x = x + 1)
+    ASTree *t = expr->data;
+    if (t->typ == ASSIGN_EXPR) {
+      killGuards(t->children->next->data, &set);
+    } else if (t->typ == DOT_ASSIGN_EXPR) {
+      killGuards(t->children->data, &set);
+      killGuards(t->children->next->next->data, &set);
+    } else {
+      killGuards(t, &set);
+    }
+    analyzeExpr(t, &set);
+    killGuards(t, &set);
+  }
+}
+
+/* Returns the slot width in bytes that holds every value in r */
+static int widthFor(Range r) {
+  if (r.lo < 0)
+    return SLOT_SIZE;
+  if (r.hi <= 0xFFLL)
+    return 1;
+  if (r.hi <= 0xFFFFLL)
+    return 2;
+  if (r.hi <= 0xFFFFFFFFLL)
+    return 4;
+  return SLOT_SIZE;
+}
+
+/* Narrows the slots of nat fields that provably hold small values. */
+void narrowFieldStorage() {
+  fieldRanges = (Range **)malloc(sizeof(Range *) * numClasses);
+  fieldGrowth = (int **)malloc(sizeof(int *) * numClasses);
+  for (int i = 0; i < numClasses; i++) {
+    fieldRanges[i] =
+        (Range *)malloc(sizeof(Range) * (classesST[i].numVars + 1));
+    fieldGrowth[i] = (int *)calloc(classesST[i].numVars + 1, sizeof(int));
+    for (int j = 0; j < classesST[i].numVars; j++)
+      fieldRanges[i][j] = singleValue(0); // fields start out as 0
+  }
+
+  GuardSet noGuards;
+  noGuards.numGuards = 0;
+  do {
+    rangesChanged = 0;
+    for (int i = 1; i < numClasses; i++) {
+      for (int j = 0; j < classesST[i].numMethods && !isIntrinsicClass(i);
+           j++) {
+        currClass = i;
+        currMethod = j;
+        analyzeExprs(classesST[i].methodList[j].bodyExprs, noGuards);
+      }
+    }
+    currClass = -1;
+    currMethod = -1;
+    analyzeExprs(mainExprs, noGuards);
+  } while (rangesChanged);
+
+  // The runtime stores a pointer in the state of intrinsic classes
+  for (int i = 1; i < numClasses; i++)
+    for (int j = 0; j < classesST[i].numVars; j++)
+      if (classesST[i].varList[j].type == -1 && !isIntrinsicClass(i))
+        setFieldWidth(i, j, widthFor(fieldRanges[i][j]));
+}
@@ -0,0 +1,229 @@
+#include "../../include/options.h"
+#include "../../include/codegen.h"
+#include "../../include/customize.h"
+#include "../../include/heapdump.h"
+#include "../../include/passes.h"
+#include "../../include/preeval.h"
+#include "../../include/profile.h"
+#include "../../include/strmethods.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+CompilerOptions options;
+
+/* Prints the usage message and exits the compiler */
+static void exitWithUsage() {
+  printf("Usage: dj [options] filename\n");
+  printf("Options:\n");
+  printf("  -O0, -O1, -O2, -Os     optimization level: none (default), cheap, "
+         "all, or for size\n");
+  printf("  --PASS                 run optimization pass PASS whatever the "
+         "level, e.g. --ipcp\n");
+  printf("  --disable-pass=PASS    do not run optimization pass PASS\n");
+  printf("  --list-passes          list the optimization passes and exit\n");
+  printf("  --time-passes          print the time each optimization pass "
+         "takes\n");
+  printf("  --pass-stats           print how each optimization pass changes "
+         "the program\n");
+  printf("  --dump-after=PASS      print the program after pass PASS (or "
+         "after every pass, with all)\n");
+  printf("  --layout-report        print the layout of every class's "
+         "objects\n");
+  printf("Optimization passes:\n");
+  printf("  --assume-asserts       use assert conditions as facts when "
+         "optimizing the code after them\n");
+  printf("  --no-asserts           type check asserts but emit no code for "
+         "them\n");
+  printf("  --narrow-fields        store nat fields that provably hold small "
+         "values in 8/16/32-bit slots\n");
+  printf("  --dead-fields          remove fields that are never read from "
+         "object layouts\n");
+  printf("  --ipcp                 propagate constant arguments into methods "
+         "and clone methods for hot constant arguments\n");
+  printf("  --customize            clone inherited methods per subclass so "
+         "calls on `this` are direct\n");
+  printf("  --customize-budget=N   let customization add at most N AST nodes "
+         "(default %d)\n",
+         DEFAULT_CUSTOMIZE_BUDGET);
+  printf("  --promote-fields       keep fields of `this` in locals across "
+         "while loops that make no calls\n");
+  printf("  --compress-refs        store references as 32-bit heap offsets "
+         "behind a 32-bit type id\n");
+  printf("  --order-fields         lay out each class's fields most "
+         "frequently accessed first\n");
+  printf("  --align-objects        align objects of hot classes to cache "
+         "lines\n");
+  printf("  --rta                  leave out methods, dispatch rows, and "
+         "runtime helpers that can never run\n");
+  printf("  --prefetch             prefetch the next object in loops and "
+         "recursive calls that chase references\n");
+  printf("  --preeval              run the main block up to its first I/O at "
+         "compile time, into a heap image\n");
+  printf("  --preeval-fuel=N       let --preeval evaluate at most N "
+         "expressions (default %d)\n",
+         DEFAULT_PREEVAL_FUEL);
+  printf("  --profile-generate[=F] instrument the program to write a profile "
+         "to F (default %s)\n",
+         DEFAULT_PROFILE_FILE);
+  printf("  --profile-use[=F]      optimize using the profile in F "
+         "(default %s)\n",
+         DEFAULT_PROFILE_FILE);
+  printf("Runtime:\n");
+  printf("  --heap-limit=N[K|M|G]  let the heap grow to at most N bytes "
+         "(default 1G; %s overrides)\n",
+         HEAP_LIMIT_ENV);
+  printf("  --heap-populate        prefault heap chunks with MAP_POPULATE "
+         "(%s=0|1 overrides)\n",
+         HEAP_POPULATE_ENV);
+  printf("  --heap-hugepages       ask for transparent huge pages for the "
+         "heap (%s=0|1 overrides)\n",
+         HEAP_HUGE_PAGES_ENV);
+  printf("  --gc                   reclaim unreachable objects with a copying "
+         "collector\n");
+  printf("  --heap-dump[=F]        write a heap dump to F (default %s) on "
+         "exit and SIGUSR1\n",
+         DEFAULT_HEAP_DUMP_FILE);
+  printf("  --alloc-stats[=F]      report allocations per `new` site to "
+         "stderr (or F) on exit\n");
+  printf("  --io-uring             overlap output and input with computation "
+         "through io_uring\n");
+  exit(-1);
+}
+
+/* Returns nonzero iff str starts with prefix */
+static int hasPrefix(const char *str, const char *prefix) {
+  return strncmp(str, prefix, strlen(prefix)) == 0;
+}
+
+/* Returns the non-negative number in str; exits the compiler if str is
+   not a number */
+static int parseCount(const char *str) {
+  char *end;
+  long value = strtol(str, &end, 10);
+  if (*str == '\0' || *end != '\0' || value < 0 || value > 1000000000) {
+    printf("Bad number %s\n", str);
+    exitWithUsage();
+  }
+  return (int)value;
+}
+
+/* Returns the positive size in str, a number of bytes with an optional K,
+   M, or G suffix; exits the compiler if str is not a size */
+static long long parseSize(const char *str) {
+  char *end;
+  long long value = strtoll(str, &end, 10);
+  int shift = 0;
+  if (*end == 'K')
+    shift = 10;
+  else if (*end == 'M')
+    shift = 20;
+  else if (*end == 'G')
+    shift = 30;
+  if (shift > 0)
+    end++;
+  if (*str == '\0' || *end != '\0' || value <= 0 ||
+      value > (1LL << 40) >> shift) {
+    printf("Bad size %s\n", str);
+    exitWithUsage();
+  }
+  return value << shift;
+}
+
+/* Parses the command line into the options global.
+   Prints a usage message and exits the compiler on a bad command line. */
+void parseCommandLine(int argc, char **argv) {
+  options.sourceFile = NULL;
+  options.customizeBudget = DEFAULT_CUSTOMIZE_BUDGET;
+  options.preevalFuel = DEFAULT_PREEVAL_FUEL;
+  options.timePasses = 0;
+  options.passStats = 0;
+  options.dumpAfter = NULL;
+  options.layoutReport = 0;
+  options.heapLimit = DEFAULT_HEAP_LIMIT;
+  options.heapPopulate = 0;
+  options.heapHugePages = 0;
+  options.collectGarbage = 0;
+  options.heapDump = NULL;
+  options.allocStats = 0;
+  options.allocStatsFile = NULL;
+  options.ioUring = 0;
+  options.profileGenerate = NULL;
+  options.profileUse = NULL;
+
+  for (int i = 1; i < argc; i++) {
+    if (strCompare(argv[i], "-O0"))
+      setOptLevel(OPT_LEVEL_0);
+    else if (strCompare(argv[i], "-O1"))
+      setOptLevel(OPT_LEVEL_1);
+    else if (strCompare(argv[i], "-O2"))
+      setOptLevel(OPT_LEVEL_2);
+    else if (strCompare(argv[i], "-Os"))
+      setOptLevel(OPT_LEVEL_S);
+    else if (hasPrefix(argv[i], "--") && setPassEnabled(argv[i] + 2, 1))
+      ; // --PASS
+    else if (hasPrefix(argv[i], "--disable-pass=")) {
+      if (!setPassEnabled(argv[i] + strlen("--disable-pass="), 0)) {
+        printf("Unknown pass %s\n", argv[i] + strlen("--disable-pass="));
+        exitWithUsage();
+      }
+    } else if (strCompare(argv[i], "--list-passes")) {
+      listPasses();
+      exit(0);
+    } else if (strCompare(argv[i], "--time-passes"))
+      options.timePasses = 1;
+    else if (strCompare(argv[i], "--pass-stats"))
+      options.passStats = 1;
+    else if (strCompare(argv[i], "--layout-report"))
+      options.layoutReport = 1;
+    else if (hasPrefix(argv[i], "--dump-after=")) {
+      options.dumpAfter = argv[i] + strlen("--dump-after=");
+      if (!isPassName(options.dumpAfter)) {
+        printf("Unknown pass %s\n", options.dumpAfter);
+        exitWithUsage();
+      }
+    } else if (hasPrefix(argv[i], "--customize-budget="))
+      options.customizeBudget =
+          parseCount(argv[i] + strlen("--customize-budget="));
+    else if (hasPrefix(argv[i], "--preeval-fuel="))
+      options.preevalFuel = parseCount(argv[i] + strlen("--preeval-fuel="));
+    else if (hasPrefix(argv[i], "--heap-limit="))
+      options.heapLimit = parseSize(argv[i] + strlen("--heap-limit="));
+    else if (strCompare(argv[i], "--heap-populate"))
+      options.heapPopulate = 1;
+    else if (strCompare(argv[i], "--heap-hugepages"))
+      options.heapHugePages = 1;
+    else if (strCompare(argv[i], "--gc"))
+      options.collectGarbage = 1;
+    else if (strCompare(argv[i], "--heap-dump"))
+      options.heapDump = DEFAULT_HEAP_DUMP_FILE;
+    else if (hasPrefix(argv[i], "--heap-dump="))
+      options.heapDump = argv[i] + strlen("--heap-dump=");
+    else if (strCompare(argv[i], "--alloc-stats"))
+      options.allocStats = 1;
+    else if (hasPrefix(argv[i], "--alloc-stats=")) {
+      options.allocStats = 1;
+      options.allocStatsFile = argv[i] + strlen("--alloc-stats=");
+    }
+    else if (strCompare(argv[i], "--io-uring"))
+      options.ioUring = 1;
+    else if (strCompare(argv[i], "--profile-generate"))
+      options.profileGenerate = DEFAULT_PROFILE_FILE;
+    else if (hasPrefix(argv[i], "--profile-generate="))
+      options.profileGenerate = argv[i] + strlen("--profile-generate=");
+    else if (strCompare(argv[i], "--profile-use"))
+      options.profileUse = DEFAULT_PROFILE_FILE;
+    else if (hasPrefix(argv[i], "--profile-use="))
+      options.profileUse = argv[i] + strlen("--profile-use=");
+    else if (argv[i][0] == '-') {
+      printf("Unknown option %s\n", argv[i]);
+      exitWithUsage();
+    } else if (options.sourceFile == NULL)
+      options.sourceFile = argv[i];
+    else
+      exitWithUsage();
+  }
+
+  if (options.sourceFile == NULL)
+    exitWithUsage();
+}
@@ -0,0 +1,208 @@
+#include "../../include/passes.h"
+#include "../../include/assume.h"
+#include "../../include/customize.h"
+#include "../../include/deadfield.h"
+#include "../../include/fieldorder.h"
+#include "../../include/intrinsics.h"
+#include "../../include/ipcp.h"
+#include "../../include/narrow.h"
+#include "../../include/options.h"
+#include "../../include/preeval.h"
+#include "../../include/prefetch.h"
+#include "../../include/promote.h"
+#include "../../include/rta.h"
+#include <stdio.h>
+#include <time.h>
+
+/* Bit of an optimization level in a pass's set of levels */
+#define LEVEL(l) (1 << (l))
+
+/* Encapsulate one optimization pass: its name (also its command-line
+   flag), a description, how to run it, the optimization levels that
+   enable it, and its explicit setting (-1 when only the level decides) */
+typedef struct pass {
+  const char *name;
+  const char *description;
+  void (*run)();
+  int levels;
+  int setting;
+} Pass;
+
+static void runCustomize() {
+  customizeInheritedMethods(options.customizeBudget);
+}
+
+static void runPreeval() { preevaluateMain(options.preevalFuel); }
+
+/* Every pass, in the order they run. The order matters: dead fields must
+   be removed before clones are made, rapid type analysis must see every
+   clone and the whole main block, references are compressed after every
+   pass that changes field widths, fields are ordered after every pass
+   that changes how often they are accessed but before pre-evaluation
+   first queries a layout, and prefetch sites are found last. */
+static Pass passes[] = {
+    {"assume-asserts", "use assert conditions as facts", assumeAssertedFacts,
+     LEVEL(OPT_LEVEL_2) | LEVEL(OPT_LEVEL_S), -1},
+    {"no-asserts", "emit no code for asserts (changes behavior)",
+     stripAsserts, 0, -1},
+    {"narrow-fields", "narrow slots of small nat fields", narrowFieldStorage,
+     LEVEL(OPT_LEVEL_2) | LEVEL(OPT_LEVEL_S), -1},
+    {"dead-fields", "remove fields that are never read", eliminateDeadFields,
+     LEVEL(OPT_LEVEL_1) | LEVEL(OPT_LEVEL_2) | LEVEL(OPT_LEVEL_S), -1},
+    {"ipcp", "constant propagation and cloning", propagateArgumentConstants,
+     LEVEL(OPT_LEVEL_2), -1},
+    {"customize", "per-subclass clones of inherited methods", runCustomize,
+     LEVEL(OPT_LEVEL_2), -1},
+    {"promote-fields", "keep fields of `this` in locals across loops",
+     promoteLoopFields, LEVEL(OPT_LEVEL_1) | LEVEL(OPT_LEVEL_2), -1},
+    {"rta", "leave out code that can never run", runRapidTypeAnalysis,
+     LEVEL(OPT_LEVEL_1) | LEVEL(OPT_LEVEL_2) | LEVEL(OPT_LEVEL_S), -1},
+    {"compress-refs", "32-bit references and type ids in objects",
+     compressReferences, LEVEL(OPT_LEVEL_2) | LEVEL(OPT_LEVEL_S), -1},
+    {"order-fields", "lay out hot fields first", orderFieldsByAccess,
+     LEVEL(OPT_LEVEL_1) | LEVEL(OPT_LEVEL_2) | LEVEL(OPT_LEVEL_S), -1},
+    {"align-objects", "align objects of hot classes to cache lines",
+     alignHotClasses, LEVEL(OPT_LEVEL_2), -1},
+    {"preeval", "run the start of main at compile time", runPreeval,
+     LEVEL(OPT_LEVEL_2), -1},
+    {"prefetch", "prefetch objects ahead of pointer chasing",
+     findPrefetchSites, LEVEL(OPT_LEVEL_2), -1},
+};
+
+#define NUM_PASSES ((int)(sizeof(passes) / sizeof(passes[0])))
+
+/* The selected optimization level */
+static OptLevel optLevel = OPT_LEVEL_0;
+
+/* Selects the optimization level. */
+void setOptLevel(OptLevel level) { optLevel = level; }
+
+/* Returns the pass called name, or NULL */
+static Pass *findPass(const char *name) {
+  for (int i = 0; i < NUM_PASSES; i++)
+    if (strCompare(name, passes[i].name))
+      return &passes[i];
+  return NULL;
+}
+
+/* Explicitly enables or disables a pass. */
+int setPassEnabled(const char *name, int enabled) {
+  Pass *pass = findPass(name);
+  if (pass == NULL)
+    return 0;
+  pass->setting = enabled != 0;
+  return 1;
+}
+
+/* Returns nonzero iff name is the name of a pass, or "all" */
+int isPassName(const char *name) {
+  return findPass(name) != NULL || strCompare(name, "all");
+}
+
+/* Returns nonzero iff pass runs */
+static int isEnabled(Pass *pass) {
+  if (pass->setting >= 0)
+    return pass->setting;
+  return (pass->levels & LEVEL(optLevel)) != 0;
+}
+
+/* Prints the passes in the order they run. */
+void listPasses() {
+  const char *levelNames[] = {"O0", "O1", "O2", "Os"};
+  for (int i = 0; i < NUM_PASSES; i++) {
+    printf("  %-16s %-46s", passes[i].name, passes[i].description);
+    for (int l = OPT_LEVEL_1; l <= OPT_LEVEL_S; l++)
+      if (passes[i].levels & LEVEL(l))
+        printf(" -%s", levelNames[l]);
+    printf("\n");
+  }
+}
+
+/* Returns the number of AST nodes in t */
+static long countNodes(ASTree *t) {
+  if (t == NULL)
+    return 0;
+  long count = 1;
+  for (ASTList *child = t->children; child != NULL; child = child->next)
+    count += countNodes(child->data);
+  return count;
+}
+
+/* Returns the number of AST nodes in the code of the whole program: the
+   main block, the method bodies, and the method clones */
+static long countProgramNodes() {
+  long count = countNodes(mainExprs);
+  for (int i = 1; i < numClasses; i++)
+    for (int j = 0; j < classesST[i].numMethods; j++)
+      count += countNodes(classesST[i].methodList[j].bodyExprs);
+  for (int i = 0; i < numMethodClones; i++)
+    count += countNodes(methodClones[i].bodyExprs);
+  return count;
+}
+
+/* Prints the code of the whole program, after the pass called name */
+static void dumpProgram(const char *name) {
+  printf("****** program after %s ******\n", name);
+  printf("main:\n");
+  printAST(mainExprs);
+  for (int i = 1; i < numClasses; i++) {
+    for (int j = 0; j < classesST[i].numMethods && !isIntrinsicClass(i);
+         j++) {
+      printf("%s.%s (class%dmethod%d):\n", classesST[i].className,
+             classesST[i].methodList[j].methodName, i, j);
+      printAST(classesST[i].methodList[j].bodyExprs);
+    }
+  }
+  for (int i = 0; i < numMethodClones; i++) {
+    printf("%s.%s (%s):\n", classesST[methodClones[i].classNum].className,
+           classesST[methodClones[i].classNum]
+               .methodList[methodClones[i].methodNum]
+               .methodName,
+           methodClones[i].label);
+    printAST(methodClones[i].bodyExprs);
+  }
+  printf("****** end program after %s ******\n", name);
+}
+
+/* Runs the enabled optimization passes. */
+void runPasses() {
+  int report = options.timePasses || options.passStats;
+  if (report)
+    printf("****** optimization passes ******\n");
+
+  double totalMs = 0;
+  for (int i = 0; i < NUM_PASSES; i++) {
+    Pass *pass = &passes[i];
+    if (!isEnabled(pass))
+      continue;
+
+    long nodesBefore = options.passStats ? countProgramNodes() : 0;
+    int clonesBefore = numMethodClones;
+    clock_t start = clock();
+    pass->run();
+    double ms = 1000.0 * (clock() - start) / CLOCKS_PER_SEC;
+    totalMs += ms;
+
+    if (report) {
+      printf("  %-16s", pass->name);
+      if (options.timePasses)
+        printf(" %9.3f ms", ms);
+      if (options.passStats)
+        printf("  AST nodes %6ld -> %6ld  clones %+d", nodesBefore,
+               countProgramNodes(), numMethodClones - clonesBefore);
+      printf("\n");
+    }
+    if (options.dumpAfter != NULL &&
+        (strCompare(options.dumpAfter, pass->name) ||
+         strCompare(options.dumpAfter, "all")))
+      dumpProgram(pass->name);
+  }
+
+  if (options.timePasses)
+    printf("  %-16s %9.3f ms\n", "total", totalMs);
+  if (report)
+    printf("****** end optimization passes ******\n");
+  if (options.layoutReport)
+    printLayoutReport();
+  fflush(stdout); // before the compiled program's output
+}
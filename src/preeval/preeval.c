@@ -0,0 +1,359 @@
+#include "../../include/preeval.h"
+#include "../../include/intrinsics.h"
+#include <setjmp.h>
+#include <stdint.h>
+#include <string.h>
+
+/* Largest heap image, in bytes */
+#define MAX_IMAGE_BYTES (65536 * SLOT_SIZE)
+/* Deepest nesting of method calls the interpreter follows */
+#define MAX_CALL_DEPTH 1000
+/* Most locals of all active calls together */
+#define MAX_FRAME_SLOTS 65536
+
+int heapImageWords = 0;
+ImageWord *heapImage = NULL;
+ImageWord *mainLocalsImage = NULL;
+
+/* A run-time value: a nat, or a reference (isRef set) to the object at
+   byte offset value of the image. Null is the nat 0. */
+typedef ImageWord Value;
+
+/* Encapsulate one active method call (class -1 for the main block) */
+typedef struct frame {
+  int classNum, methodNum;
+  Value thisVal;
+  Value param;
+  Value *locals;
+} Frame;
+
+/* The heap image being built, a byte per byte of object memory, and
+   whether each word holds a reference */
+static unsigned char *heapBytes;
+static unsigned char *wordIsRef;
+static int heapTop; // bytes of the image in use
+
+/* Storage for the locals of every active call */
+static Value frameSlots[MAX_FRAME_SLOTS];
+static int frameSlotsUsed;
+static int callDepth;
+
+/* Evaluation steps left, and where to go when evaluation must stop */
+static long fuelLeft;
+static jmp_buf stopEvaluation;
+
+/* Abandons the statement being evaluated */
+static void stop() { longjmp(stopEvaluation, 1); }
+
+static Value natValue(long long n) {
+  Value v;
+  v.value = n;
+  v.isRef = 0;
+  return v;
+}
+
+/* Returns the object reference in v, stopping on null */
+static long long objectOffset(Value v) {
+  if (!v.isRef)
+    stop(); // null dereference: leave it to run time
+  return v.value;
+}
+
+/* Returns the dynamic type of the object at offset obj */
+static int dynamicType(long long obj) {
+  long long typeId = 0;
+  memcpy(&typeId, heapBytes + obj, getHeaderSize());
+  return (int)typeId;
+}
+
+/* Reads the field in slot of the object at offset obj, zero-extending
+   narrow slots as code gen's loads do */
+static Value loadField(long long obj, FieldSlot slot) {
+  unsigned long long bits = 0;
+  memcpy(&bits, heapBytes + obj + slot.offset, slot.width);
+  Value v = natValue((long long)bits);
+  if (slot.compressed && bits != 0)
+    v.isRef = 1; // the image is laid out as the heap, so offsets agree
+  if (slot.width == SLOT_SIZE && wordIsRef[(obj + slot.offset) / SLOT_SIZE])
+    v.isRef = 1;
+  return v;
+}
+
+/* Stores v into slot of the object at offset obj, truncating to the
+   width of narrow slots as code gen's stores do */
+static void storeField(long long obj, FieldSlot slot, Value v) {
+  if (slot.width == 0)
+    return; // the field was removed from the layout
+  unsigned long long bits = (unsigned long long)v.value;
+  memcpy(heapBytes + obj + slot.offset, &bits, slot.width);
+  if (slot.width == SLOT_SIZE)
+    wordIsRef[(obj + slot.offset) / SLOT_SIZE] = (unsigned char)v.isRef;
+}
+
+/* Allocates a zeroed object of class classNum; returns a reference to it */
+static Value newObject(int classNum) {
+  int size = getObjectSize(classNum);
+  int alignment = getObjectAlignment(classNum);
+  heapTop = (heapTop + alignment - 1) / alignment * alignment;
+  if (heapTop + size > MAX_IMAGE_BYTES)
+    stop();
+  Value v;
+  v.value = heapTop;
+  v.isRef = 1;
+  long long typeId = classNum;
+  memcpy(heapBytes + heapTop, &typeId, getHeaderSize());
+  heapTop += size;
+  return v;
+}
+
+/* Finds the variable called name in frame f, in code gen's lookup order
+   (parameter, then locals, then fields of `this`). Returns a pointer to
+   a parameter or local, or NULL for a field. */
+static Value *findVariable(Frame *f, char *name) {
+  if (f->classNum < 0) {
+    for (int i = 0; i < numMainBlockLocals; i++)
+      if (strCompare(name, mainBlockST[i].varName))
+        return &f->locals[i];
+    return NULL;
+  }
+  MethodDecl *method = &classesST[f->classNum].methodList[f->methodNum];
+  if (strCompare(name, method->paramName))
+    return &f->param;
+  for (int i = 0; i < method->numLocals; i++)
+    if (strCompare(name, method->localST[i].varName))
+      return &f->locals[i];
+  return NULL;
+}
+
+static Value evalExpr(ASTree *t, Frame *f);
+
+/* Evaluates an expression list; returns the value of its last expression */
+static Value evalExprs(ASTree *list, Frame *f) {
+  Value v = natValue(0);
+  for (ASTList *e = list->children; e != NULL && e->data != NULL; e = e->next)
+    v = evalExpr(e->data, f);
+  return v;
+}
+
+/* Runs the method a call resolved to (staticClass, staticMethod)
+   dispatches to on receiver, passing arg */
+static Value callMethod(Value receiver, int staticClass, int staticMethod,
+                        Value arg) {
+  int targetClass, targetMethod;
+  if (!resolveMethod(dynamicType(objectOffset(receiver)), staticClass,
+                     staticMethod, &targetClass, &targetMethod))
+    stop();
+  // The storage of intrinsic classes lives in the runtime
+  if (isIntrinsicClass(targetClass))
+    stop();
+
+  MethodDecl *method = &classesST[targetClass].methodList[targetMethod];
+  if (callDepth == MAX_CALL_DEPTH ||
+      frameSlotsUsed + method->numLocals > MAX_FRAME_SLOTS)
+    stop();
+
+  Frame callee;
+  callee.classNum = targetClass;
+  callee.methodNum = targetMethod;
+  callee.thisVal = receiver;
+  callee.param = arg;
+  callee.locals = &frameSlots[frameSlotsUsed];
+  for (int i = 0; i < method->numLocals; i++)
+    callee.locals[i] = natValue(0);
+
+  frameSlotsUsed += method->numLocals;
+  callDepth++;
+  Value result = evalExprs(method->bodyExprs, &callee);
+  callDepth--;
+  frameSlotsUsed -= method->numLocals;
+  return result;
+}
+
+/* Evaluates t in frame f, with the semantics of the code that code gen
+   emits for it */
+static Value evalExpr(ASTree *t, Frame *f) {
+  if (--fuelLeft < 0)
+    stop();
+
+  Value left, right, *var;
+  FieldSlot slot;
+  switch (t->typ) {
+  case NAT_LITERAL_EXPR:
+    // Code gen emits a literal as a sign-extended 32-bit immediate
+    return natValue((long long)(int32_t)t->natVal);
+  case NULL_EXPR:
+    return natValue(0);
+  case THIS_EXPR:
+    return f->thisVal;
+  case NEW_EXPR:
+    return newObject(classNameToNumber(t->children->data->idVal));
+
+  case ID_EXPR:
+    var = findVariable(f, t->children->data->idVal);
+    if (var != NULL)
+      return *var;
+    return loadField(objectOffset(f->thisVal),
+                     getFieldSlot(f->classNum, t->children->data->idVal));
+
+  case DOT_ID_EXPR:
+    left = evalExpr(t->children->data, f);
+    slot = getFieldSlot(typeExpr(t->children->data, f->classNum, f->methodNum),
+                        t->children->next->data->idVal);
+    return loadField(objectOffset(left), slot);
+
+  case ASSIGN_EXPR:
+    right = evalExpr(t->children->next->data, f);
+    var = findVariable(f, t->children->data->idVal);
+    if (var != NULL)
+      *var = right;
+    else
+      storeField(objectOffset(f->thisVal),
+                 getFieldSlot(f->classNum, t->children->data->idVal), right);
+    return right;
+
+  case DOT_ASSIGN_EXPR:
+    // Code gen evaluates the value before the object
+    right = evalExpr(t->children->next->next->data, f);
+    left = evalExpr(t->children->data, f);
+    slot = getFieldSlot(typeExpr(t->children->data, f->classNum, f->methodNum),
+                        t->children->next->data->idVal);
+    storeField(objectOffset(left), slot, right);
+    return right;
+
+  case METHOD_CALL_EXPR:
+    right = evalExpr(t->children->next->data, f);
+    return callMethod(f->thisVal, t->staticClassNum, t->staticMemberNum,
+                      right);
+  case DOT_METHOD_CALL_EXPR:
+    left = evalExpr(t->children->data, f);
+    objectOffset(left); // code gen checks the receiver before the argument
+    right = evalExpr(t->children->next->next->data, f);
+    return callMethod(left, t->staticClassNum, t->staticMemberNum, right);
+
+  case PLUS_EXPR:
+  case MINUS_EXPR:
+  case TIMES_EXPR: {
+    // Arithmetic wraps around at 64 bits
+    unsigned long long a =
+        (unsigned long long)evalExpr(t->children->data, f).value;
+    unsigned long long b =
+        (unsigned long long)evalExpr(t->children->next->data, f).value;
+    unsigned long long r =
+        t->typ == PLUS_EXPR ? a + b : t->typ == MINUS_EXPR ? a - b : a * b;
+    return natValue((long long)r);
+  }
+
+  case EQUALITY_EXPR:
+    left = evalExpr(t->children->data, f);
+    right = evalExpr(t->children->next->data, f);
+    return natValue(left.value == right.value && left.isRef == right.isRef);
+  case LESS_THAN_EXPR:
+    left = evalExpr(t->children->data, f);
+    right = evalExpr(t->children->next->data, f);
+    return natValue(left.value < right.value);
+  case NOT_EXPR:
+    return natValue(evalExpr(t->children->data, f).value == 0);
+  case OR_EXPR:
+    if (evalExpr(t->children->data, f).value != 0)
+      return natValue(1);
+    return natValue(evalExpr(t->children->next->data, f).value != 0);
+
+  case ASSERT_EXPR:
+    left = evalExpr(t->children->data, f);
+    if (left.value == 0)
+      stop(); // the failure must happen at run time
+    return left;
+
+  case IF_THEN_ELSE_EXPR:
+    if (evalExpr(t->children->data, f).value != 0)
+      return evalExprs(t->children->next->data, f);
+    return evalExprs(t->children->next->next->data, f);
+
+  case WHILE_EXPR:
+    while (evalExpr(t->children->data, f).value != 0)
+      evalExprs(t->children->next->data, f);
+    return natValue(0);
+
+  default:
+    // printNat and readNat must happen at run time
+    stop();
+  }
+  return natValue(0);
+}
+
+/* Evaluates the deterministic prefix of the main block at compile time. */
+void preevaluateMain(int fuel) {
+  heapBytes = (unsigned char *)calloc(MAX_IMAGE_BYTES, 1);
+  wordIsRef = (unsigned char *)calloc(MAX_IMAGE_BYTES / SLOT_SIZE, 1);
+  unsigned char *savedBytes = (unsigned char *)malloc(MAX_IMAGE_BYTES);
+  unsigned char *savedIsRef = (unsigned char *)malloc(MAX_IMAGE_BYTES / SLOT_SIZE);
+  Value *locals = (Value *)calloc(numMainBlockLocals + 1, sizeof(Value));
+  Value *savedLocals = (Value *)malloc(sizeof(Value) * (numMainBlockLocals + 1));
+  // With compressed references, offset 0 encodes null
+  heapTop = referencesCompressed() ? SLOT_SIZE : 0;
+  fuelLeft = fuel;
+
+  Frame mainFrame;
+  mainFrame.classNum = -1;
+  mainFrame.methodNum = -1;
+  mainFrame.thisVal = natValue(0);
+  mainFrame.param = natValue(0);
+  mainFrame.locals = locals;
+
+  // Evaluate whole statements, undoing the one that has to stop
+  int evaluated = 0;
+  ASTList *stmt = mainExprs->children;
+  while (stmt != NULL && stmt->data != NULL) {
+    int savedTop = heapTop;
+    memcpy(savedBytes, heapBytes, heapTop);
+    memcpy(savedIsRef, wordIsRef, heapTop / SLOT_SIZE);
+    memcpy(savedLocals, locals, sizeof(Value) * numMainBlockLocals);
+    frameSlotsUsed = 0;
+    callDepth = 0;
+    if (setjmp(stopEvaluation)) {
+      heapTop = savedTop;
+      memcpy(heapBytes, savedBytes, heapTop);
+      memcpy(wordIsRef, savedIsRef, heapTop / SLOT_SIZE);
+      memcpy(locals, savedLocals, sizeof(Value) * numMainBlockLocals);
+      break;
+    }
+    evalExpr(stmt->data, &mainFrame);
+    evaluated++;
+    stmt = stmt->next;
+  }
+
+  if (evaluated > 0) {
+    // Drop the evaluated statements, keeping the main block non-empty
+    ASTList *rest = mainExprs->children;
+    for (int i = 0; i < evaluated; i++) {
+      ASTList *next = rest->next;
+      freeAST(rest->data);
+      free(rest);
+      rest = next;
+    }
+    mainExprs->children = rest;
+    if (rest == NULL) {
+      mainExprs->children = (ASTList *)malloc(sizeof(ASTList));
+      mainExprs->children->data =
+          newAST(NAT_LITERAL_EXPR, NULL, 0, NULL, mainExprs->lineNumber);
+      mainExprs->children->next = NULL;
+      mainExprs->childrenTail = mainExprs->children;
+    }
+
+    heapImageWords = heapTop / SLOT_SIZE;
+    heapImage = (ImageWord *)malloc(sizeof(ImageWord) * (heapImageWords + 1));
+    for (int i = 0; i < heapImageWords; i++) {
+      memcpy(&heapImage[i].value, heapBytes + i * SLOT_SIZE, SLOT_SIZE);
+      heapImage[i].isRef = wordIsRef[i];
+    }
+    mainLocalsImage = locals;
+  } else {
+    free(locals);
+  }
+
+  free(heapBytes);
+  free(wordIsRef);
+  free(savedBytes);
+  free(savedIsRef);
+  free(savedLocals);
+}
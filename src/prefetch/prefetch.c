@@ -0,0 +1,192 @@
+#include "../../include/prefetch.h"
+#include <stdlib.h>
+
+/* Most prefetches emitted at the start of one loop body or method */
+#define MAX_PREFETCHES_PER_SITE 4
+
+int numPrefetchSites = 0;
+PrefetchSite *prefetchSites = NULL;
+
+/* Capacity of the prefetchSites array */
+static int sitesCapacity = 0;
+
+/* The method being searched (class -1 for the main block), and its body */
+static int currClass, currMethod;
+static ASTree *currBody;
+
+/* Returns the type of the field called name in objects of class
+   classNum, or -3 if there is no such field */
+static int fieldType(int classNum, char *name) {
+  while (classNum > 0) {
+    ClassDecl *class = &classesST[classNum];
+    for (int i = 0; i < class->numVars; i++)
+      if (strCompare(name, class->varList[i].varName))
+        return class->varList[i].type;
+    classNum = class->superclass;
+  }
+  return -3;
+}
+
+/* Returns the type of the parameter or local variable called name in the
+   current method, or -3 if name is not one */
+static int variableType(char *name) {
+  if (currClass < 0) {
+    for (int i = 0; i < numMainBlockLocals; i++)
+      if (strCompare(name, mainBlockST[i].varName))
+        return mainBlockST[i].type;
+    return -3;
+  }
+
+  MethodDecl *method = &classesST[currClass].methodList[currMethod];
+  if (strCompare(name, method->paramName))
+    return method->paramType;
+  for (int i = 0; i < method->numLocals; i++)
+    if (strCompare(name, method->localST[i].varName))
+      return method->localST[i].type;
+  return -3;
+}
+
+/* Returns the number of prefetches already recorded for anchor, and
+   whether one of them loads field from a base that reads name */
+static int countSites(ASTree *anchor, char *name, char *field, int *dup) {
+  int count = 0;
+  *dup = 0;
+  for (int i = 0; i < numPrefetchSites; i++) {
+    if (prefetchSites[i].anchor != anchor)
+      continue;
+    count++;
+    ASTree *base = prefetchSites[i].baseExpr;
+    char *baseName = base->typ == ID_EXPR ? base->children->data->idVal : "";
+    if (strCompare(baseName, name) &&
+        strCompare(prefetchSites[i].field, field))
+      *dup = 1;
+  }
+  return count;
+}
+
+/* Records a prefetch of the object that field of the object baseExpr
+   points to, at the start of anchor. name is the variable baseExpr
+   reads, or "" for `this`. Takes ownership of baseExpr. */
+static void addSite(ASTree *anchor, ASTree *baseExpr, int baseType,
+                    char *name, char *field) {
+  int dup;
+  int targetType = fieldType(baseType, field);
+  if (targetType <= 0 ||
+      countSites(anchor, name, field, &dup) >= MAX_PREFETCHES_PER_SITE ||
+      dup) {
+    freeAST(baseExpr);
+    return;
+  }
+
+  if (numPrefetchSites == sitesCapacity) {
+    sitesCapacity = sitesCapacity ? sitesCapacity * 2 : 8;
+    prefetchSites = (PrefetchSite *)realloc(
+        prefetchSites, sizeof(PrefetchSite) * sitesCapacity);
+  }
+  PrefetchSite *site = &prefetchSites[numPrefetchSites++];
+  site->anchor = anchor;
+  site->baseExpr = baseExpr;
+  site->baseType = baseType;
+  site->field = field;
+  site->targetType = targetType;
+}
+
+/* Returns a new ID expression reading the variable called name */
+static ASTree *variableAST(char *name, unsigned int line) {
+  return newAST(ID_EXPR, newAST(AST_ID, NULL, 0, getID(name), line), 0, NULL,
+                line);
+}
+
+/* Records the prefetches for a while loop whose body walks a variable
+   along a reference field: x = x.f anywhere in t */
+static void findWalks(ASTree *loop, ASTree *t) {
+  if (t == NULL)
+    return;
+
+  if (t->typ == ASSIGN_EXPR) {
+    char *name = t->children->data->idVal;
+    ASTree *value = t->children->next->data;
+    int type = variableType(name);
+    if (type > 0 && value->typ == DOT_ID_EXPR &&
+        value->children->data->typ == ID_EXPR &&
+        strCompare(value->children->data->children->data->idVal, name))
+      addSite(loop->children->next->data, variableAST(name, t->lineNumber),
+              type, name, value->children->next->data->idVal);
+  }
+
+  for (ASTList *child = t->children; child != NULL; child = child->next)
+    findWalks(loop, child->data);
+}
+
+/* Returns nonzero iff the call t may run the method being searched */
+static int isRecursiveCall(ASTree *t) {
+  if (currClass < 0)
+    return 0;
+  if (t->callTarget != NULL) {
+    MethodClone *clone = findMethodClone(t->callTarget);
+    if (clone != NULL)
+      return clone->classNum == currClass && clone->methodNum == currMethod;
+    return strCompare(t->callTarget, methodLabel(currClass, currMethod));
+  }
+  return callMayReach(t->staticClassNum, t->staticMemberNum, currClass,
+                      currMethod);
+}
+
+/* Records the prefetch for a recursive call whose receiver or argument is
+   the reference field of `this` or of the parameter read by e */
+static void findRecursiveField(ASTree *e) {
+  MethodDecl *method = &classesST[currClass].methodList[currMethod];
+  if (e->typ == ID_EXPR && variableType(e->children->data->idVal) == -3) {
+    // An unqualified field of `this`
+    addSite(currBody, newAST(THIS_EXPR, NULL, 0, NULL, e->lineNumber),
+            currClass, "", e->children->data->idVal);
+  } else if (e->typ == DOT_ID_EXPR &&
+             e->children->data->typ == THIS_EXPR) {
+    addSite(currBody, newAST(THIS_EXPR, NULL, 0, NULL, e->lineNumber),
+            currClass, "", e->children->next->data->idVal);
+  } else if (e->typ == DOT_ID_EXPR && e->children->data->typ == ID_EXPR &&
+             strCompare(e->children->data->children->data->idVal,
+                        method->paramName) &&
+             method->paramType > 0) {
+    addSite(currBody, variableAST(method->paramName, e->lineNumber),
+            method->paramType, method->paramName,
+            e->children->next->data->idVal);
+  }
+}
+
+/* Searches t for pointer-chasing loops and recursive calls */
+static void searchExpr(ASTree *t) {
+  if (t == NULL)
+    return;
+
+  if (t->typ == WHILE_EXPR) {
+    findWalks(t, t->children->next->data);
+  } else if ((t->typ == METHOD_CALL_EXPR || t->typ == DOT_METHOD_CALL_EXPR) &&
+             isRecursiveCall(t)) {
+    if (t->typ == DOT_METHOD_CALL_EXPR)
+      findRecursiveField(t->children->data);
+    findRecursiveField(t->childrenTail->data);
+  }
+
+  for (ASTList *child = t->children; child != NULL; child = child->next)
+    searchExpr(child->data);
+}
+
+/* Searches one method body, or the main block */
+static void searchBody(int classNum, int methodNum, ASTree *body) {
+  currClass = classNum;
+  currMethod = methodNum;
+  currBody = body;
+  searchExpr(body);
+}
+
+/* Finds pointer-chasing code and records where to prefetch. */
+void findPrefetchSites() {
+  for (int i = 1; i < numClasses; i++)
+    for (int j = 0; j < classesST[i].numMethods; j++)
+      searchBody(i, j, classesST[i].methodList[j].bodyExprs);
+  for (int i = 0; i < numMethodClones; i++)
+    searchBody(methodClones[i].classNum, methodClones[i].methodNum,
+               methodClones[i].bodyExprs);
+  searchBody(-1, -1, mainExprs);
+}
@@ -0,0 +1,173 @@
+#include "../../include/profile.h"
+#include <stdio.h>
+#include <string.h>
+
+/* Magic string that starts every profile file */
+#define PROFILE_MAGIC "DJPROF01"
+
+int numProfileMethods = 0;
+int numProfileBranches = 0;
+int numProfileCalls = 0;
+
+/* The identities of the call sites (see profileCallIdentity), indexed by
+   call-site number. Optimizations may free the call nodes themselves
+   before code gen asks for them. */
+static long long *callIdentities = NULL;
+static int callIdentitiesCapacity = 0;
+
+/* The counts read from the profile, laid out as in the profile file:
+   method entries; then taken and not-taken counts of each branch site;
+   then, for each call site, a count per receiver type (class number) */
+static long long *methodCounts = NULL;
+static long long *branchCounts = NULL;
+static long long *receiverCounts = NULL;
+
+/* The file instrumented programs write their profile to */
+static char *outputFile = NULL;
+
+/* Makes code gen instrument the program with profile counters. */
+void instrumentForProfile(char *fileName) { outputFile = fileName; }
+
+/* Returns the file an instrumented program writes its profile to. */
+char *profileOutputFile() { return outputFile; }
+
+/* Numbers the branch and call sites in t */
+static void numberSites(ASTree *t) {
+  if (t == NULL)
+    return;
+
+  if (t->typ == IF_THEN_ELSE_EXPR || t->typ == WHILE_EXPR) {
+    t->profileSite = ++numProfileBranches;
+  } else if (t->typ == METHOD_CALL_EXPR || t->typ == DOT_METHOD_CALL_EXPR) {
+    if (numProfileCalls == callIdentitiesCapacity) {
+      callIdentitiesCapacity =
+          callIdentitiesCapacity ? callIdentitiesCapacity * 2 : 16;
+      callIdentities = (long long *)realloc(
+          callIdentities, sizeof(long long) * callIdentitiesCapacity);
+    }
+    callIdentities[numProfileCalls] =
+        (long long)t->staticClassNum << 32 | t->staticMemberNum;
+    t->profileSite = ++numProfileCalls;
+  }
+
+  for (ASTList *child = t->children; child != NULL; child = child->next)
+    numberSites(child->data);
+}
+
+/* Numbers the profile sites of the program. */
+void numberProfileSites() {
+  numberSites(mainExprs);
+  for (int i = 1; i < numClasses; i++) {
+    numProfileMethods += classesST[i].numMethods;
+    for (int j = 0; j < classesST[i].numMethods; j++)
+      numberSites(classesST[i].methodList[j].bodyExprs);
+  }
+}
+
+/* Returns the index of a method among the method-entry counters. */
+int profileMethodIndex(int classNum, int methodNum) {
+  int index = methodNum;
+  for (int i = 1; i < classNum; i++)
+    index += classesST[i].numMethods;
+  return index;
+}
+
+/* Returns the statically resolved identity of a call site. */
+long long profileCallIdentity(int site) { return callIdentities[site]; }
+
+/* Reads count 8-byte words from in into words; returns nonzero on success */
+static int readWords(FILE *in, long long *words, size_t count) {
+  return fread(words, sizeof(long long), count, in) == count;
+}
+
+/* Reads a profile and checks that it matches the program */
+static int loadProfile(FILE *in) {
+  char magic[8];
+  long long sizes[4];
+  if (fread(magic, 1, sizeof(magic), in) != sizeof(magic) ||
+      memcmp(magic, PROFILE_MAGIC, sizeof(magic)) != 0 ||
+      !readWords(in, sizes, 4) || sizes[0] != numProfileMethods ||
+      sizes[1] != numProfileBranches || sizes[2] != numProfileCalls ||
+      sizes[3] != numClasses)
+    return 0;
+
+  methodCounts = (long long *)calloc(numProfileMethods + 1, sizeof(long long));
+  branchCounts =
+      (long long *)calloc(2 * numProfileBranches + 1, sizeof(long long));
+  long long *identities =
+      (long long *)calloc(numProfileCalls + 1, sizeof(long long));
+  receiverCounts = (long long *)calloc(
+      (size_t)numProfileCalls * numClasses + 1, sizeof(long long));
+  int ok = readWords(in, methodCounts, numProfileMethods) &&
+           readWords(in, branchCounts, 2 * numProfileBranches) &&
+           readWords(in, identities, numProfileCalls) &&
+           readWords(in, receiverCounts, (size_t)numProfileCalls * numClasses);
+  for (int i = 0; ok && i < numProfileCalls; i++)
+    ok = identities[i] == profileCallIdentity(i);
+  free(identities);
+
+  if (!ok) {
+    free(methodCounts);
+    free(branchCounts);
+    free(receiverCounts);
+    methodCounts = branchCounts = receiverCounts = NULL;
+  }
+  return ok;
+}
+
+/* Reads the profile in fileName. */
+void readProfile(char *fileName) {
+  FILE *in = fopen(fileName, "rb");
+  if (in == NULL) {
+    printf("Warning: could not open profile %s; compiling without it\n",
+           fileName);
+    return;
+  }
+  if (!loadProfile(in))
+    printf("Warning: profile %s does not match this program; "
+           "compiling without it\n",
+           fileName);
+  fclose(in);
+}
+
+/* Returns nonzero iff a profile has been read */
+int haveProfile() { return methodCounts != NULL; }
+
+/* Returns the number of times a method was entered. */
+long long methodEntryCount(int classNum, int methodNum) {
+  if (!haveProfile())
+    return 0;
+  return methodCounts[profileMethodIndex(classNum, methodNum)];
+}
+
+/* Returns how often a branch site went each way. */
+long long branchCount(ASTree *t, int taken) {
+  if (!haveProfile() || t->profileSite == 0)
+    return 0;
+  return branchCounts[2 * (t->profileSite - 1) + (taken ? 0 : 1)];
+}
+
+/* Returns the number of calls at a call site with a given receiver type. */
+long long receiverCount(ASTree *t, int dynamicType) {
+  if (!haveProfile() || t->profileSite == 0)
+    return 0;
+  return receiverCounts[(size_t)(t->profileSite - 1) * numClasses +
+                        dynamicType];
+}
+
+/* Returns the receiver type that dominates a call site, or 0. */
+int dominantReceiver(ASTree *t) {
+  long long total = 0, best = 0;
+  int bestType = 0;
+  for (int i = 1; i < numClasses; i++) {
+    long long count = receiverCount(t, i);
+    total += count;
+    if (count > best) {
+      best = count;
+      bestType = i;
+    }
+  }
+  if (best == 0 || best * 100 < total * GUARD_PERCENT)
+    return 0;
+  return bestType;
+}
@@ -0,0 +1,355 @@
+#include "../../include/promote.h"
+#include "../../include/intrinsics.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+/* Most distinct fields tracked per loop */
+#define MAX_LOOP_FIELDS 32
+
+/* Encapsulate a field of `this` accessed inside a loop: its declaration,
+   whether the loop assigns it, and whether the loop also accesses the same
+   field through another reference (so it cannot be promoted). */
+typedef struct loopfield {
+  int declClass;
+  int declIndex;
+  int written;
+  int aliased;
+} LoopField;
+
+/* Everything gathered about one while loop */
+typedef struct loopinfo {
+  int hasCall;
+  int overflow;
+  int numFields;
+  LoopField fields[MAX_LOOP_FIELDS];
+} LoopInfo;
+
+/* The method whose body is being promoted */
+static int currClass, currMethod;
+
+/* Finds the field called name in class classNum or its superclasses.
+   Returns nonzero iff found, storing the declaring class and the index
+   into its varList. */
+static int findField(int classNum, char *name, int *declClass,
+                     int *declIndex) {
+  while (classNum > 0) {
+    ClassDecl *class = &classesST[classNum];
+    for (int i = 0; i < class->numVars; i++) {
+      if (strCompare(name, class->varList[i].varName)) {
+        *declClass = classNum;
+        *declIndex = i;
+        return 1;
+      }
+    }
+    classNum = class->superclass;
+  }
+  return 0;
+}
+
+/* Returns nonzero iff the identifier name refers to a field of `this`
+   in the current method, following code gen's lookup order (parameter,
+   then locals, then fields). */
+static int isThisField(char *name, int *declClass, int *declIndex) {
+  MethodDecl *method = &classesST[currClass].methodList[currMethod];
+  if (strCompare(name, method->paramName))
+    return 0;
+  for (int i = 0; i < method->numLocals; i++)
+    if (strCompare(name, method->localST[i].varName))
+      return 0;
+  return findField(currClass, name, declClass, declIndex);
+}
+
+/* Returns the entry for the given field in info, adding it if needed.
+   Returns NULL when info is full. */
+static LoopField *loopField(LoopInfo *info, int declClass, int declIndex) {
+  for (int i = 0; i < info->numFields; i++)
+    if (info->fields[i].declClass == declClass &&
+        info->fields[i].declIndex == declIndex)
+      return &info->fields[i];
+  if (info->numFields == MAX_LOOP_FIELDS) {
+    info->overflow = 1;
+    return NULL;
+  }
+  LoopField *field = &info->fields[info->numFields++];
+  field->declClass = declClass;
+  field->declIndex = declIndex;
+  field->written = 0;
+  field->aliased = 0;
+  return field;
+}
+
+/* Records every field access and call inside t into info */
+static void scanLoop(ASTree *t, LoopInfo *info) {
+  if (t == NULL)
+    return;
+
+  int declClass, declIndex;
+  LoopField *field;
+  switch (t->typ) {
+  case METHOD_CALL_EXPR:
+  case DOT_METHOD_CALL_EXPR:
+  case JOIN_EXPR: // may run tasks, and sees what the joined one stored
+    info->hasCall = 1;
+    break;
+
+  case ID_EXPR:
+  case ASSIGN_EXPR:
+    if (isThisField(t->children->data->idVal, &declClass, &declIndex)) {
+      field = loopField(info, declClass, declIndex);
+      if (field != NULL && t->typ == ASSIGN_EXPR)
+        field->written = 1;
+    }
+    break;
+
+  case DOT_ID_EXPR:
+  case DOT_ASSIGN_EXPR: {
+    ASTree *obj = t->children->data;
+    int objType = typeExpr(obj, currClass, currMethod);
+    if (findField(objType, t->children->next->data->idVal, &declClass,
+                  &declIndex)) {
+      field = loopField(info, declClass, declIndex);
+      if (field != NULL) {
+        if (obj->typ != THIS_EXPR)
+          field->aliased = 1;
+        else if (t->typ == DOT_ASSIGN_EXPR)
+          field->written = 1;
+      }
+    }
+  } break;
+
+  default:
+    break;
+  }
+
+  for (ASTList *child = t->children; child != NULL; child = child->next)
+    scanLoop(child->data, info);
+}
+
+/* Returns the name of the local that holds the given field while it is
+   promoted in the current method, adding the local if needed.
+   The name starts with a digit, so it cannot clash with a DJ identifier. */
+static char *promotedLocal(int declClass, int declIndex) {
+  VarDecl *var = &classesST[declClass].varList[declIndex];
+  char *name = strConcat("0", var->varName, NULL);
+
+  MethodDecl *method = &classesST[currClass].methodList[currMethod];
+  for (int i = 0; i < method->numLocals; i++) {
+    if (strCompare(name, method->localST[i].varName)) {
+      free(name);
+      return method->localST[i].varName;
+    }
+  }
+
+  method->localST = (VarDecl *)realloc(
+      method->localST, sizeof(VarDecl) * (method->numLocals + 1));
+  VarDecl *local = &method->localST[method->numLocals++];
+  local->varName = name;
+  local->varNameLineNumber = var->varNameLineNumber;
+  local->type = var->type;
+  local->typeLineNumber = var->typeLineNumber;
+  return name;
+}
+
+/* Returns the promoted field of info that the identifier name refers to
+   when accessed on `this`, or NULL */
+static LoopField *promotedField(LoopInfo *info, char *name) {
+  int declClass, declIndex;
+  if (!findField(currClass, name, &declClass, &declIndex))
+    return NULL;
+  for (int i = 0; i < info->numFields; i++)
+    if (info->fields[i].declClass == declClass &&
+        info->fields[i].declIndex == declIndex && !info->fields[i].aliased)
+      return &info->fields[i];
+  return NULL;
+}
+
+/* Renames the AST_ID node id to the local holding field */
+static void renameToLocal(ASTree *id, LoopField *field) {
+  free(id->idVal);
+  id->idVal = getID(promotedLocal(field->declClass, field->declIndex));
+}
+
+/* Rewrites every access to a promoted field inside t into an access to
+   its local */
+static void rewriteAccesses(ASTree *t, LoopInfo *info) {
+  if (t == NULL)
+    return;
+
+  for (ASTList *child = t->children; child != NULL; child = child->next)
+    rewriteAccesses(child->data, info);
+
+  int declClass, declIndex;
+  LoopField *field;
+  switch (t->typ) {
+  case ID_EXPR:
+  case ASSIGN_EXPR:
+    if (isThisField(t->children->data->idVal, &declClass, &declIndex) &&
+        (field = promotedField(info, t->children->data->idVal)) != NULL)
+      renameToLocal(t->children->data, field);
+    break;
+
+  case DOT_ID_EXPR:
+  case DOT_ASSIGN_EXPR:
+    if (t->children->data->typ == THIS_EXPR &&
+        (field = promotedField(info, t->children->next->data->idVal)) !=
+            NULL) {
+      // this.f becomes 0f, and this.f = E becomes 0f = E
+      ASTList *thisNode = t->children;
+      t->children = thisNode->next;
+      freeAST(thisNode->data);
+      free(thisNode);
+      t->typ = t->typ == DOT_ID_EXPR ? ID_EXPR : ASSIGN_EXPR;
+      renameToLocal(t->children->data, field);
+    }
+    break;
+
+  default:
+    break;
+  }
+}
+
+/* Returns a new AST for this.f, for the given field */
+static ASTree *thisFieldAST(VarDecl *var, unsigned int line) {
+  ASTree *t = newAST(DOT_ID_EXPR, newAST(THIS_EXPR, NULL, 0, NULL, line), 0,
+                     NULL, line);
+  appendToChildrenList(t, newAST(AST_ID, NULL, 0, getID(var->varName), line));
+  return t;
+}
+
+/* Returns a new AST for the local that holds the given field */
+static ASTree *localAST(LoopField *field, unsigned int line) {
+  char *name = promotedLocal(field->declClass, field->declIndex);
+  return newAST(ID_EXPR, newAST(AST_ID, NULL, 0, getID(name), line), 0, NULL,
+                line);
+}
+
+/* Returns a new list node holding t */
+static ASTList *listNode(ASTree *t) {
+  ASTList *node = (ASTList *)malloc(sizeof(ASTList));
+  node->data = t;
+  node->next = NULL;
+  return node;
+}
+
+/* Promotes the fields of the while loop held by loopNode, an element of
+   the expression list exprList, if possible.
+   Returns the list node after which processing of exprList resumes. */
+static ASTList *promoteLoop(ASTree *exprList, ASTList *prev,
+                            ASTList *loopNode) {
+  ASTree *loop = loopNode->data;
+  LoopInfo info;
+  info.hasCall = 0;
+  info.overflow = 0;
+  info.numFields = 0;
+  scanLoop(loop, &info);
+
+  int numPromoted = 0;
+  for (int i = 0; i < info.numFields; i++)
+    if (!info.fields[i].aliased)
+      numPromoted++;
+  if (info.hasCall || info.overflow || numPromoted == 0)
+    return NULL;
+
+  rewriteAccesses(loop, &info);
+
+  // 0f = this.f for every promoted field, before the loop
+  ASTList *first = loopNode;
+  for (int i = info.numFields - 1; i >= 0; i--) {
+    LoopField *field = &info.fields[i];
+    if (field->aliased)
+      continue;
+    VarDecl *var = &classesST[field->declClass].varList[field->declIndex];
+    ASTree *load = newAST(ASSIGN_EXPR,
+                          newAST(AST_ID, NULL, 0,
+                                 getID(promotedLocal(field->declClass,
+                                                     field->declIndex)),
+                                 loop->lineNumber),
+                          0, NULL, loop->lineNumber);
+    appendToChildrenList(load, thisFieldAST(var, loop->lineNumber));
+    ASTList *node = listNode(load);
+    node->next = first;
+    first = node;
+  }
+  if (prev == NULL)
+    exprList->children = first;
+  else
+    prev->next = first;
+
+  // this.f = 0f for every promoted field the loop assigns, after the loop
+  ASTList *last = loopNode;
+  for (int i = 0; i < info.numFields; i++) {
+    LoopField *field = &info.fields[i];
+    if (field->aliased || !field->written)
+      continue;
+    VarDecl *var = &classesST[field->declClass].varList[field->declIndex];
+    ASTree *store = thisFieldAST(var, loop->lineNumber);
+    store->typ = DOT_ASSIGN_EXPR;
+    appendToChildrenList(store, localAST(field, loop->lineNumber));
+    ASTList *node = listNode(store);
+    node->next = last->next;
+    last->next = node;
+    last = node;
+  }
+
+  // A loop at the end of the list still gives the list its value of 0
+  if (last != loopNode && last->next == NULL) {
+    ASTList *node = listNode(newAST(NAT_LITERAL_EXPR, NULL, 0, NULL,
+                                    loop->lineNumber));
+    last->next = node;
+    last = node;
+  }
+  if (last->next == NULL)
+    exprList->childrenTail = last;
+
+  return last;
+}
+
+static void promoteInExprs(ASTree *exprList);
+
+/* Promotes loops in the expression lists nested inside t */
+static void promoteInExpr(ASTree *t) {
+  if (t == NULL)
+    return;
+  for (ASTList *child = t->children; child != NULL; child = child->next) {
+    if (child->data != NULL && child->data->typ == EXPR_LIST)
+      promoteInExprs(child->data);
+    else
+      promoteInExpr(child->data);
+  }
+}
+
+/* Promotes loops in the expression list exprList and the lists nested
+   inside it */
+static void promoteInExprs(ASTree *exprList) {
+  ASTList *prev = NULL;
+  ASTList *expr = exprList->children;
+  while (expr != NULL && expr->data != NULL) {
+    ASTList *resume = NULL;
+    if (expr->data->typ == WHILE_EXPR)
+      resume = promoteLoop(exprList, prev, expr);
+    if (resume == NULL) {
+      // Loops that could not be promoted may contain ones that can
+      promoteInExpr(expr->data);
+      resume = expr;
+    }
+    prev = resume;
+    expr = resume->next;
+  }
+}
+
+/* Promotes fields of `this` into locals across while loops. */
+void promoteLoopFields() {
+  for (int i = 1; i < numClasses; i++) {
+    for (int j = 0; j < classesST[i].numMethods && !isIntrinsicClass(i);
+         j++) {
+      currClass = i;
+      currMethod = j;
+      promoteInExprs(classesST[i].methodList[j].bodyExprs);
+    }
+  }
+  for (int i = 0; i < numMethodClones; i++) {
+    currClass = methodClones[i].classNum;
+    currMethod = methodClones[i].methodNum;
+    promoteInExprs(methodClones[i].bodyExprs);
+  }
+}
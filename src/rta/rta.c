@@ -0,0 +1,178 @@
+#include "../../include/rta.h"
+#include <stdlib.h>
+
+/* Whether runRapidTypeAnalysis() has executed */
+static int analyzed = 0;
+
+/* Classes instantiated by reachable code, indexed by class number */
+static int *instantiated;
+
+/* Reachable method bodies, indexed by class number and then method
+   number, and whether each one has been scanned yet */
+static int **methodLive;
+static int **methodScanned;
+
+/* Reachable clones, indexed like methodClones, and whether each one has
+   been scanned yet */
+static int *cloneLive;
+static int *cloneScanned;
+
+/* Method signatures, indexed by class number and then method number, that
+   reachable code calls through the dispatcher */
+static int **dispatchedCalls;
+
+/* Whether reachable code prints or reads nats */
+static int printUsed, readUsed;
+
+/* Whether the last round reached anything new */
+static int reachedNew;
+
+/* Returns an array of numClasses arrays, each holding one zeroed int per
+   method of its class */
+static int **newMethodTable() {
+  int **table = (int **)malloc(sizeof(int *) * numClasses);
+  for (int i = 0; i < numClasses; i++)
+    table[i] = (int *)calloc(classesST[i].numMethods + 1, sizeof(int));
+  return table;
+}
+
+/* Marks method number methodNum of class classNum reachable */
+static void reachMethod(int classNum, int methodNum) {
+  if (!methodLive[classNum][methodNum]) {
+    methodLive[classNum][methodNum] = 1;
+    reachedNew = 1;
+  }
+}
+
+/* Marks the method or clone emitted under label reachable */
+static void reachLabel(char *label) {
+  for (int i = 0; i < numMethodClones; i++) {
+    if (strCompare(label, methodClones[i].label)) {
+      if (!cloneLive[i]) {
+        cloneLive[i] = 1;
+        reachedNew = 1;
+      }
+      return;
+    }
+  }
+  for (int i = 1; i < numClasses; i++)
+    for (int j = 0; j < classesST[i].numMethods; j++)
+      if (strCompare(label, methodLabel(i, j)))
+        reachMethod(i, j);
+}
+
+/* Records the instantiations, calls, and I/O inside t */
+static void scanExpr(ASTree *t) {
+  if (t == NULL)
+    return;
+
+  switch (t->typ) {
+  case NEW_EXPR: {
+    int classNum = classNameToNumber(t->children->data->idVal);
+    if (classNum > 0 && !instantiated[classNum]) {
+      instantiated[classNum] = 1;
+      reachedNew = 1;
+    }
+  } break;
+
+  case METHOD_CALL_EXPR:
+  case DOT_METHOD_CALL_EXPR:
+    if (t->callTarget != NULL)
+      reachLabel(t->callTarget);
+    else if (!dispatchedCalls[t->staticClassNum][t->staticMemberNum]) {
+      dispatchedCalls[t->staticClassNum][t->staticMemberNum] = 1;
+      reachedNew = 1;
+    }
+    break;
+
+  case PRINT_EXPR:
+    printUsed = 1;
+    break;
+
+  case READ_EXPR:
+    readUsed = 1;
+    break;
+
+  default:
+    break;
+  }
+
+  for (ASTList *child = t->children; child != NULL; child = child->next)
+    scanExpr(child->data);
+}
+
+/* Marks the bodies reachable through the dispatcher: for every signature
+   called through it and every instantiated class that can receive the
+   call, the body of the matching dispatcher row */
+static void reachDispatchTargets() {
+  int targetClass, targetMethod;
+  for (int sc = 1; sc < numClasses; sc++) {
+    for (int sm = 0; sm < classesST[sc].numMethods; sm++) {
+      if (!dispatchedCalls[sc][sm])
+        continue;
+      for (int d = 1; d < numClasses; d++) {
+        if (!instantiated[d] || !isSubtype(d, sc) ||
+            !resolveMethod(d, sc, sm, &targetClass, &targetMethod))
+          continue;
+        MethodClone *clone =
+            findCustomizedClone(targetClass, targetMethod, d);
+        if (clone != NULL)
+          reachLabel(clone->label);
+        else
+          reachMethod(targetClass, targetMethod);
+      }
+    }
+  }
+}
+
+/* Finds the parts of the program that can run. */
+void runRapidTypeAnalysis() {
+  instantiated = (int *)calloc(numClasses, sizeof(int));
+  methodLive = newMethodTable();
+  methodScanned = newMethodTable();
+  dispatchedCalls = newMethodTable();
+  cloneLive = (int *)calloc(numMethodClones + 1, sizeof(int));
+  cloneScanned = (int *)calloc(numMethodClones + 1, sizeof(int));
+  printUsed = 0;
+  readUsed = 0;
+
+  scanExpr(mainExprs);
+  do {
+    reachedNew = 0;
+    reachDispatchTargets();
+    for (int i = 1; i < numClasses; i++) {
+      for (int j = 0; j < classesST[i].numMethods; j++) {
+        if (methodLive[i][j] && !methodScanned[i][j]) {
+          methodScanned[i][j] = 1;
+          scanExpr(classesST[i].methodList[j].bodyExprs);
+        }
+      }
+    }
+    for (int i = 0; i < numMethodClones; i++) {
+      if (cloneLive[i] && !cloneScanned[i]) {
+        cloneScanned[i] = 1;
+        scanExpr(methodClones[i].bodyExprs);
+      }
+    }
+  } while (reachedNew);
+
+  analyzed = 1;
+}
+
+/* Returns nonzero iff the given method may run. */
+int isMethodLive(int classNum, int methodNum) {
+  return !analyzed || methodLive[classNum][methodNum];
+}
+
+/* Returns nonzero iff the given clone may run. */
+int isCloneLive(int cloneNum) { return !analyzed || cloneLive[cloneNum]; }
+
+/* Returns nonzero iff the given dispatcher row may match. */
+int isDispatchRowLive(int staticClass, int staticMethod, int dynamicType) {
+  return !analyzed || (dispatchedCalls[staticClass][staticMethod] &&
+                       instantiated[dynamicType]);
+}
+
+/* Returns nonzero iff reachable code may call printNat or readNat. */
+int usesPrintNat() { return !analyzed || printUsed; }
+int usesReadNat() { return !analyzed || readUsed; }
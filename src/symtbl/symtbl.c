@@ -1,4 +1,5 @@
 #include "../../include/symtbl.h"
+#include "../../include/intrinsics.h"
 
 ASTree *wholeProgram;
 int numClasses;
@@ -14,7 +15,8 @@ ASTree *mainExprs;
    NOTE on typing conventions:
    This compiler represents types as integers.
    The DJ type denoted by int i is:
-     The ith class declared in the source program, if i > 0
+     The ith class declared in the source program, if i > 0, or,
+       past those, an intrinsic class the program uses (intrinsics.h)
      Object, if i = 0
      nat, if i = -1
      "any-object" (i.e., the type of "null"), if i = -2
@@ -41,6 +43,9 @@ void setupSymbolTables(ASTree *fullProgramAST) {
     numClasses++;
     currClass = currClass->next;
   }
+  // The intrinsic classes the program uses come after its own
+  int numUserClasses = numClasses;
+  numClasses += countIntrinsicClasses(fullProgramAST);
 
   // Partial Class Symbol Table
   classesST = (ClassDecl *)malloc(sizeof(ClassDecl) * numClasses);
@@ -48,6 +53,10 @@ void setupSymbolTables(ASTree *fullProgramAST) {
   classesST[0].className = "Object";
   classesST[0].superclass = -4;
   classesST[0].isFinal = 0;
+  classesST[0].numVars = 0;
+  classesST[0].varList = NULL;
+  classesST[0].numMethods = 0;
+  classesST[0].methodList = NULL;
   // Setup User Classes
   int classIdx = 1;
   currClass = fullProgramAST->children->data->children;
@@ -86,6 +95,8 @@ void setupSymbolTables(ASTree *fullProgramAST) {
     classIdx++;
     currClass = currClass->next;
   }
+  // Setup Intrinsic Classes
+  setupIntrinsicClasses(numUserClasses);
 
   // Complete Class Symbol Table
   classIdx = 1;
@@ -1,4 +1,5 @@
 #include "../../include/typecheck.h"
+#include "../../include/intrinsics.h"
 #include <stdio.h>
 
 typedef enum { INTERNAL_ERR, EXTERNAL_ERR } ErrorType;
@@ -25,6 +26,10 @@ void typecheckProgram() {
   // Assert that there are no cycles in class inheritance
   assertAcyclicClassHeirarchies();
   for (int i = 1; i < numClasses; i++) {
+    // The runtime implements the intrinsic classes
+    if (isIntrinsicClass(i))
+      continue;
+
     // Check each class
     checkClass(&classesST[i], i, numClasses);
 
@@ -470,6 +475,43 @@ int typeExpr(ASTree *t, int classContainingExpr, int methodContainingExpr) {
   else if (t->typ == READ_EXPR)
     return -1;
 
+  /* A spawn expression is well typed (with a nat type, that of the handle of
+  the task it starts) exactly when its subexpression is a well-typed call of a
+  method that returns a nat, and not a method of an intrinsic class. */
+  else if (t->typ == SPAWN_EXPR) {
+    ASTree *call = t->children->data;
+    if (call->typ != METHOD_CALL_EXPR && call->typ != DOT_METHOD_CALL_EXPR)
+      exitWithError(EXTERNAL_ERR,
+                    "Bad argument for `spawn`. Must be a method call",
+                    call->lineNumber);
+    int callType = typeExpr(call, classContainingExpr, methodContainingExpr);
+
+    if (isIntrinsicClass(call->staticClassNum))
+      exitWithError(EXTERNAL_ERR,
+                    "Bad argument for `spawn`. Cannot spawn a method of an "
+                    "intrinsic class",
+                    call->lineNumber);
+    else if (callType == -1)
+      return -1;
+    else
+      exitWithError(EXTERNAL_ERR,
+                    "Bad argument for `spawn`. The method must return a nat",
+                    call->lineNumber);
+  }
+
+  /* A join expression is well typed (with a nat type, that of the result of
+  the task it waits for) exactly when its subexpression has nat type. */
+  else if (t->typ == JOIN_EXPR) {
+    int exprType =
+        typeExpr(t->children->data, classContainingExpr, methodContainingExpr);
+
+    if (exprType == -1)
+      return -1;
+    else
+      exitWithError(EXTERNAL_ERR, "Bad argument for `join`. Must be a nat type",
+                    t->children->data->lineNumber);
+  }
+
   /* A use of the `this` keyword must appear inside a declaration of some class
   C, in which case this has type C. */
   else if (t->typ == THIS_EXPR) {
@@ -0,0 +1,575 @@
+/* File djheap.c: Summarizes a heap dump written by a DJ program compiled
+   with --heap-dump (see heapdump.h).
+
+   Usage: djheap [-n N] FILE
+
+   Prints the objects and bytes of each class, and the bytes each class
+   retains: the bytes that would become garbage if every object of the
+   class were unreachable. Then prints the N (default 10) objects that
+   retain the most bytes, the dominators of the heap.
+
+   Roots are the stack words that are addresses of objects, and the
+   objects of the heap image, which is never freed; no other memory of
+   the program holds references. An object is reachable when a chain of
+   references leads to it from a root.
+   Object x dominates object y when every such chain to y goes through x;
+   x retains the bytes of the objects it dominates, itself included.
+   Dominators are computed with the Lengauer-Tarjan algorithm, with
+   explicit stacks rather than recursion, so heaps with millions of
+   objects (and lists millions long) are fine. */
+
+#include "../include/heapdump.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define WORD_SIZE 8
+
+/* Default number of dominators printed */
+#define DEFAULT_TOP_DOMINATORS 10
+
+/* Encapsulate a class of the dumped program: its object size, the
+   offsets of its reference fields, and its name */
+typedef struct dumpclass {
+  long long size;
+  long long numRefs;
+  long long *refOffsets;
+  char *name;
+} DumpClass;
+
+/* Encapsulate an object of the dump: its address, type id, where its
+   contents are in the dump, and whether it is in the heap image */
+typedef struct dumpobject {
+  long long address;
+  long long type;
+  const unsigned char *contents;
+  int inImage;
+} DumpObject;
+
+/* The whole dump, read into memory, and the next word to read */
+static unsigned char *dump;
+static long long dumpSize;
+static long long readPos;
+
+static long long numClasses;
+static int compressed;
+static long long base; // what compressed references are offsets from
+static DumpClass *classes;
+
+static DumpObject *objects;
+static long long numObjects;
+static long long objectsCapacity;
+
+/* The words of the stack segments */
+static const unsigned char *stackWords;
+static long long numStackWords;
+
+static void fail(const char *message) {
+  fprintf(stderr, "djheap: %s\n", message);
+  exit(EXIT_FAILURE);
+}
+
+static void *checkedMalloc(size_t size) {
+  void *p = malloc(size > 0 ? size : 1);
+  if (p == NULL)
+    fail("out of memory");
+  return p;
+}
+
+static long long loadWord(const unsigned char *p) {
+  unsigned long long word = 0;
+  for (int i = WORD_SIZE - 1; i >= 0; i--)
+    word = word << 8 | p[i];
+  return (long long)word;
+}
+
+static long long loadHalfWord(const unsigned char *p) {
+  return (long long)((unsigned long long)p[0] | (unsigned long long)p[1] << 8 |
+                     (unsigned long long)p[2] << 16 |
+                     (unsigned long long)p[3] << 24);
+}
+
+static long long readWord() {
+  if (readPos + WORD_SIZE > dumpSize)
+    fail("truncated heap dump");
+  long long word = loadWord(dump + readPos);
+  readPos += WORD_SIZE;
+  return word;
+}
+
+static void readDump(const char *fileName) {
+  FILE *in = fopen(fileName, "rb");
+  if (in == NULL)
+    fail("cannot open the heap dump");
+  fseek(in, 0, SEEK_END);
+  dumpSize = ftell(in);
+  fseek(in, 0, SEEK_SET);
+  dump = (unsigned char *)checkedMalloc(dumpSize);
+  if (fread(dump, 1, dumpSize, in) != (size_t)dumpSize)
+    fail("cannot read the heap dump");
+  fclose(in);
+}
+
+/* Reads the classes after the magic string */
+static void readClasses() {
+  if (dumpSize < WORD_SIZE || memcmp(dump, HEAP_DUMP_MAGIC, WORD_SIZE) != 0)
+    fail("not a DJ heap dump");
+  readPos = WORD_SIZE;
+  numClasses = readWord();
+  compressed = readWord() != 0;
+  base = readWord();
+  if (numClasses <= 0 || numClasses > dumpSize)
+    fail("bad class count");
+  classes = (DumpClass *)checkedMalloc(sizeof(DumpClass) * numClasses);
+  for (long long i = 0; i < numClasses; i++) {
+    DumpClass *class = &classes[i];
+    class->size = readWord();
+    class->numRefs = readWord();
+    if (class->size < WORD_SIZE || class->size % WORD_SIZE != 0 ||
+        class->numRefs < 0 || class->numRefs > class->size)
+      fail("bad class layout");
+    class->refOffsets =
+        (long long *)checkedMalloc(sizeof(long long) * class->numRefs);
+    for (long long j = 0; j < class->numRefs; j++)
+      class->refOffsets[j] = readWord();
+    long long nameLength = readWord();
+    if (nameLength < 0 || readPos + nameLength > dumpSize)
+      fail("bad class name");
+    class->name = (char *)checkedMalloc(nameLength + 1);
+    memcpy(class->name, dump + readPos, nameLength);
+    class->name[nameLength] = '\0';
+    readPos += (nameLength + WORD_SIZE - 1) / WORD_SIZE * WORD_SIZE;
+  }
+}
+
+static void addObject(long long address, long long type,
+                      const unsigned char *contents, int inImage) {
+  if (numObjects == objectsCapacity) {
+    objectsCapacity = objectsCapacity ? 2 * objectsCapacity : 1024;
+    objects = (DumpObject *)realloc(objects,
+                                    sizeof(DumpObject) * objectsCapacity);
+    if (objects == NULL)
+      fail("out of memory");
+  }
+  DumpObject object = {address, type, contents, inImage};
+  objects[numObjects++] = object;
+}
+
+/* Finds the objects of an image or heap segment */
+static void readObjects(long long start, const unsigned char *contents,
+                        long long length, int inImage) {
+  long long pos = 0;
+  while (pos + WORD_SIZE <= length) {
+    long long type = compressed ? loadHalfWord(contents + pos)
+                                : loadWord(contents + pos);
+    if (type < 0 || type >= numClasses)
+      fail("bad type id in a heap segment");
+    if (type == 0) { // a gap, or an Object, which has no references
+      pos += WORD_SIZE;
+      continue;
+    }
+    if (pos + classes[type].size > length)
+      fail("object past the end of its segment");
+    addObject(start + pos, type, contents + pos, inImage);
+    pos += classes[type].size;
+  }
+}
+
+/* Reads the segments after the classes */
+static void readSegments() {
+  while (readPos < dumpSize) {
+    long long kind = readWord();
+    long long start = readWord();
+    long long length = readWord();
+    if (length < 0 || readPos + length > dumpSize)
+      fail("truncated segment");
+    if (kind == DUMP_SEGMENT_STACK) {
+      stackWords = dump + readPos;
+      numStackWords = length / WORD_SIZE;
+    } else if (kind == DUMP_SEGMENT_IMAGE || kind == DUMP_SEGMENT_HEAP) {
+      readObjects(start, dump + readPos, length,
+                  kind == DUMP_SEGMENT_IMAGE);
+    } else {
+      fail("bad segment kind");
+    }
+    readPos += length;
+  }
+}
+
+static int compareAddresses(const void *a, const void *b) {
+  long long x = ((const DumpObject *)a)->address;
+  long long y = ((const DumpObject *)b)->address;
+  return x < y ? -1 : x > y;
+}
+
+/* Returns the index of the object at address, or -1 */
+static long long findObject(long long address) {
+  long long low = 0, high = numObjects - 1;
+  while (low <= high) {
+    long long mid = low + (high - low) / 2;
+    if (objects[mid].address == address)
+      return mid;
+    if (objects[mid].address < address)
+      low = mid + 1;
+    else
+      high = mid - 1;
+  }
+  return -1;
+}
+
+/* Returns the address reference field number field of object o
+   refers to, or 0 for null */
+static long long referenceOf(DumpObject *o, long long field) {
+  const unsigned char *slot =
+      o->contents + classes[o->type].refOffsets[field];
+  if (!compressed)
+    return loadWord(slot);
+  long long offset = loadHalfWord(slot);
+  return offset == 0 ? 0 : base + offset;
+}
+
+/* The object graph, plus a root node (number numObjects) whose
+   successors are the roots, as successor lists: the successors of node
+   v are succ[succStart[v] .. succStart[v + 1]) */
+static long long *succStart;
+static long long *succ;
+
+static void buildGraph() {
+  long long numNodes = numObjects + 1;
+  succStart = (long long *)calloc(numNodes + 1, sizeof(long long));
+  char *isRoot = (char *)calloc(numObjects + 1, 1);
+  if (succStart == NULL || isRoot == NULL)
+    fail("out of memory");
+
+  // Count, then fill, the successors of each node
+  for (int fill = 0; fill < 2; fill++) {
+    long long *next = NULL;
+    if (fill) {
+      for (long long v = 0; v < numNodes; v++)
+        succStart[v + 1] += succStart[v];
+      succ = (long long *)checkedMalloc(sizeof(long long) *
+                                        succStart[numNodes]);
+      next = (long long *)checkedMalloc(sizeof(long long) * numNodes);
+      memcpy(next, succStart, sizeof(long long) * numNodes);
+    }
+    for (long long v = 0; v < numObjects; v++) {
+      DumpObject *o = &objects[v];
+      for (long long f = 0; f < classes[o->type].numRefs; f++) {
+        long long w = findObject(referenceOf(o, f));
+        if (w < 0)
+          continue;
+        if (fill)
+          succ[next[v]++] = w;
+        else
+          succStart[v + 1]++;
+      }
+    }
+    for (long long i = 0; i < numStackWords + numObjects; i++) {
+      long long w;
+      if (i < numStackWords)
+        w = findObject(loadWord(stackWords + i * WORD_SIZE));
+      else
+        w = objects[i - numStackWords].inImage ? i - numStackWords : -1;
+      if (w < 0 || isRoot[w] == fill + 1)
+        continue;
+      isRoot[w] = fill + 1;
+      if (fill)
+        succ[next[numObjects]++] = w;
+      else
+        succStart[numObjects + 1]++;
+    }
+    free(next);
+  }
+  free(isRoot);
+}
+
+/* Dominator tree of the nodes reachable from the root, numbered in
+   depth-first preorder (the root is 0): vertex[i] is the node numbered
+   i, and idom[i] the number of its immediate dominator */
+static long long numReachable;
+static long long *vertex;
+static long long *idom;
+
+/* Numbers the nodes reachable from the root in depth-first preorder,
+   and records each one's depth-first tree parent; number[v] is -1 for
+   unreachable nodes */
+static void depthFirstNumber(long long *number, long long *parent) {
+  long long numNodes = numObjects + 1;
+  long long *stack = (long long *)checkedMalloc(sizeof(long long) * numNodes);
+  long long *nextEdge =
+      (long long *)checkedMalloc(sizeof(long long) * numNodes);
+  for (long long v = 0; v < numNodes; v++)
+    number[v] = -1;
+  long long root = numObjects, depth = 0;
+  number[root] = 0;
+  vertex[0] = root;
+  parent[0] = -1;
+  numReachable = 1;
+  stack[depth++] = root;
+  nextEdge[root] = succStart[root];
+  while (depth > 0) {
+    long long v = stack[depth - 1];
+    if (nextEdge[v] == succStart[v + 1]) {
+      depth--;
+      continue;
+    }
+    long long w = succ[nextEdge[v]++];
+    if (number[w] >= 0)
+      continue;
+    number[w] = numReachable;
+    vertex[numReachable] = w;
+    parent[numReachable] = number[v];
+    numReachable++;
+    nextEdge[w] = succStart[w];
+    stack[depth++] = w;
+  }
+  free(stack);
+  free(nextEdge);
+}
+
+/* Lengauer-Tarjan state, by preorder number */
+static long long *semi, *ancestor, *best;
+
+/* Returns the ancestor of i in the forest linked so far whose semi-
+   dominator has the lowest number, compressing the path to it */
+static long long lowestSemiAncestor(long long i, long long *path) {
+  if (ancestor[i] < 0)
+    return i;
+  long long length = 0;
+  for (long long u = i; ancestor[ancestor[u]] >= 0; u = ancestor[u])
+    path[length++] = u;
+  while (length > 0) {
+    long long u = path[--length];
+    long long a = ancestor[u];
+    if (semi[best[a]] < semi[best[u]])
+      best[u] = best[a];
+    ancestor[u] = ancestor[a];
+  }
+  return best[i];
+}
+
+static void computeDominators() {
+  long long numNodes = numObjects + 1;
+  long long *number = (long long *)checkedMalloc(sizeof(long long) * numNodes);
+  long long *parent = (long long *)checkedMalloc(sizeof(long long) * numNodes);
+  vertex = (long long *)checkedMalloc(sizeof(long long) * numNodes);
+  depthFirstNumber(number, parent);
+  long long n = numReachable;
+
+  // Predecessor lists, by preorder number, of the reachable nodes
+  long long *predStart = (long long *)calloc(n + 1, sizeof(long long));
+  if (predStart == NULL)
+    fail("out of memory");
+  for (long long v = 0; v < numNodes; v++)
+    if (number[v] >= 0)
+      for (long long e = succStart[v]; e < succStart[v + 1]; e++)
+        predStart[number[succ[e]] + 1]++;
+  for (long long i = 0; i < n; i++)
+    predStart[i + 1] += predStart[i];
+  long long *pred =
+      (long long *)checkedMalloc(sizeof(long long) * predStart[n]);
+  long long *next = (long long *)checkedMalloc(sizeof(long long) * n);
+  memcpy(next, predStart, sizeof(long long) * n);
+  for (long long v = 0; v < numNodes; v++)
+    if (number[v] >= 0)
+      for (long long e = succStart[v]; e < succStart[v + 1]; e++)
+        pred[next[number[succ[e]]]++] = number[v];
+
+  semi = (long long *)checkedMalloc(sizeof(long long) * n);
+  ancestor = (long long *)checkedMalloc(sizeof(long long) * n);
+  best = (long long *)checkedMalloc(sizeof(long long) * n);
+  idom = (long long *)checkedMalloc(sizeof(long long) * n);
+  long long *sameDom = (long long *)checkedMalloc(sizeof(long long) * n);
+  long long *bucketHead = (long long *)checkedMalloc(sizeof(long long) * n);
+  long long *bucketNext = (long long *)checkedMalloc(sizeof(long long) * n);
+  long long *path = (long long *)checkedMalloc(sizeof(long long) * n);
+  for (long long i = 0; i < n; i++) {
+    semi[i] = i;
+    ancestor[i] = -1;
+    best[i] = i;
+    idom[i] = -1;
+    sameDom[i] = -1;
+    bucketHead[i] = -1;
+  }
+
+  for (long long i = n - 1; i > 0; i--) {
+    long long p = parent[i], s = p;
+    for (long long e = predStart[i]; e < predStart[i + 1]; e++) {
+      long long v = pred[e];
+      long long candidate = v <= i ? v : semi[lowestSemiAncestor(v, path)];
+      if (candidate < s)
+        s = candidate;
+    }
+    semi[i] = s;
+    bucketNext[i] = bucketHead[s];
+    bucketHead[s] = i;
+    ancestor[i] = p; // link
+    for (long long v = bucketHead[p]; v >= 0; v = bucketNext[v]) {
+      long long y = lowestSemiAncestor(v, path);
+      if (semi[y] == semi[v])
+        idom[v] = p;
+      else
+        sameDom[v] = y;
+    }
+    bucketHead[p] = -1;
+  }
+  for (long long i = 1; i < n; i++)
+    if (sameDom[i] >= 0)
+      idom[i] = idom[sameDom[i]];
+
+  free(number);
+  free(parent);
+  free(predStart);
+  free(pred);
+  free(next);
+  free(semi);
+  free(ancestor);
+  free(best);
+  free(sameDom);
+  free(bucketHead);
+  free(bucketNext);
+  free(path);
+}
+
+/* Encapsulate the totals of a class */
+typedef struct classtotals {
+  long long type;
+  long long objects;
+  long long bytes;
+  long long retained;
+} ClassTotals;
+
+static int compareRetained(const void *a, const void *b) {
+  long long x = ((const ClassTotals *)a)->retained;
+  long long y = ((const ClassTotals *)b)->retained;
+  return x > y ? -1 : x < y;
+}
+
+static void printSummary(const char *fileName, int topDominators) {
+  long long n = numReachable;
+  long long *retained = (long long *)checkedMalloc(sizeof(long long) * n);
+  long long *subtree = (long long *)checkedMalloc(sizeof(long long) * n);
+  retained[0] = 0;
+  subtree[0] = 1;
+  for (long long i = 1; i < n; i++) {
+    retained[i] = classes[objects[vertex[i]].type].size;
+    subtree[i] = 1;
+  }
+  // Immediate dominators come before what they dominate in preorder
+  for (long long i = n - 1; i > 0; i--) {
+    retained[idom[i]] += retained[i];
+    subtree[idom[i]] += subtree[i];
+  }
+
+  long long totalBytes = 0;
+  ClassTotals *totals =
+      (ClassTotals *)checkedMalloc(sizeof(ClassTotals) * numClasses);
+  for (long long c = 0; c < numClasses; c++) {
+    ClassTotals zero = {c, 0, 0, 0};
+    totals[c] = zero;
+  }
+  for (long long v = 0; v < numObjects; v++) {
+    totals[objects[v].type].objects++;
+    totals[objects[v].type].bytes += classes[objects[v].type].size;
+    totalBytes += classes[objects[v].type].size;
+  }
+
+  // A class retains what its instances retain, counting instances that
+  // other instances of it dominate only once: with the dominator tree
+  // laid out in preorder, an instance is dominated by another iff it
+  // falls in that one's subtree
+  long long *order = (long long *)checkedMalloc(sizeof(long long) * n);
+  long long *nextPos = (long long *)checkedMalloc(sizeof(long long) * n);
+  long long *position = (long long *)checkedMalloc(sizeof(long long) * n);
+  position[0] = 0;
+  nextPos[0] = 1;
+  for (long long i = 1; i < n; i++) {
+    position[i] = nextPos[idom[i]];
+    nextPos[idom[i]] += subtree[i];
+    nextPos[i] = position[i] + 1;
+  }
+  for (long long i = 0; i < n; i++)
+    order[position[i]] = i;
+  long long *coveredUntil =
+      (long long *)calloc(numClasses, sizeof(long long));
+  if (coveredUntil == NULL)
+    fail("out of memory");
+  for (long long k = 1; k < n; k++) {
+    long long i = order[k];
+    long long type = objects[vertex[i]].type;
+    if (k < coveredUntil[type])
+      continue;
+    coveredUntil[type] = k + subtree[i];
+    totals[type].retained += retained[i];
+  }
+
+  printf("Heap dump %s: %lld objects, %lld bytes\n", fileName, numObjects,
+         totalBytes);
+  printf("Reachable: %lld objects, %lld bytes\n", n - 1, retained[0]);
+  printf("\n%-24s %12s %14s %14s\n", "Class", "Objects", "Bytes",
+         "Retained");
+  qsort(totals, numClasses, sizeof(ClassTotals), compareRetained);
+  for (long long c = 0; c < numClasses; c++)
+    if (totals[c].objects > 0)
+      printf("%-24s %12lld %14lld %14lld\n", classes[totals[c].type].name,
+             totals[c].objects, totals[c].bytes, totals[c].retained);
+
+  // The dominators retaining the most, by repeated selection, which is
+  // cheap for the few printed
+  printf("\nTop dominators:\n");
+  printf("%-18s %-24s %12s %14s\n", "Address", "Class", "Dominates",
+         "Retained");
+  char *printed = (char *)calloc(n, 1);
+  if (printed == NULL)
+    fail("out of memory");
+  for (int k = 0; k < topDominators; k++) {
+    long long top = -1;
+    for (long long i = 1; i < n; i++)
+      if (!printed[i] && (top < 0 || retained[i] > retained[top]))
+        top = i;
+    if (top < 0)
+      break;
+    printed[top] = 1;
+    DumpObject *o = &objects[vertex[top]];
+    printf("0x%016llx %-24s %12lld %14lld\n", (unsigned long long)o->address,
+           classes[o->type].name, subtree[top] - 1, retained[top]);
+  }
+
+  free(retained);
+  free(subtree);
+  free(totals);
+  free(order);
+  free(nextPos);
+  free(position);
+  free(coveredUntil);
+  free(printed);
+}
+
+int main(int argc, char **argv) {
+  int topDominators = DEFAULT_TOP_DOMINATORS;
+  const char *fileName = NULL;
+  int badUsage = 0;
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "-n") == 0 && i + 1 < argc)
+      topDominators = atoi(argv[++i]);
+    else if (fileName == NULL)
+      fileName = argv[i];
+    else
+      badUsage = 1;
+  }
+  if (fileName == NULL || badUsage) {
+    printf("Usage: djheap [-n N] FILE\n");
+    printf("Summarizes a heap dump written by a DJ program compiled with "
+           "--heap-dump.\n");
+    return EXIT_FAILURE;
+  }
+
+  readDump(fileName);
+  readClasses();
+  readSegments();
+  qsort(objects, numObjects, sizeof(DumpObject), compareAddresses);
+  buildGraph();
+  computeDominators();
+  printSummary(fileName, topDominators);
+  return EXIT_SUCCESS;
+}
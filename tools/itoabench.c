@@ -0,0 +1,262 @@
+/* File itoabench.c: Microbenchmark of the conversion of nats to decimal
+   in _print_int, the printNat runtime of compiled DJ programs.
+
+   Usage: itoabench [-n N]
+
+   Times two conversions, each the runtime's instruction sequence run as
+   inline assembly, so that what is measured does not depend on how this
+   file is compiled:
+     div    the former one: a 64-bit div per digit, the digits written
+            last first to a scratch area, then copied to the buffer;
+     fast   the current one: the number of digits from the bit length
+            and a table of powers of 10, then two digits at a time from
+            a table, written in place, dividing by 100 with a
+            multiplication by its reciprocal.
+   The nats cover the full 64-bit range: N (default 100000) random nats
+   of each bit length from 1 to 64, which are converted, one after the
+   other, into an output buffer like the runtime's. Both conversions are
+   first checked against snprintf on every nat. Prints the nanoseconds
+   per nat of each conversion for nats of 1-5, 6-10, 11-15, and 16-20
+   digits, and over all nats. */
+
+#include <inttypes.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/* The runtime's output buffer size, and the most bytes a nat and its
+   newline take */
+#define OUTPUT_BUFFER_SIZE (64 * 1024)
+#define MAX_PRINTED_NAT 21
+
+/* Default number of nats of each bit length */
+#define DEFAULT_NATS_PER_LENGTH 100000
+
+/* Rounds each conversion is timed for; the fastest counts */
+#define ROUNDS 5
+
+/* Groups of nats by their number of digits, in the report */
+#define NUM_GROUPS 4
+#define DIGITS_PER_GROUP 5
+
+/* The tables of the fast conversion, as the runtime's print_powers and
+   print_pairs */
+static uint64_t powers[MAX_PRINTED_NAT - 1];
+static char pairs[200];
+
+/* Returns the end of the digits and newline of v written at out, by the
+   former conversion; scratch holds MAX_PRINTED_NAT bytes */
+static char *convertDiv(uint64_t v, char *out, char *scratch) {
+  char *scratchEnd = scratch + MAX_PRINTED_NAT;
+  __asm__ volatile(".intel_syntax noprefix\n\t"
+                   "mov rbx, 10\n\t"
+                   "mov r8, rsi\n"
+                   "1:\n\t"
+                   "xor edx, edx\n\t"
+                   "div rbx\n\t"
+                   "add dl, 48\n\t"
+                   "dec rsi\n\t"
+                   "mov [rsi], dl\n\t"
+                   "test rax, rax\n\t"
+                   "jnz 1b\n\t"
+                   "mov rcx, r8\n\t"
+                   "sub rcx, rsi\n\t"
+                   "rep movsb\n\t"
+                   "mov byte ptr [rdi], 10\n\t"
+                   "inc rdi\n\t"
+                   ".att_syntax prefix"
+                   : "+a"(v), "+D"(out), "+S"(scratchEnd)
+                   :
+                   : "rbx", "rcx", "rdx", "r8", "memory", "cc");
+  return out;
+}
+
+/* Returns the end of the digits and newline of v written at out, by the
+   fast conversion */
+static char *convertFast(uint64_t v, char *out) {
+  const uint64_t *powerTable = powers;
+  const char *pairTable = pairs;
+  __asm__ volatile(".intel_syntax noprefix\n\t"
+                   "mov rax, rsi\n\t"
+                   "or rax, 1\n\t"
+                   "bsr rax, rax\n\t"
+                   "inc eax\n\t"
+                   "imul eax, eax, 1233\n\t"
+                   "shr eax, 12\n\t"
+                   "cmp rsi, [rcx + rax * 8]\n\t"
+                   "sbb eax, -1\n\t"
+                   "add rdi, rax\n\t"
+                   "mov byte ptr [rdi], 10\n\t"
+                   "lea r8, [rdi + 1]\n"
+                   "2:\n\t"
+                   "cmp rsi, 100\n\t"
+                   "jb 3f\n\t"
+                   "mov rax, rsi\n\t"
+                   "shr rax, 2\n\t"
+                   "mov rdx, 0x28F5C28F5C28F5C3\n\t"
+                   "mul rdx\n\t"
+                   "shr rdx, 2\n\t"
+                   "imul rax, rdx, 100\n\t"
+                   "sub rsi, rax\n\t"
+                   "movzx eax, word ptr [rbx + rsi * 2]\n\t"
+                   "sub rdi, 2\n\t"
+                   "mov [rdi], ax\n\t"
+                   "mov rsi, rdx\n\t"
+                   "jmp 2b\n"
+                   "3:\n\t"
+                   "cmp rsi, 10\n\t"
+                   "jb 4f\n\t"
+                   "movzx eax, word ptr [rbx + rsi * 2]\n\t"
+                   "mov [rdi - 2], ax\n\t"
+                   "jmp 5f\n"
+                   "4:\n\t"
+                   "add esi, 48\n\t"
+                   "mov [rdi - 1], sil\n"
+                   "5:\n\t"
+                   "mov rdi, r8\n\t"
+                   ".att_syntax prefix"
+                   : "+S"(v), "+D"(out), "+c"(powerTable), "+b"(pairTable)
+                   :
+                   : "rax", "rdx", "r8", "memory", "cc");
+  return out;
+}
+
+/* Returns the next number of a xorshift generator */
+static uint64_t nextRandom(uint64_t *state) {
+  *state ^= *state << 13;
+  *state ^= *state >> 7;
+  *state ^= *state << 17;
+  return *state;
+}
+
+/* Returns the number of decimal digits of v */
+static int countDigits(uint64_t v) {
+  int digits = 1;
+  while (v >= 10) {
+    v /= 10;
+    digits++;
+  }
+  return digits;
+}
+
+/* Returns the current time in nanoseconds */
+static double now() {
+  struct timespec t;
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return t.tv_sec * 1e9 + t.tv_nsec;
+}
+
+/* Returns the fewest nanoseconds, over ROUNDS rounds, the conversion
+   (fast when fast is nonzero) takes for the n nats of v */
+static double timeConversion(int fast, const uint64_t *v, long n,
+                             char *buffer) {
+  char scratch[MAX_PRINTED_NAT];
+  double best = 0;
+  for (int round = 0; round < ROUNDS; round++) {
+    char *out = buffer;
+    double start = now();
+    for (long i = 0; i < n; i++) {
+      if (out - buffer > OUTPUT_BUFFER_SIZE - MAX_PRINTED_NAT)
+        out = buffer; // as a flush would
+      out = fast ? convertFast(v[i], out) : convertDiv(v[i], out, scratch);
+    }
+    double elapsed = now() - start;
+    if (round == 0 || elapsed < best)
+      best = elapsed;
+  }
+  return best;
+}
+
+/* Exits with a message unless both conversions of every nat of v agree
+   with snprintf */
+static void checkConversions(const uint64_t *v, long n) {
+  char expected[MAX_PRINTED_NAT + 1];
+  char got[MAX_PRINTED_NAT + 1];
+  char scratch[MAX_PRINTED_NAT];
+  for (long i = 0; i < n; i++) {
+    int length = snprintf(expected, sizeof(expected), "%" PRIu64 "\n", v[i]);
+    for (int fast = 0; fast <= 1; fast++) {
+      char *end =
+          fast ? convertFast(v[i], got) : convertDiv(v[i], got, scratch);
+      if (end - got != length || memcmp(got, expected, length) != 0) {
+        printf("The %s conversion of %" PRIu64 " is wrong\n",
+               fast ? "fast" : "div", v[i]);
+        exit(EXIT_FAILURE);
+      }
+    }
+  }
+}
+
+int main(int argc, char **argv) {
+  long perLength = DEFAULT_NATS_PER_LENGTH;
+  int badUsage = 0;
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "-n") == 0 && i + 1 < argc)
+      perLength = atol(argv[++i]);
+    else
+      badUsage = 1;
+  }
+  if (badUsage || perLength <= 0) {
+    printf("Usage: itoabench [-n N]\n");
+    printf("Times printNat's conversion of N nats of each bit length to "
+           "decimal.\n");
+    return EXIT_FAILURE;
+  }
+
+  powers[0] = 0; // so that 0 has a digit
+  uint64_t power = 1;
+  for (int digits = 1; digits < MAX_PRINTED_NAT - 1; digits++) {
+    power *= 10;
+    powers[digits] = power;
+  }
+  for (int i = 0; i < 100; i++) {
+    pairs[2 * i] = '0' + i / 10;
+    pairs[2 * i + 1] = '0' + i % 10;
+  }
+
+  // The nats of each group, of every bit length in turn
+  uint64_t *nats[NUM_GROUPS];
+  long numNats[NUM_GROUPS] = {0};
+  for (int g = 0; g < NUM_GROUPS; g++)
+    nats[g] = (uint64_t *)malloc(sizeof(uint64_t) * 64 * perLength);
+  uint64_t state = 88172645463325252ULL;
+  for (long i = 0; i < perLength; i++)
+    for (int bits = 1; bits <= 64; bits++) {
+      uint64_t v = nextRandom(&state);
+      if (bits < 64)
+        v = (v & ((1ULL << bits) - 1)) | (1ULL << (bits - 1));
+      else
+        v |= 1ULL << 63;
+      int g = (countDigits(v) - 1) / DIGITS_PER_GROUP;
+      nats[g][numNats[g]++] = v;
+    }
+
+  uint64_t edges[] = {0, 9, 10, 99, 100, 999, 1000, UINT64_MAX};
+  checkConversions(edges, sizeof(edges) / sizeof(edges[0]));
+
+  char *buffer = (char *)malloc(OUTPUT_BUFFER_SIZE);
+  printf("%-8s %12s %12s %12s %8s\n", "digits", "nats", "div ns/nat",
+         "fast ns/nat", "speedup");
+  double totalDiv = 0, totalFast = 0;
+  long total = 0;
+  for (int g = 0; g < NUM_GROUPS; g++) {
+    checkConversions(nats[g], numNats[g]);
+    double divNs = timeConversion(0, nats[g], numNats[g], buffer);
+    double fastNs = timeConversion(1, nats[g], numNats[g], buffer);
+    totalDiv += divNs;
+    totalFast += fastNs;
+    total += numNats[g];
+    printf("%2d-%-5d %12ld %12.2f %12.2f %7.2fx\n", g * DIGITS_PER_GROUP + 1,
+           (g + 1) * DIGITS_PER_GROUP, numNats[g], divNs / numNats[g],
+           fastNs / numNats[g], divNs / fastNs);
+  }
+  printf("%-8s %12ld %12.2f %12.2f %7.2fx\n", "all", total, totalDiv / total,
+         totalFast / total, totalDiv / totalFast);
+
+  for (int g = 0; g < NUM_GROUPS; g++)
+    free(nats[g]);
+  free(buffer);
+  return EXIT_SUCCESS;
+}